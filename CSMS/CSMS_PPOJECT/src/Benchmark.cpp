@@ -0,0 +1,779 @@
+// ===== Benchmark.cpp =====
+// Microbenchmarks for the core store operations.
+//
+// A store is populated by DataGenerator from a fixed seed, then each
+// benchmark is calibrated to run for at least --min-time and repeated;
+// results are written as JSON lines or CSV so runs can be compared.
+#include "Product.h"
+#include "Customer.h"
+#include "Transaction.h"
+#include "InventoryManager.h"
+#include "Store.h"
+#include "DataGenerator.h"
+#include "NullBuffer.h"
+#include "LatencyHistogram.h"
+#include "StorageTables.h"
+#include "TransactionArchive.h"
+#include "HeadOffice.h"
+#include "StockTransfer.h"
+#include "PersistenceFlusher.h"
+#include "SnapshotCatalog.h"
+#include "Gtin.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Command-line configurable benchmark parameters
+ */
+struct BenchmarkConfig {
+    GeneratorConfig data;
+    int transactionCount;
+    long cubeLines;           // Synthetic lines added to the sales cube
+    long storageRows;         // Rows in the on-disk B+tree benchmarks
+    long storageCacheKB;      // Buffer pool size for those benchmarks
+    double minSeconds;        // Minimum measured time per repetition
+    int repetitions;
+    std::string filter;       // Only run benchmarks whose name contains this
+    bool csv;
+    std::string outputPath;   // Empty = stdout
+
+    BenchmarkConfig()
+        : transactionCount(20000), cubeLines(0), storageRows(100000), storageCacheKB(1024), minSeconds(0.05),
+          repetitions(5), csv(false) {
+        data.productCount = 5000;
+        data.customerCount = 5000;
+        data.historyDays = 60;
+    }
+};
+
+/**
+ * @brief Timing of one benchmark across its repetitions
+ */
+struct BenchmarkResult {
+    std::string name;
+    long iterations;          // Per repetition
+    double medianNanos;       // Per operation
+    double minNanos;
+    double maxNanos;
+};
+
+// Benchmarks fold results into this so the work cannot be optimized away
+static volatile long benchmarkSink = 0;
+
+static double timeBatch(const std::function<void(long)>& body, long iterations) {
+    auto start = std::chrono::steady_clock::now();
+    body(iterations);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static BenchmarkResult runBenchmark(const std::string& name, const BenchmarkConfig& config,
+                                    const std::function<void(long)>& body) {
+    // Double the batch until one batch takes long enough to time reliably
+    long iterations = 1;
+    double seconds = timeBatch(body, iterations);
+    while (seconds < config.minSeconds && iterations < (1L << 30)) {
+        iterations *= 2;
+        seconds = timeBatch(body, iterations);
+    }
+
+    std::vector<double> samples;
+    for (int i = 0; i < config.repetitions; ++i) {
+        samples.push_back(timeBatch(body, iterations) * 1e9 / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.medianNanos = samples[samples.size() / 2];
+    result.minNanos = samples.front();
+    result.maxNanos = samples.back();
+    return result;
+}
+
+static void writeResult(std::ostream& out, const BenchmarkResult& result, const BenchmarkConfig& config) {
+    out << std::fixed << std::setprecision(1);
+    if (config.csv) {
+        out << result.name << ',' << result.iterations << ',' << result.medianNanos << ','
+            << result.minNanos << ',' << result.maxNanos << ',' << std::setprecision(0)
+            << (1e9 / result.medianNanos) << ',' << config.data.productCount << ','
+            << config.data.customerCount << ',' << config.transactionCount << ','
+            << config.data.seed << '\n';
+    } else {
+        out << "{\"benchmark\":\"" << result.name << "\",\"iterations\":" << result.iterations
+            << ",\"ns_per_op\":" << result.medianNanos << ",\"min_ns_per_op\":" << result.minNanos
+            << ",\"max_ns_per_op\":" << result.maxNanos << ",\"ops_per_sec\":" << std::setprecision(0)
+            << (1e9 / result.medianNanos) << ",\"products\":" << config.data.productCount
+            << ",\"customers\":" << config.data.customerCount << ",\"transactions\":"
+            << config.transactionCount << ",\"seed\":" << config.data.seed << "}\n";
+    }
+    out.flush();
+}
+
+/**
+ * @brief Runs each registered benchmark that passes the filter
+ */
+class BenchmarkSuite {
+private:
+    const BenchmarkConfig& config;
+    std::ostream& out;
+    int runCount;
+
+public:
+    BenchmarkSuite(const BenchmarkConfig& config, std::ostream& out)
+        : config(config), out(out), runCount(0) {
+        if (config.csv) {
+            out << "benchmark,iterations,ns_per_op,min_ns_per_op,max_ns_per_op,ops_per_sec,"
+                << "products,customers,transactions,seed\n";
+        }
+    }
+
+    void add(const std::string& name, const std::function<void(long)>& body) {
+        if (!config.filter.empty() && name.find(config.filter) == std::string::npos) {
+            return;
+        }
+        writeResult(out, runBenchmark(name, config, body), config);
+        runCount++;
+    }
+
+    // Report benchmarks print to std::cout, which is discarded while they run
+    void addReport(const std::string& name, const std::function<void()>& report) {
+        add(name, [&report](long iterations) {
+            NullBuffer discard;
+            std::streambuf* original = std::cout.rdbuf(&discard);
+            for (long i = 0; i < iterations; ++i) {
+                report();
+            }
+            std::cout.rdbuf(original);
+        });
+    }
+
+    int getRunCount() const { return runCount; }
+};
+
+// Bulk-loads skewed lines straight into the cube, bypassing transactions
+static void loadCubeLines(SalesCube& cube, DataGenerator& generator, long lines) {
+    std::unordered_map<const Product*, std::pair<uint32_t, uint16_t>> codes;
+    for (const Product* product : generator.getCatalog()) {
+        codes[product] = std::make_pair(cube.internProduct(product->getId()), cube.internSupplier(product->getSupplier()));
+    }
+
+    std::mt19937_64& rng = generator.getRandom();
+    std::uniform_int_distribution<int> hours(7, 22);
+    std::uniform_int_distribution<int> customerTypes(0, CUBE_CUSTOMER_TYPES - 1);
+    std::uniform_int_distribution<int> payments(0, 3);
+    cube.reserve(cube.getLineCount() + lines);
+    for (long i = 0; i < lines; ++i) {
+        const Product* product = generator.pickProduct();
+        const auto& code = codes[product];
+        double quantity = generator.pickQuantity(product);
+        cube.appendLine(code.first, code.second, static_cast<uint8_t>(product->getCategory()),
+                        static_cast<uint8_t>(hours(rng)), static_cast<uint8_t>(customerTypes(rng)),
+                        static_cast<uint8_t>(payments(rng)), 0, static_cast<float>(quantity),
+                        static_cast<int32_t>(product->calculateSellingPrice() * quantity * 100.0));
+    }
+}
+
+static void printUsage() {
+    std::cout << "Usage: benchmark [options]\n"
+              << "  --products N       Catalog size (default 5000)\n"
+              << "  --customers N      Customer count (default 5000)\n"
+              << "  --transactions N   Completed sales loaded before timing (default 20000)\n"
+              << "  --seed N           Generator seed (default 42)\n"
+              << "  --cube-lines N     Add N synthetic lines to the sales cube before timing (default 0)\n"
+              << "  --history-days N   Spread the loaded sales over the last N days (default 60)\n"
+              << "  --storage-rows N   Rows written to the B+tree benchmark file (default 100000, 0 = skip)\n"
+              << "  --storage-cache KB Buffer pool for the B+tree benchmarks (default 1024)\n"
+              << "  --min-time MS      Minimum time per repetition (default 50)\n"
+              << "  --repetitions N    Timed repetitions per benchmark (default 5)\n"
+              << "  --filter TEXT      Only run benchmarks whose name contains TEXT\n"
+              << "  --csv              CSV instead of JSON lines\n"
+              << "  --out FILE         Write results to FILE instead of stdout\n"
+              << "  --metrics          Record latency histograms while benchmarking (overhead check)\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--products" && hasValue) {
+            config.data.productCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--customers" && hasValue) {
+            config.data.customerCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--transactions" && hasValue) {
+            config.transactionCount = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            config.data.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--cube-lines" && hasValue) {
+            config.cubeLines = std::max(0L, std::atol(argv[++i]));
+        } else if (arg == "--storage-rows" && hasValue) {
+            config.storageRows = std::max(0L, std::atol(argv[++i]));
+        } else if (arg == "--storage-cache" && hasValue) {
+            config.storageCacheKB = std::max(64L, std::atol(argv[++i]));
+        } else if (arg == "--history-days" && hasValue) {
+            config.data.historyDays = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--min-time" && hasValue) {
+            config.minSeconds = std::max(1.0, std::atof(argv[++i])) / 1000.0;
+        } else if (arg == "--repetitions" && hasValue) {
+            config.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--filter" && hasValue) {
+            config.filter = argv[++i];
+        } else if (arg == "--csv") {
+            config.csv = true;
+        } else if (arg == "--out" && hasValue) {
+            config.outputPath = argv[++i];
+        } else if (arg == "--metrics") {
+            LatencyMetrics::setEnabled(true);
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::ofstream file;
+    if (!config.outputPath.empty()) {
+        file.open(config.outputPath);
+        if (!file) {
+            std::cerr << "Error: cannot open " << config.outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = config.outputPath.empty() ? std::cout : file;
+
+    Store store;
+    DataGenerator generator(config.data);
+    generator.populate(store);
+    int completed = generator.generateSales(store, config.transactionCount);
+    std::cerr << "Generated " << generator.getCatalog().size() << " products, "
+              << generator.getCustomers().size() << " customers, " << completed << " sales" << std::endl;
+
+    InventoryManager& inventory = store.getInventory();
+    CustomerDatabase& customerDB = store.getCustomerDatabase();
+    SalesCube& cube = store.getSalesCube();
+    if (config.cubeLines > 0) {
+        loadCubeLines(cube, generator, config.cubeLines);
+        std::cerr << "Sales cube holds " << cube.getLineCount() << " lines" << std::endl;
+    }
+
+    // Lookup keys are drawn from the same skewed distributions as live traffic
+    std::vector<std::string> productIds;
+    std::vector<std::string> phones;
+    for (int i = 0; i < 4096; ++i) {
+        productIds.push_back(generator.pickProduct()->getId());
+        const auto& customers = generator.getCustomers();
+        phones.push_back(customers[(i * 7919) % customers.size()]->getPhone());
+    }
+    std::vector<std::string> searchTerms = { "cola", "milk", "SKU1012", "supplier 003", "promo", "zzz" };
+
+    // Open (unfinalized) transactions for pricing, built from generated baskets
+    std::vector<Transaction*> baskets;
+    TaxTable taxTable;
+    for (int i = 0; i < 256; ++i) {
+        GeneratedSale sale = generator.nextSale();
+        Transaction* transaction = new Transaction(sale.customer, "BENCH");
+        for (const auto& line : sale.items) {
+            transaction->addItem(line.first, line.second);
+        }
+        baskets.push_back(transaction);
+    }
+
+    BenchmarkSuite suite(config, out);
+
+    suite.add("InventoryManager::findProduct", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += inventory.findProduct(productIds[i & 4095]) != nullptr;
+        }
+    });
+    suite.add("InventoryManager::findProduct/miss", [&](long iterations) {
+        std::string missing = "NOSUCH";
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += inventory.findProduct(missing) != nullptr;
+        }
+    });
+    suite.add("InventoryManager::searchProducts", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += inventory.searchProducts(searchTerms[i % searchTerms.size()]).size();
+        }
+    });
+    // One supplier's catalogue goes through its index, a category-wide filter through the columns
+    ProductQuery supplierQuery = ProductQuery()
+                                     .where(ProductField::SUPPLIER, QueryOp::EQ, inventory.getAllSuppliers().back())
+                                     .where(ProductField::MARGIN, QueryOp::GT, 30)
+                                     .whereField(ProductField::STOCK, QueryOp::LT, ProductField::MIN_STOCK);
+    ProductQuery categoryQuery = ProductQuery()
+                                     .where(ProductField::ACTIVE, QueryOp::EQ, 1)
+                                     .where(ProductField::CATEGORY, QueryOp::EQ, "snacks")
+                                     .where(ProductField::MARGIN, QueryOp::GT, 30)
+                                     .sortBy(ProductField::MARGIN, true)
+                                     .take(20);
+    suite.add("InventoryManager::query/index", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += inventory.query(supplierQuery).matched;
+        }
+    });
+    suite.add("InventoryManager::query/columns", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += inventory.query(categoryQuery).matched;
+        }
+    });
+    suite.add("CustomerDatabase::findCustomerByPhone", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += customerDB.findCustomerByPhone(phones[i & 4095]) != nullptr;
+        }
+    });
+    suite.add("CustomerDatabase::getTopCustomers", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += customerDB.getTopCustomers(10).size();
+        }
+    });
+    suite.add("Transaction::calculateTotals", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            Transaction* transaction = baskets[i & 255];
+            transaction->calculateTotals(taxTable.getJurisdiction(i % taxTable.getJurisdictionCount()));
+            benchmarkSink += static_cast<long>(transaction->getFinalTotal());
+        }
+    });
+
+    // Cube queries: cell-only, full scan with a small key space, and a wide scan
+    CubeQuery byCategoryHour;
+    byCategoryHour.groupBy = { CubeDimension::CATEGORY, CubeDimension::HOUR };
+    CubeQuery bySupplierCustomer;
+    bySupplierCustomer.groupBy = { CubeDimension::SUPPLIER, CubeDimension::CUSTOMER_TYPE };
+    bySupplierCustomer.filters.push_back(CubeFilter{ CubeDimension::PAYMENT_METHOD, { 1, 2 } });
+    CubeQuery topProducts;
+    topProducts.groupBy = { CubeDimension::PRODUCT, CubeDimension::HOUR };
+    topProducts.limit = 20;
+    suite.add("SalesCube::query(category x hour)", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += cube.query(byCategoryHour).rows.size();
+        }
+    });
+    suite.add("SalesCube::query(supplier x customer, payment filter)", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += cube.query(bySupplierCustomer).rows.size();
+        }
+    });
+    suite.add("SalesCube::query(product x hour, top 20)", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += cube.query(topProducts).rows.size();
+        }
+    });
+
+    MarketBasketConfig basketConfig;
+    basketConfig.minSupport = 0.002;
+    EncodedBaskets encoded = MarketBasketAnalysis::encode(store.getTransactions());
+    MarketBasketAnalysis basketAnalysis;
+    suite.add("MarketBasketAnalysis::encode", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += MarketBasketAnalysis::encode(store.getTransactions()).items.size();
+        }
+    });
+    suite.add("MarketBasketAnalysis::run(0.2% support)", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            basketAnalysis.run(encoded, basketConfig);
+            benchmarkSink += basketAnalysis.getItemsets().size();
+        }
+    });
+
+    // Sketch update cost per finalized sale, and combining two lanes' sketches
+    const std::vector<Transaction*>& history = store.getTransactions();
+    SalesSketches laneSketches;
+    SalesSketches otherLane;
+    for (size_t i = 0; i < history.size(); i += 2) {
+        otherLane.recordSale(*history[i]);
+    }
+    if (!history.empty()) {
+        suite.add("SalesSketches::recordSale", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                laneSketches.recordSale(*history[i % history.size()]);
+            }
+            benchmarkSink += laneSketches.getSaleCount();
+        });
+    }
+    suite.add("SalesSketches::merge", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            SalesSketches combined;
+            combined.merge(otherLane);
+            benchmarkSink += combined.getSaleCount();
+        }
+    });
+
+    // Window queries read one slot per second of the window
+    std::time_t windowEnd = std::time(nullptr);
+    suite.add("SalesWindowEngine::summarize(15 min)", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += store.getSalesWindows().summarize(windowEnd - 900, windowEnd).transactions;
+        }
+    });
+    suite.add("SalesWindowEngine::summarize(24 h)", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += store.getSalesWindows().summarize(windowEnd - 86400, windowEnd).transactions;
+        }
+    });
+
+    // Columnar archive of the generated history, sealed by day without
+    // touching the store's own transactions
+    std::map<std::time_t, std::vector<const Transaction*>> historyDays;
+    size_t historyBytes = 0;
+    for (const auto* transaction : history) {
+        historyDays[SalesAggregates::startOfDay(transaction->getTimestamp())].push_back(transaction);
+        historyBytes += MemorySizing::allocation(sizeof(Transaction)) + transaction->getHeapBytes();
+    }
+    TransactionArchive archive;
+    for (const auto& day : historyDays) {
+        archive.add(ArchiveSegment::seal(day.first, day.second));
+    }
+    archive.recordSourceBytes(historyBytes);
+    if (!historyDays.empty()) {
+        size_t archiveBytes = 0;
+        for (const ArchiveSegment& segment : archive.getSegments()) {
+            archiveBytes += segment.getHeapBytes();
+        }
+        std::cerr << "Archive holds " << archive.getSegments().size() << " days in "
+                  << MemoryReport::formatBytes(archiveBytes) << " (" << MemoryReport::formatBytes(historyBytes)
+                  << " as Transaction objects)" << std::endl;
+
+        const std::vector<const Transaction*>& busiestDay = std::max_element(
+            historyDays.begin(), historyDays.end(), [](const std::pair<const std::time_t, std::vector<const Transaction*>>& a,
+                                                       const std::pair<const std::time_t, std::vector<const Transaction*>>& b) {
+                return a.second.size() < b.second.size();
+            })->second;
+        suite.add("ArchiveSegment::seal(busiest day)", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                benchmarkSink += ArchiveSegment::seal(0, busiestDay).getEncodedBytes();
+            }
+        });
+        suite.add("TransactionArchive::summarize(all days)", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                benchmarkSink += archive.summarize(0, windowEnd).transactions;
+            }
+        });
+        suite.add("TransactionArchive::forEach(all days)", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                archive.forEach(0, windowEnd, [](const ArchivedTransaction& transaction) {
+                    benchmarkSink += transaction.lines.size();
+                });
+            }
+        });
+        suite.add("ArchiveSegment::productUnits(all days)", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                std::unordered_map<std::string, double> units;
+                for (const ArchiveSegment& segment : archive.getSegments()) {
+                    segment.productUnits(units);
+                }
+                benchmarkSink += units.size();
+            }
+        });
+    }
+
+    // Replication: a sale's stock events appended and written, and head
+    // office applying a fixed-size log from scratch
+    static const char* replicationPath = "benchmark_replication.log";
+    static const char* replayPath = "benchmark_replay.log";
+    std::remove(replicationPath);
+    std::remove(replayPath);
+    ReplicationLog replicationLog;
+    if (!history.empty() && replicationLog.open(replicationPath, "BENCH")) {
+        suite.add("ReplicationLog::append+flush(sale)", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                for (const auto& item : history[i % history.size()]->getItems()) {
+                    replicationLog.append(ReplicationEvent(ReplicationEventType::STOCK, *item.product));
+                }
+                benchmarkSink += replicationLog.flush();
+            }
+        });
+        suite.add("ReplicationLog::append+flushSoon(sale)", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                for (const auto& item : history[i % history.size()]->getItems()) {
+                    replicationLog.append(ReplicationEvent(ReplicationEventType::STOCK, *item.product));
+                }
+                replicationLog.flushSoon();
+            }
+        });
+        replicationLog.close();
+    }
+    {
+        ReplicationLog replay;
+        if (replay.open(replayPath, "REPLAY")) {
+            const std::vector<Product*>& catalog = generator.getCatalog();
+            for (int i = 0; i < 10000; ++i) {
+                replay.append(ReplicationEvent(i < static_cast<int>(catalog.size()) ? ReplicationEventType::PRODUCT
+                                                                                   : ReplicationEventType::STOCK,
+                                               *catalog[i % catalog.size()]));
+            }
+            replay.close();
+            suite.add("HeadOfficeView::poll(10000 events)", [&](long iterations) {
+                for (long i = 0; i < iterations; ++i) {
+                    HeadOfficeView view;
+                    view.addFeed(replayPath);
+                    benchmarkSink += view.poll();
+                }
+            });
+        }
+    }
+
+    // Journal: what a checkout pays to hand its sale to the flusher while
+    // the flusher is writing and syncing earlier batches
+    static const char* journalPath = "benchmark_journal.jnl";
+    std::remove(journalPath);
+    PersistenceFlusher journal;
+    if (!history.empty() && journal.open(journalPath)) {
+        suite.add("PersistenceFlusher::submitSale(sustained)", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                journal.submitSale(*history[i % history.size()]);
+            }
+            benchmarkSink += journal.getBacklog();
+        });
+        suite.add("PersistenceFlusher::submitSale+sync", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                journal.submitSale(*history[i % history.size()]);
+                benchmarkSink += journal.sync();
+            }
+        });
+        journal.close();
+    }
+
+    // Transfers between the benchmark store and two branches with their own
+    // catalog stock; every fifth branch product is run down to its minimum
+    std::vector<InventoryManager*> branches;
+    for (unsigned b = 0; b < 2; ++b) {
+        GeneratorConfig branchConfig = config.data;
+        branchConfig.seed += 1 + b;
+        InventoryManager* branch = new InventoryManager();
+        DataGenerator branchGenerator(branchConfig);
+        branchGenerator.populateCatalog(*branch);
+        const std::vector<Product*>& branchCatalog = branchGenerator.getCatalog();
+        for (size_t i = b; i < branchCatalog.size(); i += 5) {
+            branchCatalog[i]->reduceStock(branchCatalog[i]->getCurrentStock() - branchCatalog[i]->getMinStockLevel());
+        }
+        branches.push_back(branch);
+    }
+    std::vector<StoreInventory> network = { { "BENCH", &inventory }, { "BRANCH1", branches[0] },
+                                            { "BRANCH2", branches[1] } };
+    {
+        // One unit of every SKU that can move both ways, there and back
+        std::vector<std::string> movable;
+        for (const Product* product : generator.getCatalog()) {
+            const Product* other = branches[0]->findProduct(product->getId());
+            if (other && product->getAvailableStock() > 0 && product->getFreeCapacity() > 0 &&
+                other->getAvailableStock() > 0 && other->getFreeCapacity() > 0) {
+                movable.push_back(product->getId());
+            }
+        }
+        if (!movable.empty()) {
+            suite.add("StockTransfer::prepare+commit(" + std::to_string(movable.size()) + " SKUs)",
+                      [&, movable](long iterations) {
+                for (long i = 0; i < iterations; ++i) {
+                    bool outbound = (i & 1) == 0;
+                    StockTransfer transfer(outbound ? inventory : *branches[0], outbound ? "BENCH" : "BRANCH1",
+                                           outbound ? *branches[0] : inventory, outbound ? "BRANCH1" : "BENCH");
+                    for (const std::string& id : movable) {
+                        transfer.addLine(id, 1);
+                    }
+                    benchmarkSink += transfer.prepare() && transfer.commit();
+                }
+            });
+        }
+    }
+    suite.add("RebalancePlanner::plan(3 stores)", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += RebalancePlanner::plan(network).size();
+        }
+    });
+
+    // Multi-version reads: publishing each sale, and reports over a pinned epoch
+    SnapshotCatalog snapshots;
+    snapshots.registerAll(generator.getCatalog(), generator.getCustomers());
+    if (!history.empty()) {
+        std::vector<std::vector<std::pair<const Product*, double>>> saleLines;
+        for (const Transaction* transaction : history) {
+            std::vector<std::pair<const Product*, double>> lines;
+            for (const TransactionItem& item : transaction->getItems()) {
+                lines.push_back(std::make_pair(item.product, static_cast<double>(item.stockUnits)));
+            }
+            saleLines.push_back(lines);
+        }
+        suite.add("SnapshotCatalog::commitSale", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                const Transaction* transaction = history[i % history.size()];
+                benchmarkSink += snapshots.commitSale(saleLines[i % history.size()], transaction->getCustomer(),
+                                                      transaction->getFinalTotal());
+            }
+        });
+    }
+    suite.add("CatalogSnapshot reports(inventory+profit+financial)", [&](long iterations) {
+        NullBuffer discard;
+        std::ostream out(&discard);
+        for (long i = 0; i < iterations; ++i) {
+            CatalogSnapshot snapshot(snapshots);
+            snapshot.generateInventoryReport(out);
+            snapshot.generateProfitabilityReport(out);
+            snapshot.generateFinancialSummary(out);
+            benchmarkSink += static_cast<long>(snapshot.getEpoch());
+        }
+    });
+
+    // Versioned shelf prices: a catalog-wide change, and what every new cart pays to pin one
+    PriceBook& priceBook = store.getPriceBook();
+    PriceChange catalogChange = priceBook.draftPercentChange(generator.getCatalog(), 1.0);
+    suite.add("PriceBook::publish(all products)", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += static_cast<long>(priceBook.publish(catalogChange));
+        }
+    });
+    suite.add("PriceBook::acquire", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            PriceVersionPtr version = priceBook.acquire();
+            benchmarkSink += static_cast<long>(version->number);
+        }
+    });
+
+    // Barcodes: a supplier feed checked one code at a time and as a batch, and till scans
+    std::vector<std::string> feedCodes;
+    std::vector<std::string> scanCodes;
+    for (Product* product : generator.getCatalog()) {
+        std::string code = product->getBarcode();
+        if (feedCodes.size() % 16 == 15) {
+            code[code.size() - 1] = static_cast<char>('0' + (code[code.size() - 1] - '0' + 1) % 10);   // Bad check digit
+        }
+        feedCodes.push_back(code);
+        if (scanCodes.size() < 4096) {
+            BarcodeScan scan;
+            Gtin::decode(product->getBarcode(), scan);
+            scanCodes.push_back(scan.measure == MeasureKind::WEIGHT
+                                    ? Gtin::makeMeasureLabel(21, scan.itemReference, 1250)   // 1.25 kg
+                                    : product->getBarcode());
+        }
+    }
+    suite.add("Gtin::isValid(catalog feed)", [&](long iterations) {
+        for (long i = 0; i < iterations; ++i) {
+            long passed = 0;
+            for (const std::string& code : feedCodes) {
+                passed += Gtin::isValid(code) ? 1 : 0;
+            }
+            benchmarkSink += passed;
+        }
+    });
+    suite.add("Gtin::validateBatch(catalog feed)", [&](long iterations) {
+        std::vector<uint8_t> valid;
+        for (long i = 0; i < iterations; ++i) {
+            benchmarkSink += static_cast<long>(Gtin::validateBatch(feedCodes, valid));
+        }
+    });
+    suite.add("InventoryManager::findProductByBarcode", [&](long iterations) {
+        BarcodeScan scan;
+        for (long i = 0; i < iterations; ++i) {
+            Product* product = inventory.findProductByBarcode(scanCodes[i % scanCodes.size()], scan);
+            benchmarkSink += product ? static_cast<long>(scan.measureValue) + 1 : 0;
+        }
+    });
+
+    // On-disk B+tree with a buffer pool much smaller than the file
+    static const char* storagePath = "benchmark_storage.db";
+    std::remove(storagePath);
+    StorageEngine storage;
+    std::vector<std::string> storageKeys;
+    if (config.storageRows > 0 && storage.open(storagePath, config.storageCacheKB * 1024)) {
+        BPlusTree& tree = storage.openTree("rows");
+        std::string value(160, 'x');
+        for (long i = 0; i < config.storageRows; ++i) {
+            char key[24];
+            std::snprintf(key, sizeof(key), "SKU%09ld", (i * 7919) % config.storageRows);
+            tree.insert(key, value);
+        }
+        ProductTable productTable(storage);
+        for (const Product* product : generator.getCatalog()) {
+            productTable.put(*product);
+        }
+        storage.flush();
+        std::cerr << "Storage file holds " << storage.getPager().getPageCount() << " pages, cache "
+                  << storage.getBufferPool().getCapacity() << " pages" << std::endl;
+
+        std::mt19937 keyRng(7);
+        for (int i = 0; i < 4096; ++i) {
+            char key[24];
+            std::snprintf(key, sizeof(key), "SKU%09ld", static_cast<long>(keyRng() % config.storageRows));
+            storageKeys.push_back(key);
+        }
+        suite.add("BPlusTree::find(uniform, cache << file)", [&](long iterations) {
+            std::string found;
+            for (long i = 0; i < iterations; ++i) {
+                benchmarkSink += tree.find(storageKeys[i & 4095], found);
+            }
+        });
+        suite.add("BPlusTree::scan(100 rows)", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                long rows = 0;
+                tree.scan(storageKeys[i & 4095], [&rows](const std::string&, const std::string&) { return ++rows < 100; });
+                benchmarkSink += rows;
+            }
+        });
+        suite.add("BPlusTree::insert(update)", [&](long iterations) {
+            for (long i = 0; i < iterations; ++i) {
+                benchmarkSink += tree.insert(storageKeys[i & 4095], value);
+            }
+        });
+        suite.add("ProductTable::load", [&](long iterations) {
+            ProductTable table(storage);
+            for (long i = 0; i < iterations; ++i) {
+                Product* product = table.load(productIds[i & 4095]);
+                benchmarkSink += product ? product->getCurrentStock() : 0;
+                delete product;
+            }
+        });
+    }
+
+    suite.addReport("InventoryManager::generateInventoryReport", [&]() { inventory.generateInventoryReport(); });
+    suite.addReport("InventoryManager::generateLowStockReport", [&]() { inventory.generateLowStockReport(); });
+    suite.addReport("InventoryManager::generateCategoryReport", [&]() { inventory.generateCategoryReport(); });
+    suite.addReport("InventoryManager::generateSupplierReport", [&]() { inventory.generateSupplierReport(); });
+    suite.addReport("InventoryManager::generateProfitabilityReport",
+                    [&]() { inventory.generateProfitabilityReport(); });
+    suite.addReport("Store::generateSalesReport", [&]() { store.generateSalesReport(); });
+    suite.addReport("Store::generateCustomerAnalytics", [&]() { store.generateCustomerAnalytics(); });
+    suite.addReport("Store::generateFinancialSummary", [&]() { store.generateFinancialSummary(); });
+    suite.addReport("Store::generatePeriodReport(today)",
+                    [&]() { store.generatePeriodReport(ReportPeriod::TODAY); });
+    suite.addReport("Store::generatePeriodReport(30days)",
+                    [&]() { store.generatePeriodReport(ReportPeriod::LAST_30_DAYS); });
+    suite.addReport("Store::generateMemoryReport", [&]() { store.generateMemoryReport(); });
+    suite.addReport("Store::generateLiveDashboard", [&]() { store.generateLiveDashboard(); });
+    suite.addReport("Store::generateWindowComparison(15)", [&]() { store.generateWindowComparison(15); });
+    suite.addReport("TransactionArchive::displayStats", [&]() { archive.displayStats(std::cout); });
+
+    for (Transaction* transaction : baskets) {
+        delete transaction;
+    }
+    for (InventoryManager* branch : branches) {
+        delete branch;
+    }
+    storage.close();
+    std::remove(storagePath);
+    std::remove(replicationPath);
+    std::remove(replayPath);
+    std::remove(journalPath);
+
+    if (LatencyMetrics::isEnabled()) {
+        LatencyMetrics::displaySummary(std::cerr);
+    }
+
+    if (suite.getRunCount() == 0) {
+        std::cerr << "No benchmark matches '" << config.filter << "'" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,993 @@
+// ===== CommandProcessor.cpp =====
+#include "CommandProcessor.h"
+#include "Gtin.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <ctime>
+#include <iomanip>
+#include <map>
+
+static bool parseDouble(const std::string& text, double& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+static bool parseInt(const std::string& text, int& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    value = static_cast<int>(parsed);
+    return *end == '\0';
+}
+
+static std::vector<std::string> splitFields(const std::string& text, char separator) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t pos = text.find(separator, start);
+        fields.push_back(text.substr(start, pos - start));
+        if (pos == std::string::npos) {
+            return fields;
+        }
+        start = pos + 1;
+    }
+}
+
+static bool parseCategory(const std::string& text, ProductCategory& category) {
+    static const char* names[] = {"beverages", "snacks", "dairy", "bakery",
+                                  "household", "electronics", "health", "other"};
+    for (int i = 0; i < PRODUCT_CATEGORY_COUNT; ++i) {
+        if (text == names[i]) {
+            category = static_cast<ProductCategory>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseCustomerType(const std::string& text, CustomerType& type) {
+    if (text == "regular") type = CustomerType::REGULAR;
+    else if (text == "premium") type = CustomerType::PREMIUM;
+    else if (text == "vip") type = CustomerType::VIP;
+    else if (text == "employee") type = CustomerType::EMPLOYEE;
+    else return false;
+    return true;
+}
+
+static bool parsePaymentMethod(const std::string& text, PaymentMethod& method) {
+    if (text == "cash") method = PaymentMethod::CASH;
+    else if (text == "credit") method = PaymentMethod::CREDIT_CARD;
+    else if (text == "debit") method = PaymentMethod::DEBIT_CARD;
+    else if (text == "mobile") method = PaymentMethod::MOBILE_PAYMENT;
+    else return false;
+    return true;
+}
+
+CommandProcessor::CommandProcessor(Store& store, const std::string& cashierId)
+    : store(store), cashierId(cashierId), lastTransactionId(0), stats() {
+}
+
+CommandProcessor::~CommandProcessor() {
+    // Transfers hold reservations in the branches' inventories, so they go first
+    for (auto& entry : transfers) {
+        delete entry.second;
+    }
+    for (auto& entry : branches) {
+        delete entry.second;
+    }
+}
+
+CommandProcessor::Arguments CommandProcessor::tokenize(const std::string& line) {
+    Arguments tokens;
+    std::string current;
+    bool inQuotes = false;
+    bool hasToken = false;
+
+    for (char c : line) {
+        if (c == '"') {
+            inQuotes = !inQuotes;
+            hasToken = true;
+        } else if (!inQuotes && (c == ' ' || c == '\t' || c == '\r')) {
+            if (hasToken) {
+                tokens.push_back(current);
+                current.clear();
+                hasToken = false;
+            }
+        } else if (!inQuotes && c == '#' && !hasToken) {
+            break;
+        } else {
+            current += c;
+            hasToken = true;
+        }
+    }
+    if (hasToken) {
+        tokens.push_back(current);
+    }
+    return tokens;
+}
+
+bool CommandProcessor::execute(const std::string& line, std::string& error) {
+    Arguments args = tokenize(line);
+    if (args.empty()) {
+        return true;
+    }
+    stats.commands++;
+
+    const std::string& command = args[0];
+    if (command == "product") return addProduct(args, error);
+    if (command == "customer") return addCustomer(args, error);
+    if (command == "stock") return adjustStock(args, error);
+    if (command == "price") return setPrice(args, error);
+    if (command == "barcodes") return importBarcodes(args, error);
+    if (command == "reprice") return reprice(args, error);
+    if (command == "sale") return sale(args, error);
+    if (command == "refund") return refund(args, error);
+    if (command == "receipt") return receipt(args, error);
+    if (command == "report") return report(args, error);
+    if (command == "cube") return cube(args, error);
+    if (command == "query") return queryProducts(args, error);
+    if (command == "basket") return basket(args, error);
+    if (command == "jurisdiction") return setJurisdiction(args, error);
+    if (command == "storage") return storage(args, error);
+    if (command == "journal") return journal(args, error);
+    if (command == "archive") return archive(args, error);
+    if (command == "branch") return branch(args, error);
+    if (command == "transfer") return transfer(args, error);
+    if (command == "rebalance") return rebalance(args, error);
+    if (command == "cashier") {
+        if (args.size() != 2) {
+            error = "usage: cashier <id>";
+            return false;
+        }
+        cashierId = args[1];
+        return true;
+    }
+
+    error = "unknown command '" + command + "'";
+    return false;
+}
+
+void CommandProcessor::run(std::istream& input, std::ostream& errors) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::string line;
+    std::string error;
+    while (std::getline(input, line)) {
+        stats.lines++;
+        error.clear();
+        if (!execute(line, error)) {
+            stats.errors++;
+            errors << "line " << stats.lines << ": " << error << '\n';
+        }
+        // Between commands nothing but transaction lines and transfers holds a product
+        store.getInventory().trimResident();
+        for (const auto& pair : branches) {
+            pair.second->getInventory().trimResident();
+        }
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    errors.flush();
+}
+
+bool CommandProcessor::addProduct(const Arguments& args, std::string& error) {
+    if (args.size() < 8) {
+        error = "usage: product <type> <id> <name> <category> <price> <cost> <stock> [key=value...]";
+        return false;
+    }
+
+    const std::string& type = args[1];
+    ProductCategory category;
+    double price, cost;
+    int stock;
+    if (!parseCategory(args[4], category)) {
+        error = "unknown category '" + args[4] + "'";
+        return false;
+    }
+    if (!parseDouble(args[5], price) || !parseDouble(args[6], cost) || !parseInt(args[7], stock)) {
+        error = "invalid price, cost or stock";
+        return false;
+    }
+
+    std::map<std::string, std::string> options;
+    for (size_t i = 8; i < args.size(); ++i) {
+        size_t eq = args[i].find('=');
+        if (eq == std::string::npos) {
+            error = "expected key=value, got '" + args[i] + "'";
+            return false;
+        }
+        options[args[i].substr(0, eq)] = args[i].substr(eq + 1);
+    }
+
+    std::string desc = options.count("desc") ? options["desc"] : "";
+    std::string supplier = options.count("supplier") ? options["supplier"] : "";
+    int minStock = 0, maxStock = 0;
+    if ((options.count("min") && !parseInt(options["min"], minStock)) ||
+        (options.count("max") && !parseInt(options["max"], maxStock))) {
+        error = "invalid min or max stock";
+        return false;
+    }
+
+    Product* product = nullptr;
+    if (type == "regular") {
+        double markup = 0.3;
+        if (options.count("markup") && !parseDouble(options["markup"], markup)) {
+            error = "invalid markup";
+            return false;
+        }
+        product = new RegularProduct(args[2], args[3], desc, price, cost, stock, category, supplier,
+                                     markup, options.count("min") ? minStock : 10,
+                                     options.count("max") ? maxStock : 1000);
+    } else if (type == "perishable") {
+        int shelfLife = 7;
+        double discount = 0.2;
+        if ((options.count("shelf") && !parseInt(options["shelf"], shelfLife)) ||
+            (options.count("discount") && !parseDouble(options["discount"], discount))) {
+            error = "invalid shelf life or discount";
+            return false;
+        }
+        product = new PerishableProduct(args[2], args[3], desc, price, cost, stock, category,
+                                        options.count("expires") ? options["expires"] : "", shelfLife,
+                                        supplier, discount, options.count("min") ? minStock : 5,
+                                        options.count("max") ? maxStock : 500);
+    } else if (type == "bulk") {
+        double minQty = 0.1;
+        if (options.count("minqty") && !parseDouble(options["minqty"], minQty)) {
+            error = "invalid minimum quantity";
+            return false;
+        }
+        product = new BulkProduct(args[2], args[3], desc, price, cost, stock, category,
+                                  options.count("unit") ? options["unit"] : "kg", minQty, supplier,
+                                  options.count("min") ? minStock : 10,
+                                  options.count("max") ? maxStock : 1000);
+    } else {
+        error = "unknown product type '" + type + "'";
+        return false;
+    }
+
+    if (options.count("barcode")) {
+        if (!Gtin::isValid(options["barcode"])) {
+            delete product;
+            error = "invalid barcode '" + options["barcode"] + "'";
+            return false;
+        }
+        product->setBarcode(options["barcode"]);
+    }
+
+    if (!store.getInventory().addProduct(product)) {
+        delete product;
+        error = "could not add product " + args[2];
+        return false;
+    }
+    return true;
+}
+
+bool CommandProcessor::importBarcodes(const Arguments& args, std::string& error) {
+    if (args.size() != 2) {
+        error = "usage: barcodes <file>";
+        return false;
+    }
+    std::ifstream in(args[1]);
+    if (!in) {
+        error = "cannot read '" + args[1] + "'";
+        return false;
+    }
+
+    // One "<productId> <barcode>" or "<productId>,<barcode>" per line
+    std::vector<std::pair<std::string, std::string>> rows;
+    std::string line;
+    while (std::getline(in, line)) {
+        Arguments fields = tokenize(line);
+        if (fields.size() == 1) {
+            fields = splitFields(fields[0], ',');
+        }
+        if (fields.size() == 2) {
+            rows.push_back(std::make_pair(fields[0], fields[1]));
+        } else if (!fields.empty()) {
+            rows.push_back(std::make_pair(line, std::string()));
+        }
+    }
+
+    std::vector<size_t> rejected;
+    store.getInventory().importBarcodes(rows, rejected);
+    if (!rejected.empty()) {
+        error = std::to_string(rejected.size()) + " of " + std::to_string(rows.size()) +
+                " barcodes rejected, first: '" + rows[rejected[0]].first + " " + rows[rejected[0]].second + "'";
+        return false;
+    }
+    return true;
+}
+
+bool CommandProcessor::addCustomer(const Arguments& args, std::string& error) {
+    if (args.size() < 5 || args.size() > 6) {
+        error = "usage: customer <first> <last> <email> <phone> [type]";
+        return false;
+    }
+
+    CustomerType type = CustomerType::REGULAR;
+    if (args.size() == 6 && !parseCustomerType(args[5], type)) {
+        error = "unknown customer type '" + args[5] + "'";
+        return false;
+    }
+
+    store.getCustomerDatabase().addCustomer(args[1], args[2], args[3], args[4], type);
+    return true;
+}
+
+bool CommandProcessor::adjustStock(const Arguments& args, std::string& error) {
+    int change;
+    if (args.size() != 3 || !parseInt(args[2], change) || change == 0) {
+        error = "usage: stock <productId> <+N|-N>";
+        return false;
+    }
+
+    Product* product = store.getInventory().findProduct(args[1]);
+    if (!product) {
+        error = "product not found: " + args[1];
+        return false;
+    }
+
+    if (change > 0) {
+        if (change > product->getFreeCapacity()) {
+            error = "only " + std::to_string(std::max(0, product->getFreeCapacity())) + " units of room for " +
+                    args[1] + " (max " + std::to_string(product->getMaxStockLevel()) + ")";
+            return false;
+        }
+        product->addStock(change);
+    } else if (!product->reduceStock(-change)) {
+        error = "insufficient stock for " + args[1];
+        return false;
+    }
+    store.getInventory().recordStockChange(*product);
+    return true;
+}
+
+bool CommandProcessor::setPrice(const Arguments& args, std::string& error) {
+    double price;
+    if (args.size() != 3 || !parseDouble(args[2], price) || price < 0) {
+        error = "usage: price <productId> <basePrice>";
+        return false;
+    }
+    if (!store.getInventory().updatePrice(args[1], price)) {
+        error = "product not found: " + args[1];
+        return false;
+    }
+    return true;
+}
+
+bool CommandProcessor::reprice(const Arguments& args, std::string& error) {
+    const std::string usage = "usage: reprice <percent> [category] [at=<unix time>|in=<seconds>] | "
+                              "reprice cancel <scheduleId> | reprice stats";
+    if (args.size() == 2 && args[1] == "stats") {
+        store.generatePriceBookReport();
+        return true;
+    }
+    if (args.size() == 3 && args[1] == "cancel") {
+        int scheduleId;
+        if (!parseInt(args[2], scheduleId) || scheduleId <= 0) {
+            error = usage;
+            return false;
+        }
+        if (!store.getInventory().cancelScheduledPrices(static_cast<uint64_t>(scheduleId))) {
+            error = "no scheduled price change #" + args[2];
+            return false;
+        }
+        return true;
+    }
+
+    double percent;
+    if (args.size() < 2 || args.size() > 4 || !parseDouble(args[1], percent) || percent <= -100.0) {
+        error = usage;
+        return false;
+    }
+    bool hasCategory = false;
+    ProductCategory category = ProductCategory::OTHER;
+    bool scheduled = false;
+    std::time_t effectiveAt = 0;
+    for (size_t i = 2; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        double seconds;
+        if (arg.compare(0, 3, "at=") == 0 && parseDouble(arg.substr(3), seconds) && seconds >= 0) {
+            effectiveAt = static_cast<std::time_t>(seconds);
+            scheduled = true;
+        } else if (arg.compare(0, 3, "in=") == 0 && parseDouble(arg.substr(3), seconds) && seconds >= 0) {
+            effectiveAt = std::time(nullptr) + static_cast<std::time_t>(seconds);
+            scheduled = true;
+        } else if (!hasCategory && parseCategory(arg, category)) {
+            hasCategory = true;
+        } else {
+            error = "invalid argument '" + arg + "'";
+            return false;
+        }
+    }
+
+    InventoryManager& inventory = store.getInventory();
+    if (!scheduled) {
+        if (hasCategory) {
+            inventory.updateCategoryPrices(category, percent);
+        } else {
+            inventory.updateAllPrices(percent);
+        }
+        return true;
+    }
+    uint64_t scheduleId = hasCategory ? inventory.scheduleCategoryPrices(category, percent, effectiveAt)
+                                      : inventory.scheduleAllPrices(percent, effectiveAt);
+    if (scheduleId == 0) {
+        error = "nothing to reprice";
+        return false;
+    }
+    return true;
+}
+
+bool CommandProcessor::sale(const Arguments& args, std::string& error) {
+    PaymentMethod method;
+    if (args.size() < 4 || !parsePaymentMethod(args[2], method)) {
+        error = "usage: sale <customerId|-> <cash|credit|debit|mobile> [paid=X] [points=N] <productId>:<qty>|@<barcode>...";
+        return false;
+    }
+
+    Customer* customer = nullptr;
+    if (args[1] != "-") {
+        customer = store.getCustomerDatabase().findCustomer(args[1]);
+        if (!customer) {
+            error = "customer not found: " + args[1];
+            return false;
+        }
+    }
+
+    Transaction* transaction = store.openTransaction(customer, cashierId);
+    double amountPaid = -1.0;
+    double points = 0.0;
+
+    for (size_t i = 3; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        if (arg.compare(0, 5, "paid=") == 0) {
+            if (!parseDouble(arg.substr(5), amountPaid)) {
+                error = "invalid amount '" + arg + "'";
+                delete transaction;
+                return false;
+            }
+            continue;
+        }
+        if (arg.compare(0, 7, "points=") == 0) {
+            if (!parseDouble(arg.substr(7), points)) {
+                error = "invalid points '" + arg + "'";
+                delete transaction;
+                return false;
+            }
+            continue;
+        }
+
+        if (arg[0] == '@') {
+            BarcodeScan scan;
+            Product* product = store.getInventory().findProductByBarcode(arg.substr(1), scan);
+            if (!product || !product->getIsActive() || !transaction->addScannedItem(product, scan)) {
+                error = "cannot sell " + arg;
+                delete transaction;
+                return false;
+            }
+            continue;
+        }
+
+        std::vector<std::string> fields = splitFields(arg, ':');
+        double quantity = 0.0;
+        double discount = 0.0;
+        if (fields.size() < 2 || fields.size() > 3 || !parseDouble(fields[1], quantity) ||
+            (fields.size() == 3 && !parseDouble(fields[2], discount))) {
+            error = "invalid item '" + arg + "'";
+            delete transaction;
+            return false;
+        }
+
+        Product* product = store.getInventory().findProduct(fields[0]);
+        if (!product || !product->getIsActive() || !transaction->addItem(product, quantity, discount)) {
+            error = "cannot sell " + arg;
+            delete transaction;
+            return false;
+        }
+    }
+
+    if (transaction->getItems().empty()) {
+        error = "sale has no items";
+        delete transaction;
+        return false;
+    }
+
+    if (points > 0 && !transaction->applyLoyaltyPoints(points)) {
+        error = "cannot apply loyalty points";
+        delete transaction;
+        return false;
+    }
+
+    store.priceTransaction(transaction);
+    if (amountPaid < 0) {
+        amountPaid = transaction->getFinalTotal();
+    }
+
+    if (!store.completeSale(transaction, method, amountPaid)) {
+        error = "payment failed";
+        delete transaction;
+        return false;
+    }
+
+    lastTransactionId = transaction->getId();
+    stats.sales++;
+    stats.salesValue += transaction->getFinalTotal();
+    return true;
+}
+
+Transaction* CommandProcessor::resolveTransaction(const std::string& token, std::string& error) {
+    int transactionId = lastTransactionId;
+    if (token != "last" && !parseInt(token, transactionId)) {
+        error = "invalid transaction id '" + token + "'";
+        return nullptr;
+    }
+
+    Transaction* transaction = store.findTransaction(transactionId);
+    if (!transaction) {
+        bool archived = store.getArchive().findTransaction(transactionId, [](const ArchivedTransaction&) {});
+        error = archived ? "transaction " + token + " is archived; archived sales cannot be refunded"
+                         : "transaction not found: " + token;
+    }
+    return transaction;
+}
+
+bool CommandProcessor::refund(const Arguments& args, std::string& error) {
+    if (args.size() < 3) {
+        error = "usage: refund <transactionId|last> full | amount <X> | items <itemNo>:<qty>...";
+        return false;
+    }
+
+    Transaction* transaction = resolveTransaction(args[1], error);
+    if (!transaction) {
+        return false;
+    }
+
+    RefundRecord record;
+    bool success = false;
+    const std::string& mode = args[2];
+
+    if (mode == "full" && args.size() == 3) {
+        success = transaction->processRefund(-1.0, &record);
+    } else if (mode == "amount" && args.size() == 4) {
+        double amount;
+        if (!parseDouble(args[3], amount)) {
+            error = "invalid amount '" + args[3] + "'";
+            return false;
+        }
+        success = transaction->processRefund(amount, &record);
+    } else if (mode == "items" && args.size() > 3) {
+        std::vector<std::pair<int, double>> returns;
+        for (size_t i = 3; i < args.size(); ++i) {
+            std::vector<std::string> fields = splitFields(args[i], ':');
+            int itemNumber;
+            double quantity;
+            if (fields.size() != 2 || !parseInt(fields[0], itemNumber) || !parseDouble(fields[1], quantity)) {
+                error = "invalid item '" + args[i] + "'";
+                return false;
+            }
+            returns.push_back(std::make_pair(itemNumber - 1, quantity));
+        }
+        success = transaction->processItemRefunds(returns, &record);
+    } else {
+        error = "unknown refund mode '" + mode + "'";
+        return false;
+    }
+
+    if (!success) {
+        error = "refund rejected for transaction " + args[1];
+        return false;
+    }
+
+    store.recordRefund(transaction, record);
+    stats.refunds++;
+    stats.refundValue += record.amount;
+    return true;
+}
+
+bool CommandProcessor::receipt(const Arguments& args, std::string& error) {
+    if (args.size() != 2) {
+        error = "usage: receipt <transactionId|last>";
+        return false;
+    }
+
+    Transaction* transaction = resolveTransaction(args[1], error);
+    if (!transaction) {
+        // Closed days are reprinted from the archive
+        int transactionId = lastTransactionId;
+        if ((args[1] == "last" || parseInt(args[1], transactionId)) &&
+            store.getArchive().renderReceipt(transactionId, std::cout)) {
+            error.clear();
+            return true;
+        }
+        return false;
+    }
+    transaction->renderReceipt(std::cout);
+    return true;
+}
+
+bool CommandProcessor::report(const Arguments& args, std::string& error) {
+    if (args.size() != 2 && !(args.size() == 3 && (args[1] == "sales" || args[1] == "window"))) {
+        error = "usage: report inventory|lowstock|sales [today|week|30days]|window [minutes]|customers|financial|memory|live|replication|journal|prices";
+        return false;
+    }
+
+    const std::string& name = args[1];
+    if (name == "window") {
+        int minutes = 15;
+        if (args.size() == 3 && (!parseInt(args[2], minutes) || minutes < 1 || minutes > 1440)) {
+            error = "window must be 1-1440 minutes";
+            return false;
+        }
+        store.generateWindowComparison(minutes);
+        return true;
+    }
+    if (args.size() == 3) {
+        ReportPeriod period;
+        if (!SalesAggregates::stringToPeriod(args[2], period)) {
+            error = "unknown period '" + args[2] + "'";
+            return false;
+        }
+        store.generatePeriodReport(period);
+        return true;
+    }
+    if (name == "inventory") store.getInventory().generateInventoryReport();
+    else if (name == "lowstock") store.getInventory().generateLowStockReport();
+    else if (name == "sales") store.generateSalesReport();
+    else if (name == "customers") store.generateCustomerAnalytics();
+    else if (name == "financial") store.generateFinancialSummary();
+    else if (name == "memory") store.generateMemoryReport();
+    else if (name == "live") store.generateLiveDashboard();
+    else if (name == "replication") store.generateReplicationReport();
+    else if (name == "journal") store.generateJournalReport();
+    else if (name == "prices") store.generatePriceBookReport();
+    else {
+        error = "unknown report '" + name + "'";
+        return false;
+    }
+    return true;
+}
+
+bool CommandProcessor::cube(const Arguments& args, std::string& error) {
+    if (args.size() < 2) {
+        error = "usage: cube <dim,dim...|-> [dim=value,value...] [limit=N]";
+        return false;
+    }
+
+    const SalesCube& salesCube = store.getSalesCube();
+    CubeQuery query;
+    if (!salesCube.parseQuery(Arguments(args.begin() + 1, args.end()), query, error)) {
+        return false;
+    }
+    salesCube.display(query, salesCube.query(query), std::cout);
+    return true;
+}
+
+bool CommandProcessor::queryProducts(const Arguments& args, std::string& error) {
+    ProductQuery query;
+    if (!ProductQuery::parse(Arguments(args.begin() + 1, args.end()), query, error)) {
+        return false;
+    }
+    store.getInventory().query(query).display(query, std::cout);
+    return true;
+}
+
+bool CommandProcessor::basket(const Arguments& args, std::string& error) {
+    const std::string usage = "usage: basket run [support=F] [confidence=F] [maxsize=N] [threads=N] | "
+                              "basket itemsets|rules [N] | basket also <productId> [N]";
+    if (args.size() < 2) {
+        error = usage;
+        return false;
+    }
+
+    const std::string& action = args[1];
+    if (action == "run") {
+        MarketBasketConfig config;
+        for (size_t i = 2; i < args.size(); ++i) {
+            const std::string& arg = args[i];
+            size_t equals = arg.find('=');
+            std::string key = arg.substr(0, equals);
+            std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+            int number = 0;
+            bool valid;
+            if (key == "support") {
+                valid = parseDouble(value, config.minSupport) && config.minSupport > 0.0 && config.minSupport <= 1.0;
+            } else if (key == "confidence") {
+                valid = parseDouble(value, config.minConfidence) && config.minConfidence >= 0.0;
+            } else if (key == "maxsize") {
+                valid = parseInt(value, number) && number >= 1;
+                config.maxItemsetSize = number;
+            } else if (key == "threads") {
+                valid = parseInt(value, number) && number >= 0;
+                config.threads = static_cast<unsigned>(number);
+            } else {
+                valid = false;
+            }
+            if (!valid) {
+                error = "invalid option '" + arg + "'";
+                return false;
+            }
+        }
+        store.runBasketAnalysis(config);
+        return true;
+    }
+
+    const MarketBasketAnalysis& analysis = store.getBasketAnalysis();
+    if (!analysis.hasResults()) {
+        error = "no basket analysis has been run";
+        return false;
+    }
+
+    size_t limitIndex = action == "also" ? 3 : 2;
+    int limit = 10;
+    if (args.size() > limitIndex + 1 || (args.size() == limitIndex + 1 && !parseInt(args[limitIndex], limit)) ||
+        limit < 1 || (action == "also" && args.size() < 3)) {
+        error = usage;
+        return false;
+    }
+
+    if (action == "itemsets") analysis.displayItemsets(std::cout, limit);
+    else if (action == "rules") analysis.displayRules(std::cout, limit);
+    else if (action == "also") analysis.displayAlsoBought(std::cout, args[2], limit);
+    else {
+        error = "unknown basket action '" + action + "'";
+        return false;
+    }
+    return true;
+}
+
+bool CommandProcessor::setJurisdiction(const Arguments& args, std::string& error) {
+    if (args.size() != 2) {
+        error = "usage: jurisdiction <code>";
+        return false;
+    }
+
+    if (!store.setJurisdiction(store.getTaxTable().findJurisdiction(args[1]))) {
+        error = "unknown jurisdiction '" + args[1] + "'";
+        return false;
+    }
+    return true;
+}
+
+bool CommandProcessor::storage(const Arguments& args, std::string& error) {
+    if (args.size() != 2 || (args[1] != "sync" && args[1] != "stats")) {
+        error = "usage: storage sync|stats";
+        return false;
+    }
+    if (args[1] == "sync") {
+        store.syncDatabase();
+    } else {
+        store.generateStorageReport();
+    }
+    return true;
+}
+
+bool CommandProcessor::journal(const Arguments& args, std::string& error) {
+    if (args.size() != 2 || (args[1] != "sync" && args[1] != "stats")) {
+        error = "usage: journal sync|stats";
+        return false;
+    }
+    if (args[1] == "stats") {
+        store.generateJournalReport();
+    } else if (!store.getJournal()) {
+        error = "journal is off";
+        return false;
+    } else if (!store.syncJournal()) {
+        error = "journal write failed";
+        return false;
+    }
+    return true;
+}
+
+bool CommandProcessor::archive(const Arguments& args, std::string& error) {
+    if (args.size() == 2 && args[1] == "seal") {
+        store.archiveClosedDays(std::time(nullptr));
+    } else if (args.size() == 2 && args[1] == "stats") {
+        store.generateArchiveReport();
+    } else if (args.size() == 3 && args[1] == "save") {
+        if (!store.getArchive().save(args[2])) {
+            error = "cannot write archive '" + args[2] + "'";
+            return false;
+        }
+    } else if (args.size() == 3 && args[1] == "load") {
+        if (!store.getArchive().load(args[2])) {
+            error = "cannot read archive '" + args[2] + "'";
+            return false;
+        }
+    } else {
+        error = "usage: archive seal|stats | archive save|load <file>";
+        return false;
+    }
+    return true;
+}
+
+Store* CommandProcessor::findStore(const std::string& name) {
+    if (name == "local") {
+        return &store;
+    }
+    auto it = branches.find(name);
+    return it != branches.end() ? it->second : nullptr;
+}
+
+std::vector<StoreInventory> CommandProcessor::getStoreInventories() {
+    std::vector<StoreInventory> stores;
+    stores.push_back(StoreInventory{ "local", &store.getInventory() });
+    for (auto& entry : branches) {
+        stores.push_back(StoreInventory{ entry.first, &entry.second->getInventory() });
+    }
+    return stores;
+}
+
+bool CommandProcessor::branch(const Arguments& args, std::string& error) {
+    if (args.size() < 2) {
+        error = "usage: branch <name> [db=<file>] [replicate=<file>] [sample]";
+        return false;
+    }
+    const std::string& name = args[1];
+    if (findStore(name)) {
+        error = "store '" + name + "' is already open";
+        return false;
+    }
+
+    std::string databasePath;
+    std::string replicationPath;
+    bool sample = false;
+    for (size_t i = 2; i < args.size(); ++i) {
+        if (args[i].compare(0, 3, "db=") == 0) {
+            databasePath = args[i].substr(3);
+        } else if (args[i].compare(0, 10, "replicate=") == 0) {
+            replicationPath = args[i].substr(10);
+        } else if (args[i] == "sample") {
+            sample = true;
+        } else {
+            error = "unknown branch option '" + args[i] + "'";
+            return false;
+        }
+    }
+
+    Store* opened = new Store();
+    if (!databasePath.empty() && !opened->openDatabase(databasePath, 16 * 1024 * 1024)) {
+        error = "cannot open database " + databasePath;
+    } else if (!replicationPath.empty() && !opened->openReplication(replicationPath, name)) {
+        error = "cannot open replication log " + replicationPath;
+    }
+    if (!error.empty()) {
+        delete opened;
+        return false;
+    }
+    if (sample && !opened->hasStoredData()) {
+        opened->loadSampleData();
+    }
+    branches[name] = opened;
+    return true;
+}
+
+bool CommandProcessor::transfer(const Arguments& args, std::string& error) {
+    const std::string usage = "usage: transfer [prepare] <from> <to> <productId>:<qty>... | "
+                              "transfer commit|abort <transferId> | transfer list";
+    if (args.size() == 2 && args[1] == "list") {
+        if (transfers.empty()) {
+            std::cout << "No transfers" << std::endl;
+        }
+        for (const auto& entry : transfers) {
+            entry.second->display(std::cout);
+        }
+        return true;
+    }
+
+    if (args.size() == 3 && (args[1] == "commit" || args[1] == "abort")) {
+        int transferId;
+        auto it = parseInt(args[2], transferId) ? transfers.find(transferId) : transfers.end();
+        if (it == transfers.end()) {
+            error = "transfer not found: " + args[2];
+            return false;
+        }
+        StockTransfer* pending = it->second;
+        if (pending->getStatus() != TransferStatus::PREPARED) {
+            error = "transfer " + args[2] + " is " + pending->getStatusString();
+            return false;
+        }
+        if (args[1] == "commit") {
+            pending->commit();
+        } else {
+            pending->abort();
+        }
+        pending->display(std::cout);
+        return true;
+    }
+
+    bool prepareOnly = args.size() > 1 && args[1] == "prepare";
+    size_t first = prepareOnly ? 2 : 1;
+    if (args.size() < first + 3) {
+        error = usage;
+        return false;
+    }
+    Store* from = findStore(args[first]);
+    Store* to = findStore(args[first + 1]);
+    if (!from || !to) {
+        error = "no store '" + args[from ? first + 1 : first] + "'";
+        return false;
+    }
+
+    StockTransfer* started = new StockTransfer(from->getInventory(), args[first], to->getInventory(),
+                                               args[first + 1]);
+    for (size_t i = first + 2; i < args.size(); ++i) {
+        std::vector<std::string> fields = splitFields(args[i], ':');
+        int quantity = 0;
+        if (fields.size() != 2 || !parseInt(fields[1], quantity) || !started->addLine(fields[0], quantity)) {
+            error = "invalid line '" + args[i] + "'";
+            delete started;
+            return false;
+        }
+    }
+    transfers[started->getId()] = started;
+
+    if (!started->prepare()) {
+        error = "transfer " + std::to_string(started->getId()) + " failed: " + started->getFailure();
+        return false;
+    }
+    if (!prepareOnly) {
+        started->commit();
+    }
+    started->display(std::cout);
+    return true;
+}
+
+bool CommandProcessor::rebalance(const Arguments& args, std::string& error) {
+    if (args.size() != 2 || (args[1] != "plan" && args[1] != "run")) {
+        error = "usage: rebalance plan|run";
+        return false;
+    }
+
+    std::vector<StoreInventory> stores = getStoreInventories();
+    std::vector<TransferProposal> proposals = RebalancePlanner::plan(stores);
+    if (args[1] == "plan") {
+        std::cout << "Rebalance plan: " << proposals.size() << " movement(s)" << std::endl;
+        for (const TransferProposal& proposal : proposals) {
+            std::cout << "  " << std::left << std::setw(12) << proposal.productId << std::right << std::setw(6)
+                      << proposal.quantity << "  " << stores[proposal.from].name << " -> "
+                      << stores[proposal.to].name << std::endl;
+        }
+        return true;
+    }
+
+    // Each route's transfer commits on its own; one that cannot be reserved is reported and skipped
+    int failures = 0;
+    for (StockTransfer* planned : RebalancePlanner::buildTransfers(stores, proposals)) {
+        transfers[planned->getId()] = planned;
+        if (planned->prepare()) {
+            planned->commit();
+        } else {
+            failures++;
+        }
+        planned->display(std::cout);
+    }
+    if (failures > 0) {
+        error = std::to_string(failures) + " rebalance transfer(s) failed";
+        return false;
+    }
+    return true;
+}
+
+void CommandProcessor::printSummary(std::ostream& out) const {
+    double seconds = stats.seconds > 0 ? stats.seconds : 1e-9;
+
+    out << "\n--- SCRIPT SUMMARY ---" << std::endl;
+    out << "Lines Read: " << stats.lines << std::endl;
+    out << "Commands: " << stats.commands << " (" << stats.errors << " failed)" << std::endl;
+    out << "Sales: " << stats.sales << " ($" << std::fixed << std::setprecision(2)
+        << stats.salesValue << ")" << std::endl;
+    out << "Refunds: " << stats.refunds << " ($" << std::fixed << std::setprecision(2)
+        << stats.refundValue << ")" << std::endl;
+    out << "Elapsed: " << std::fixed << std::setprecision(3) << stats.seconds << "s" << std::endl;
+    out << "Throughput: " << std::fixed << std::setprecision(0)
+        << (stats.commands / seconds) << " commands/s, "
+        << (stats.sales / seconds) << " sales/s" << std::endl;
+}
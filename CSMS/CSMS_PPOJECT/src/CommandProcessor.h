@@ -0,0 +1,120 @@
+// ===== CommandProcessor.h =====
+#ifndef COMMAND_PROCESSOR_H
+#define COMMAND_PROCESSOR_H
+
+#include "Store.h"
+#include "StockTransfer.h"
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Counters collected while running a command script
+ */
+struct CommandStats {
+    long lines;
+    long commands;
+    long errors;
+    long sales;
+    long refunds;
+    double salesValue;
+    double refundValue;
+    double seconds;
+};
+
+/**
+ * @brief Headless driver that applies text commands to a Store
+ *
+ * One command per line; blank lines and lines starting with '#' are skipped,
+ * and arguments containing spaces can be double-quoted.
+ *
+ *   product regular|perishable|bulk <id> <name> <category> <price> <cost> <stock> [key=value...]
+ *       keys: desc supplier min max markup expires shelf discount unit minqty barcode
+ *   customer <first> <last> <email> <phone> [regular|premium|vip|employee]
+ *   stock <productId> <+N|-N>
+ *   price <productId> <basePrice>
+ *   barcodes <file>
+ *       lines: <productId> <GTIN> or <productId>,<GTIN>
+ *   reprice <percent> [category] [at=<unix time>|in=<seconds>] | reprice cancel <scheduleId> | reprice stats
+ *   sale <customerId|-> <cash|credit|debit|mobile> [paid=X] [points=N] <productId>:<qty>[:<discount>]|@<barcode>...
+ *   refund <transactionId|last> full | amount <X> | items <itemNo>:<qty>...
+ *   receipt <transactionId|last>
+ *   report inventory|lowstock|sales [today|week|30days]|window [minutes]|customers|financial|memory|live|replication|journal|prices
+ *   cube <dim,dim...|-> [dim=value,value...] [limit=N]
+ *       dims: product category supplier hour customer payment store
+ *   query [field<op>value...] [sort=[-]field] [limit=N] [show=field,field...]
+ *       ops: = != < <= > >= ~ (contains); values: comma lists, or a field as in stock<min or stock>=max*0.9
+ *       fields: id name category supplier type tag active price cost margin min max stock available value
+ *   basket run [support=F] [confidence=F] [maxsize=N] [threads=N]
+ *   basket itemsets|rules [N] | basket also <productId> [N]
+ *   cashier <id>
+ *   jurisdiction <code>
+ *   storage sync|stats
+ *   journal sync|stats
+ *   archive seal|stats | archive save|load <file>
+ *   branch <name> [db=<file>] [replicate=<file>] [sample]
+ *       opens another store in this process; the script's own store is "local"
+ *   transfer <from> <to> <productId>:<qty>... | transfer prepare <from> <to> <productId>:<qty>...
+ *   transfer commit|abort <transferId> | transfer list
+ *   rebalance plan|run
+ *
+ * Nothing is prompted or echoed; failures go to the error stream with their
+ * line number and the run continues.
+ */
+class CommandProcessor {
+private:
+    Store& store;
+    std::string cashierId;
+    int lastTransactionId;
+    CommandStats stats;
+    std::map<std::string, Store*> branches;     // Opened by "branch", owned
+    std::map<int, StockTransfer*> transfers;    // Every transfer started, owned
+
+    typedef std::vector<std::string> Arguments;
+
+    bool addProduct(const Arguments& args, std::string& error);
+    bool addCustomer(const Arguments& args, std::string& error);
+    bool adjustStock(const Arguments& args, std::string& error);
+    bool setPrice(const Arguments& args, std::string& error);
+    bool importBarcodes(const Arguments& args, std::string& error);
+    bool reprice(const Arguments& args, std::string& error);
+    bool sale(const Arguments& args, std::string& error);
+    bool refund(const Arguments& args, std::string& error);
+    bool receipt(const Arguments& args, std::string& error);
+    bool report(const Arguments& args, std::string& error);
+    bool cube(const Arguments& args, std::string& error);
+    bool queryProducts(const Arguments& args, std::string& error);
+    bool basket(const Arguments& args, std::string& error);
+    bool setJurisdiction(const Arguments& args, std::string& error);
+    bool storage(const Arguments& args, std::string& error);
+    bool journal(const Arguments& args, std::string& error);
+    bool archive(const Arguments& args, std::string& error);
+    bool branch(const Arguments& args, std::string& error);
+    bool transfer(const Arguments& args, std::string& error);
+    bool rebalance(const Arguments& args, std::string& error);
+
+    Transaction* resolveTransaction(const std::string& token, std::string& error);
+    Store* findStore(const std::string& name);
+    std::vector<StoreInventory> getStoreInventories();
+
+public:
+    CommandProcessor(Store& store, const std::string& cashierId = "CASHIER001");
+    ~CommandProcessor();                         // Aborts prepared transfers, then closes branches
+
+    CommandProcessor(const CommandProcessor&) = delete;
+    CommandProcessor& operator=(const CommandProcessor&) = delete;
+
+    static Arguments tokenize(const std::string& line);
+
+    // Executes one command line; returns false and sets error on failure
+    bool execute(const std::string& line, std::string& error);
+
+    // Executes every line of the stream, reporting failures to errors; trims resident products between lines
+    void run(std::istream& input, std::ostream& errors);
+
+    const CommandStats& getStats() const { return stats; }
+    void printSummary(std::ostream& out) const;
+};
+
+#endif // COMMAND_PROCESSOR_H
@@ -0,0 +1,239 @@
+// ===== DataGenerator.cpp =====
+#include "DataGenerator.h"
+#include "Gtin.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+
+static const char* ADJECTIVES[] = { "Classic", "Fresh", "Organic", "Premium", "Lite", "Family",
+                                    "Spicy", "Original", "Golden", "Value", "Crunchy", "Natural" };
+static const int ADJECTIVE_COUNT = sizeof(ADJECTIVES) / sizeof(ADJECTIVES[0]);
+
+// Nouns per ProductCategory, in enum order
+static const char* NOUNS[PRODUCT_CATEGORY_COUNT][6] = {
+    { "Cola", "Iced Tea", "Sparkling Water", "Orange Juice", "Energy Drink", "Cold Brew" },
+    { "Potato Chips", "Pretzels", "Trail Mix", "Chocolate Bar", "Popcorn", "Granola Bar" },
+    { "Milk", "Greek Yogurt", "Cheddar", "Butter", "Cream Cheese", "Kefir" },
+    { "Croissant", "Bagel", "Sourdough Loaf", "Muffin", "Baguette", "Cinnamon Roll" },
+    { "Dish Soap", "Paper Towels", "Trash Bags", "Sponges", "Detergent", "Light Bulbs" },
+    { "USB Cable", "Earbuds", "Phone Charger", "AA Batteries", "Power Bank", "SD Card" },
+    { "Shampoo", "Toothpaste", "Sunscreen", "Hand Cream", "Vitamins", "Lip Balm" },
+    { "Rice", "Coffee Beans", "Oats", "Lentils", "Sugar", "Flour" }
+};
+
+static const char* FIRST_NAMES[] = { "James", "Mary", "Wei", "Fatima", "Carlos", "Aiko", "Olga",
+                                     "Kwame", "Priya", "Liam", "Sofia", "Noah", "Amara", "Jonas" };
+static const char* LAST_NAMES[] = { "Smith", "Chen", "Garcia", "Khan", "Novak", "Okafor", "Sato",
+                                    "Muller", "Rossi", "Silva", "Kim", "Patel", "Brown", "Larsen" };
+static const int FIRST_NAME_COUNT = sizeof(FIRST_NAMES) / sizeof(FIRST_NAMES[0]);
+static const int LAST_NAME_COUNT = sizeof(LAST_NAMES) / sizeof(LAST_NAMES[0]);
+
+ZipfDistribution::ZipfDistribution(int n, double exponent) {
+    double total = 0.0;
+    for (int rank = 1; rank <= std::max(1, n); ++rank) {
+        total += 1.0 / std::pow(rank, exponent);
+        cdf.push_back(total);
+    }
+    for (double& value : cdf) {
+        value /= total;
+    }
+}
+
+DataGenerator::DataGenerator(const GeneratorConfig& config)
+    : config(config), rng(config.seed), supplierSizes(config.supplierCount, config.supplierSkew),
+      popularity(config.productCount, config.popularitySkew) {
+    for (int i = 0; i < config.supplierCount; ++i) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "Supplier %03d", i + 1);
+        suppliers.push_back(name);
+    }
+}
+
+Product* DataGenerator::makeProduct(int index) {
+    ProductCategory category = static_cast<ProductCategory>(
+        std::uniform_int_distribution<int>(0, PRODUCT_CATEGORY_COUNT - 1)(rng));
+    int categoryIndex = static_cast<int>(category);
+
+    std::string id = "SKU" + std::to_string(100000 + index);
+    std::string name = std::string(ADJECTIVES[std::uniform_int_distribution<int>(0, ADJECTIVE_COUNT - 1)(rng)]) +
+                       " " + NOUNS[categoryIndex][std::uniform_int_distribution<int>(0, 5)(rng)] +
+                       " #" + std::to_string(index);
+    std::string supplier = suppliers.empty() ? std::string() : suppliers[supplierSizes(rng)];
+
+    // Log-normal costs: mostly cheap items with a long tail of expensive ones
+    double cost = std::min(150.0, std::lognormal_distribution<double>(1.0, 0.7)(rng));
+    cost = std::round(cost * 100.0) / 100.0 + 0.25;
+    int stock = std::uniform_int_distribution<int>(20, 800)(rng);
+
+    // Weighed goods get a weight-label item reference while the five digits last
+    std::string barcode = Gtin::makeEan13("590", static_cast<uint64_t>(index));
+    Product* product;
+    double u = uniform();
+    if (u < config.perishableShare) {
+        char expires[16];
+        std::snprintf(expires, sizeof(expires), "2027-%02d-%02d",
+                      std::uniform_int_distribution<int>(1, 12)(rng),
+                      std::uniform_int_distribution<int>(1, 28)(rng));
+        product = new PerishableProduct(id, name, "Generated perishable", cost * 1.6, cost, stock, category,
+                                        expires, std::uniform_int_distribution<int>(2, 21)(rng), supplier,
+                                        0.2, 15, 600);
+        product->addTag("fresh");
+    } else if (u < config.perishableShare + config.bulkShare) {
+        product = new BulkProduct(id, name, "Generated bulk", cost * 1.4, cost, stock * 2, category, "kg", 0.25,
+                                  supplier, 40, 2000);
+        product->addTag("bulk");
+        if (index < 100000) {
+            barcode = Gtin::makeMeasureLabel(21, static_cast<uint32_t>(index), 0);
+        }
+    } else {
+        product = new RegularProduct(id, name, "Generated regular", cost * 1.3, cost, stock, category, supplier,
+                                     0.2 + 0.3 * uniform(), 20, 1000);
+    }
+    product->setBarcode(barcode);
+
+    std::string tag = NOUNS[categoryIndex][0];
+    std::transform(tag.begin(), tag.end(), tag.begin(), ::tolower);
+    product->addTag(tag);
+    if (uniform() < 0.1) {
+        product->addTag("promo");
+    }
+    return product;
+}
+
+void DataGenerator::populateCatalog(InventoryManager& inventory) {
+    catalog.clear();
+    for (int i = 0; i < config.productCount; ++i) {
+        Product* product = makeProduct(i);
+        if (inventory.addProduct(product)) {
+            catalog.push_back(product);
+        } else {
+            delete product;
+        }
+    }
+
+    // Popularity ranks are assigned over a shuffled catalog
+    std::shuffle(catalog.begin(), catalog.end(), rng);
+    popularity = ZipfDistribution(static_cast<int>(catalog.size()), config.popularitySkew);
+}
+
+void DataGenerator::populateCustomers(CustomerDatabase& customerDB) {
+    customers.clear();
+    for (int i = 0; i < config.customerCount; ++i) {
+        std::string first = FIRST_NAMES[std::uniform_int_distribution<int>(0, FIRST_NAME_COUNT - 1)(rng)];
+        std::string last = LAST_NAMES[std::uniform_int_distribution<int>(0, LAST_NAME_COUNT - 1)(rng)];
+
+        std::string email = first + "." + last + std::to_string(i) + "@example.com";
+        std::transform(email.begin(), email.end(), email.begin(), ::tolower);
+
+        // Area code is random, the line number is unique per customer
+        char phone[24];
+        std::snprintf(phone, sizeof(phone), "+1%03d%07d",
+                      std::uniform_int_distribution<int>(201, 989)(rng), i);
+
+        double u = uniform();
+        CustomerType type = (u < 0.70) ? CustomerType::REGULAR
+                          : (u < 0.90) ? CustomerType::PREMIUM
+                          : (u < 0.97) ? CustomerType::VIP
+                                       : CustomerType::EMPLOYEE;
+        customers.push_back(customerDB.addCustomer(first, last, email, phone, type));
+    }
+}
+
+void DataGenerator::populate(Store& store) {
+    populateCatalog(store.getInventory());
+    populateCustomers(store.getCustomerDatabase());
+}
+
+Product* DataGenerator::pickProduct() {
+    return catalog.empty() ? nullptr : catalog[popularity(rng)];
+}
+
+Customer* DataGenerator::pickCustomer() {
+    if (customers.empty() || uniform() >= config.memberShare) {
+        return nullptr;
+    }
+    return customers[std::uniform_int_distribution<size_t>(0, customers.size() - 1)(rng)];
+}
+
+int DataGenerator::pickBasketSize() {
+    std::uniform_int_distribution<int> small(1, 4);
+    std::uniform_int_distribution<int> medium(5, 14);
+    std::uniform_int_distribution<int> large(15, 40);
+    double u = uniform();
+
+    switch (config.basket) {
+        case BasketMix::SMALL: return small(rng);
+        case BasketMix::LARGE: return large(rng);
+        default:
+            return (u < 0.70) ? small(rng) : (u < 0.95) ? medium(rng) : large(rng);
+    }
+}
+
+double DataGenerator::pickQuantity(const Product* product) {
+    if (product->getProductType() == "Bulk") {
+        return 0.25 * (1 + static_cast<int>(uniform() * 8));
+    }
+    return 1.0 + static_cast<int>(uniform() * uniform() * 3);
+}
+
+GeneratedSale DataGenerator::nextSale() {
+    GeneratedSale sale;
+    sale.customer = pickCustomer();
+
+    double u = uniform();
+    sale.method = (u < 0.35) ? PaymentMethod::CASH
+                : (u < 0.75) ? PaymentMethod::CREDIT_CARD
+                : (u < 0.90) ? PaymentMethod::DEBIT_CARD
+                             : PaymentMethod::MOBILE_PAYMENT;
+
+    int size = pickBasketSize();
+    for (int i = 0; i < size && !catalog.empty(); ++i) {
+        Product* product = pickProduct();
+        sale.items.push_back(std::make_pair(product, pickQuantity(product)));
+    }
+    return sale;
+}
+
+int DataGenerator::generateSales(Store& store, int count, const std::string& cashierId) {
+    int completed = 0;
+    std::time_t now = std::time(nullptr);
+    for (int n = 0; n < count; ++n) {
+        GeneratedSale sale = nextSale();
+        Transaction* transaction = new Transaction(sale.customer, cashierId);
+        if (config.historyDays > 0) {
+            // Oldest first, so the store sees sales in time order
+            transaction->setTimestamp(now - static_cast<std::time_t>(
+                static_cast<double>(count - n) / count * config.historyDays * 86400.0));
+        }
+
+        for (const auto& line : sale.items) {
+            Product* product = line.first;
+            int needed = static_cast<int>(std::ceil(line.second));
+            if (product->getAvailableStock() < needed + product->getMinStockLevel()) {
+                product->addStock(product->getRestockRecommendation() + needed);  // Replenish from the back room
+            }
+            transaction->addItem(product, line.second);
+        }
+
+        if (transaction->getItems().empty()) {
+            delete transaction;
+            continue;
+        }
+
+        store.priceTransaction(transaction);
+
+        // Cash customers round up to the next dollar
+        double amountPaid = transaction->getFinalTotal();
+        if (sale.method == PaymentMethod::CASH) {
+            amountPaid = std::ceil(amountPaid);
+        }
+
+        if (store.completeSale(transaction, sale.method, amountPaid)) {
+            completed++;
+        } else {
+            delete transaction;
+        }
+    }
+    return completed;
+}
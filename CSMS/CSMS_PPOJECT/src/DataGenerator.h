@@ -0,0 +1,116 @@
+// ===== DataGenerator.h =====
+#ifndef DATA_GENERATOR_H
+#define DATA_GENERATOR_H
+
+#include "Product.h"
+#include "Customer.h"
+#include "Transaction.h"
+#include "InventoryManager.h"
+#include "Store.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class BasketMix {
+    SMALL,     // Grab-and-go, 1-4 items
+    MIXED,     // Mostly small, some weekly shops
+    LARGE      // Stock-up trips, 15-40 items
+};
+
+/**
+ * @brief Zipf(s) over ranks 0..n-1, sampled by binary search of the CDF
+ */
+class ZipfDistribution {
+private:
+    std::vector<double> cdf;
+
+public:
+    ZipfDistribution(int n = 1, double exponent = 1.0);
+
+    template <typename Random>
+    int operator()(Random& random) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(random);
+        size_t rank = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+        return static_cast<int>(std::min(rank, cdf.size() - 1));
+    }
+
+    int size() const { return static_cast<int>(cdf.size()); }
+};
+
+/**
+ * @brief Shape of the generated store
+ */
+struct GeneratorConfig {
+    unsigned seed;
+    int productCount;
+    int customerCount;
+    int supplierCount;
+    double popularitySkew;     // Zipf exponent over product popularity ranks
+    double supplierSkew;       // Zipf exponent over supplier catalog sizes
+    double perishableShare;    // Fraction of the catalog that is perishable
+    double bulkShare;          // Fraction of the catalog sold by weight
+    double memberShare;        // Fraction of sales made by loyalty members
+    int historyDays;           // Spread generated sales evenly over this many past days (0 = now)
+    BasketMix basket;
+
+    GeneratorConfig()
+        : seed(42), productCount(1000), customerCount(1000), supplierCount(40),
+          popularitySkew(1.0), supplierSkew(1.2), perishableShare(0.2), bulkShare(0.1),
+          memberShare(0.65), historyDays(0), basket(BasketMix::MIXED) {}
+};
+
+/**
+ * @brief One generated checkout, not yet rung up
+ */
+struct GeneratedSale {
+    Customer* customer;                              // nullptr for walk-ins
+    PaymentMethod method;
+    std::vector<std::pair<Product*, double>> items;  // Product and quantity
+};
+
+/**
+ * @brief Deterministic, seedable source of catalogs, customers and sales
+ *
+ * The same seed and configuration always produce the same store. Product
+ * popularity and supplier catalog sizes are Zipf distributed, so a few
+ * products dominate sales and a few suppliers carry most of the catalog.
+ */
+class DataGenerator {
+private:
+    GeneratorConfig config;
+    std::mt19937_64 rng;
+    std::vector<std::string> suppliers;
+    ZipfDistribution supplierSizes;
+    ZipfDistribution popularity;
+    std::vector<Product*> catalog;      // Ordered by popularity rank
+    std::vector<Customer*> customers;
+
+    Product* makeProduct(int index);
+    double uniform() { return std::uniform_real_distribution<double>(0.0, 1.0)(rng); }
+
+public:
+    explicit DataGenerator(const GeneratorConfig& config = GeneratorConfig());
+
+    void populateCatalog(InventoryManager& inventory);
+    void populateCustomers(CustomerDatabase& customerDB);
+    void populate(Store& store);
+
+    // Transaction stream
+    Product* pickProduct();
+    Customer* pickCustomer();
+    int pickBasketSize();
+    double pickQuantity(const Product* product);
+    GeneratedSale nextSale();
+
+    // Rings up count generated sales, restocking as needed; returns the number completed
+    int generateSales(Store& store, int count, const std::string& cashierId = "GEN001");
+
+    const std::vector<Product*>& getCatalog() const { return catalog; }
+    const std::vector<Customer*>& getCustomers() const { return customers; }
+    const GeneratorConfig& getConfig() const { return config; }
+    std::mt19937_64& getRandom() { return rng; }
+};
+
+#endif // DATA_GENERATOR_H
@@ -0,0 +1,202 @@
+// ===== Gtin.cpp =====
+#include "Gtin.h"
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static const uint64_t EAN13_LIMIT = 10000000000000ULL;   // GTIN-14 values below this are EAN-13/UPC-A/EAN-8
+static const uint64_t PREFIX_DIVISOR = 100000000000ULL;  // Leaves the two leading EAN-13 digits
+static const uint64_t VALUE_AND_CHECK = 1000000ULL;      // Five value digits and the check digit
+static const uint64_t MEASURE_KEY_BASE = 20 * PREFIX_DIVISOR;   // Item references share one key range
+
+static MeasureKind measureForPrefix(int prefix) {
+    if (prefix >= 20 && prefix <= 22) {
+        return MeasureKind::WEIGHT;
+    }
+    if (prefix == 2 || (prefix >= 23 && prefix <= 25)) {
+        return MeasureKind::PRICE;
+    }
+    return MeasureKind::NONE;
+}
+
+int Gtin::checkDigit(const char* digits, size_t length) {
+    // GS1 mod 10: weights 3, 1, 3, ... from the rightmost data digit
+    int sum = 0;
+    for (size_t i = 0; i < length; ++i) {
+        int digit = digits[length - 1 - i] - '0';
+        sum += (i % 2 == 0) ? 3 * digit : digit;
+    }
+    return (10 - sum % 10) % 10;
+}
+
+bool Gtin::parse(const std::string& text, uint64_t& gtin, GtinFormat& format) {
+    size_t length = text.size();
+    switch (length) {
+        case 8: format = GtinFormat::EAN8; break;
+        case 12: format = GtinFormat::UPC_A; break;
+        case 13: format = GtinFormat::EAN13; break;
+        case 14: format = GtinFormat::GTIN14; break;
+        default:
+            format = GtinFormat::INVALID;
+            return false;
+    }
+    uint64_t value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            format = GtinFormat::INVALID;
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    if (checkDigit(text.data(), length - 1) != text[length - 1] - '0') {
+        format = GtinFormat::INVALID;
+        return false;
+    }
+    gtin = value;
+    return true;
+}
+
+bool Gtin::isValid(const std::string& text) {
+    uint64_t gtin;
+    GtinFormat format;
+    return parse(text, gtin, format);
+}
+
+bool Gtin::decode(const std::string& text, BarcodeScan& scan) {
+    scan = BarcodeScan();
+    if (!parse(text, scan.gtin, scan.format)) {
+        return false;
+    }
+    scan.lookupKey = scan.gtin;
+    if (scan.gtin >= EAN13_LIMIT) {
+        return true;
+    }
+
+    scan.measure = measureForPrefix(static_cast<int>(scan.gtin / PREFIX_DIVISOR));
+    if (scan.measure == MeasureKind::NONE) {
+        return true;
+    }
+    scan.itemReference = static_cast<uint32_t>((scan.gtin / VALUE_AND_CHECK) % 100000);
+    scan.measureValue = static_cast<uint32_t>((scan.gtin / 10) % 100000);
+    scan.lookupKey = MEASURE_KEY_BASE + scan.itemReference * VALUE_AND_CHECK;
+    if (scan.measure == MeasureKind::WEIGHT) {
+        scan.quantity = scan.measureValue / 1000.0;
+    } else {
+        scan.price = scan.measureValue / 100.0;
+    }
+    return true;
+}
+
+std::string Gtin::withCheckDigit(const std::string& dataDigits) {
+    return dataDigits + static_cast<char>('0' + checkDigit(dataDigits.data(), dataDigits.size()));
+}
+
+std::string Gtin::makeEan13(const std::string& prefix, uint64_t itemNumber) {
+    if (prefix.size() >= 12) {
+        return std::string();
+    }
+    std::string item = std::to_string(itemNumber);
+    size_t width = 12 - prefix.size();
+    if (item.size() > width) {
+        return std::string();
+    }
+    return withCheckDigit(prefix + std::string(width - item.size(), '0') + item);
+}
+
+std::string Gtin::makeMeasureLabel(int prefix, uint32_t itemReference, uint32_t value) {
+    if (measureForPrefix(prefix) == MeasureKind::NONE || itemReference > 99999 || value > 99999) {
+        return std::string();
+    }
+    char data[16];
+    std::snprintf(data, sizeof(data), "%02d%05u%05u", prefix, itemReference, value);
+    return withCheckDigit(data);
+}
+
+std::string Gtin::formatName(GtinFormat format) {
+    switch (format) {
+        case GtinFormat::EAN8: return "EAN-8";
+        case GtinFormat::UPC_A: return "UPC-A";
+        case GtinFormat::EAN13: return "EAN-13";
+        case GtinFormat::GTIN14: return "GTIN-14";
+        default: return "Invalid";
+    }
+}
+
+size_t Gtin::validateBatch(const std::vector<std::string>& codes, std::vector<uint8_t>& valid) {
+    valid.assign(codes.size(), 0);
+    size_t passed = 0;
+
+#if defined(__SSE2__)
+    // Codes are right-aligned as GTIN-14 in 16-byte records, '0'-padded on
+    // both sides. With the check digit weighted 1, a code is valid when its
+    // weighted digit sum is a multiple of 10; the pad bytes are weighted 0.
+    static const size_t BLOCK = 64;
+    alignas(16) char records[BLOCK][16];
+    alignas(16) int32_t sums[BLOCK];
+    int badDigits[BLOCK];
+    size_t indexes[BLOCK];
+
+    const __m128i zeroChar = _mm_set1_epi8('0');
+    const __m128i nineChar = _mm_set1_epi8('9');
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lowWeights = _mm_setr_epi16(3, 1, 3, 1, 3, 1, 3, 1);
+    const __m128i highWeights = _mm_setr_epi16(3, 1, 3, 1, 3, 1, 0, 0);
+
+    size_t next = 0;
+    while (next < codes.size()) {
+        // Pack the next block; codes of a length no GTIN has fail here
+        size_t count = 0;
+        for (; next < codes.size() && count < BLOCK; ++next) {
+            const std::string& code = codes[next];
+            size_t length = code.size();
+            if (length != 8 && length != 12 && length != 13 && length != 14) {
+                continue;
+            }
+            std::memset(records[count], '0', 16);
+            std::memcpy(records[count] + MAX_DIGITS - length, code.data(), length);
+            indexes[count++] = next;
+        }
+        while (count % 4 != 0) {
+            std::memset(records[count], '0', 16);
+            indexes[count++] = codes.size();   // Padding record, never stored
+        }
+
+        for (size_t r = 0; r < count; r += 4) {
+            __m128i partial[4];
+            for (int k = 0; k < 4; ++k) {
+                __m128i chars = _mm_load_si128(reinterpret_cast<const __m128i*>(records[r + k]));
+                __m128i outside = _mm_or_si128(_mm_cmplt_epi8(chars, zeroChar), _mm_cmpgt_epi8(chars, nineChar));
+                badDigits[r + k] = _mm_movemask_epi8(outside);
+                __m128i digits = _mm_sub_epi8(chars, zeroChar);
+                partial[k] = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), lowWeights),
+                                           _mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), highWeights));
+            }
+            // Transpose-add the four partial vectors into one vector of four sums
+            __m128i ab = _mm_add_epi32(_mm_unpacklo_epi32(partial[0], partial[1]),
+                                       _mm_unpackhi_epi32(partial[0], partial[1]));
+            __m128i cd = _mm_add_epi32(_mm_unpacklo_epi32(partial[2], partial[3]),
+                                       _mm_unpackhi_epi32(partial[2], partial[3]));
+            __m128i total = _mm_add_epi32(_mm_unpacklo_epi64(ab, cd), _mm_unpackhi_epi64(ab, cd));
+            _mm_store_si128(reinterpret_cast<__m128i*>(sums + r), total);
+        }
+
+        for (size_t r = 0; r < count; ++r) {
+            if (indexes[r] < codes.size() && badDigits[r] == 0 && sums[r] % 10 == 0) {
+                valid[indexes[r]] = 1;
+                ++passed;
+            }
+        }
+    }
+#else
+    for (size_t i = 0; i < codes.size(); ++i) {
+        if (isValid(codes[i])) {
+            valid[i] = 1;
+            ++passed;
+        }
+    }
+#endif
+    return passed;
+}
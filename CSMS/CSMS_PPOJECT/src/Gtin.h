@@ -0,0 +1,87 @@
+// ===== Gtin.h =====
+#ifndef GTIN_H
+#define GTIN_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Symbology a scanned code arrived in, by digit count
+ */
+enum class GtinFormat {
+    INVALID,
+    EAN8,
+    UPC_A,
+    EAN13,
+    GTIN14
+};
+
+/**
+ * @brief What the value field of a variable-measure code carries
+ */
+enum class MeasureKind {
+    NONE,        // Ordinary trade item
+    WEIGHT,      // Thousandths of the product's selling unit (grams for kg)
+    PRICE        // Line price in cents
+};
+
+/**
+ * @brief A validated code, decoded
+ *
+ * Codes are kept as their GTIN-14 value: shorter symbologies are the same
+ * number with leading zeros. lookupKey identifies the product: the code
+ * itself, or for variable-measure codes the item reference alone, so
+ * weight and price labels of one item find the same product.
+ */
+struct BarcodeScan {
+    uint64_t gtin;
+    uint64_t lookupKey;
+    GtinFormat format;
+    MeasureKind measure;
+    uint32_t itemReference;   // Variable-measure item number
+    uint32_t measureValue;    // Raw value field
+    double quantity;          // WEIGHT: quantity in selling units
+    double price;             // PRICE: line price
+
+    BarcodeScan()
+        : gtin(0), lookupKey(0), format(GtinFormat::INVALID), measure(MeasureKind::NONE), itemReference(0),
+          measureValue(0), quantity(0.0), price(0.0) {}
+};
+
+/**
+ * @brief GTIN/EAN/UPC parsing and GS1 check digits
+ *
+ * Accepts EAN-8, UPC-A, EAN-13 and GTIN-14 as plain digit strings.
+ * Variable-measure codes are EAN-13s with a 02 or 20-25 prefix (UPC-A
+ * number system 2 is 02): two prefix digits, a five-digit item reference,
+ * a five-digit value and the check digit. 20-22 carry a weight and 02 and
+ * 23-25 a price; 26-29 are left to in-store numbering as ordinary codes.
+ *
+ * validateBatch checks many codes at once for supplier imports; with SSE2
+ * it weighs a whole code per register and reduces four codes together.
+ */
+class Gtin {
+public:
+    static const size_t MAX_DIGITS = 14;
+
+    static int checkDigit(const char* digits, size_t length);   // Check digit for `length` data digits
+    static bool isValid(const std::string& text);
+    static bool parse(const std::string& text, uint64_t& gtin, GtinFormat& format);
+    static bool decode(const std::string& text, BarcodeScan& scan);
+
+    // Product and shelf-label codes; data digits without the check digit
+    static std::string withCheckDigit(const std::string& dataDigits);
+    static std::string makeEan13(const std::string& prefix, uint64_t itemNumber);   // prefix + item, 12 digits
+    static std::string makeMeasureLabel(int prefix, uint32_t itemReference, uint32_t value);
+
+    static std::string formatName(GtinFormat format);
+
+    /**
+     * @brief Validates every code; valid[i] is 1 for a well-formed code with
+     *        a correct check digit. Returns how many passed.
+     */
+    static size_t validateBatch(const std::vector<std::string>& codes, std::vector<uint8_t>& valid);
+};
+
+#endif // GTIN_H
@@ -0,0 +1,316 @@
+// ===== HeadOffice.cpp =====
+#include "HeadOffice.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+static const char* CHECKPOINT_TAG = "#CSMS-HEADOFFICE";
+static const std::streamoff READ_CHUNK = 1 << 20;
+
+static std::vector<std::string> splitTabs(const std::string& line) {
+    std::vector<std::string> fields;
+    std::istringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, '\t')) {
+        fields.push_back(field);
+    }
+    if (!line.empty() && line.back() == '\t') {
+        fields.push_back("");
+    }
+    return fields;
+}
+
+StoreFeed::StoreFeed(const std::string& path)
+    : path(path), offset(0), lastSequence(0), eventsApplied(0), badLines(0), gaps(0), resets(0), available(false) {
+}
+
+int ConsolidatedProduct::getTotalStock() const {
+    int total = 0;
+    for (const auto& store : stores) {
+        total += store.second.stock;
+    }
+    return total;
+}
+
+// HeadOfficeView implementation
+void HeadOfficeView::addFeed(const std::string& path) {
+    for (const StoreFeed& feed : feeds) {
+        if (feed.path == path) {
+            return;
+        }
+    }
+    feeds.push_back(StoreFeed(path));
+}
+
+long HeadOfficeView::poll() {
+    long applied = 0;
+    for (StoreFeed& feed : feeds) {
+        applied += pollFeed(feed);
+    }
+    return applied;
+}
+
+long HeadOfficeView::pollFeed(StoreFeed& feed) {
+    std::ifstream in(feed.path, std::ios::binary | std::ios::ate);
+    std::string header;
+    std::string storeId;
+    std::string epoch;
+    std::streamoff size = in ? static_cast<std::streamoff>(in.tellg()) : 0;
+    in.seekg(0);
+    feed.available = in && std::getline(in, header) && ReplicationLog::parseHeader(header, storeId, epoch);
+    if (!feed.available) {
+        return 0;   // Not there yet, or the store is offline; keep the position
+    }
+
+    // A different epoch, or a log shorter than what was read, means the store started a new log
+    if (epoch != feed.epoch || storeId != feed.storeId || size < feed.offset) {
+        if (!feed.epoch.empty()) {
+            feed.resets++;
+            dropStore(feed.storeId);
+        }
+        feed.storeId = storeId;
+        feed.epoch = epoch;
+        feed.offset = static_cast<std::streamoff>(header.size()) + 1;
+        feed.lastSequence = 0;
+    }
+
+    long applied = 0;
+    std::string buffer;
+    ReplicationEvent event;
+    while (feed.offset < size) {
+        size_t length = static_cast<size_t>(std::min(READ_CHUNK, size - feed.offset));
+        buffer.resize(length);
+        in.clear();
+        in.seekg(feed.offset);
+        in.read(&buffer[0], length);
+        buffer.resize(static_cast<size_t>(in.gcount()));
+
+        size_t lastNewline = buffer.rfind('\n');
+        if (lastNewline == std::string::npos) {
+            if (buffer.size() < static_cast<size_t>(READ_CHUNK)) {
+                break;          // The store is still writing this line
+            }
+            feed.badLines++;    // A line no writer produces; skip past it
+            feed.offset += static_cast<std::streamoff>(buffer.size());
+            continue;
+        }
+
+        size_t start = 0;
+        while (start <= lastNewline) {
+            size_t end = buffer.find('\n', start);
+            if (!ReplicationEvent::parse(buffer.substr(start, end - start), event)) {
+                feed.badLines++;
+            } else if (event.sequence > feed.lastSequence) {
+                feed.gaps += static_cast<long>(event.sequence - feed.lastSequence - 1);
+                apply(feed.storeId, event);
+                feed.lastSequence = event.sequence;
+                feed.eventsApplied++;
+                applied++;
+            }
+            start = end + 1;
+        }
+        feed.offset += static_cast<std::streamoff>(lastNewline + 1);
+    }
+    return applied;
+}
+
+void HeadOfficeView::dropStore(const std::string& storeId) {
+    for (auto it = products.begin(); it != products.end();) {
+        it->second.stores.erase(storeId);
+        it = it->second.stores.empty() ? products.erase(it) : std::next(it);
+    }
+}
+
+void HeadOfficeView::apply(const std::string& storeId, const ReplicationEvent& event) {
+    if (event.type == ReplicationEventType::REMOVE) {
+        auto it = products.find(event.productId);
+        if (it != products.end()) {
+            it->second.stores.erase(storeId);
+            if (it->second.stores.empty()) {
+                products.erase(it);
+            }
+        }
+        return;
+    }
+
+    auto inserted = products.insert(std::make_pair(event.productId, ConsolidatedProduct()));
+    ConsolidatedProduct& product = inserted.first->second;
+    if (inserted.second) {
+        product.category = ProductCategory::OTHER;
+    }
+    auto storeInserted = product.stores.insert(std::make_pair(storeId, StoreStock()));
+    StoreStock& stock = storeInserted.first->second;
+    if (storeInserted.second) {
+        stock.stock = 0;
+        stock.basePrice = 0.0;
+        stock.sellingPrice = 0.0;
+    }
+
+    if (event.type == ReplicationEventType::PRODUCT) {
+        product.name = event.name;
+        product.supplier = event.supplier;
+        product.category = event.category;
+    }
+    if (event.type == ReplicationEventType::PRODUCT || event.type == ReplicationEventType::STOCK) {
+        stock.stock = event.stock;
+    }
+    if (event.type == ReplicationEventType::PRODUCT || event.type == ReplicationEventType::PRICE) {
+        stock.basePrice = event.basePrice;
+        stock.sellingPrice = event.sellingPrice;
+    }
+    stock.sequence = event.sequence;
+    stock.updated = event.timestamp;
+}
+
+const ConsolidatedProduct* HeadOfficeView::findProduct(const std::string& productId) const {
+    auto it = products.find(productId);
+    return it != products.end() ? &it->second : nullptr;
+}
+
+bool HeadOfficeView::saveCheckpoint(const std::string& path) const {
+    // Written beside the old checkpoint and renamed over it, so a crash leaves one or the other
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out << CHECKPOINT_TAG << "\t1\n" << std::setprecision(4) << std::fixed;
+        for (const StoreFeed& feed : feeds) {
+            out << "F\t" << feed.path << '\t' << feed.storeId << '\t' << feed.epoch << '\t' << feed.offset << '\t'
+                << feed.lastSequence << '\t' << feed.eventsApplied << '\t' << feed.badLines << '\t' << feed.gaps
+                << '\t' << feed.resets << '\n';
+        }
+        for (const auto& entry : products) {
+            const ConsolidatedProduct& product = entry.second;
+            out << "P\t" << entry.first << '\t' << static_cast<int>(product.category) << '\t' << product.name << '\t'
+                << product.supplier << '\n';
+            for (const auto& store : product.stores) {
+                const StoreStock& stock = store.second;
+                out << "S\t" << store.first << '\t' << stock.stock << '\t' << stock.basePrice << '\t'
+                    << stock.sellingPrice << '\t' << stock.sequence << '\t' << static_cast<long long>(stock.updated)
+                    << '\n';
+            }
+        }
+        if (!out.flush()) {
+            return false;
+        }
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool HeadOfficeView::loadCheckpoint(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::string line;
+    if (!std::getline(in, line) || line != std::string(CHECKPOINT_TAG) + "\t1") {
+        return false;
+    }
+
+    std::vector<StoreFeed> loadedFeeds;
+    std::map<std::string, ConsolidatedProduct> loadedProducts;
+    ConsolidatedProduct* current = nullptr;
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields = splitTabs(line);
+        if (fields.size() == 10 && fields[0] == "F") {
+            StoreFeed feed(fields[1]);
+            feed.storeId = fields[2];
+            feed.epoch = fields[3];
+            feed.offset = std::strtoll(fields[4].c_str(), nullptr, 10);
+            feed.lastSequence = std::strtoull(fields[5].c_str(), nullptr, 10);
+            feed.eventsApplied = std::atol(fields[6].c_str());
+            feed.badLines = std::atol(fields[7].c_str());
+            feed.gaps = std::atol(fields[8].c_str());
+            feed.resets = std::atol(fields[9].c_str());
+            loadedFeeds.push_back(feed);
+        } else if (fields.size() == 5 && fields[0] == "P") {
+            current = &loadedProducts[fields[1]];
+            current->category = static_cast<ProductCategory>(
+                std::min(std::max(std::atoi(fields[2].c_str()), 0), static_cast<int>(ProductCategory::OTHER)));
+            current->name = fields[3];
+            current->supplier = fields[4];
+        } else if (fields.size() == 7 && fields[0] == "S" && current) {
+            StoreStock& stock = current->stores[fields[1]];
+            stock.stock = std::atoi(fields[2].c_str());
+            stock.basePrice = std::atof(fields[3].c_str());
+            stock.sellingPrice = std::atof(fields[4].c_str());
+            stock.sequence = std::strtoull(fields[5].c_str(), nullptr, 10);
+            stock.updated = static_cast<std::time_t>(std::strtoll(fields[6].c_str(), nullptr, 10));
+        } else {
+            return false;
+        }
+    }
+
+    feeds.swap(loadedFeeds);
+    products.swap(loadedProducts);
+    return true;
+}
+
+void HeadOfficeView::displayFeeds(std::ostream& out) const {
+    out << "\n" << std::string(78, '=') << std::endl;
+    out << "                          STORE REPLICATION FEEDS" << std::endl;
+    out << std::string(78, '=') << std::endl;
+    out << std::left << std::setw(10) << "Store" << std::setw(28) << "Log" << std::right << std::setw(10)
+        << "Sequence" << std::setw(10) << "Applied" << std::setw(6) << "Gaps" << std::setw(6) << "Bad"
+        << std::setw(8) << "Resets" << "  Status" << std::endl;
+    out << std::string(78, '-') << std::endl;
+    for (const StoreFeed& feed : feeds) {
+        std::string path = feed.path.size() > 26 ? "..." + feed.path.substr(feed.path.size() - 23) : feed.path;
+        out << std::left << std::setw(10) << (feed.storeId.empty() ? "?" : feed.storeId) << std::setw(28) << path
+            << std::right << std::setw(10) << feed.lastSequence << std::setw(10) << feed.eventsApplied
+            << std::setw(6) << feed.gaps << std::setw(6) << feed.badLines << std::setw(8) << feed.resets << "  "
+            << (feed.available ? "ok" : "unavailable") << std::endl;
+    }
+    out << std::string(78, '=') << std::endl;
+}
+
+void HeadOfficeView::displayConsolidated(std::ostream& out, size_t limit) const {
+    std::map<std::string, int> storeUnits;
+    std::map<std::string, double> storeValue;
+    for (const auto& entry : products) {
+        for (const auto& store : entry.second.stores) {
+            storeUnits[store.first] += store.second.stock;
+            storeValue[store.first] += store.second.stock * store.second.sellingPrice;
+        }
+    }
+
+    out << "\n" << std::string(78, '=') << std::endl;
+    out << "                        CONSOLIDATED INVENTORY" << std::endl;
+    out << std::string(78, '=') << std::endl;
+    out << "Products: " << products.size() << " across " << storeUnits.size() << " stores" << std::endl;
+    for (const auto& store : storeUnits) {
+        out << "  " << std::left << std::setw(12) << store.first << std::right << std::setw(10) << store.second
+            << " units  $" << std::fixed << std::setprecision(2) << storeValue[store.first] << std::endl;
+    }
+
+    // Lowest total stock first: what head office needs to move or reorder
+    std::vector<std::pair<int, const std::string*>> order;
+    order.reserve(products.size());
+    for (const auto& entry : products) {
+        order.push_back(std::make_pair(entry.second.getTotalStock(), &entry.first));
+    }
+    size_t shown = std::min(limit, order.size());
+    std::partial_sort(order.begin(), order.begin() + shown, order.end(),
+                      [](const std::pair<int, const std::string*>& a, const std::pair<int, const std::string*>& b) {
+                          return a.first != b.first ? a.first < b.first : *a.second < *b.second;
+                      });
+
+    if (shown > 0) {
+        out << std::string(78, '-') << std::endl;
+        out << std::left << std::setw(12) << "Product" << std::setw(24) << "Name" << std::right << std::setw(8)
+            << "Total" << "  By store" << std::endl;
+    }
+    for (size_t i = 0; i < shown; ++i) {
+        const ConsolidatedProduct& product = products.at(*order[i].second);
+        std::string name = product.name.size() > 22 ? product.name.substr(0, 22) : product.name;
+        out << std::left << std::setw(12) << *order[i].second << std::setw(24) << name << std::right << std::setw(8)
+            << order[i].first << " ";
+        for (const auto& store : product.stores) {
+            out << ' ' << store.first << '=' << store.second.stock;
+        }
+        out << std::endl;
+    }
+    out << std::string(78, '=') << std::endl << std::endl;
+}
@@ -0,0 +1,87 @@
+// ===== HeadOffice.h =====
+#ifndef HEAD_OFFICE_H
+#define HEAD_OFFICE_H
+
+#include "ReplicationLog.h"
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Read position in one store's replication log
+ */
+struct StoreFeed {
+    std::string path;
+    std::string storeId;        // From the log header, empty until first read
+    std::string epoch;
+    std::streamoff offset;      // Bytes consumed, always at a line boundary
+    uint64_t lastSequence;
+    long eventsApplied;
+    long badLines;
+    long gaps;                  // Sequence numbers missing from the log
+    long resets;                // Times the log was replaced and re-read
+    bool available;             // Last poll could open the log
+
+    explicit StoreFeed(const std::string& path = "");
+};
+
+/**
+ * @brief One store's copy of a product in the consolidated view
+ */
+struct StoreStock {
+    int stock;
+    double basePrice;
+    double sellingPrice;
+    uint64_t sequence;          // Event that last changed it
+    std::time_t updated;
+};
+
+/**
+ * @brief A product across every store that stocks it
+ */
+struct ConsolidatedProduct {
+    std::string name;
+    std::string supplier;
+    ProductCategory category;
+    std::map<std::string, StoreStock> stores;
+
+    int getTotalStock() const;
+};
+
+/**
+ * @brief Head office's merged inventory, built by applying each store's log
+ *
+ * Every poll reads only what each log gained since the last one, so a
+ * store that was unreachable for a while is caught up from where it left
+ * off. A checkpoint saves the positions together with the view, so a
+ * restarted head office also resumes incrementally. A log with a new epoch
+ * replaces everything previously applied from that store.
+ */
+class HeadOfficeView {
+private:
+    std::vector<StoreFeed> feeds;
+    std::map<std::string, ConsolidatedProduct> products;
+
+    long pollFeed(StoreFeed& feed);
+    void dropStore(const std::string& storeId);
+    void apply(const std::string& storeId, const ReplicationEvent& event);
+
+public:
+    void addFeed(const std::string& path);
+    long poll();                                       // Events applied across all feeds
+
+    const std::vector<StoreFeed>& getFeeds() const { return feeds; }
+    const std::map<std::string, ConsolidatedProduct>& getProducts() const { return products; }
+    const ConsolidatedProduct* findProduct(const std::string& productId) const;
+
+    bool saveCheckpoint(const std::string& path) const;
+    bool loadCheckpoint(const std::string& path);
+
+    void displayFeeds(std::ostream& out) const;
+    void displayConsolidated(std::ostream& out, size_t limit) const;
+};
+
+#endif // HEAD_OFFICE_H
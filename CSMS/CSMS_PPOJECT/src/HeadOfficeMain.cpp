@@ -0,0 +1,85 @@
+// ===== HeadOfficeMain.cpp =====
+// Head-office consolidation of store inventories.
+//
+// Each store process runs with --replicate <log> --store-id <code> and
+// appends its inventory changes to that log. This process reads the logs,
+// merges them into one view and, with --checkpoint, remembers how far it
+// got so the next run only reads what was appended since.
+
+#include "HeadOffice.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void printUsage() {
+    std::cout << "Usage: headoffice [options] <store log>...\n"
+              << "  --checkpoint FILE  Resume from and save to this checkpoint\n"
+              << "  --follow SECONDS   Keep polling the logs this long (default 0: one pass)\n"
+              << "  --interval MS      Poll interval while following (default 500)\n"
+              << "  --top N            Products listed, lowest total stock first (default 20)\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string checkpointPath;
+    double followSeconds = 0.0;
+    int intervalMs = 500;
+    size_t top = 20;
+    std::vector<std::string> logs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--checkpoint" && hasValue) {
+            checkpointPath = argv[++i];
+        } else if (arg == "--follow" && hasValue) {
+            followSeconds = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--interval" && hasValue) {
+            intervalMs = std::max(10, std::atoi(argv[++i]));
+        } else if (arg == "--top" && hasValue) {
+            top = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (!arg.empty() && arg[0] != '-') {
+            logs.push_back(arg);
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    HeadOfficeView view;
+    if (!checkpointPath.empty() && view.loadCheckpoint(checkpointPath)) {
+        std::cout << "Resumed from " << checkpointPath << " (" << view.getFeeds().size() << " stores, "
+                  << view.getProducts().size() << " products)\n";
+    }
+    for (const std::string& log : logs) {
+        view.addFeed(log);
+    }
+    if (view.getFeeds().empty()) {
+        printUsage();
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    long total = view.poll();
+    std::cout << "Applied " << total << " events\n";
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < followSeconds) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        long applied = view.poll();
+        if (applied > 0) {
+            total += applied;
+            std::cout << "Applied " << applied << " events\n";
+        }
+    }
+
+    view.displayFeeds(std::cout);
+    view.displayConsolidated(std::cout, top);
+
+    if (!checkpointPath.empty() && !view.saveCheckpoint(checkpointPath)) {
+        std::cerr << "Error: cannot write " << checkpointPath << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,289 +1,1283 @@
-// ===== InventoryManager.cpp =====
-#include "InventoryManager.h"
-#include <iostream>
-#include <iomanip>
-#include <algorithm>
-#include <set>
-
-InventoryManager::~InventoryManager() {
-    for (auto& pair : products) {
-        delete pair.second;
-    }
-}
-
-bool InventoryManager::addProduct(Product* product) {
-    if (!product || products.find(product->getId()) != products.end()) {
-        return false;
-    }
-    
-    products[product->getId()] = product;
-    updateCategoryMapping(product);
-    updateSupplierMapping(product);
-    return true;
-}
-
-bool InventoryManager::removeProduct(const std::string& productId) {
-    auto it = products.find(productId);
-    if (it == products.end()) {
-        return false;
-    }
-    
-    Product* product = it->second;
-    removeCategoryMapping(product);
-    removeSupplierMapping(product);
-    
-    delete product;
-    products.erase(it);
-    return true;
-}
-
-Product* InventoryManager::findProduct(const std::string& productId) {
-    auto it = products.find(productId);
-    return (it != products.end()) ? it->second : nullptr;
-}
-
-std::vector<Product*> InventoryManager::findProductsByName(const std::string& name) {
-    std::vector<Product*> result;
-    std::string lowerName = name;
-    std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
-    
-    for (const auto& pair : products) {
-        std::string productName = pair.second->getName();
-        std::transform(productName.begin(), productName.end(), productName.begin(), ::tolower);
-        
-        if (productName.find(lowerName) != std::string::npos) {
-            result.push_back(pair.second);
-        }
-    }
-    
-    return result;
-}
-
-std::vector<Product*> InventoryManager::findProductsByTag(const std::string& tag) {
-    std::vector<Product*> result;
-    
-    for (const auto& pair : products) {
-        if (pair.second->hasTag(tag)) {
-            result.push_back(pair.second);
-        }
-    }
-    
-    return result;
-}
-
-std::vector<Product*> InventoryManager::getProductsByCategory(ProductCategory category) const {
-    auto it = productsByCategory.find(category);
-    return (it != productsByCategory.end()) ? it->second : std::vector<Product*>();
-}
-
-std::vector<Product*> InventoryManager::getProductsBySupplier(const std::string& supplier) const {
-    auto it = productsBySupplier.find(supplier);
-    return (it != productsBySupplier.end()) ? it->second : std::vector<Product*>();
-}
-
-std::vector<std::string> InventoryManager::getAllSuppliers() const {
-    std::vector<std::string> suppliers;
-    for (const auto& pair : productsBySupplier) {
-        suppliers.push_back(pair.first);
-    }
-    return suppliers;
-}
-
-std::vector<Product*> InventoryManager::getLowStockProducts() const {
-    std::vector<Product*> result;
-    
-    for (const auto& pair : products) {
-        if (pair.second->isLowStock() && pair.second->getIsActive()) {
-            result.push_back(pair.second);
-        }
-    }
-    
-    return result;
-}
-
-std::vector<Product*> InventoryManager::getOverstockedProducts() const {
-    std::vector<Product*> result;
-    
-    for (const auto& pair : products) {
-        if (pair.second->isOverstocked() && pair.second->getIsActive()) {
-            result.push_back(pair.second);
-        }
-    }
-    
-    return result;
-}
-
-std::vector<Product*> InventoryManager::getOutOfStockProducts() const {
-    std::vector<Product*> result;
-    
-    for (const auto& pair : products) {
-        if (pair.second->getCurrentStock() == 0 && pair.second->getIsActive()) {
-            result.push_back(pair.second);
-        }
-    }
-    
-    return result;
-}
-
-double InventoryManager::getTotalInventoryValue() const {
-    double total = 0.0;
-    for (const auto& pair : products) {
-        if (pair.second->getIsActive()) {
-            total += pair.second->getTotalInventoryValue();
-        }
-    }
-    return total;
-}
-
-double InventoryManager::getTotalInventoryCost() const {
-    double total = 0.0;
-    for (const auto& pair : products) {
-        if (pair.second->getIsActive()) {
-            total += pair.second->getTotalInventoryCost();
-        }
-    }
-    return total;
-}
-
-double InventoryManager::getTotalPotentialProfit() const {
-    return getTotalInventoryValue() - getTotalInventoryCost();
-}
-
-double InventoryManager::getCategoryValue(ProductCategory category) const {
-    double total = 0.0;
-    auto products = getProductsByCategory(category);
-    
-    for (Product* product : products) {
-        if (product->getIsActive()) {
-            total += product->getTotalInventoryValue();
-        }
-    }
-    
-    return total;
-}
-
-void InventoryManager::generateInventoryReport() const {
-    std::cout << "\n" << std::string(60, '=') << std::endl;
-    std::cout << "                INVENTORY REPORT                " << std::endl;
-    std::cout << std::string(60, '=') << std::endl;
-    
-    std::cout << "Total Products: " << getTotalProductCount() << std::endl;
-    std::cout << "Active Products: " << getActiveProductCount() << std::endl;
-    std::cout << "Total Inventory Value: $" << std::fixed << std::setprecision(2) 
-              << getTotalInventoryValue() << std::endl;
-    std::cout << "Total Inventory Cost: $" << std::fixed << std::setprecision(2) 
-              << getTotalInventoryCost() << std::endl;
-    std::cout << "Potential Profit: $" << std::fixed << std::setprecision(2) 
-              << getTotalPotentialProfit() << std::endl;
-    
-    auto lowStockProducts = getLowStockProducts();
-    auto outOfStockProducts = getOutOfStockProducts();
-    auto overstockedProducts = getOverstockedProducts();
-    
-    std::cout << "\nStock Status:" << std::endl;
-    std::cout << "  Low Stock Items: " << lowStockProducts.size() << std::endl;
-    std::cout << "  Out of Stock Items: " << outOfStockProducts.size() << std::endl;
-    std::cout << "  Overstocked Items: " << overstockedProducts.size() << std::endl;
-    
-    std::cout << std::string(60, '=') << std::endl << std::endl;
-}
-
-void InventoryManager::generateLowStockReport() const {
-    auto lowStockProducts = getLowStockProducts();
-    auto outOfStockProducts = getOutOfStockProducts();
-    
-    std::cout << "\n" << std::string(60, '=') << std::endl;
-    std::cout << "                LOW STOCK REPORT                " << std::endl;
-    std::cout << std::string(60, '=') << std::endl;
-    
-    if (outOfStockProducts.empty() && lowStockProducts.empty()) {
-        std::cout << "  All products are adequately stocked!" << std::endl;
-    } else {
-        if (!outOfStockProducts.empty()) {
-            std::cout << "\n  OUT OF STOCK (" << outOfStockProducts.size() << " items):" << std::endl;
-            for (Product* product : outOfStockProducts) {
-                std::cout << "  " << product->getId() << " - " << product->getName() 
-                          << " (Restock: " << product->getRestockRecommendation() << ")" << std::endl;
-            }
-        }
-        
-        if (!lowStockProducts.empty()) {
-            std::cout << "\n   LOW STOCK (" << lowStockProducts.size() << " items):" << std::endl;
-            for (Product* product : lowStockProducts) {
-                std::cout << "  " << product->getId() << " - " << product->getName() 
-                          << " (Current: " << product->getCurrentStock() 
-                          << ", Min: " << product->getMinStockLevel()
-                          << ", Restock: " << product->getRestockRecommendation() << ")" << std::endl;
-            }
-        }
-    }
-    
-    std::cout << std::string(60, '=') << std::endl << std::endl;
-}
-
-void InventoryManager::updateCategoryMapping(Product* product) {
-    productsByCategory[product->getCategory()].push_back(product);
-}
-
-void InventoryManager::updateSupplierMapping(Product* product) {
-    if (!product->getSupplier().empty()) {
-        productsBySupplier[product->getSupplier()].push_back(product);
-    }
-}
-
-void InventoryManager::removeCategoryMapping(Product* product) {
-    auto& categoryProducts = productsByCategory[product->getCategory()];
-    categoryProducts.erase(std::remove(categoryProducts.begin(), categoryProducts.end(), product), 
-                          categoryProducts.end());
-}
-
-void InventoryManager::removeSupplierMapping(Product* product) {
-    if (!product->getSupplier().empty()) {
-        auto& supplierProducts = productsBySupplier[product->getSupplier()];
-        supplierProducts.erase(std::remove(supplierProducts.begin(), supplierProducts.end(), product), 
-                              supplierProducts.end());
-    }
-}
-
-int InventoryManager::getTotalProductCount() const {
-    return products.size();
-}
-
-int InventoryManager::getActiveProductCount() const {
-    int count = 0;
-    for (const auto& pair : products) {
-        if (pair.second->getIsActive()) {
-            count++;
-        }
-    }
-    return count;
-}
-
-void InventoryManager::displayAllProducts() const {
-    std::cout << "\n" << std::string(60, '=') << std::endl;
-    std::cout << "                ALL PRODUCTS                " << std::endl;
-    std::cout << std::string(60, '=') << std::endl;
-    
-    if (products.empty()) {
-        std::cout << "No products in inventory." << std::endl;
-    } else {
-        for (const auto& pair : products) {
-            const Product* product = pair.second;
-            std::cout << "ID: " << product->getId() 
-                      << " | Name: " << product->getName()
-                      << " | Price: $" << std::fixed << std::setprecision(2) << product->calculateSellingPrice()
-                      << " | Stock: " << product->getCurrentStock()
-                      << " | Category: " << product->categoryToString();
-            
-            if (product->isLowStock()) {
-                std::cout << " [LOW STOCK]";
-            }
-            if (!product->getIsActive()) {
-                std::cout << " [INACTIVE]";
-            }
-            std::cout << std::endl;
-        }
-    }
-    
-    std::cout << std::string(60, '=') << std::endl << std::endl;
-}
+// ===== InventoryManager.cpp =====
+#include "InventoryManager.h"
+#include "LatencyHistogram.h"
+#include "Tracing.h"
+#include "MemoryAccounting.h"
+#include "StorageTables.h"
+#include "ReplicationLog.h"
+#include "PriceBook.h"
+#include "Gtin.h"
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <unordered_set>
+
+static const size_t DEFAULT_RESIDENT_LIMIT = 100000;
+static const size_t STORED_BATCH = 1024;        // Rows decoded at a time by whole-table passes
+
+static double repricedBase(double basePrice, double percentageChange) {
+    return std::round(basePrice * (100.0 + percentageChange)) / 100.0;
+}
+
+InventoryManager::InventoryManager()
+    : storage(nullptr), replication(nullptr), priceBook(nullptr), catalogVersion(0),
+      residentLimit(DEFAULT_RESIDENT_LIMIT), evictions(0) {
+}
+
+InventoryManager::~InventoryManager() {
+    for (auto& pair : products) {
+        delete pair.second;
+    }
+    for (Product* product : retired) {
+        delete product;
+    }
+}
+
+bool InventoryManager::addProduct(Product* product) {
+    if (!product || products.find(product->getId()) != products.end() ||
+        (storage && storage->contains(product->getId()))) {
+        return false;
+    }
+    
+    products[product->getId()] = product;
+    updateCategoryMapping(product);
+    updateSupplierMapping(product);
+    updateBarcodeMapping(product);
+    residentOrder.push_back(product->getId());
+    ++catalogVersion;
+    if (storage) {
+        storage->put(*product);
+    }
+    if (replication) {
+        replication->append(ReplicationEvent(ReplicationEventType::PRODUCT, *product));
+        replication->flush();
+    }
+    return true;
+}
+
+bool InventoryManager::removeProduct(const std::string& productId) {
+    bool stored = storage && storage->erase(productId);
+    if (replication && (stored || products.count(productId))) {
+        ReplicationEvent event;
+        event.type = ReplicationEventType::REMOVE;
+        event.productId = productId;
+        replication->append(event);
+        replication->flush();
+    }
+    auto it = products.find(productId);
+    if (it == products.end()) {
+        return stored;
+    }
+    
+    Product* product = it->second;
+    removeCategoryMapping(product);
+    removeSupplierMapping(product);
+    removeBarcodeMapping(product);
+    
+    // Receipts and refunds still read a product their lines hold
+    if (product->isHeld()) {
+        retired.push_back(product);
+    } else {
+        delete product;
+    }
+    products.erase(it);
+    evictedSlots.erase(productId);
+    ++catalogVersion;
+    return true;
+}
+
+Product* InventoryManager::findProductByBarcode(const std::string& code, BarcodeScan& scan) {
+    if (!Gtin::decode(code, scan)) {
+        return nullptr;
+    }
+    auto it = productsByBarcode.find(scan.lookupKey);
+    if (it != productsByBarcode.end()) {
+        return it->second;
+    }
+    if (!storage) {
+        return nullptr;
+    }
+    std::string productId = storage->idByBarcode(scan.lookupKey);
+    return productId.empty() ? nullptr : loadFromStorage(productId);
+}
+
+bool InventoryManager::setBarcode(const std::string& productId, const std::string& code) {
+    Product* product = findProduct(productId);
+    BarcodeScan scan;
+    if (!product || !Gtin::decode(code, scan)) {
+        return false;
+    }
+    // Loads a stored product holding the code, so the check below sees it
+    Product* holder = findProductByBarcode(code, scan);
+    if (holder && holder != product) {
+        return false;
+    }
+    removeBarcodeMapping(product);
+    product->setBarcode(code);
+    productsByBarcode[scan.lookupKey] = product;
+    if (storage) {
+        storage->put(*product);
+    }
+    return true;
+}
+
+size_t InventoryManager::importBarcodes(const std::vector<std::pair<std::string, std::string>>& rows,
+                                        std::vector<size_t>& rejected) {
+    // Most of a supplier feed is well formed; check digits are verified in one pass first
+    std::vector<std::string> codes;
+    codes.reserve(rows.size());
+    for (const auto& row : rows) {
+        codes.push_back(row.second);
+    }
+    std::vector<uint8_t> valid;
+    Gtin::validateBatch(codes, valid);
+
+    size_t assigned = 0;
+    rejected.clear();
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (valid[i] && setBarcode(rows[i].first, rows[i].second)) {
+            ++assigned;
+        } else {
+            rejected.push_back(i);
+        }
+    }
+    return assigned;
+}
+
+Product* InventoryManager::findProduct(const std::string& productId) {
+    CSMS_TIME_LATENCY(FIND_PRODUCT);
+    CSMS_TRACE_SPAN("lookup", "InventoryManager::findProduct", -1);
+    auto it = products.find(productId);
+    return (it != products.end()) ? it->second : loadFromStorage(productId);
+}
+
+void InventoryManager::attachStorage(ProductTable* table) {
+    storage = table;
+    syncStorage();
+}
+
+void InventoryManager::syncStorage() {
+    if (!storage) {
+        return;
+    }
+    for (const auto& pair : products) {
+        storage->put(*pair.second);
+    }
+}
+
+Product* InventoryManager::loadFromStorage(const std::string& productId) {
+    auto it = products.find(productId);
+    if (it != products.end()) {
+        return it->second;
+    }
+    if (!storage) {
+        return nullptr;
+    }
+    Product* product = storage->load(productId);
+    if (product) {
+        auto slot = evictedSlots.find(productId);
+        if (slot != evictedSlots.end()) {
+            product->setPriceSlot(slot->second);
+            evictedSlots.erase(slot);
+        }
+        products[productId] = product;
+        updateCategoryMapping(product);
+        updateSupplierMapping(product);
+        updateBarcodeMapping(product);
+        residentOrder.push_back(productId);
+        ++catalogVersion;
+    }
+    return product;
+}
+
+void InventoryManager::forEachProduct(const std::function<void(const Product&)>& visit) const {
+    if (!storage) {
+        for (const auto& pair : products) {
+            visit(*pair.second);
+        }
+        return;
+    }
+    // Every resident product is stored; it is visited in place of its row, which may be older
+    std::string next;
+    do {
+        std::vector<Product*> batch;
+        next = storage->loadRange(next, STORED_BATCH, batch);
+        for (Product* stored : batch) {
+            auto it = products.find(stored->getId());
+            visit(it != products.end() ? *it->second : *stored);
+            delete stored;
+        }
+    } while (!next.empty());
+}
+
+void InventoryManager::forEachStored(const std::vector<std::string>& productIds,
+                                     const std::function<void(const Product&)>& visit) const {
+    for (const std::string& id : productIds) {
+        auto it = products.find(id);
+        if (it != products.end()) {
+            visit(*it->second);
+        } else if (Product* stored = storage->load(id)) {
+            visit(*stored);
+            delete stored;
+        }
+    }
+}
+
+std::vector<std::string> InventoryManager::storedIdsNotResident(const ProductCategory* category) const {
+    std::vector<std::string> ids;
+    if (!storage) {
+        return ids;
+    }
+    if (category) {
+        for (std::string& id : storage->idsByCategory(*category, SIZE_MAX)) {
+            if (products.find(id) == products.end()) {
+                ids.push_back(std::move(id));
+            }
+        }
+        return ids;
+    }
+    std::string next;
+    do {
+        std::vector<std::string> page = storage->scanIds(next, "", STORED_BATCH + 1);
+        next = page.size() > STORED_BATCH ? page.back() : std::string();
+        page.resize(std::min(page.size(), STORED_BATCH));
+        for (std::string& id : page) {
+            if (products.find(id) == products.end()) {
+                ids.push_back(std::move(id));
+            }
+        }
+    } while (!next.empty());
+    return ids;
+}
+
+void InventoryManager::repriceStored(std::vector<Product*>& batch, double percentageChange) {
+    // No cart can hold a product that is not resident, so the book has nothing to publish
+    for (Product* stored : batch) {
+        stored->setBasePrice(repricedBase(stored->getBasePrice(), percentageChange));
+        storage->put(*stored);
+        evictedSlots.erase(stored->getId());
+        if (replication) {
+            replication->append(ReplicationEvent(ReplicationEventType::PRICE, *stored));
+        }
+        delete stored;
+    }
+    batch.clear();
+    if (replication) {
+        replication->flush();
+    }
+}
+
+size_t InventoryManager::trimResident() {
+    retired.erase(std::remove_if(retired.begin(), retired.end(), [](Product* product) {
+        if (product->isHeld()) {
+            return false;
+        }
+        delete product;
+        return true;
+    }), retired.end());
+    if (!storage || residentLimit == 0 || products.size() <= residentLimit) {
+        return 0;
+    }
+
+    // Oldest first; reservations are not stored, so products with one stay like held ones
+    std::unordered_set<Product*> victims;
+    size_t excess = products.size() - residentLimit;
+    for (size_t examined = residentOrder.size(); victims.size() < excess && examined > 0; --examined) {
+        std::string id = residentOrder.front();
+        residentOrder.pop_front();
+        auto it = products.find(id);
+        if (it == products.end() || victims.count(it->second)) {
+            continue;
+        }
+        Product* product = it->second;
+        if (product->isHeld() || product->getReservedStock() > 0 || product->getIncomingStock() > 0 ||
+            !storage->put(*product)) {
+            residentOrder.push_back(id);
+            continue;
+        }
+        victims.insert(product);
+    }
+    if (victims.empty()) {
+        return 0;
+    }
+
+    auto evicted = [&victims](Product* product) { return victims.count(product) > 0; };
+    for (auto& pair : productsByCategory) {
+        pair.second.erase(std::remove_if(pair.second.begin(), pair.second.end(), evicted), pair.second.end());
+    }
+    for (auto& pair : productsBySupplier) {
+        pair.second.erase(std::remove_if(pair.second.begin(), pair.second.end(), evicted), pair.second.end());
+    }
+    for (Product* product : victims) {
+        removeBarcodeMapping(product);
+        if (product->getPriceSlot() >= 0) {
+            evictedSlots[product->getId()] = product->getPriceSlot();
+        }
+        products.erase(product->getId());
+        delete product;
+    }
+    if (residentOrder.size() > 2 * products.size()) {
+        residentOrder.clear();
+        for (const auto& pair : products) {
+            residentOrder.push_back(pair.first);
+        }
+    }
+    ++catalogVersion;
+    evictions += static_cast<long>(victims.size());
+    return victims.size();
+}
+
+std::vector<Product*> InventoryManager::loadAllFromStorage(const std::vector<std::string>& productIds) {
+    std::vector<Product*> result;
+    result.reserve(productIds.size());
+    for (const std::string& id : productIds) {
+        if (Product* product = loadFromStorage(id)) {
+            result.push_back(product);
+        }
+    }
+    return result;
+}
+
+std::vector<Product*> InventoryManager::scanStoredProducts(const std::string& fromId, const std::string& toId,
+                                                           size_t limit) {
+    return storage ? loadAllFromStorage(storage->scanIds(fromId, toId, limit)) : std::vector<Product*>();
+}
+
+std::vector<Product*> InventoryManager::findStoredProductsBySupplier(const std::string& supplier, size_t limit) {
+    return storage ? loadAllFromStorage(storage->idsBySupplier(supplier, limit)) : std::vector<Product*>();
+}
+
+std::vector<Product*> InventoryManager::findStoredProductsByCategory(ProductCategory category, size_t limit) {
+    return storage ? loadAllFromStorage(storage->idsByCategory(category, limit)) : std::vector<Product*>();
+}
+
+void InventoryManager::attachReplication(ReplicationLog* log) {
+    replication = log;
+    if (!replication) {
+        return;
+    }
+    forEachProduct([this](const Product& product) {
+        replication->append(ReplicationEvent(ReplicationEventType::PRODUCT, product));
+    });
+    replication->flush();
+}
+
+void InventoryManager::attachPriceBook(PriceBook* book) {
+    if (priceBook) {
+        priceBook->setPromotionListener(nullptr);
+    }
+    priceBook = book;
+    scheduledTargets.clear();
+    if (priceBook) {
+        priceBook->setPromotionListener([this](const ScheduledPriceChange& change) {
+            scheduledPricesPublished(change);
+        });
+    }
+}
+
+void InventoryManager::recordStockChange(const Product& product) {
+    if (replication) {
+        replication->append(ReplicationEvent(ReplicationEventType::STOCK, product));
+        replication->flushSoon();
+    }
+}
+
+void InventoryManager::recordStockChanges(const std::vector<const Product*>& changed) {
+    if (!replication || changed.empty()) {
+        return;
+    }
+    for (const Product* product : changed) {
+        replication->append(ReplicationEvent(ReplicationEventType::STOCK, *product));
+    }
+    replication->flushSoon();
+}
+
+std::vector<Product*> InventoryManager::findProductsByName(const std::string& name) {
+    return query(ProductQuery().where(ProductField::NAME, QueryOp::CONTAINS, name)).rows;
+}
+
+std::vector<Product*> InventoryManager::findProductsByTag(const std::string& tag) {
+    return query(ProductQuery().where(ProductField::TAG, QueryOp::EQ, tag)).rows;
+}
+
+std::vector<Product*> InventoryManager::getProductsByCategory(ProductCategory category) const {
+    auto it = productsByCategory.find(category);
+    return (it != productsByCategory.end()) ? it->second : std::vector<Product*>();
+}
+
+std::vector<Product*> InventoryManager::listProducts(const std::string& afterId, size_t limit) const {
+    std::vector<Product*> page;
+    auto it = afterId.empty() ? products.begin() : products.upper_bound(afterId);
+    for (; it != products.end() && page.size() < limit; ++it) {
+        page.push_back(it->second);
+    }
+    return page;
+}
+
+std::vector<Product*> InventoryManager::getProductsBySupplier(const std::string& supplier) const {
+    auto it = productsBySupplier.find(supplier);
+    return (it != productsBySupplier.end()) ? it->second : std::vector<Product*>();
+}
+
+std::vector<std::string> InventoryManager::getAllSuppliers() const {
+    std::vector<std::string> suppliers;
+    for (const auto& pair : productsBySupplier) {
+        suppliers.push_back(pair.first);
+    }
+    return suppliers;
+}
+
+std::vector<Product*> InventoryManager::getLowStockProducts() {
+    return query(ProductQuery().where(ProductField::ACTIVE, QueryOp::EQ, 1)
+                     .whereField(ProductField::STOCK, QueryOp::LE, ProductField::MIN_STOCK)).rows;
+}
+
+std::vector<Product*> InventoryManager::getOverstockedProducts() {
+    return query(ProductQuery().where(ProductField::ACTIVE, QueryOp::EQ, 1)
+                     .whereField(ProductField::STOCK, QueryOp::GE, ProductField::MAX_STOCK, 0.9)).rows;
+}
+
+std::vector<Product*> InventoryManager::getOutOfStockProducts() {
+    return query(ProductQuery().where(ProductField::ACTIVE, QueryOp::EQ, 1)
+                     .where(ProductField::STOCK, QueryOp::EQ, 0)).rows;
+}
+
+bool InventoryManager::countIndexed(const ProductPredicate& filter, size_t& candidates) const {
+    if (filter.op != QueryOp::EQ || filter.compareField) {
+        return false;
+    }
+    candidates = 0;
+    switch (filter.field) {
+        case ProductField::ID:
+            candidates = filter.values.size();
+            return true;
+        case ProductField::CATEGORY:
+            for (const auto& pair : productsByCategory) {
+                std::string key = ProductQuery::valueKey(Product::categoryName(pair.first));
+                if (std::find(filter.values.begin(), filter.values.end(), key) != filter.values.end()) {
+                    candidates += pair.second.size();
+                }
+            }
+            return true;
+        case ProductField::SUPPLIER:
+            for (const std::string& supplier : std::set<std::string>(filter.values.begin(), filter.values.end())) {
+                auto it = productsBySupplier.find(supplier);
+                candidates += (it != productsBySupplier.end()) ? it->second.size() : 0;
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::vector<Product*> InventoryManager::indexCandidates(const ProductPredicate& filter) const {
+    std::vector<Product*> candidates;
+    if (filter.field == ProductField::ID) {
+        for (const std::string& id : std::set<std::string>(filter.values.begin(), filter.values.end())) {
+            auto it = products.find(id);
+            if (it != products.end()) {
+                candidates.push_back(it->second);
+            }
+        }
+    } else if (filter.field == ProductField::CATEGORY) {
+        for (const auto& pair : productsByCategory) {
+            std::string key = ProductQuery::valueKey(Product::categoryName(pair.first));
+            if (std::find(filter.values.begin(), filter.values.end(), key) != filter.values.end()) {
+                candidates.insert(candidates.end(), pair.second.begin(), pair.second.end());
+            }
+        }
+    } else {
+        for (const std::string& supplier : std::set<std::string>(filter.values.begin(), filter.values.end())) {
+            auto it = productsBySupplier.find(supplier);
+            if (it != productsBySupplier.end()) {
+                candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+    return candidates;
+}
+
+ProductQueryResult InventoryManager::queryStored(const ProductQuery& query) {
+    auto start = std::chrono::steady_clock::now();
+    ProductQueryResult result;
+
+    // The table's own indexes narrow an ID, category or supplier filter; every filter is checked on each row
+    const ProductPredicate* indexed = nullptr;
+    for (const ProductPredicate& filter : query.filters) {
+        if (filter.op == QueryOp::EQ && !filter.compareField &&
+            (filter.field == ProductField::ID || filter.field == ProductField::CATEGORY ||
+             filter.field == ProductField::SUPPLIER) &&
+            (!indexed || filter.field == ProductField::ID)) {
+            indexed = &filter;
+        }
+    }
+
+    std::vector<std::string> matchedIds;
+    auto check = [&](const Product& product) {
+        ++result.scanned;
+        for (const ProductPredicate& filter : query.filters) {
+            if (!filter.matches(product)) {
+                return;
+            }
+        }
+        matchedIds.push_back(product.getId());
+    };
+    if (indexed) {
+        std::set<std::string> ids;
+        for (const std::string& value : indexed->values) {
+            if (indexed->field == ProductField::ID) {
+                ids.insert(value);
+            } else if (indexed->field == ProductField::SUPPLIER) {
+                for (const std::string& id : storage->idsBySupplier(value, SIZE_MAX)) {
+                    ids.insert(id);
+                }
+            } else {
+                for (int c = 0; c <= static_cast<int>(ProductCategory::OTHER); ++c) {
+                    ProductCategory category = static_cast<ProductCategory>(c);
+                    if (ProductQuery::valueKey(Product::categoryName(category)) == value) {
+                        for (const std::string& id : storage->idsByCategory(category, SIZE_MAX)) {
+                            ids.insert(id);
+                        }
+                    }
+                }
+            }
+        }
+        forEachStored(std::vector<std::string>(ids.begin(), ids.end()), check);
+        result.plan = "stored index on " + ProductQuery::fieldName(indexed->field);
+    } else {
+        forEachProduct(check);
+        result.plan = "stored scan";
+    }
+    if (!query.filters.empty()) {
+        result.plan += ", " + std::to_string(query.filters.size()) + " row filter" +
+                       (query.filters.size() == 1 ? "" : "s");
+    }
+
+    result.rows = loadAllFromStorage(matchedIds);
+    result.matched = result.rows.size();
+    query.order(result.rows);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+ProductQueryResult InventoryManager::query(const ProductQuery& query) {
+    // An index candidate costs a pointer chase and virtual calls, some 20-40
+    // times a column compare; an index wins below 1/64 of the rows
+    static const size_t INDEX_SELECTIVITY = 64;
+
+    // Resident products are all stored; with rows beyond them the table is queried instead
+    if (storage && static_cast<size_t>(storage->getRowCount()) > products.size()) {
+        return queryStored(query);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ProductQueryResult result;
+
+    const ProductPredicate* indexed = nullptr;
+    size_t fewest = products.size() + 1;
+    for (const ProductPredicate& filter : query.filters) {
+        size_t candidates;
+        if (countIndexed(filter, candidates) && candidates < fewest) {
+            indexed = &filter;
+            fewest = candidates;
+        }
+    }
+
+    std::vector<Product*> rows;
+    std::vector<uint32_t> selected;           // Column row numbers of rows, on the column path
+    bool fromColumns = false;
+    std::vector<const ProductPredicate*> rowFilters;
+    bool useIndex = indexed && fewest * INDEX_SELECTIVITY <= products.size();
+    if (useIndex) {
+        rows = indexCandidates(*indexed);
+        for (const ProductPredicate& filter : query.filters) {
+            if (&filter != indexed) {
+                rowFilters.push_back(&filter);
+            }
+        }
+        result.plan = "index on " + ProductQuery::fieldName(indexed->field);
+    } else {
+        std::vector<const ProductPredicate*> columnFilters;
+        for (const ProductPredicate& filter : query.filters) {
+            (columns.canScan(filter) ? columnFilters : rowFilters).push_back(&filter);
+        }
+        if (columnFilters.empty() && !columns.isCurrent(catalogVersion)) {
+            // Not worth a rebuild just to list the rows
+            rows.reserve(products.size());
+            for (const auto& pair : products) {
+                rows.push_back(pair.second);
+            }
+        } else {
+            if (!columns.isCurrent(catalogVersion)) {
+                columns.rebuild(products, catalogVersion);
+            }
+            columns.scan(columnFilters, selected);
+            rows.reserve(selected.size());
+            for (uint32_t row : selected) {
+                rows.push_back(columns.getRow(row));
+            }
+            fromColumns = true;
+        }
+        result.plan = columnFilters.empty() ? std::string("full scan")
+                                            : "column scan, " + std::to_string(columnFilters.size()) +
+                                                  " column filter" + (columnFilters.size() == 1 ? "" : "s");
+    }
+    result.scanned = static_cast<long>(useIndex ? rows.size() : products.size());
+
+    if (!rowFilters.empty()) {
+        result.plan += ", " + std::to_string(rowFilters.size()) + " row filter" +
+                       (rowFilters.size() == 1 ? "" : "s") + " on " + std::to_string(rows.size()) + " rows";
+        size_t kept = 0;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            bool match = true;
+            for (size_t f = 0; match && f < rowFilters.size(); ++f) {
+                match = rowFilters[f]->matches(*rows[i]);
+            }
+            if (match) {
+                rows[kept] = rows[i];
+                if (fromColumns) {
+                    selected[kept] = selected[i];
+                }
+                ++kept;
+            }
+        }
+        rows.resize(kept);
+        selected.resize(fromColumns ? kept : 0);
+    }
+    result.matched = rows.size();
+
+    // Sort keys the columns hold are read from them rather than from each product
+    const std::vector<double>* sortColumn = (fromColumns && query.sorted) ? columns.getColumn(query.sortField)
+                                                                          : nullptr;
+    if (sortColumn) {
+        std::vector<double> keys;
+        keys.reserve(selected.size());
+        for (uint32_t row : selected) {
+            keys.push_back((*sortColumn)[row]);
+        }
+        query.order(rows, keys);
+    } else {
+        query.order(rows);
+    }
+    result.rows.swap(rows);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+double InventoryManager::getTotalInventoryValue() const {
+    double total = 0.0;
+    forEachProduct([&total](const Product& product) {
+        if (product.getIsActive()) {
+            total += product.getTotalInventoryValue();
+        }
+    });
+    return total;
+}
+
+double InventoryManager::getTotalInventoryCost() const {
+    double total = 0.0;
+    forEachProduct([&total](const Product& product) {
+        if (product.getIsActive()) {
+            total += product.getTotalInventoryCost();
+        }
+    });
+    return total;
+}
+
+double InventoryManager::getTotalPotentialProfit() const {
+    return getTotalInventoryValue() - getTotalInventoryCost();
+}
+
+double InventoryManager::getCategoryValue(ProductCategory category) const {
+    double total = 0.0;
+    auto add = [&total](const Product& product) {
+        if (product.getIsActive()) {
+            total += product.getTotalInventoryValue();
+        }
+    };
+    if (storage) {
+        forEachStored(storage->idsByCategory(category, SIZE_MAX), add);
+    } else {
+        for (const Product* product : getProductsByCategory(category)) {
+            add(*product);
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Stock status of one product, as the low-stock and overstock queries define it
+ */
+struct StockStatus {
+    bool low;
+    bool out;
+    bool over;
+
+    explicit StockStatus(const Product& product)
+        : low(product.getIsActive() && product.getCurrentStock() <= product.getMinStockLevel()),
+          out(product.getIsActive() && product.getCurrentStock() == 0),
+          over(product.getIsActive() && product.getCurrentStock() >= product.getMaxStockLevel() * 0.9) {}
+};
+
+void InventoryManager::generateInventoryReport() const {
+    CSMS_TIME_LATENCY(INVENTORY_REPORT);
+    // One pass over the catalogue, resident or stored
+    int total = 0;
+    int active = 0;
+    double value = 0.0;
+    double cost = 0.0;
+    int lowStock = 0;
+    int outOfStock = 0;
+    int overstocked = 0;
+    forEachProduct([&](const Product& product) {
+        ++total;
+        if (product.getIsActive()) {
+            ++active;
+            value += product.getTotalInventoryValue();
+            cost += product.getTotalInventoryCost();
+        }
+        StockStatus status(product);
+        lowStock += status.low;
+        outOfStock += status.out;
+        overstocked += status.over;
+    });
+
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "                INVENTORY REPORT                " << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    std::cout << "Total Products: " << total << std::endl;
+    std::cout << "Active Products: " << active << std::endl;
+    std::cout << "Total Inventory Value: $" << std::fixed << std::setprecision(2) 
+              << value << std::endl;
+    std::cout << "Total Inventory Cost: $" << std::fixed << std::setprecision(2) 
+              << cost << std::endl;
+    std::cout << "Potential Profit: $" << std::fixed << std::setprecision(2) 
+              << value - cost << std::endl;
+    
+    std::cout << "\nStock Status:" << std::endl;
+    std::cout << "  Low Stock Items: " << lowStock << std::endl;
+    std::cout << "  Out of Stock Items: " << outOfStock << std::endl;
+    std::cout << "  Overstocked Items: " << overstocked << std::endl;
+    
+    std::cout << std::string(60, '=') << std::endl << std::endl;
+}
+
+void InventoryManager::generateLowStockReport() const {
+    CSMS_TIME_LATENCY(LOW_STOCK_REPORT);
+    std::vector<std::string> lowStockLines;
+    std::vector<std::string> outOfStockLines;
+    forEachProduct([&](const Product& product) {
+        StockStatus status(product);
+        if (status.out) {
+            outOfStockLines.push_back(product.getId() + " - " + product.getName() + " (Restock: " +
+                                      std::to_string(product.getRestockRecommendation()) + ")");
+        }
+        if (status.low) {
+            lowStockLines.push_back(product.getId() + " - " + product.getName() + " (Current: " +
+                                    std::to_string(product.getCurrentStock()) + ", Min: " +
+                                    std::to_string(product.getMinStockLevel()) + ", Restock: " +
+                                    std::to_string(product.getRestockRecommendation()) + ")");
+        }
+    });
+    
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "                LOW STOCK REPORT                " << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    if (outOfStockLines.empty() && lowStockLines.empty()) {
+        std::cout << "  All products are adequately stocked!" << std::endl;
+    } else {
+        if (!outOfStockLines.empty()) {
+            std::cout << "\n  OUT OF STOCK (" << outOfStockLines.size() << " items):" << std::endl;
+            for (const std::string& line : outOfStockLines) {
+                std::cout << "  " << line << std::endl;
+            }
+        }
+        
+        if (!lowStockLines.empty()) {
+            std::cout << "\n   LOW STOCK (" << lowStockLines.size() << " items):" << std::endl;
+            for (const std::string& line : lowStockLines) {
+                std::cout << "  " << line << std::endl;
+            }
+        }
+    }
+    
+    std::cout << std::string(60, '=') << std::endl << std::endl;
+}
+
+/**
+ * @brief Per-category or per-supplier totals gathered in one catalogue pass
+ */
+struct GroupTotals {
+    int products;
+    int active;
+    long units;
+    double value;
+    double cost;
+    int lowStock;
+
+    GroupTotals() : products(0), active(0), units(0), value(0.0), cost(0.0), lowStock(0) {}
+
+    void add(const Product& product) {
+        ++products;
+        if (product.getIsActive()) {
+            ++active;
+            units += product.getCurrentStock();
+            value += product.getTotalInventoryValue();
+            cost += product.getTotalInventoryCost();
+            lowStock += product.isLowStock();
+        }
+    }
+};
+
+void InventoryManager::generateCategoryReport() const {
+    CSMS_TIME_LATENCY(CATEGORY_REPORT);
+    std::map<ProductCategory, GroupTotals> categories;
+    forEachProduct([&categories](const Product& product) {
+        categories[product.getCategory()].add(product);
+    });
+
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "                CATEGORY REPORT                " << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    for (const auto& pair : categories) {
+        const GroupTotals& totals = pair.second;
+        std::cout << Product::categoryName(pair.first) << ":" << std::endl;
+        std::cout << "  Products: " << totals.products << " (" << totals.active << " active)" << std::endl;
+        std::cout << "  Units in Stock: " << totals.units << std::endl;
+        std::cout << "  Inventory Value: $" << std::fixed << std::setprecision(2) 
+                  << totals.value << std::endl;
+        std::cout << "  Low Stock Items: " << totals.lowStock << std::endl;
+    }
+    
+    std::cout << std::string(60, '=') << std::endl << std::endl;
+}
+
+void InventoryManager::generateSupplierReport() const {
+    CSMS_TIME_LATENCY(SUPPLIER_REPORT);
+    std::map<std::string, GroupTotals> suppliers;
+    forEachProduct([&suppliers](const Product& product) {
+        if (!product.getSupplier().empty()) {
+            suppliers[product.getSupplier()].add(product);
+        }
+    });
+
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "                SUPPLIER REPORT                " << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    if (suppliers.empty()) {
+        std::cout << "No suppliers on record." << std::endl;
+    }
+    
+    for (const auto& pair : suppliers) {
+        const GroupTotals& totals = pair.second;
+        std::cout << pair.first << ": " << totals.products << " products"
+                  << " | Value: $" << std::fixed << std::setprecision(2) << totals.value
+                  << " | Cost: $" << std::fixed << std::setprecision(2) << totals.cost
+                  << " | Low Stock: " << totals.lowStock << std::endl;
+    }
+    
+    std::cout << std::string(60, '=') << std::endl << std::endl;
+}
+
+/**
+ * @brief What the profitability report ranks, copied so stored products need not stay loaded
+ */
+struct ProfitLine {
+    std::string id;
+    std::string name;
+    double profit;
+    double margin;
+};
+
+void InventoryManager::generateProfitabilityReport() const {
+    CSMS_TIME_LATENCY(PROFITABILITY_REPORT);
+    std::vector<ProfitLine> active;
+    double totalProfit = 0.0;
+    forEachProduct([&](const Product& product) {
+        if (product.getIsActive()) {
+            ProfitLine line;
+            line.id = product.getId();
+            line.name = product.getName();
+            line.profit = product.getTotalInventoryValue() - product.getTotalInventoryCost();
+            line.margin = product.calculateProfitMargin();
+            totalProfit += line.profit;
+            active.push_back(line);
+        }
+    });
+    
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "              PROFITABILITY REPORT              " << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    std::cout << "Potential Profit: $" << std::fixed << std::setprecision(2) 
+              << totalProfit << std::endl;
+    
+    size_t shown = std::min<size_t>(10, active.size());
+    std::partial_sort(active.begin(), active.begin() + shown, active.end(),
+                      [](const ProfitLine& a, const ProfitLine& b) { return a.profit > b.profit; });
+    std::cout << "\nTop " << shown << " Products by Potential Profit:" << std::endl;
+    for (size_t i = 0; i < shown; ++i) {
+        const ProfitLine& line = active[i];
+        std::cout << "  " << line.id << " - " << line.name
+                  << " | Profit: $" << std::fixed << std::setprecision(2) << line.profit
+                  << " | Margin: " << std::fixed << std::setprecision(1)
+                  << line.margin << "%" << std::endl;
+    }
+    
+    std::partial_sort(active.begin(), active.begin() + shown, active.end(),
+                      [](const ProfitLine& a, const ProfitLine& b) { return a.margin < b.margin; });
+    std::cout << "\nLowest " << shown << " Margins:" << std::endl;
+    for (size_t i = 0; i < shown; ++i) {
+        const ProfitLine& line = active[i];
+        std::cout << "  " << line.id << " - " << line.name
+                  << " | Margin: " << std::fixed << std::setprecision(1)
+                  << line.margin << "%" << std::endl;
+    }
+    
+    std::cout << std::string(60, '=') << std::endl << std::endl;
+}
+
+bool InventoryManager::updatePrice(const std::string& productId, double basePrice) {
+    Product* product = findProduct(productId);
+    if (!product || basePrice < 0) {
+        return false;
+    }
+    product->setBasePrice(basePrice);
+    ++catalogVersion;
+    if (priceBook && product->getPriceSlot() >= 0) {
+        priceBook->publish(priceBook->draftPrice(product, product->calculateSellingPrice()));
+    }
+    if (replication) {
+        replication->append(ReplicationEvent(ReplicationEventType::PRICE, *product));
+        replication->flush();
+    }
+    return true;
+}
+
+void InventoryManager::repriceProducts(const std::vector<Product*>& targets, double percentageChange) {
+    // Products are the source of every price; the book then publishes them in one
+    // version. Products it does not price yet join first at their old price, so
+    // carts see the whole change or none of it.
+    if (priceBook) {
+        priceBook->registerProducts(targets);
+    }
+    applyBasePrices(targets, percentageChange);
+    if (priceBook) {
+        priceBook->publish(priceBook->draftSellingPrices(targets));
+    }
+}
+
+void InventoryManager::applyBasePrices(const std::vector<Product*>& targets, double percentageChange) {
+    ++catalogVersion;
+    for (Product* product : targets) {
+        product->setBasePrice(repricedBase(product->getBasePrice(), percentageChange));
+        if (replication) {
+            replication->append(ReplicationEvent(ReplicationEventType::PRICE, *product));
+        }
+    }
+    if (replication) {
+        replication->flush();
+    }
+}
+
+void InventoryManager::updateAllPrices(double percentageChange) {
+    std::vector<Product*> targets;
+    targets.reserve(products.size());
+    for (const auto& pair : products) {
+        targets.push_back(pair.second);
+    }
+    repriceProducts(targets, percentageChange);
+    if (!storage) {
+        return;
+    }
+    // The rest of the table is repriced in place a batch at a time
+    std::string next;
+    do {
+        std::vector<Product*> batch;
+        next = storage->loadRange(next, STORED_BATCH, batch);
+        batch.erase(std::remove_if(batch.begin(), batch.end(), [this](Product* stored) {
+            if (products.find(stored->getId()) == products.end()) {
+                return false;
+            }
+            delete stored;
+            return true;
+        }), batch.end());
+        repriceStored(batch, percentageChange);
+    } while (!next.empty());
+}
+
+void InventoryManager::updateCategoryPrices(ProductCategory category, double percentageChange) {
+    auto it = productsByCategory.find(category);
+    if (it != productsByCategory.end()) {
+        repriceProducts(it->second, percentageChange);
+    }
+    std::vector<Product*> batch;
+    for (const std::string& id : storedIdsNotResident(&category)) {
+        if (Product* stored = storage->load(id)) {
+            batch.push_back(stored);
+        }
+        if (batch.size() == STORED_BATCH) {
+            repriceStored(batch, percentageChange);
+        }
+    }
+    if (!batch.empty()) {
+        repriceStored(batch, percentageChange);
+    }
+}
+
+uint64_t InventoryManager::schedulePrices(const std::vector<Product*>& targets, double percentageChange,
+                                          std::time_t effectiveAt, const ProductCategory* category) {
+    // The book reprices resident products; stored ones are repriced on disk when the change comes due
+    uint64_t scheduleId = priceBook->schedulePercentChange(targets, percentageChange, effectiveAt);
+    std::vector<std::string>& ids = scheduledTargets[scheduleId];
+    ids = storedIdsNotResident(category);
+    ids.reserve(ids.size() + targets.size());
+    for (const Product* product : targets) {
+        ids.push_back(product->getId());
+    }
+    return scheduleId;
+}
+
+uint64_t InventoryManager::scheduleAllPrices(double percentageChange, std::time_t effectiveAt) {
+    if (!priceBook) {
+        return 0;
+    }
+    std::vector<Product*> targets;
+    targets.reserve(products.size());
+    for (const auto& pair : products) {
+        targets.push_back(pair.second);
+    }
+    return schedulePrices(targets, percentageChange, effectiveAt, nullptr);
+}
+
+uint64_t InventoryManager::scheduleCategoryPrices(ProductCategory category, double percentageChange,
+                                                  std::time_t effectiveAt) {
+    if (!priceBook) {
+        return 0;
+    }
+    return schedulePrices(getProductsByCategory(category), percentageChange, effectiveAt, &category);
+}
+
+bool InventoryManager::cancelScheduledPrices(uint64_t scheduleId) {
+    if (!priceBook || !priceBook->cancelScheduled(scheduleId)) {
+        return false;
+    }
+    scheduledTargets.erase(scheduleId);
+    return true;
+}
+
+void InventoryManager::scheduledPricesPublished(const ScheduledPriceChange& change) {
+    auto it = scheduledTargets.find(change.id);
+    if (it == scheduledTargets.end()) {
+        return;
+    }
+    // The book has already repriced resident products; products removed since scheduling are skipped
+    std::vector<Product*> targets;
+    std::vector<Product*> stored;
+    targets.reserve(it->second.size());
+    for (const std::string& id : it->second) {
+        auto product = products.find(id);
+        if (product != products.end()) {
+            targets.push_back(product->second);
+        } else if (Product* row = storage ? storage->load(id) : nullptr) {
+            stored.push_back(row);
+            if (stored.size() == STORED_BATCH) {
+                repriceStored(stored, change.percentageChange);
+            }
+        }
+    }
+    scheduledTargets.erase(it);
+    applyBasePrices(targets, change.percentageChange);
+    if (!stored.empty()) {
+        repriceStored(stored, change.percentageChange);
+    }
+
+    // The book repriced from its own prices; where a product's price differs
+    // from that (a markdown, say), the product's price wins
+    PriceVersionPtr version = priceBook->getCurrent();
+    std::vector<Product*> drifted;
+    for (Product* product : targets) {
+        if (version->priceOf(*product) != product->calculateSellingPrice()) {
+            drifted.push_back(product);
+        }
+    }
+    if (!drifted.empty()) {
+        priceBook->publish(priceBook->draftSellingPrices(drifted));
+    }
+}
+
+std::vector<const Product*> InventoryManager::getPriceMismatches() const {
+    std::vector<const Product*> mismatched;
+    if (!priceBook) {
+        return mismatched;
+    }
+    PriceVersionPtr version = priceBook->getCurrent();
+    for (const auto& pair : products) {
+        if (version->priceOf(*pair.second) != pair.second->calculateSellingPrice()) {
+            mismatched.push_back(pair.second);
+        }
+    }
+    return mismatched;
+}
+
+void InventoryManager::updateCategoryMapping(Product* product) {
+    productsByCategory[product->getCategory()].push_back(product);
+}
+
+void InventoryManager::updateSupplierMapping(Product* product) {
+    if (!product->getSupplier().empty()) {
+        productsBySupplier[product->getSupplier()].push_back(product);
+    }
+}
+
+void InventoryManager::updateBarcodeMapping(Product* product) {
+    // Placeholder barcodes are not GTINs and stay unindexed; the first product keeps a shared code
+    BarcodeScan scan;
+    if (Gtin::decode(product->getBarcode(), scan)) {
+        productsByBarcode.insert(std::make_pair(scan.lookupKey, product));
+    }
+}
+
+void InventoryManager::removeBarcodeMapping(Product* product) {
+    BarcodeScan scan;
+    if (Gtin::decode(product->getBarcode(), scan)) {
+        auto it = productsByBarcode.find(scan.lookupKey);
+        if (it != productsByBarcode.end() && it->second == product) {
+            productsByBarcode.erase(it);
+        }
+    }
+}
+
+void InventoryManager::removeCategoryMapping(Product* product) {
+    auto& categoryProducts = productsByCategory[product->getCategory()];
+    categoryProducts.erase(std::remove(categoryProducts.begin(), categoryProducts.end(), product), 
+                          categoryProducts.end());
+}
+
+void InventoryManager::removeSupplierMapping(Product* product) {
+    if (!product->getSupplier().empty()) {
+        auto& supplierProducts = productsBySupplier[product->getSupplier()];
+        supplierProducts.erase(std::remove(supplierProducts.begin(), supplierProducts.end(), product), 
+                              supplierProducts.end());
+    }
+}
+
+int InventoryManager::getTotalProductCount() const {
+    return storage ? static_cast<int>(storage->getRowCount()) : static_cast<int>(products.size());
+}
+
+int InventoryManager::getActiveProductCount() const {
+    int count = 0;
+    forEachProduct([&count](const Product& product) {
+        if (product.getIsActive()) {
+            count++;
+        }
+    });
+    return count;
+}
+
+std::vector<Product*> InventoryManager::searchProducts(const std::string& searchTerm) {
+    std::vector<std::string> found;
+    std::string term = searchTerm;
+    std::transform(term.begin(), term.end(), term.begin(), ::tolower);
+    
+    auto matches = [&term](std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+        return text.find(term) != std::string::npos;
+    };
+    
+    // Matches ID, name, supplier or any tag, case-insensitively
+    forEachProduct([&](const Product& product) {
+        bool match = matches(product.getId()) || matches(product.getName()) ||
+                     matches(product.getSupplier());
+        for (size_t i = 0; !match && i < product.getTags().size(); ++i) {
+            match = matches(product.getTags()[i]);
+        }
+        if (match) {
+            found.push_back(product.getId());
+        }
+    });
+    
+    return loadAllFromStorage(found);
+}
+
+void InventoryManager::displayAllProducts() const {
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "                ALL PRODUCTS                " << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    bool any = false;
+    forEachProduct([&any](const Product& product) {
+        any = true;
+        std::cout << "ID: " << product.getId() 
+                  << " | Name: " << product.getName()
+                  << " | Price: $" << std::fixed << std::setprecision(2) << product.calculateSellingPrice()
+                  << " | Stock: " << product.getCurrentStock()
+                  << " | Category: " << product.categoryToString();
+        
+        if (product.isLowStock()) {
+            std::cout << " [LOW STOCK]";
+        }
+        if (!product.getIsActive()) {
+            std::cout << " [INACTIVE]";
+        }
+        std::cout << std::endl;
+    });
+    if (!any) {
+        std::cout << "No products in inventory." << std::endl;
+    }
+    
+    std::cout << std::string(60, '=') << std::endl << std::endl;
+}
+
+void InventoryManager::accountMemory(MemoryReport& report) const {
+    long count = static_cast<long>(products.size());
+    size_t objectBytes = 0;
+    size_t stringBytes = 0;
+    size_t tagBytes = 0;
+    long tagCount = 0;
+    size_t keyBytes = 0;
+    
+    for (const auto& pair : products) {
+        objectBytes += pair.second->getObjectBytes();
+        stringBytes += pair.second->getStringBytes();
+        tagBytes += pair.second->getTagBytes();
+        tagCount += static_cast<long>(pair.second->getTags().size());
+        keyBytes += MemorySizing::stringBytes(pair.first);
+    }
+    
+    report.add("Inventory", "Product objects", count, objectBytes);
+    report.add("Inventory", "Product strings", count, stringBytes);
+    report.add("Inventory", "Product tags", tagCount, tagBytes);
+    report.add("Inventory", "products index (by ID)", count,
+               count * MemorySizing::mapNodeBytes<std::string, Product*>() + keyBytes);
+    
+    size_t categoryBytes = productsByCategory.size() *
+                           MemorySizing::mapNodeBytes<ProductCategory, std::vector<Product*>>();
+    long categoryEntries = 0;
+    for (const auto& pair : productsByCategory) {
+        categoryBytes += MemorySizing::vectorBytes(pair.second);
+        categoryEntries += static_cast<long>(pair.second.size());
+    }
+    report.add("Inventory", "productsByCategory index", categoryEntries, categoryBytes);
+    
+    size_t supplierBytes = productsBySupplier.size() *
+                           MemorySizing::mapNodeBytes<std::string, std::vector<Product*>>();
+    long supplierEntries = 0;
+    for (const auto& pair : productsBySupplier) {
+        supplierBytes += MemorySizing::stringBytes(pair.first) + MemorySizing::vectorBytes(pair.second);
+        supplierEntries += static_cast<long>(pair.second.size());
+    }
+    report.add("Inventory", "productsBySupplier index", supplierEntries, supplierBytes);
+    report.add("Inventory", "productsByBarcode index", static_cast<long>(productsByBarcode.size()),
+               productsByBarcode.size() * MemorySizing::hashNodeBytes<uint64_t, Product*>() +
+               MemorySizing::hashBucketBytes(productsByBarcode.bucket_count()));
+    report.add("Inventory", "Query columns", static_cast<long>(columns.size()), columns.getAllocatedBytes());
+}
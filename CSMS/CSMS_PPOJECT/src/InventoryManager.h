@@ -1,74 +1,203 @@
-// ===== InventoryManager.h =====
-#ifndef INVENTORY_MANAGER_H
-#define INVENTORY_MANAGER_H
-
-#include "Product.h"
-#include <map>
-#include <vector>
-#include <string>
-
-/**
- * @brief Advanced inventory management system
- */
-class InventoryManager {
-private:
-    std::map<std::string, Product*> products;
-    std::map<ProductCategory, std::vector<Product*>> productsByCategory;
-    std::map<std::string, std::vector<Product*>> productsBySupplier;
-    
-public:
-    ~InventoryManager();
-    
-    // Product management
-    bool addProduct(Product* product);
-    bool removeProduct(const std::string& productId);
-    Product* findProduct(const std::string& productId);
-    std::vector<Product*> findProductsByName(const std::string& name);
-    std::vector<Product*> findProductsByTag(const std::string& tag);
-    
-    // Category and supplier management
-    std::vector<Product*> getProductsByCategory(ProductCategory category) const; 
-    std::vector<Product*> getProductsBySupplier(const std::string& supplier) const;
-    std::vector<std::string> getAllSuppliers() const;
-    
-    // Stock management
-    std::vector<Product*> getLowStockProducts() const;
-    std::vector<Product*> getOverstockedProducts() const;
-    std::vector<Product*> getOutOfStockProducts() const;
-    
-    // Financial calculations
-    double getTotalInventoryValue() const;
-    double getTotalInventoryCost() const;
-    double getTotalPotentialProfit() const;
-    double getCategoryValue(ProductCategory category) const;
-    
-    // Reports and analytics
-    void generateInventoryReport() const;
-    void generateLowStockReport() const;
-    void generateCategoryReport() const;
-    void generateSupplierReport() const;
-    void generateProfitabilityReport() const;
-    
-    // Bulk operations
-    void updateAllPrices(double percentageChange);
-    void updateCategoryPrices(ProductCategory category, double percentageChange);
-    void deactivateExpiredProducts();
-    
-    // Display methods
-    void displayAllProducts() const;
-    void displayProductsByCategory(ProductCategory category) const;
-    void displayLowStockAlert() const;
-    
-    // Utility methods
-    int getTotalProductCount() const;
-    int getActiveProductCount() const;
-    std::vector<Product*> searchProducts(const std::string& searchTerm) const;
-    
-private:
-    void updateCategoryMapping(Product* product);
-    void updateSupplierMapping(Product* product);
-    void removeCategoryMapping(Product* product);
-    void removeSupplierMapping(Product* product);
-};
-
+// ===== InventoryManager.h =====
+#ifndef INVENTORY_MANAGER_H
+#define INVENTORY_MANAGER_H
+
+#include "Product.h"
+#include "ProductQuery.h"
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <string>
+
+class MemoryReport;
+class ProductTable;
+class ReplicationLog;
+class PriceBook;
+struct ScheduledPriceChange;
+struct BarcodeScan;
+
+/**
+ * @brief Advanced inventory management system
+ *
+ * Products live in memory. With a ProductTable attached they are also
+ * written to disk, and a lookup that misses in memory loads the product
+ * from the table, so the catalogue can be far larger than what is
+ * resident. Reports, query(), bulk and scheduled reprices and the
+ * replication snapshot cover the whole table: they read stored rows a
+ * batch at a time and only what query() returns becomes resident.
+ *
+ * trimResident() evicts the longest-resident products beyond the
+ * resident limit, writing each back first. Transaction lines hold their
+ * product (Product::hold), and products with transfer reservations are
+ * skipped too, so nothing a cart, receipt or refund points at is freed.
+ * Any other Product* returned by a lookup is good until the next trim;
+ * single-threaded drivers trim between commands, and servers whose lanes
+ * hold pointers across requests never trim. A product removed while held
+ * is kept until it is released.
+ *
+ * With a ReplicationLog attached, the inventory is one shard of a chain:
+ * product, stock and price changes are appended to the log for head
+ * office. Stock changes made directly on a Product are published through
+ * recordStockChange().
+ *
+ * With a PriceBook attached, price changes are published to it as one
+ * version each, so open carts never see a bulk change half-applied. The
+ * product's own price is the one the book publishes, so carts, reports and
+ * queries agree; getPriceMismatches() lists any product where they do not.
+ * Scheduled changes are published by the book when they come due; base
+ * prices, storage and replication follow in the same pass as an immediate
+ * change.
+ *
+ * Resident products with a valid GTIN are indexed by it; variable-measure
+ * products by their item reference, so any weight or price label finds
+ * them in one lookup. A scan that misses falls back to the table's
+ * barcode index and loads the product, as a lookup by ID does.
+ *
+ * query() answers composed filters over resident products. A filter on an
+ * ID, category or supplier that leaves few candidates is answered from
+ * that index; broader queries scan columns copied from the products,
+ * rebuilt after the catalogue changes. Attribute changes therefore go
+ * through this class, as they already do for storage and replication.
+ */
+class InventoryManager {
+private:
+    std::map<std::string, Product*> products;   // Resident products
+    std::map<ProductCategory, std::vector<Product*>> productsByCategory;
+    std::map<std::string, std::vector<Product*>> productsBySupplier;
+    std::unordered_map<uint64_t, Product*> productsByBarcode;   // BarcodeScan::lookupKey
+    ProductTable* storage;                      // Optional on-disk table, not owned
+    ReplicationLog* replication;                // Optional change log, not owned
+    PriceBook* priceBook;                       // Optional shelf prices for carts, not owned
+    std::map<uint64_t, std::vector<std::string>> scheduledTargets;   // Schedule ID -> product IDs
+    uint64_t catalogVersion;                    // Moves on with every change the query columns copy
+    mutable ProductColumns columns;             // Rebuilt by query() when catalogVersion has moved on
+    size_t residentLimit;                       // Products trimResident() keeps; 0 keeps everything
+    std::deque<std::string> residentOrder;      // Resident IDs, oldest first; may hold stale IDs
+    std::unordered_map<std::string, int> evictedSlots;   // Price slots of evicted products, restored on load
+    std::vector<Product*> retired;              // Removed while held; freed once released
+    long evictions;
+    
+    Product* loadFromStorage(const std::string& productId);
+    std::vector<Product*> loadAllFromStorage(const std::vector<std::string>& productIds);
+    void forEachProduct(const std::function<void(const Product&)>& visit) const;
+    void forEachStored(const std::vector<std::string>& productIds,
+                       const std::function<void(const Product&)>& visit) const;
+    void repriceStored(std::vector<Product*>& batch, double percentageChange);   // Frees the batch
+    std::vector<std::string> storedIdsNotResident(const ProductCategory* category) const;
+    bool countIndexed(const ProductPredicate& filter, size_t& candidates) const;
+    std::vector<Product*> indexCandidates(const ProductPredicate& filter) const;
+    ProductQueryResult queryStored(const ProductQuery& query);
+
+public:
+    InventoryManager();
+    ~InventoryManager();
+    
+    // Persistent storage
+    void attachStorage(ProductTable* table);
+    void syncStorage();
+    std::vector<Product*> scanStoredProducts(const std::string& fromId, const std::string& toId, size_t limit);
+    std::vector<Product*> findStoredProductsBySupplier(const std::string& supplier, size_t limit);
+    std::vector<Product*> findStoredProductsByCategory(ProductCategory category, size_t limit);
+    // Resident products beyond the limit are written back and freed by trimResident()
+    void setResidentLimit(size_t limit) { residentLimit = limit; }
+    size_t getResidentLimit() const { return residentLimit; }
+    size_t getResidentCount() const { return products.size(); }
+    long getEvictionCount() const { return evictions; }
+    size_t trimResident();                         // Returns how many were evicted
+    
+    // Replication to head office
+    void attachReplication(ReplicationLog* log);   // Publishes every resident product first
+    // Stock events are group-committed by the log's flusher, not written per checkout
+    void recordStockChange(const Product& product);
+    void recordStockChanges(const std::vector<const Product*>& changed);
+    
+    // Versioned shelf prices
+    void attachPriceBook(PriceBook* book);
+    
+    // Product management
+    bool addProduct(Product* product);
+    bool removeProduct(const std::string& productId);
+    Product* findProduct(const std::string& productId);
+    std::vector<Product*> findProductsByName(const std::string& name);
+    std::vector<Product*> findProductsByTag(const std::string& tag);
+    std::vector<Product*> listProducts(const std::string& afterId, size_t limit) const;   // Resident, in ID order
+    ProductQueryResult query(const ProductQuery& query);   // Loads stored matches
+    
+    // Barcodes: scanning decodes weight or price labels into scan
+    Product* findProductByBarcode(const std::string& code, BarcodeScan& scan);   // Loads from storage on a miss
+    bool setBarcode(const std::string& productId, const std::string& code);   // False if invalid or taken
+    // Assigns (productId, code) rows, validated as one batch; returns how many were assigned
+    size_t importBarcodes(const std::vector<std::pair<std::string, std::string>>& rows,
+                          std::vector<size_t>& rejected);
+    
+    // Category and supplier management
+    std::vector<Product*> getProductsByCategory(ProductCategory category) const; 
+    std::vector<Product*> getProductsBySupplier(const std::string& supplier) const;
+    std::vector<std::string> getAllSuppliers() const;
+    
+    // Stock management; stored matches are loaded
+    std::vector<Product*> getLowStockProducts();
+    std::vector<Product*> getOverstockedProducts();
+    std::vector<Product*> getOutOfStockProducts();
+    
+    // Financial calculations
+    double getTotalInventoryValue() const;
+    double getTotalInventoryCost() const;
+    double getTotalPotentialProfit() const;
+    double getCategoryValue(ProductCategory category) const;
+    
+    // Reports and analytics
+    void generateInventoryReport() const;
+    void generateLowStockReport() const;
+    void generateCategoryReport() const;
+    void generateSupplierReport() const;
+    void generateProfitabilityReport() const;
+    
+    // Pricing
+    bool updatePrice(const std::string& productId, double basePrice);
+    
+    // Bulk operations
+    void updateAllPrices(double percentageChange);
+    void updateCategoryPrices(ProductCategory category, double percentageChange);
+    // Applied on top of the prices current at effectiveAt; return the schedule ID, 0 without a book
+    uint64_t scheduleAllPrices(double percentageChange, std::time_t effectiveAt);
+    uint64_t scheduleCategoryPrices(ProductCategory category, double percentageChange, std::time_t effectiveAt);
+    bool cancelScheduledPrices(uint64_t scheduleId);
+    // Resident products the current book version prices differently from the product; empty when in step
+    std::vector<const Product*> getPriceMismatches() const;
+    void deactivateExpiredProducts();
+    
+    // Display methods
+    void displayAllProducts() const;
+    void displayProductsByCategory(ProductCategory category) const;
+    void displayLowStockAlert() const;
+    
+    // Utility methods
+    int getTotalProductCount() const;
+    int getActiveProductCount() const;
+    std::vector<Product*> searchProducts(const std::string& searchTerm);   // Loads stored matches
+    
+    // Memory accounting
+    void accountMemory(MemoryReport& report) const;
+    
+private:
+    void repriceProducts(const std::vector<Product*>& targets, double percentageChange);
+    void applyBasePrices(const std::vector<Product*>& targets, double percentageChange);
+    // Stored products outside targets are repriced too: every one, or those in category when given
+    uint64_t schedulePrices(const std::vector<Product*>& targets, double percentageChange, std::time_t effectiveAt,
+                            const ProductCategory* category);
+    void scheduledPricesPublished(const ScheduledPriceChange& change);
+    void updateCategoryMapping(Product* product);
+    void updateSupplierMapping(Product* product);
+    void removeCategoryMapping(Product* product);
+    void removeSupplierMapping(Product* product);
+    void updateBarcodeMapping(Product* product);
+    void removeBarcodeMapping(Product* product);
+};
+
 #endif // INVENTORY_MANAGER_H
\ No newline at end of file
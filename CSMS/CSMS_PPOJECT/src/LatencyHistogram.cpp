@@ -0,0 +1,205 @@
+// ===== LatencyHistogram.cpp =====
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> LatencyMetrics::enabled(false);
+
+static const char* METRIC_NAMES[LATENCY_METRIC_COUNT] = {
+    "InventoryManager::findProduct",
+    "Transaction::addItem",
+    "Transaction::calculateTotals",
+    "Transaction::finalizeTransaction",
+    "Transaction::processRefund",
+    "Transaction::processItemRefunds",
+    "InventoryManager::generateInventoryReport",
+    "InventoryManager::generateLowStockReport",
+    "InventoryManager::generateCategoryReport",
+    "InventoryManager::generateSupplierReport",
+    "InventoryManager::generateProfitabilityReport",
+    "Store::generateSalesReport",
+    "Store::generateCustomerAnalytics",
+    "Store::generateFinancialSummary"
+};
+
+/**
+ * @brief One thread's histograms; only the owning thread writes to them
+ */
+struct ThreadLatencyHistograms {
+    std::atomic<uint64_t> counts[LATENCY_METRIC_COUNT][LATENCY_BUCKET_COUNT];
+    std::atomic<uint64_t> sumNanos[LATENCY_METRIC_COUNT];
+    std::atomic<uint64_t> maxNanos[LATENCY_METRIC_COUNT];
+
+    ThreadLatencyHistograms() {
+        for (int m = 0; m < LATENCY_METRIC_COUNT; ++m) {
+            for (int b = 0; b < LATENCY_BUCKET_COUNT; ++b) {
+                counts[m][b].store(0, std::memory_order_relaxed);
+            }
+            sumNanos[m].store(0, std::memory_order_relaxed);
+            maxNanos[m].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Histograms outlive their threads so samples from finished workers still count
+static std::mutex registryMutex;
+static std::vector<ThreadLatencyHistograms*> registry;
+
+static ThreadLatencyHistograms& localHistograms() {
+    static thread_local ThreadLatencyHistograms* histograms = nullptr;
+    if (!histograms) {
+        histograms = new ThreadLatencyHistograms();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(histograms);
+    }
+    return *histograms;
+}
+
+// Single writer: a relaxed load and store is enough, no read-modify-write needed
+static inline void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void LatencyMetrics::setEnabled(bool on) {
+    enabled.store(on && isCompiledIn(), std::memory_order_relaxed);
+}
+
+int LatencyMetrics::bucketFor(uint64_t nanos) {
+    if (nanos < static_cast<uint64_t>(LATENCY_SUB_BUCKET_COUNT)) {
+        return static_cast<int>(nanos);
+    }
+    int highestBit = 63 - __builtin_clzll(nanos);
+    int shift = highestBit - LATENCY_SUB_BUCKET_BITS;
+    int sub = static_cast<int>((nanos >> shift) & (LATENCY_SUB_BUCKET_COUNT - 1));
+    return std::min((shift + 1) * LATENCY_SUB_BUCKET_COUNT + sub, LATENCY_BUCKET_COUNT - 1);
+}
+
+uint64_t LatencyMetrics::bucketLowerBound(int bucket) {
+    if (bucket < LATENCY_SUB_BUCKET_COUNT) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int shift = bucket / LATENCY_SUB_BUCKET_COUNT - 1;
+    uint64_t sub = static_cast<uint64_t>(bucket % LATENCY_SUB_BUCKET_COUNT);
+    return (LATENCY_SUB_BUCKET_COUNT + sub) << shift;
+}
+
+uint64_t LatencyMetrics::bucketUpperBound(int bucket) {
+    if (bucket < LATENCY_SUB_BUCKET_COUNT) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int shift = bucket / LATENCY_SUB_BUCKET_COUNT - 1;
+    return bucketLowerBound(bucket) + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyMetrics::record(LatencyMetric metric, uint64_t nanos) {
+    ThreadLatencyHistograms& histograms = localHistograms();
+    int m = static_cast<int>(metric);
+
+    bump(histograms.counts[m][bucketFor(nanos)], 1);
+    bump(histograms.sumNanos[m], nanos);
+    if (nanos > histograms.maxNanos[m].load(std::memory_order_relaxed)) {
+        histograms.maxNanos[m].store(nanos, std::memory_order_relaxed);
+    }
+}
+
+LatencySnapshot LatencyMetrics::snapshot(LatencyMetric metric) {
+    LatencySnapshot snapshot = LatencySnapshot();
+    int m = static_cast<int>(metric);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const ThreadLatencyHistograms* histograms : registry) {
+        for (int b = 0; b < LATENCY_BUCKET_COUNT; ++b) {
+            uint64_t count = histograms->counts[m][b].load(std::memory_order_relaxed);
+            snapshot.counts[b] += count;
+            snapshot.count += count;
+        }
+        snapshot.sumNanos += histograms->sumNanos[m].load(std::memory_order_relaxed);
+        snapshot.maxNanos = std::max(snapshot.maxNanos, histograms->maxNanos[m].load(std::memory_order_relaxed));
+    }
+    return snapshot;
+}
+
+uint64_t LatencySnapshot::getPercentileNanos(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(percentile * count);
+    if (target < 1) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKET_COUNT; ++b) {
+        seen += counts[b];
+        if (seen >= target) {
+            return std::min(LatencyMetrics::bucketUpperBound(b), maxNanos);
+        }
+    }
+    return maxNanos;
+}
+
+long LatencyMetrics::getThreadCount() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return static_cast<long>(registry.size());
+}
+
+size_t LatencyMetrics::getAllocatedBytes() {
+    return getThreadCount() * sizeof(ThreadLatencyHistograms);
+}
+
+const char* LatencyMetrics::getName(LatencyMetric metric) {
+    return METRIC_NAMES[static_cast<int>(metric)];
+}
+
+void LatencyMetrics::displaySummary(std::ostream& out) {
+    if (!isCompiledIn()) {
+        out << "Latency metrics not compiled in (CSMS_LATENCY_METRICS=0)" << std::endl;
+        return;
+    }
+
+    out << std::left << std::setw(46) << "Operation" << std::right << std::setw(10) << "Count"
+        << std::setw(11) << "Mean us" << std::setw(11) << "p50 us" << std::setw(11) << "p99 us"
+        << std::setw(11) << "p999 us" << std::setw(11) << "Max us" << std::endl;
+
+    bool any = false;
+    for (int m = 0; m < LATENCY_METRIC_COUNT; ++m) {
+        LatencyMetric metric = static_cast<LatencyMetric>(m);
+        LatencySnapshot data = snapshot(metric);
+        if (data.count == 0) {
+            continue;
+        }
+        any = true;
+        out << std::left << std::setw(46) << getName(metric) << std::right << std::setw(10) << data.count
+            << std::fixed << std::setprecision(2)
+            << std::setw(11) << data.getMeanNanos() / 1000.0
+            << std::setw(11) << data.getPercentileNanos(0.50) / 1000.0
+            << std::setw(11) << data.getPercentileNanos(0.99) / 1000.0
+            << std::setw(11) << data.getPercentileNanos(0.999) / 1000.0
+            << std::setw(11) << data.maxNanos / 1000.0 << std::endl;
+    }
+    if (!any) {
+        out << "  (no samples" << (isEnabled() ? "" : "; metrics are disabled") << ")" << std::endl;
+    }
+}
+
+bool LatencyMetrics::dumpToFile(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    file << "metric,bucket_low_ns,bucket_high_ns,count\n";
+    for (int m = 0; m < LATENCY_METRIC_COUNT; ++m) {
+        LatencyMetric metric = static_cast<LatencyMetric>(m);
+        LatencySnapshot data = snapshot(metric);
+        for (int b = 0; b < LATENCY_BUCKET_COUNT; ++b) {
+            if (data.counts[b] > 0) {
+                file << getName(metric) << ',' << bucketLowerBound(b) << ',' << bucketUpperBound(b)
+                     << ',' << data.counts[b] << '\n';
+            }
+        }
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,122 @@
+// ===== LatencyHistogram.h =====
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Build with -DCSMS_LATENCY_METRICS=0 (make METRICS=0) to compile the timers out
+#ifndef CSMS_LATENCY_METRICS
+#define CSMS_LATENCY_METRICS 1
+#endif
+
+/**
+ * @brief Instrumented operations
+ */
+enum class LatencyMetric {
+    FIND_PRODUCT,
+    ADD_ITEM,
+    CALCULATE_TOTALS,
+    FINALIZE_TRANSACTION,
+    PROCESS_REFUND,
+    ITEM_REFUND,
+    INVENTORY_REPORT,
+    LOW_STOCK_REPORT,
+    CATEGORY_REPORT,
+    SUPPLIER_REPORT,
+    PROFITABILITY_REPORT,
+    SALES_REPORT,
+    CUSTOMER_ANALYTICS,
+    FINANCIAL_SUMMARY
+};
+
+constexpr int LATENCY_METRIC_COUNT = 14;
+
+// Log-linear buckets: 16 per power of two (about 6% resolution), exact below 16ns
+constexpr int LATENCY_SUB_BUCKET_BITS = 4;
+constexpr int LATENCY_SUB_BUCKET_COUNT = 1 << LATENCY_SUB_BUCKET_BITS;
+constexpr int LATENCY_BUCKET_COUNT = 41 * LATENCY_SUB_BUCKET_COUNT;  // Up to ~2^44ns
+
+/**
+ * @brief Merged view of one metric across all threads
+ */
+struct LatencySnapshot {
+    uint64_t counts[LATENCY_BUCKET_COUNT];
+    uint64_t count;
+    uint64_t sumNanos;
+    uint64_t maxNanos;
+
+    double getMeanNanos() const { return count ? static_cast<double>(sumNanos) / count : 0.0; }
+    uint64_t getPercentileNanos(double percentile) const;  // Upper bound of the bucket holding it
+};
+
+/**
+ * @brief Process-wide latency histograms, one set per recording thread
+ *
+ * Each thread records into its own histograms with plain relaxed stores, so
+ * the hot path takes no lock and shares no cache lines; readers merge all
+ * threads' histograms on demand. Recording is off until setEnabled(true),
+ * and a disabled timer costs one relaxed load.
+ */
+class LatencyMetrics {
+private:
+    static std::atomic<bool> enabled;
+
+public:
+    static bool isEnabled() { return CSMS_LATENCY_METRICS && enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on);
+    static bool isCompiledIn() { return CSMS_LATENCY_METRICS != 0; }
+
+    static void record(LatencyMetric metric, uint64_t nanos);
+    static LatencySnapshot snapshot(LatencyMetric metric);
+    static const char* getName(LatencyMetric metric);
+
+    static int bucketFor(uint64_t nanos);
+    static uint64_t bucketLowerBound(int bucket);
+    static uint64_t bucketUpperBound(int bucket);
+
+    static long getThreadCount();          // Threads that have recorded a sample
+    static size_t getAllocatedBytes();
+
+    static void displaySummary(std::ostream& out);
+    static bool dumpToFile(const std::string& path);  // CSV of every non-empty bucket
+};
+
+/**
+ * @brief Records the lifetime of a scope into a metric when metrics are enabled
+ */
+class LatencyTimer {
+private:
+    LatencyMetric metric;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit LatencyTimer(LatencyMetric metric) : metric(metric), active(LatencyMetrics::isEnabled()) {
+        if (active) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~LatencyTimer() {
+        if (active) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            LatencyMetrics::record(metric, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    LatencyTimer(const LatencyTimer&) = delete;
+    LatencyTimer& operator=(const LatencyTimer&) = delete;
+};
+
+#if CSMS_LATENCY_METRICS
+#define CSMS_TIME_LATENCY(metric) LatencyTimer latencyTimer(LatencyMetric::metric)
+#else
+#define CSMS_TIME_LATENCY(metric) ((void)0)
+#endif
+
+#endif // LATENCY_HISTOGRAM_H
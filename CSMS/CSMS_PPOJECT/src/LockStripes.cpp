@@ -0,0 +1,114 @@
+// ===== LockStripes.cpp =====
+#include "LockStripes.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+LockStripes::LockStripes(const std::string& name, int stripeCount) : name(name) {
+    if (stripeCount < 1) {
+        stripeCount = 1;
+    }
+    for (int i = 0; i < stripeCount; ++i) {
+        stripes.push_back(new Stripe());
+    }
+}
+
+LockStripes::~LockStripes() {
+    for (Stripe* stripe : stripes) {
+        delete stripe;
+    }
+}
+
+int LockStripes::stripeFor(const void* key) const {
+    size_t hash = std::hash<const void*>()(key);
+    hash ^= hash >> 17;  // Heap addresses share low bits; mix before reducing
+    hash *= 0x9E3779B97F4A7C15ULL;
+    return static_cast<int>((hash >> 32) % stripes.size());
+}
+
+void LockStripes::lock(int stripe, const void* key) {
+    Stripe* s = stripes[stripe];
+    if (!s->mutex.try_lock()) {
+        auto start = std::chrono::steady_clock::now();
+        s->mutex.lock();
+        auto waited = std::chrono::steady_clock::now() - start;
+        s->contended.fetch_add(1, std::memory_order_relaxed);
+        s->waitNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count(),
+                               std::memory_order_relaxed);
+    }
+    s->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (key) {
+        s->lastKey = key;
+    }
+}
+
+void LockStripes::unlock(int stripe) {
+    stripes[stripe]->mutex.unlock();
+}
+
+std::vector<int> LockStripes::lockAll(const std::vector<const void*>& keys) {
+    std::vector<std::pair<int, const void*>> wanted;
+    for (const void* key : keys) {
+        wanted.push_back(std::make_pair(stripeFor(key), key));
+    }
+    std::sort(wanted.begin(), wanted.end(),
+              [](const std::pair<int, const void*>& a, const std::pair<int, const void*>& b) {
+                  return a.first < b.first;
+              });
+
+    std::vector<int> held;
+    for (const auto& entry : wanted) {
+        if (held.empty() || held.back() != entry.first) {
+            lock(entry.first, entry.second);
+            held.push_back(entry.first);
+        }
+    }
+    return held;
+}
+
+void LockStripes::unlockAll(const std::vector<int>& held) {
+    for (auto it = held.rbegin(); it != held.rend(); ++it) {
+        unlock(*it);
+    }
+}
+
+StripeStats LockStripes::getStats(int stripe) const {
+    const Stripe* s = stripes[stripe];
+    StripeStats stats;
+    stats.stripe = stripe;
+    stats.acquisitions = s->acquisitions.load();
+    stats.contended = s->contended.load();
+    stats.waitNanos = s->waitNanos.load();
+    stats.lastKey = s->lastKey;
+    return stats;
+}
+
+std::vector<StripeStats> LockStripes::getHottestStripes(int count) const {
+    std::vector<StripeStats> all;
+    for (int i = 0; i < getStripeCount(); ++i) {
+        all.push_back(getStats(i));
+    }
+    std::sort(all.begin(), all.end(), [](const StripeStats& a, const StripeStats& b) {
+        return a.waitNanos != b.waitNanos ? a.waitNanos > b.waitNanos : a.contended > b.contended;
+    });
+    if (count < static_cast<int>(all.size())) {
+        all.resize(count);
+    }
+    return all;
+}
+
+long LockStripes::getTotalWaitNanos() const {
+    long total = 0;
+    for (const Stripe* s : stripes) {
+        total += s->waitNanos.load();
+    }
+    return total;
+}
+
+void LockStripes::resetStats() {
+    for (Stripe* s : stripes) {
+        s->acquisitions = 0;
+        s->contended = 0;
+        s->waitNanos = 0;
+    }
+}
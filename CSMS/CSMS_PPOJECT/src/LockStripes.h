@@ -0,0 +1,64 @@
+// ===== LockStripes.h =====
+#ifndef LOCK_STRIPES_H
+#define LOCK_STRIPES_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Contention counters for one stripe
+ */
+struct StripeStats {
+    int stripe;
+    long acquisitions;
+    long contended;      // Acquisitions that had to wait
+    long waitNanos;      // Total time spent waiting
+    const void* lastKey; // Last key locked on the stripe, for reporting
+};
+
+/**
+ * @brief Fixed set of mutexes selected by key hash, with contention profiling
+ *
+ * Used to serialize updates to shared objects (products, customers) without
+ * one global lock. Every acquisition first tries the lock; only a failed try
+ * pays for timing, so uncontended locking stays cheap.
+ */
+class LockStripes {
+private:
+    struct Stripe {
+        std::mutex mutex;
+        std::atomic<long> acquisitions;
+        std::atomic<long> contended;
+        std::atomic<long> waitNanos;
+        const void* lastKey;
+        Stripe() : acquisitions(0), contended(0), waitNanos(0), lastKey(nullptr) {}
+    };
+
+    std::vector<Stripe*> stripes;
+    std::string name;
+
+public:
+    LockStripes(const std::string& name, int stripeCount);
+    ~LockStripes();
+
+    int stripeFor(const void* key) const;
+    void lock(int stripe, const void* key = nullptr);
+    void unlock(int stripe);
+
+    // Locks the stripes of all keys in ascending stripe order (deadlock free);
+    // returns the stripes taken so they can be released with unlockAll
+    std::vector<int> lockAll(const std::vector<const void*>& keys);
+    void unlockAll(const std::vector<int>& held);
+
+    const std::string& getName() const { return name; }
+    int getStripeCount() const { return static_cast<int>(stripes.size()); }
+    StripeStats getStats(int stripe) const;
+    std::vector<StripeStats> getHottestStripes(int count) const;
+    long getTotalWaitNanos() const;
+    void resetStats();
+};
+
+#endif // LOCK_STRIPES_H
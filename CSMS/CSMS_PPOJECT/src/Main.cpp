@@ -1,1051 +1,1439 @@
-// ===== Main.cpp =====
-#include "Product.h"
-#include "Customer.h"
-#include "Transaction.h"
-#include "InventoryManager.h"
-#include <iostream>
-#include <string>
-#include <memory>
-
-/**
- * @brief Main application class for the Convenience Store Management System
- */
-class ConvenienceStoreApp
-{
-private:
-    InventoryManager inventory;
-    CustomerDatabase customerDB;
-    std::vector<Transaction *> transactions;
-    std::string currentCashierId;
-
-public:
-    ConvenienceStoreApp() : currentCashierId("CASHIER001")
-    {
-        initializeTestData();
-    }
-
-    ~ConvenienceStoreApp()
-    {
-        for (auto *transaction : transactions)
-        {
-            delete transaction;
-        }
-    }
-
-    void run()
-    {
-        std::cout << "  Welcome to Advanced Convenience Store Management System!" << std::endl;
-
-        int choice;
-        do
-        {
-            displayMainMenu();
-            std::cin >> choice;
-
-            switch (choice)
-            {
-            case 1:
-                handleInventoryMenu();
-                break;
-            case 2:
-                handleCustomerMenu();
-                break;
-            case 3:
-                handleSalesMenu();
-                break;
-            case 4:
-                handleReportsMenu();
-                break;
-            case 5:
-                handleSettingsMenu();
-                break;
-            case 0:
-                std::cout << "Thank you for using CSMS!" << std::endl;
-                break;
-            default:
-                std::cout << "Invalid choice! Please try again." << std::endl;
-            }
-        } while (choice != 0);
-    }
-
-private:
-    void displayMainMenu()
-    {
-        std::cout << "\n"
-                  << std::string(50, '=') << std::endl;
-        std::cout << "    CONVENIENCE STORE MANAGEMENT SYSTEM    " << std::endl;
-        std::cout << std::string(50, '=') << std::endl;
-        std::cout << "1.   Inventory Management" << std::endl;
-        std::cout << "2.   Customer Management" << std::endl;
-        std::cout << "3.   Sales & Transactions" << std::endl;
-        std::cout << "4.   Reports & Analytics" << std::endl;
-        std::cout << "5.   Settings" << std::endl;
-        std::cout << "0.   Exit" << std::endl;
-        std::cout << std::string(50, '=') << std::endl;
-        std::cout << "Choose an option: ";
-    }
-
-    void initializeTestData()
-    {
-        // Add sample products
-        inventory.addProduct(new RegularProduct("P001", "Coca Cola 330ml", "Classic Coca Cola can",
-                                                2.50, 1.20, 50, ProductCategory::BEVERAGES, "Coca Cola Co", 0.3));
-
-        inventory.addProduct(new RegularProduct("P002", "Lay's Chips Original", "Crispy potato chips",
-                                                3.00, 1.50, 30, ProductCategory::SNACKS, "Frito-Lay", 0.25));
-
-        inventory.addProduct(new PerishableProduct("P003", "Fresh Milk 1L", "Whole milk",
-                                                   4.00, 2.50, 15, ProductCategory::DAIRY, "2025-08-20", 7, "Dairy Farm"));
-
-        inventory.addProduct(new BulkProduct("P004", "Rice Premium", "Premium jasmine rice",
-                                             2.50, 1.80, 100, ProductCategory::OTHER, "kg", 0.5, "Rice Supplier"));
-
-        inventory.addProduct(new RegularProduct("P005", "Chocolate Bar", "Dark chocolate bar",
-                                                2.00, 1.00, 8, ProductCategory::SNACKS, "Chocolate Co", 0.4));
-
-        // Add sample customers
-        customerDB.addCustomer("John", "Doe", "john.doe@email.com", "+1234567890", CustomerType::REGULAR);
-        customerDB.addCustomer("Jane", "Smith", "jane.smith@email.com", "+1234567891", CustomerType::PREMIUM);
-        customerDB.addCustomer("Bob", "Johnson", "bob.johnson@email.com", "+1234567892", CustomerType::VIP);
-    }
-
-    void handleInventoryMenu()
-    {
-        int choice;
-        do
-        {
-            std::cout << "\n--- INVENTORY MANAGEMENT ---" << std::endl;
-            std::cout << "1. View All Products" << std::endl;
-            std::cout << "2. Add New Product" << std::endl;
-            std::cout << "3. Search Products" << std::endl;
-            std::cout << "4. Update Stock" << std::endl;
-            std::cout << "5. Low Stock Alert" << std::endl;
-            std::cout << "6. Inventory Reports" << std::endl;
-            std::cout << "0. Back to Main Menu" << std::endl;
-            std::cout << "Choose an option: ";
-            std::cin >> choice;
-
-            switch (choice)
-            {
-            case 1:
-                inventory.displayAllProducts();
-                break;
-            case 2:
-                addNewProduct();
-                break;
-            case 3:
-                searchProducts();
-                break;
-            case 4:
-                updateStock();
-                break;
-            case 5:
-                inventory.generateLowStockReport();
-                break;
-            case 6:
-                inventory.generateInventoryReport();
-                break;
-            }
-        } while (choice != 0);
-    }
-
-    void addNewProduct()
-    {
-        std::string id, name, desc, supplier;
-        double price, cost;
-        int stock, minStock, maxStock, productType;
-
-        std::cout << "\n--- ADD NEW PRODUCT ---" << std::endl;
-        std::cout << "Product ID: ";
-        std::cin >> id;
-
-        if (inventory.findProduct(id))
-        {
-            std::cout << "Product with ID " << id << " already exists!" << std::endl;
-            return;
-        }
-
-        std::cin.ignore();
-        std::cout << "Product Name: ";
-        std::getline(std::cin, name);
-        std::cout << "Description: ";
-        std::getline(std::cin, desc);
-        std::cout << "Selling Price: $";
-        std::cin >> price;
-        std::cout << "Cost Price: $";
-        std::cin >> cost;
-        std::cout << "Initial Stock: ";
-        std::cin >> stock;
-        std::cout << "Minimum Stock Level: ";
-        std::cin >> minStock;
-        std::cout << "Maximum Stock Level: ";
-        std::cin >> maxStock;
-
-        std::cin.ignore();
-        std::cout << "Supplier: ";
-        std::getline(std::cin, supplier);
-
-        std::cout << "\nProduct Type:" << std::endl;
-        std::cout << "1. Regular Product" << std::endl;
-        std::cout << "2. Perishable Product" << std::endl;
-        std::cout << "3. Bulk Product" << std::endl;
-        std::cout << "Choose type: ";
-        std::cin >> productType;
-
-        std::cout << "\nCategory:" << std::endl;
-        std::cout << "1. Beverages" << std::endl;
-        std::cout << "2. Snacks" << std::endl;
-        std::cout << "3. Dairy" << std::endl;
-        std::cout << "4. Bakery" << std::endl;
-        std::cout << "5. Household" << std::endl;
-        std::cout << "6. Electronics" << std::endl;
-        std::cout << "7. Health & Beauty" << std::endl;
-        std::cout << "8. Other" << std::endl;
-
-        int categoryChoice;
-        std::cout << "Choose category: ";
-        std::cin >> categoryChoice;
-
-        ProductCategory category = static_cast<ProductCategory>(categoryChoice - 1);
-        Product *newProduct = nullptr;
-
-        switch (productType)
-        {
-        case 1:
-        {
-            double markup;
-            std::cout << "Markup Percentage (e.g., 0.3 for 30%): ";
-            std::cin >> markup;
-            newProduct = new RegularProduct(id, name, desc, price, cost, stock,
-                                            category, supplier, markup, minStock, maxStock);
-            break;
-        }
-        case 2:
-        {
-            std::string expDate;
-            int shelfLife;
-            double discount;
-            std::cin.ignore();
-            std::cout << "Expiration Date (YYYY-MM-DD): ";
-            std::getline(std::cin, expDate);
-            std::cout << "Shelf Life (days): ";
-            std::cin >> shelfLife;
-            std::cout << "Near-expiration Discount Rate (e.g., 0.2 for 20%): ";
-            std::cin >> discount;
-            newProduct = new PerishableProduct(id, name, desc, price, cost, stock,
-                                               category, expDate, shelfLife, supplier,
-                                               discount, minStock, maxStock);
-            break;
-        }
-        case 3:
-        {
-            std::string unit;
-            double minQty;
-            std::cin.ignore();
-            std::cout << "Unit (kg, lbs, liters, etc.): ";
-            std::getline(std::cin, unit);
-            std::cout << "Minimum Quantity: ";
-            std::cin >> minQty;
-            newProduct = new BulkProduct(id, name, desc, price, cost, stock,
-                                         category, unit, minQty, supplier, minStock, maxStock);
-            break;
-        }
-        default:
-            std::cout << "Invalid product type!" << std::endl;
-            return;
-        }
-
-        if (newProduct && inventory.addProduct(newProduct))
-        {
-            std::cout << "  Product added successfully!" << std::endl;
-        }
-        else
-        {
-            std::cout << "  Failed to add product!" << std::endl;
-            delete newProduct;
-        }
-    }
-
-    void searchProducts()
-    {
-        std::string searchTerm;
-        std::cout << "\nEnter search term (name or tag): ";
-        std::cin.ignore();
-        std::getline(std::cin, searchTerm);
-
-        auto nameResults = inventory.findProductsByName(searchTerm);
-        auto tagResults = inventory.findProductsByTag(searchTerm);
-
-        std::cout << "\n--- SEARCH RESULTS ---" << std::endl;
-
-        if (!nameResults.empty())
-        {
-            std::cout << "Products matching name:" << std::endl;
-            for (Product *product : nameResults)
-            {
-                std::cout << "  " << product->getId() << " - " << product->getName()
-                          << " ($" << std::fixed << std::setprecision(2)
-                          << product->calculateSellingPrice() << ")" << std::endl;
-            }
-        }
-
-        if (!tagResults.empty())
-        {
-            std::cout << "Products matching tag:" << std::endl;
-            for (Product *product : tagResults)
-            {
-                std::cout << "  " << product->getId() << " - " << product->getName()
-                          << " ($" << std::fixed << std::setprecision(2)
-                          << product->calculateSellingPrice() << ")" << std::endl;
-            }
-        }
-
-        if (nameResults.empty() && tagResults.empty())
-        {
-            std::cout << "No products found matching: " << searchTerm << std::endl;
-        }
-    }
-
-    void updateStock()
-    {
-        std::string productId;
-        int quantity;
-        char operation;
-
-        std::cout << "\nProduct ID: ";
-        std::cin >> productId;
-
-        Product *product = inventory.findProduct(productId);
-        if (!product)
-        {
-            std::cout << "Product not found!" << std::endl;
-            return;
-        }
-
-        std::cout << "Current Stock: " << product->getCurrentStock() << std::endl;
-        std::cout << "Operation (+ to add, - to remove): ";
-        std::cin >> operation;
-        std::cout << "Quantity: ";
-        std::cin >> quantity;
-
-        if (operation == '+')
-        {
-            product->addStock(quantity);
-            std::cout << "  Stock added! New stock: " << product->getCurrentStock() << std::endl;
-        }
-        else if (operation == '-')
-        {
-            if (product->reduceStock(quantity))
-            {
-                std::cout << "  Stock reduced! New stock: " << product->getCurrentStock() << std::endl;
-            }
-            else
-            {
-                std::cout << "  Insufficient stock!" << std::endl;
-            }
-        }
-        else
-        {
-            std::cout << "Invalid operation!" << std::endl;
-        }
-    }
-
-    void handleCustomerMenu()
-    {
-        int choice;
-        do
-        {
-            std::cout << "\n--- CUSTOMER MANAGEMENT ---" << std::endl;
-            std::cout << "1. View All Customers" << std::endl;
-            std::cout << "2. Add New Customer" << std::endl;
-            std::cout << "3. Search Customer" << std::endl;
-            std::cout << "4. Customer Details" << std::endl;
-            std::cout << "5. Customer Statistics" << std::endl;
-            std::cout << "0. Back to Main Menu" << std::endl;
-            std::cout << "Choose an option: ";
-            std::cin >> choice;
-
-            switch (choice)
-            {
-            case 1:
-                customerDB.displayAllCustomers();
-                break;
-            case 2:
-                addNewCustomer();
-                break;
-            case 3:
-                searchCustomer();
-                break;
-            case 4:
-                viewCustomerDetails();
-                break;
-            case 5:
-                customerDB.displayCustomerStatistics();
-                break;
-            }
-        } while (choice != 0);
-    }
-
-    void addNewCustomer()
-    {
-        std::string firstName, lastName, email, phone;
-        int typeChoice;
-
-        std::cout << "\n--- ADD NEW CUSTOMER ---" << std::endl;
-        std::cin.ignore();
-        std::cout << "First Name: ";
-        std::getline(std::cin, firstName);
-        std::cout << "Last Name: ";
-        std::getline(std::cin, lastName);
-        std::cout << "Email: ";
-        std::getline(std::cin, email);
-        std::cout << "Phone: ";
-        std::getline(std::cin, phone);
-
-        std::cout << "\nCustomer Type:" << std::endl;
-        std::cout << "1. Regular" << std::endl;
-        std::cout << "2. Premium" << std::endl;
-        std::cout << "3. VIP" << std::endl;
-        std::cout << "4. Employee" << std::endl;
-        std::cout << "Choose type: ";
-        std::cin >> typeChoice;
-
-        CustomerType type = static_cast<CustomerType>(typeChoice - 1);
-        Customer *customer = customerDB.addCustomer(firstName, lastName, email, phone, type);
-
-        if (customer)
-        {
-            std::cout << "  Customer added successfully! ID: " << customer->getId() << std::endl;
-        }
-        else
-        {
-            std::cout << "  Failed to add customer!" << std::endl;
-        }
-    }
-
-    void searchCustomer()
-    {
-        std::string searchTerm;
-        int searchType;
-
-        std::cout << "\nSearch by:" << std::endl;
-        std::cout << "1. Customer ID" << std::endl;
-        std::cout << "2. Email" << std::endl;
-        std::cout << "3. Phone" << std::endl;
-        std::cout << "Choose search type: ";
-        std::cin >> searchType;
-
-        std::cin.ignore();
-        std::cout << "Enter search term: ";
-        std::getline(std::cin, searchTerm);
-
-        Customer *customer = nullptr;
-
-        switch (searchType)
-        {
-        case 1:
-            customer = customerDB.findCustomer(searchTerm);
-            break;
-        case 2:
-            customer = customerDB.findCustomerByEmail(searchTerm);
-            break;
-        case 3:
-            customer = customerDB.findCustomerByPhone(searchTerm);
-            break;
-        default:
-            std::cout << "Invalid search type!" << std::endl;
-            return;
-        }
-
-        if (customer)
-        {
-            customer->displayInfo();
-        }
-        else
-        {
-            std::cout << "Customer not found!" << std::endl;
-        }
-    }
-
-    void viewCustomerDetails()
-    {
-        std::string customerId;
-        std::cout << "\nEnter Customer ID: ";
-        std::cin >> customerId;
-
-        Customer *customer = customerDB.findCustomer(customerId);
-        if (customer)
-        {
-            customer->displayInfo();
-        }
-        else
-        {
-            std::cout << "Customer not found!" << std::endl;
-        }
-    }
-
-    void handleSalesMenu()
-    {
-        int choice;
-        do
-        {
-            std::cout << "\n--- SALES & TRANSACTIONS ---" << std::endl;
-            std::cout << "1. New Transaction" << std::endl;
-            std::cout << "2. View Transaction History" << std::endl;
-            std::cout << "3. Process Refund" << std::endl;
-            std::cout << "4. Transaction Details" << std::endl;
-            std::cout << "0. Back to Main Menu" << std::endl;
-            std::cout << "Choose an option: ";
-            std::cin >> choice;
-
-            switch (choice)
-            {
-            case 1:
-                processNewTransaction();
-                break;
-            case 2:
-                viewTransactionHistory();
-                break;
-            case 3:
-                processRefund();
-                break;
-            case 4:
-                viewTransactionDetails();
-                break;
-            }
-        } while (choice != 0);
-    }
-
-    void processNewTransaction()
-    {
-        std::cout << "\n--- NEW TRANSACTION ---" << std::endl;
-
-        // Check if customer wants to provide customer info
-        char hasCustomer;
-        std::cout << "Is this for a registered customer? (y/n): ";
-        std::cin >> hasCustomer;
-
-        Customer *customer = nullptr;
-        if (hasCustomer == 'y' || hasCustomer == 'Y')
-        {
-            std::string customerId;
-            std::cout << "Enter Customer ID: ";
-            std::cin >> customerId;
-            customer = customerDB.findCustomer(customerId);
-
-            if (!customer)
-            {
-                std::cout << "Customer not found! Proceeding without customer..." << std::endl;
-            }
-            else
-            {
-                std::cout << "Customer: " << customer->getFullName()
-                          << " (" << customer->getTypeString() << ")" << std::endl;
-            }
-        }
-
-        Transaction *transaction = new Transaction(customer, currentCashierId);
-
-        // Add items to transaction
-        std::string productId;
-        while (true)
-        {
-            std::cout << "\nEnter Product ID (or 'done' to finish): ";
-            std::cin >> productId;
-
-            if (productId == "done")
-                break;
-
-            Product *product = inventory.findProduct(productId);
-            if (!product)
-            {
-                std::cout << "Product not found!" << std::endl;
-                continue;
-            }
-
-            if (!product->getIsActive())
-            {
-                std::cout << "Product is not active!" << std::endl;
-                continue;
-            }
-
-            std::cout << "Product: " << product->getName()
-                      << " ($" << std::fixed << std::setprecision(2)
-                      << product->calculateSellingPrice() << ")" << std::endl;
-            std::cout << "Available Stock: " << product->getCurrentStock() << std::endl;
-
-            double quantity;
-            std::cout << "Quantity: ";
-            std::cin >> quantity;
-
-            double discount = 0.0;
-            char applyDiscount;
-            std::cout << "Apply manual discount? (y/n): ";
-            std::cin >> applyDiscount;
-
-            if (applyDiscount == 'y' || applyDiscount == 'Y')
-            {
-                std::cout << "Discount percentage (0.1 for 10%): ";
-                std::cin >> discount;
-            }
-
-            if (transaction->addItem(product, quantity, discount))
-            {
-                std::cout << "  Item added to transaction!" << std::endl;
-            }
-            else
-            {
-                std::cout << "  Failed to add item!" << std::endl;
-            }
-        }
-
-        if (transaction->getItems().empty())
-        {
-            std::cout << "No items in transaction. Cancelling..." << std::endl;
-            delete transaction;
-            return;
-        }
-
-        // Apply loyalty points if customer exists
-        if (customer && customer->getLoyaltyPoints() > 0)
-        {
-            char useLoyalty;
-            std::cout << "\nCustomer has " << customer->getLoyaltyPoints()
-                      << " loyalty points. Use them? (y/n): ";
-            std::cin >> useLoyalty;
-
-            if (useLoyalty == 'y' || useLoyalty == 'Y')
-            {
-                double pointsToUse;
-                std::cout << "Points to use (max " << customer->getLoyaltyPoints() << "): ";
-                std::cin >> pointsToUse;
-
-                if (pointsToUse > 0 && pointsToUse <= customer->getLoyaltyPoints())
-                {
-                    transaction->applyLoyaltyPoints(pointsToUse);
-                }
-            }
-        }
-
-        // Calculate totals
-        transaction->calculateTotals(0.08); // 8% tax rate
-
-        // Show transaction summary
-        std::cout << "\n--- TRANSACTION SUMMARY ---" << std::endl;
-        std::cout << "Subtotal: $" << std::fixed << std::setprecision(2)
-                  << transaction->getSubtotal() << std::endl;
-        std::cout << "Tax: $" << std::fixed << std::setprecision(2)
-                  << transaction->getTax() << std::endl;
-        std::cout << "Total: $" << std::fixed << std::setprecision(2)
-                  << transaction->getFinalTotal() << std::endl;
-
-        // Process payment
-        std::cout << "\nPayment Method:" << std::endl;
-        std::cout << "1. Cash" << std::endl;
-        std::cout << "2. Credit Card" << std::endl;
-        std::cout << "3. Debit Card" << std::endl;
-        std::cout << "4. Mobile Payment" << std::endl;
-        std::cout << "Choose payment method: ";
-
-        int paymentChoice;
-        std::cin >> paymentChoice;
-
-        PaymentMethod method = static_cast<PaymentMethod>(paymentChoice - 1);
-
-        double amountPaid = 0.0;
-        if (method == PaymentMethod::CASH)
-        {
-            std::cout << "Amount paid: $";
-            std::cin >> amountPaid;
-        }
-        else
-        {
-            amountPaid = transaction->getFinalTotal();
-        }
-
-        if (transaction->processPayment(method, amountPaid))
-        {
-            transaction->finalizeTransaction();
-            transactions.push_back(transaction);
-
-            // Print receipt
-            transaction->printReceipt();
-
-            // Show change for cash payments
-            if (method == PaymentMethod::CASH && amountPaid > transaction->getFinalTotal())
-            {
-                std::cout << "Change: $" << std::fixed << std::setprecision(2)
-                          << (amountPaid - transaction->getFinalTotal()) << std::endl;
-            }
-
-            std::cout << "  Transaction completed successfully!" << std::endl;
-        }
-        else
-        {
-            std::cout << "  Payment failed!" << std::endl;
-            delete transaction;
-        }
-    }
-
-    void viewTransactionHistory()
-    {
-        std::cout << "\n--- TRANSACTION HISTORY ---" << std::endl;
-
-        if (transactions.empty())
-        {
-            std::cout << "No transactions found." << std::endl;
-            return;
-        }
-
-        for (const auto *transaction : transactions)
-        {
-            std::cout << "ID: " << transaction->getId()
-                      << " | Total: $" << std::fixed << std::setprecision(2)
-                      << transaction->getFinalTotal()
-                      << " | Payment: " << transaction->getPaymentMethodString()
-                      << " | Status: " << transaction->getStatusString();
-
-            if (transaction->getCustomer())
-            {
-                std::cout << " | Customer: " << transaction->getCustomer()->getFullName();
-            }
-
-            std::time_t timestamp = transaction->getTimestamp();
-            std::cout << " | Time: " << std::ctime(&timestamp);
-        }
-    }
-
-    void processRefund()
-    {
-        int transactionId;
-        std::cout << "\nEnter Transaction ID: ";
-        std::cin >> transactionId;
-
-        Transaction *transaction = nullptr;
-        for (auto *t : transactions)
-        {
-            if (t->getId() == transactionId)
-            {
-                transaction = t;
-                break;
-            }
-        }
-
-        if (!transaction)
-        {
-            std::cout << "Transaction not found!" << std::endl;
-            return;
-        }
-
-        if (transaction->getStatus() != TransactionStatus::COMPLETED)
-        {
-            std::cout << "Can only refund completed transactions!" << std::endl;
-            return;
-        }
-
-        std::cout << "Transaction Total: $" << std::fixed << std::setprecision(2)
-                  << transaction->getFinalTotal() << std::endl;
-
-        char fullRefund;
-        std::cout << "Full refund? (y/n): ";
-        std::cin >> fullRefund;
-
-        if (fullRefund == 'y' || fullRefund == 'Y')
-        {
-            if (transaction->processRefund())
-            {
-                std::cout << "  Full refund processed successfully!" << std::endl;
-            }
-            else
-            {
-                std::cout << "  Refund failed!" << std::endl;
-            }
-        }
-        else
-        {
-            double refundAmount;
-            std::cout << "Refund amount: $";
-            std::cin >> refundAmount;
-
-            if (transaction->processRefund(refundAmount))
-            {
-                std::cout << "  Partial refund processed successfully!" << std::endl;
-            }
-            else
-            {
-                std::cout << "  Refund failed!" << std::endl;
-            }
-        }
-    }
-
-    void viewTransactionDetails()
-    {
-        int transactionId;
-        std::cout << "\nEnter Transaction ID: ";
-        std::cin >> transactionId;
-
-        Transaction *transaction = nullptr;
-        for (auto *t : transactions)
-        {
-            if (t->getId() == transactionId)
-            {
-                transaction = t;
-                break;
-            }
-        }
-
-        if (transaction)
-        {
-            transaction->printDetailedReceipt();
-        }
-        else
-        {
-            std::cout << "Transaction not found!" << std::endl;
-        }
-    }
-
-    void handleReportsMenu()
-    {
-        int choice;
-        do
-        {
-            std::cout << "\n--- REPORTS & ANALYTICS ---" << std::endl;
-            std::cout << "1. Inventory Report" << std::endl;
-            std::cout << "2. Sales Report" << std::endl;
-            std::cout << "3. Customer Analytics" << std::endl;
-            std::cout << "4. Low Stock Alert" << std::endl;
-            std::cout << "5. Financial Summary" << std::endl;
-            std::cout << "0. Back to Main Menu" << std::endl;
-            std::cout << "Choose an option: ";
-            std::cin >> choice;
-
-            switch (choice)
-            {
-            case 1:
-                inventory.generateInventoryReport();
-                break;
-            case 2:
-                generateSalesReport();
-                break;
-            case 3:
-                generateCustomerAnalytics();
-                break;
-            case 4:
-                inventory.generateLowStockReport();
-                break;
-            case 5:
-                generateFinancialSummary();
-                break;
-            }
-        } while (choice != 0);
-    }
-
-    void generateSalesReport()
-    {
-        std::cout << "\n"
-                  << std::string(60, '=') << std::endl;
-        std::cout << "                SALES REPORT                " << std::endl;
-        std::cout << std::string(60, '=') << std::endl;
-
-        if (transactions.empty())
-        {
-            std::cout << "No transactions to report." << std::endl;
-            std::cout << std::string(60, '=') << std::endl
-                      << std::endl;
-            return;
-        }
-
-        double totalSales = 0.0;
-        double totalTax = 0.0;
-        int completedTransactions = 0;
-        int refundedTransactions = 0;
-
-        for (const auto *transaction : transactions)
-        {
-            if (transaction->getStatus() == TransactionStatus::COMPLETED)
-            {
-                totalSales += transaction->getFinalTotal();
-                totalTax += transaction->getTax();
-                completedTransactions++;
-            }
-            else if (transaction->getStatus() == TransactionStatus::REFUNDED ||
-                     transaction->getStatus() == TransactionStatus::PARTIALLY_REFUNDED)
-            {
-                refundedTransactions++;
-            }
-        }
-
-        std::cout << "Total Transactions: " << transactions.size() << std::endl;
-        std::cout << "Completed Transactions: " << completedTransactions << std::endl;
-        std::cout << "Refunded Transactions: " << refundedTransactions << std::endl;
-        std::cout << "Total Sales: $" << std::fixed << std::setprecision(2) << totalSales << std::endl;
-        std::cout << "Total Tax Collected: $" << std::fixed << std::setprecision(2) << totalTax << std::endl;
-
-        if (completedTransactions > 0)
-        {
-            std::cout << "Average Transaction: $" << std::fixed << std::setprecision(2)
-                      << (totalSales / completedTransactions) << std::endl;
-        }
-
-        std::cout << std::string(60, '=') << std::endl
-                  << std::endl;
-    }
-
-    void generateCustomerAnalytics()
-    {
-        auto topCustomers = customerDB.getTopCustomers(5);
-
-        std::cout << "\n"
-                  << std::string(60, '=') << std::endl;
-        std::cout << "              CUSTOMER ANALYTICS             " << std::endl;
-        std::cout << std::string(60, '=') << std::endl;
-
-        std::cout << "Total Customers: " << customerDB.getTotalCustomerCount() << std::endl;
-        std::cout << "Total Customer Spending: $" << std::fixed << std::setprecision(2)
-                  << customerDB.getTotalCustomerSpending() << std::endl;
-
-        std::cout << "\nTop 5 Customers by Spending:" << std::endl;
-        for (size_t i = 0; i < topCustomers.size(); ++i)
-        {
-            const Customer *customer = topCustomers[i];
-            std::cout << (i + 1) << ". " << customer->getFullName()
-                      << " - $" << std::fixed << std::setprecision(2) << customer->getTotalSpent()
-                      << " (" << customer->getTransactionCount() << " transactions)" << std::endl;
-        }
-
-        // Customer type distribution
-        std::cout << "\nCustomer Type Distribution:" << std::endl;
-        auto regularCustomers = customerDB.getCustomersByType(CustomerType::REGULAR);
-        auto premiumCustomers = customerDB.getCustomersByType(CustomerType::PREMIUM);
-        auto vipCustomers = customerDB.getCustomersByType(CustomerType::VIP);
-        auto employeeCustomers = customerDB.getCustomersByType(CustomerType::EMPLOYEE);
-
-        std::cout << "Regular: " << regularCustomers.size() << std::endl;
-        std::cout << "Premium: " << premiumCustomers.size() << std::endl;
-        std::cout << "VIP: " << vipCustomers.size() << std::endl;
-        std::cout << "Employee: " << employeeCustomers.size() << std::endl;
-
-        std::cout << std::string(60, '=') << std::endl
-                  << std::endl;
-    }
-
-    void generateFinancialSummary()
-    {
-        std::cout << "\n"
-                  << std::string(60, '=') << std::endl;
-        std::cout << "              FINANCIAL SUMMARY             " << std::endl;
-        std::cout << std::string(60, '=') << std::endl;
-
-        double totalInventoryValue = inventory.getTotalInventoryValue();
-        double totalInventoryCost = inventory.getTotalInventoryCost();
-        double potentialProfit = inventory.getTotalPotentialProfit();
-
-        double totalSales = 0.0;
-        for (const auto *transaction : transactions)
-        {
-            if (transaction->getStatus() == TransactionStatus::COMPLETED)
-            {
-                totalSales += transaction->getFinalTotal();
-            }
-        }
-
-        std::cout << "INVENTORY:" << std::endl;
-        std::cout << "Total Inventory Value: $" << std::fixed << std::setprecision(2)
-                  << totalInventoryValue << std::endl;
-        std::cout << "Total Inventory Cost: $" << std::fixed << std::setprecision(2)
-                  << totalInventoryCost << std::endl;
-        std::cout << "Potential Profit: $" << std::fixed << std::setprecision(2)
-                  << potentialProfit << std::endl;
-
-        if (totalInventoryCost > 0)
-        {
-            double profitMargin = (potentialProfit / totalInventoryCost) * 100;
-            std::cout << "Profit Margin: " << std::fixed << std::setprecision(1)
-                      << profitMargin << "%" << std::endl;
-        }
-
-        std::cout << "\nSALES:" << std::endl;
-        std::cout << "Total Sales Revenue: $" << std::fixed << std::setprecision(2)
-                  << totalSales << std::endl;
-
-        std::cout << "\nCUSTOMERS:" << std::endl;
-        std::cout << "Total Customer Spending: $" << std::fixed << std::setprecision(2)
-                  << customerDB.getTotalCustomerSpending() << std::endl;
-
-        std::cout << std::string(60, '=') << std::endl
-                  << std::endl;
-    }
-
-    void handleSettingsMenu()
-    {
-        int choice;
-        do
-        {
-            std::cout << "\n--- SETTINGS ---" << std::endl;
-            std::cout << "1. Change Cashier ID" << std::endl;
-            std::cout << "2. System Information" << std::endl;
-            std::cout << "3. Data Management" << std::endl;
-            std::cout << "0. Back to Main Menu" << std::endl;
-            std::cout << "Choose an option: ";
-            std::cin >> choice;
-
-            switch (choice)
-            {
-            case 1:
-                changeCashierId();
-                break;
-            case 2:
-                showSystemInfo();
-                break;
-            case 3:
-                handleDataManagement();
-                break;
-            }
-        } while (choice != 0);
-    }
-
-    void changeCashierId()
-    {
-        std::cout << "\nCurrent Cashier ID: " << currentCashierId << std::endl;
-        std::cout << "Enter new Cashier ID: ";
-        std::cin >> currentCashierId;
-        std::cout << "  Cashier ID updated to: " << currentCashierId << std::endl;
-    }
-
-    void showSystemInfo()
-    {
-        std::cout << "\n--- SYSTEM INFORMATION ---" << std::endl;
-        std::cout << "System: Advanced Convenience Store Management System" << std::endl;
-        std::cout << "Version: 2.0" << std::endl;
-        std::cout << "Current Cashier: " << currentCashierId << std::endl;
-        std::cout << "Products in System: " << inventory.getTotalProductCount() << std::endl;
-        std::cout << "Customers in System: " << customerDB.getTotalCustomerCount() << std::endl;
-        std::cout << "Total Transactions: " << transactions.size() << std::endl;
-    }
-
-    void handleDataManagement()
-    {
-        std::cout << "\n--- DATA MANAGEMENT ---" << std::endl;
-        std::cout << "1. Export Data (Placeholder)" << std::endl;
-        std::cout << "2. Import Data (Placeholder)" << std::endl;
-        std::cout << "3. Backup System (Placeholder)" << std::endl;
-        std::cout << "Note: Data management features would be implemented" << std::endl;
-        std::cout << "with file I/O operations in a complete system." << std::endl;
-    }
-};
-
-int main()
-{
-    try
-    {
-        ConvenienceStoreApp app;
-        app.run();
-    }
-    catch (const std::exception &e)
-    {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return 1;
-    }
-
-    return 0;
-}
\ No newline at end of file
+// ===== Main.cpp =====
+#include "Store.h"
+#include "ReceiptExporter.h"
+#include "CommandProcessor.h"
+#include "NullBuffer.h"
+#include "LatencyHistogram.h"
+#include "Tracing.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+/**
+ * @brief Command-line settings for how the store is opened
+ */
+struct StoreOptions
+{
+    std::string databasePath;
+    size_t cacheBytes;
+    std::string replicationPath;
+    std::string storeId;
+    std::string journalPath;
+    long residentProducts;     // Negative keeps the inventory's default
+
+    StoreOptions() : cacheBytes(64 * 1024 * 1024), storeId("LOCAL"), residentProducts(-1) {}
+};
+
+static void openStore(Store &store, const StoreOptions &options, bool sampleData)
+{
+    if (!options.databasePath.empty() && !store.openDatabase(options.databasePath, options.cacheBytes))
+    {
+        throw std::runtime_error("cannot open database " + options.databasePath);
+    }
+    if (options.residentProducts >= 0)
+    {
+        store.getInventory().setResidentLimit(static_cast<size_t>(options.residentProducts));
+    }
+    if (sampleData && !store.hasStoredData())
+    {
+        store.loadSampleData();
+    }
+    if (!options.replicationPath.empty() && !store.openReplication(options.replicationPath, options.storeId))
+    {
+        throw std::runtime_error("cannot open replication log " + options.replicationPath);
+    }
+    if (!options.journalPath.empty() && !store.openJournal(options.journalPath))
+    {
+        throw std::runtime_error("cannot open journal " + options.journalPath);
+    }
+}
+
+/**
+ * @brief Main application class for the Convenience Store Management System
+ */
+class ConvenienceStoreApp
+{
+private:
+    Store store;
+    InventoryManager &inventory;
+    CustomerDatabase &customerDB;
+    std::string currentCashierId;
+
+public:
+    explicit ConvenienceStoreApp(const StoreOptions &options)
+        : inventory(store.getInventory()), customerDB(store.getCustomerDatabase()), currentCashierId("CASHIER001")
+    {
+        openStore(store, options, true);
+    }
+
+    void run()
+    {
+        std::cout << "  Welcome to Advanced Convenience Store Management System!" << std::endl;
+
+        int choice;
+        do
+        {
+            displayMainMenu();
+            std::cin >> choice;
+
+            switch (choice)
+            {
+            case 1:
+                handleInventoryMenu();
+                break;
+            case 2:
+                handleCustomerMenu();
+                break;
+            case 3:
+                handleSalesMenu();
+                break;
+            case 4:
+                handleReportsMenu();
+                break;
+            case 5:
+                handleSettingsMenu();
+                break;
+            case 0:
+                std::cout << "Thank you for using CSMS!" << std::endl;
+                break;
+            default:
+                std::cout << "Invalid choice! Please try again." << std::endl;
+            }
+            inventory.trimResident();
+        } while (choice != 0);
+    }
+
+private:
+    void displayMainMenu()
+    {
+        std::cout << "\n"
+                  << std::string(50, '=') << std::endl;
+        std::cout << "    CONVENIENCE STORE MANAGEMENT SYSTEM    " << std::endl;
+        std::cout << std::string(50, '=') << std::endl;
+        std::cout << "1.   Inventory Management" << std::endl;
+        std::cout << "2.   Customer Management" << std::endl;
+        std::cout << "3.   Sales & Transactions" << std::endl;
+        std::cout << "4.   Reports & Analytics" << std::endl;
+        std::cout << "5.   Settings" << std::endl;
+        std::cout << "0.   Exit" << std::endl;
+        std::cout << std::string(50, '=') << std::endl;
+        std::cout << "Choose an option: ";
+    }
+
+    void handleInventoryMenu()
+    {
+        int choice;
+        do
+        {
+            std::cout << "\n--- INVENTORY MANAGEMENT ---" << std::endl;
+            std::cout << "1. View All Products" << std::endl;
+            std::cout << "2. Add New Product" << std::endl;
+            std::cout << "3. Search Products" << std::endl;
+            std::cout << "4. Update Stock" << std::endl;
+            std::cout << "5. Low Stock Alert" << std::endl;
+            std::cout << "6. Inventory Reports" << std::endl;
+            std::cout << "0. Back to Main Menu" << std::endl;
+            std::cout << "Choose an option: ";
+            std::cin >> choice;
+
+            switch (choice)
+            {
+            case 1:
+                inventory.displayAllProducts();
+                break;
+            case 2:
+                addNewProduct();
+                break;
+            case 3:
+                searchProducts();
+                break;
+            case 4:
+                updateStock();
+                break;
+            case 5:
+                inventory.generateLowStockReport();
+                break;
+            case 6:
+                inventory.generateInventoryReport();
+                break;
+            }
+        } while (choice != 0);
+    }
+
+    void addNewProduct()
+    {
+        std::string id, name, desc, supplier;
+        double price, cost;
+        int stock, minStock, maxStock, productType;
+
+        std::cout << "\n--- ADD NEW PRODUCT ---" << std::endl;
+        std::cout << "Product ID: ";
+        std::cin >> id;
+
+        if (inventory.findProduct(id))
+        {
+            std::cout << "Product with ID " << id << " already exists!" << std::endl;
+            return;
+        }
+
+        std::cin.ignore();
+        std::cout << "Product Name: ";
+        std::getline(std::cin, name);
+        std::cout << "Description: ";
+        std::getline(std::cin, desc);
+        std::cout << "Selling Price: $";
+        std::cin >> price;
+        std::cout << "Cost Price: $";
+        std::cin >> cost;
+        std::cout << "Initial Stock: ";
+        std::cin >> stock;
+        std::cout << "Minimum Stock Level: ";
+        std::cin >> minStock;
+        std::cout << "Maximum Stock Level: ";
+        std::cin >> maxStock;
+
+        std::cin.ignore();
+        std::cout << "Supplier: ";
+        std::getline(std::cin, supplier);
+
+        std::cout << "\nProduct Type:" << std::endl;
+        std::cout << "1. Regular Product" << std::endl;
+        std::cout << "2. Perishable Product" << std::endl;
+        std::cout << "3. Bulk Product" << std::endl;
+        std::cout << "Choose type: ";
+        std::cin >> productType;
+
+        std::cout << "\nCategory:" << std::endl;
+        std::cout << "1. Beverages" << std::endl;
+        std::cout << "2. Snacks" << std::endl;
+        std::cout << "3. Dairy" << std::endl;
+        std::cout << "4. Bakery" << std::endl;
+        std::cout << "5. Household" << std::endl;
+        std::cout << "6. Electronics" << std::endl;
+        std::cout << "7. Health & Beauty" << std::endl;
+        std::cout << "8. Other" << std::endl;
+
+        int categoryChoice;
+        std::cout << "Choose category: ";
+        std::cin >> categoryChoice;
+
+        ProductCategory category = static_cast<ProductCategory>(categoryChoice - 1);
+        Product *newProduct = nullptr;
+
+        switch (productType)
+        {
+        case 1:
+        {
+            double markup;
+            std::cout << "Markup Percentage (e.g., 0.3 for 30%): ";
+            std::cin >> markup;
+            newProduct = new RegularProduct(id, name, desc, price, cost, stock,
+                                            category, supplier, markup, minStock, maxStock);
+            break;
+        }
+        case 2:
+        {
+            std::string expDate;
+            int shelfLife;
+            double discount;
+            std::cin.ignore();
+            std::cout << "Expiration Date (YYYY-MM-DD): ";
+            std::getline(std::cin, expDate);
+            std::cout << "Shelf Life (days): ";
+            std::cin >> shelfLife;
+            std::cout << "Near-expiration Discount Rate (e.g., 0.2 for 20%): ";
+            std::cin >> discount;
+            newProduct = new PerishableProduct(id, name, desc, price, cost, stock,
+                                               category, expDate, shelfLife, supplier,
+                                               discount, minStock, maxStock);
+            break;
+        }
+        case 3:
+        {
+            std::string unit;
+            double minQty;
+            std::cin.ignore();
+            std::cout << "Unit (kg, lbs, liters, etc.): ";
+            std::getline(std::cin, unit);
+            std::cout << "Minimum Quantity: ";
+            std::cin >> minQty;
+            newProduct = new BulkProduct(id, name, desc, price, cost, stock,
+                                         category, unit, minQty, supplier, minStock, maxStock);
+            break;
+        }
+        default:
+            std::cout << "Invalid product type!" << std::endl;
+            return;
+        }
+
+        if (newProduct && inventory.addProduct(newProduct))
+        {
+            std::cout << "  Product added successfully!" << std::endl;
+        }
+        else
+        {
+            std::cout << "  Failed to add product!" << std::endl;
+            delete newProduct;
+        }
+    }
+
+    void searchProducts()
+    {
+        std::string searchTerm;
+        std::cout << "\nEnter search term (name or tag): ";
+        std::cin.ignore();
+        std::getline(std::cin, searchTerm);
+
+        auto nameResults = inventory.findProductsByName(searchTerm);
+        auto tagResults = inventory.findProductsByTag(searchTerm);
+
+        std::cout << "\n--- SEARCH RESULTS ---" << std::endl;
+
+        if (!nameResults.empty())
+        {
+            std::cout << "Products matching name:" << std::endl;
+            for (Product *product : nameResults)
+            {
+                std::cout << "  " << product->getId() << " - " << product->getName()
+                          << " ($" << std::fixed << std::setprecision(2)
+                          << store.getPriceBook().getPrice(*product) << ")" << std::endl;
+            }
+        }
+
+        if (!tagResults.empty())
+        {
+            std::cout << "Products matching tag:" << std::endl;
+            for (Product *product : tagResults)
+            {
+                std::cout << "  " << product->getId() << " - " << product->getName()
+                          << " ($" << std::fixed << std::setprecision(2)
+                          << store.getPriceBook().getPrice(*product) << ")" << std::endl;
+            }
+        }
+
+        if (nameResults.empty() && tagResults.empty())
+        {
+            std::cout << "No products found matching: " << searchTerm << std::endl;
+        }
+    }
+
+    void updateStock()
+    {
+        std::string productId;
+        int quantity;
+        char operation;
+
+        std::cout << "\nProduct ID: ";
+        std::cin >> productId;
+
+        Product *product = inventory.findProduct(productId);
+        if (!product)
+        {
+            std::cout << "Product not found!" << std::endl;
+            return;
+        }
+
+        std::cout << "Current Stock: " << product->getCurrentStock() << std::endl;
+        std::cout << "Operation (+ to add, - to remove): ";
+        std::cin >> operation;
+        std::cout << "Quantity: ";
+        std::cin >> quantity;
+
+        if (operation == '+')
+        {
+            if (quantity > product->getFreeCapacity())
+            {
+                std::cout << "  Only " << std::max(0, product->getFreeCapacity()) << " units of room (max "
+                          << product->getMaxStockLevel() << ")!" << std::endl;
+            }
+            else if (product->addStock(quantity) > 0)
+            {
+                inventory.recordStockChange(*product);
+                std::cout << "  Stock added! New stock: " << product->getCurrentStock() << std::endl;
+            }
+            else
+            {
+                std::cout << "  Invalid quantity!" << std::endl;
+            }
+        }
+        else if (operation == '-')
+        {
+            if (product->reduceStock(quantity))
+            {
+                inventory.recordStockChange(*product);
+                std::cout << "  Stock reduced! New stock: " << product->getCurrentStock() << std::endl;
+            }
+            else
+            {
+                std::cout << "  Insufficient stock!" << std::endl;
+            }
+        }
+        else
+        {
+            std::cout << "Invalid operation!" << std::endl;
+        }
+    }
+
+    void handleCustomerMenu()
+    {
+        int choice;
+        do
+        {
+            std::cout << "\n--- CUSTOMER MANAGEMENT ---" << std::endl;
+            std::cout << "1. View All Customers" << std::endl;
+            std::cout << "2. Add New Customer" << std::endl;
+            std::cout << "3. Search Customer" << std::endl;
+            std::cout << "4. Customer Details" << std::endl;
+            std::cout << "5. Customer Statistics" << std::endl;
+            std::cout << "0. Back to Main Menu" << std::endl;
+            std::cout << "Choose an option: ";
+            std::cin >> choice;
+
+            switch (choice)
+            {
+            case 1:
+                customerDB.displayAllCustomers();
+                break;
+            case 2:
+                addNewCustomer();
+                break;
+            case 3:
+                searchCustomer();
+                break;
+            case 4:
+                viewCustomerDetails();
+                break;
+            case 5:
+                customerDB.displayCustomerStatistics();
+                break;
+            }
+        } while (choice != 0);
+    }
+
+    void addNewCustomer()
+    {
+        std::string firstName, lastName, email, phone;
+        int typeChoice;
+
+        std::cout << "\n--- ADD NEW CUSTOMER ---" << std::endl;
+        std::cin.ignore();
+        std::cout << "First Name: ";
+        std::getline(std::cin, firstName);
+        std::cout << "Last Name: ";
+        std::getline(std::cin, lastName);
+        std::cout << "Email: ";
+        std::getline(std::cin, email);
+        std::cout << "Phone: ";
+        std::getline(std::cin, phone);
+
+        std::cout << "\nCustomer Type:" << std::endl;
+        std::cout << "1. Regular" << std::endl;
+        std::cout << "2. Premium" << std::endl;
+        std::cout << "3. VIP" << std::endl;
+        std::cout << "4. Employee" << std::endl;
+        std::cout << "Choose type: ";
+        std::cin >> typeChoice;
+
+        CustomerType type = static_cast<CustomerType>(typeChoice - 1);
+        Customer *customer = customerDB.addCustomer(firstName, lastName, email, phone, type);
+
+        if (customer)
+        {
+            std::cout << "  Customer added successfully! ID: " << customer->getId() << std::endl;
+        }
+        else
+        {
+            std::cout << "  Failed to add customer!" << std::endl;
+        }
+    }
+
+    void searchCustomer()
+    {
+        std::string searchTerm;
+        int searchType;
+
+        std::cout << "\nSearch by:" << std::endl;
+        std::cout << "1. Customer ID" << std::endl;
+        std::cout << "2. Email" << std::endl;
+        std::cout << "3. Phone" << std::endl;
+        std::cout << "Choose search type: ";
+        std::cin >> searchType;
+
+        std::cin.ignore();
+        std::cout << "Enter search term: ";
+        std::getline(std::cin, searchTerm);
+
+        Customer *customer = nullptr;
+
+        switch (searchType)
+        {
+        case 1:
+            customer = customerDB.findCustomer(searchTerm);
+            break;
+        case 2:
+            customer = customerDB.findCustomerByEmail(searchTerm);
+            break;
+        case 3:
+            customer = customerDB.findCustomerByPhone(searchTerm);
+            break;
+        default:
+            std::cout << "Invalid search type!" << std::endl;
+            return;
+        }
+
+        if (customer)
+        {
+            customer->displayInfo();
+        }
+        else
+        {
+            std::cout << "Customer not found!" << std::endl;
+        }
+    }
+
+    void viewCustomerDetails()
+    {
+        std::string customerId;
+        std::cout << "\nEnter Customer ID: ";
+        std::cin >> customerId;
+
+        Customer *customer = customerDB.findCustomer(customerId);
+        if (customer)
+        {
+            customer->displayInfo();
+        }
+        else
+        {
+            std::cout << "Customer not found!" << std::endl;
+        }
+    }
+
+    void handleSalesMenu()
+    {
+        int choice;
+        do
+        {
+            std::cout << "\n--- SALES & TRANSACTIONS ---" << std::endl;
+            std::cout << "1. New Transaction" << std::endl;
+            std::cout << "2. View Transaction History" << std::endl;
+            std::cout << "3. Process Refund" << std::endl;
+            std::cout << "4. Transaction Details" << std::endl;
+            std::cout << "0. Back to Main Menu" << std::endl;
+            std::cout << "Choose an option: ";
+            std::cin >> choice;
+
+            switch (choice)
+            {
+            case 1:
+                processNewTransaction();
+                break;
+            case 2:
+                viewTransactionHistory();
+                break;
+            case 3:
+                processRefund();
+                break;
+            case 4:
+                viewTransactionDetails();
+                break;
+            }
+        } while (choice != 0);
+    }
+
+    void processNewTransaction()
+    {
+        std::cout << "\n--- NEW TRANSACTION ---" << std::endl;
+
+        // Check if customer wants to provide customer info
+        char hasCustomer;
+        std::cout << "Is this for a registered customer? (y/n): ";
+        std::cin >> hasCustomer;
+
+        Customer *customer = nullptr;
+        if (hasCustomer == 'y' || hasCustomer == 'Y')
+        {
+            std::string customerId;
+            std::cout << "Enter Customer ID: ";
+            std::cin >> customerId;
+            customer = customerDB.findCustomer(customerId);
+
+            if (!customer)
+            {
+                std::cout << "Customer not found! Proceeding without customer..." << std::endl;
+            }
+            else
+            {
+                std::cout << "Customer: " << customer->getFullName()
+                          << " (" << customer->getTypeString() << ")" << std::endl;
+            }
+        }
+
+        Transaction *transaction = store.openTransaction(customer, currentCashierId);
+
+        // Add items to transaction
+        std::string productId;
+        while (true)
+        {
+            std::cout << "\nEnter Product ID (or 'done' to finish): ";
+            std::cin >> productId;
+
+            if (productId == "done")
+                break;
+
+            Product *product = inventory.findProduct(productId);
+            if (!product)
+            {
+                std::cout << "Product not found!" << std::endl;
+                continue;
+            }
+
+            if (!product->getIsActive())
+            {
+                std::cout << "Product is not active!" << std::endl;
+                continue;
+            }
+
+            std::cout << "Product: " << product->getName()
+                      << " ($" << std::fixed << std::setprecision(2)
+                      << transaction->getPriceVersion()->priceOf(*product) << ")" << std::endl;
+            std::cout << "Available Stock: " << product->getAvailableStock() << std::endl;
+
+            double quantity;
+            std::cout << "Quantity: ";
+            std::cin >> quantity;
+
+            double discount = 0.0;
+            char applyDiscount;
+            std::cout << "Apply manual discount? (y/n): ";
+            std::cin >> applyDiscount;
+
+            if (applyDiscount == 'y' || applyDiscount == 'Y')
+            {
+                std::cout << "Discount percentage (0.1 for 10%): ";
+                std::cin >> discount;
+            }
+
+            if (transaction->addItem(product, quantity, discount))
+            {
+                std::cout << "  Item added to transaction!" << std::endl;
+            }
+            else
+            {
+                std::cout << "  Failed to add item!" << std::endl;
+            }
+        }
+
+        if (transaction->getItems().empty())
+        {
+            std::cout << "No items in transaction. Cancelling..." << std::endl;
+            delete transaction;
+            return;
+        }
+
+        // Apply loyalty points if customer exists
+        if (customer && customer->getLoyaltyPoints() > 0)
+        {
+            char useLoyalty;
+            std::cout << "\nCustomer has " << customer->getLoyaltyPoints()
+                      << " loyalty points. Use them? (y/n): ";
+            std::cin >> useLoyalty;
+
+            if (useLoyalty == 'y' || useLoyalty == 'Y')
+            {
+                double pointsToUse;
+                std::cout << "Points to use (max " << customer->getLoyaltyPoints() << "): ";
+                std::cin >> pointsToUse;
+
+                if (pointsToUse > 0 && pointsToUse <= customer->getLoyaltyPoints())
+                {
+                    transaction->applyLoyaltyPoints(pointsToUse);
+                }
+            }
+        }
+
+        // Calculate totals
+        store.priceTransaction(transaction);
+
+        // Show transaction summary
+        std::cout << "\n--- TRANSACTION SUMMARY ---" << std::endl;
+        std::cout << "Subtotal: $" << std::fixed << std::setprecision(2)
+                  << transaction->getSubtotal() << std::endl;
+        std::cout << "Tax" << (transaction->isTaxIncluded() ? " (included)" : "") << ": $"
+                  << std::fixed << std::setprecision(2) << transaction->getTax() << std::endl;
+        std::cout << "Total: $" << std::fixed << std::setprecision(2)
+                  << transaction->getFinalTotal() << std::endl;
+
+        // Process payment
+        std::cout << "\nPayment Method:" << std::endl;
+        std::cout << "1. Cash" << std::endl;
+        std::cout << "2. Credit Card" << std::endl;
+        std::cout << "3. Debit Card" << std::endl;
+        std::cout << "4. Mobile Payment" << std::endl;
+        std::cout << "Choose payment method: ";
+
+        int paymentChoice;
+        std::cin >> paymentChoice;
+
+        PaymentMethod method = static_cast<PaymentMethod>(paymentChoice - 1);
+
+        double amountPaid = 0.0;
+        if (method == PaymentMethod::CASH)
+        {
+            std::cout << "Amount paid: $";
+            std::cin >> amountPaid;
+        }
+        else
+        {
+            amountPaid = transaction->getFinalTotal();
+        }
+
+        if (store.completeSale(transaction, method, amountPaid))
+        {
+
+            // Print receipt
+            transaction->printReceipt();
+
+            // Show change for cash payments
+            if (method == PaymentMethod::CASH && amountPaid > transaction->getFinalTotal())
+            {
+                std::cout << "Change: $" << std::fixed << std::setprecision(2)
+                          << (amountPaid - transaction->getFinalTotal()) << std::endl;
+            }
+
+            std::cout << "  Transaction completed successfully!" << std::endl;
+        }
+        else
+        {
+            std::cout << "  Payment failed!" << std::endl;
+            delete transaction;
+        }
+    }
+
+    void viewTransactionHistory()
+    {
+        std::cout << "\n--- TRANSACTION HISTORY ---" << std::endl;
+
+        const auto &transactions = store.getTransactions();
+        if (transactions.empty())
+        {
+            std::cout << "No transactions found." << std::endl;
+            return;
+        }
+
+        for (const auto *transaction : transactions)
+        {
+            std::cout << "ID: " << transaction->getId()
+                      << " | Total: $" << std::fixed << std::setprecision(2)
+                      << transaction->getFinalTotal()
+                      << " | Payment: " << transaction->getPaymentMethodString()
+                      << " | Status: " << transaction->getStatusString();
+
+            if (transaction->getCustomer())
+            {
+                std::cout << " | Customer: " << transaction->getCustomer()->getFullName();
+            }
+
+            std::time_t timestamp = transaction->getTimestamp();
+            std::cout << " | Time: " << std::ctime(&timestamp);
+        }
+    }
+
+    void processRefund()
+    {
+        int transactionId;
+        std::cout << "\nEnter Transaction ID: ";
+        std::cin >> transactionId;
+
+        Transaction *transaction = store.findTransaction(transactionId);
+        if (!transaction)
+        {
+            if (store.getArchive().findTransaction(transactionId, [](const ArchivedTransaction &) {}))
+            {
+                std::cout << "Transaction is archived; archived sales cannot be refunded." << std::endl;
+            }
+            else
+            {
+                std::cout << "Transaction not found!" << std::endl;
+            }
+            return;
+        }
+
+        if (store.getRefunds().getRefundCount(transactionId) > 0)
+        {
+            store.getRefunds().displayRefundHistory(transactionId);
+        }
+
+        if (!transaction->canRefund())
+        {
+            std::cout << "Only completed transactions with a refundable balance can be refunded!" << std::endl;
+            return;
+        }
+
+        std::cout << "Transaction Total: $" << std::fixed << std::setprecision(2)
+                  << transaction->getFinalTotal() << std::endl;
+        std::cout << "Refundable Balance: $" << std::fixed << std::setprecision(2)
+                  << transaction->getRefundableAmount() << std::endl;
+
+        std::cout << "\nRefund type:" << std::endl;
+        std::cout << "1. Full refund" << std::endl;
+        std::cout << "2. Return items" << std::endl;
+        std::cout << "3. Refund amount (no items returned)" << std::endl;
+        std::cout << "Choose refund type: ";
+
+        int refundType;
+        std::cin >> refundType;
+
+        RefundRecord record;
+        bool success = false;
+
+        switch (refundType)
+        {
+        case 1:
+            success = transaction->processRefund(-1.0, &record);
+            break;
+        case 2:
+        {
+            const auto &items = transaction->getItems();
+            for (size_t i = 0; i < items.size(); ++i)
+            {
+                if (items[i].product && items[i].getRefundableQuantity() > 0)
+                {
+                    std::cout << (i + 1) << ". " << items[i].product->getName()
+                              << " (returnable: " << items[i].getRefundableQuantity() << ")" << std::endl;
+                }
+            }
+
+            std::vector<std::pair<int, double>> returns;
+            while (true)
+            {
+                int itemNumber;
+                std::cout << "Item number to return (0 when done): ";
+                std::cin >> itemNumber;
+                if (itemNumber == 0)
+                    break;
+
+                double quantity;
+                std::cout << "Quantity: ";
+                std::cin >> quantity;
+                returns.push_back(std::make_pair(itemNumber - 1, quantity));
+            }
+            success = !returns.empty() && transaction->processItemRefunds(returns, &record);
+            break;
+        }
+        case 3:
+        {
+            double refundAmount;
+            std::cout << "Refund amount: $";
+            std::cin >> refundAmount;
+            success = transaction->processRefund(refundAmount, &record);
+            break;
+        }
+        default:
+            std::cout << "Invalid refund type!" << std::endl;
+            return;
+        }
+
+        if (success)
+        {
+            const RefundRecord *stored = store.recordRefund(transaction, record);
+            std::cout << "  Refund #" << stored->refundId << " processed: $" << std::fixed
+                      << std::setprecision(2) << stored->amount << " (status: "
+                      << transaction->getStatusString() << ")" << std::endl;
+        }
+        else
+        {
+            std::cout << "  Refund failed!" << std::endl;
+        }
+    }
+
+    void viewTransactionDetails()
+    {
+        int transactionId;
+        std::cout << "\nEnter Transaction ID: ";
+        std::cin >> transactionId;
+
+        Transaction *transaction = store.findTransaction(transactionId);
+        if (transaction)
+        {
+            transaction->printDetailedReceipt();
+            if (store.getRefunds().getRefundCount(transactionId) > 0)
+            {
+                store.getRefunds().displayRefundHistory(transactionId);
+            }
+        }
+        else if (!store.getArchive().renderReceipt(transactionId, std::cout))
+        {
+            std::cout << "Transaction not found!" << std::endl;
+        }
+    }
+
+    void handleReportsMenu()
+    {
+        int choice;
+        do
+        {
+            std::cout << "\n--- REPORTS & ANALYTICS ---" << std::endl;
+            std::cout << "1. Inventory Report" << std::endl;
+            std::cout << "2. Sales Report" << std::endl;
+            std::cout << "3. Customer Analytics" << std::endl;
+            std::cout << "4. Low Stock Alert" << std::endl;
+            std::cout << "5. Financial Summary" << std::endl;
+            std::cout << "6. Memory Usage" << std::endl;
+            std::cout << "7. Sales by Period" << std::endl;
+            std::cout << "8. Sales Cube Query" << std::endl;
+            std::cout << "9. Market Basket Analysis" << std::endl;
+            std::cout << "10. Live Sales Dashboard" << std::endl;
+            std::cout << "11. Recent Window vs Yesterday" << std::endl;
+            std::cout << "0. Back to Main Menu" << std::endl;
+            std::cout << "Choose an option: ";
+            std::cin >> choice;
+
+            switch (choice)
+            {
+            case 1:
+                inventory.generateInventoryReport();
+                break;
+            case 2:
+                store.generateSalesReport();
+                break;
+            case 3:
+                store.generateCustomerAnalytics();
+                break;
+            case 4:
+                inventory.generateLowStockReport();
+                break;
+            case 5:
+                store.generateFinancialSummary();
+                break;
+            case 6:
+                store.generateMemoryReport();
+                break;
+            case 7:
+                handlePeriodReport();
+                break;
+            case 8:
+                handleCubeQuery();
+                break;
+            case 9:
+                handleBasketAnalysis();
+                break;
+            case 10:
+                store.generateLiveDashboard();
+                break;
+            case 11:
+                handleWindowComparison();
+                break;
+            }
+        } while (choice != 0);
+    }
+
+    void handleWindowComparison()
+    {
+        int minutes;
+        std::cout << "Window length in minutes (1-1440): ";
+        std::cin >> minutes;
+        if (minutes < 1 || minutes > 1440)
+        {
+            std::cout << "Invalid window length!" << std::endl;
+            return;
+        }
+        store.generateWindowComparison(minutes);
+    }
+
+    void handlePeriodReport()
+    {
+        int choice;
+        std::cout << "\n1. Today" << std::endl;
+        std::cout << "2. This Week" << std::endl;
+        std::cout << "3. Last 30 Days" << std::endl;
+        std::cout << "Choose a period: ";
+        std::cin >> choice;
+
+        switch (choice)
+        {
+        case 1:
+            store.generatePeriodReport(ReportPeriod::TODAY);
+            break;
+        case 2:
+            store.generatePeriodReport(ReportPeriod::THIS_WEEK);
+            break;
+        case 3:
+            store.generatePeriodReport(ReportPeriod::LAST_30_DAYS);
+            break;
+        default:
+            std::cout << "Invalid period!" << std::endl;
+        }
+    }
+
+    void handleCubeQuery()
+    {
+        std::string groupBy;
+        std::string filters;
+        std::cout << "\nDimensions: product, category, supplier, hour, customer, payment, store" << std::endl;
+        std::cout << "Group by (comma-separated, - for totals): ";
+        std::cin >> groupBy;
+        std::cin.ignore();
+        std::cout << "Filters (e.g. customer=vip,premium hour=17 limit=10; blank for none): ";
+        std::getline(std::cin, filters);
+
+        std::vector<std::string> args = CommandProcessor::tokenize(filters);
+        args.insert(args.begin(), groupBy);
+
+        const SalesCube &cube = store.getSalesCube();
+        CubeQuery query;
+        std::string error;
+        if (!cube.parseQuery(args, query, error))
+        {
+            std::cout << "Invalid query: " << error << std::endl;
+            return;
+        }
+        cube.display(query, cube.query(query), std::cout);
+    }
+
+    void handleBasketAnalysis()
+    {
+        int choice;
+        do
+        {
+            std::cout << "\n--- MARKET BASKET ANALYSIS ---" << std::endl;
+            std::cout << "1. Run Analysis" << std::endl;
+            std::cout << "2. Frequent Itemsets" << std::endl;
+            std::cout << "3. Association Rules" << std::endl;
+            std::cout << "4. Also Bought (by product)" << std::endl;
+            std::cout << "0. Back" << std::endl;
+            std::cout << "Choose an option: ";
+            std::cin >> choice;
+
+            const MarketBasketAnalysis &analysis = store.getBasketAnalysis();
+            if (choice >= 2 && choice <= 4 && !analysis.hasResults())
+            {
+                std::cout << "Run the analysis first." << std::endl;
+                continue;
+            }
+
+            switch (choice)
+            {
+            case 1:
+            {
+                MarketBasketConfig config;
+                double supportPercent;
+                double confidencePercent;
+                std::cout << "Minimum support (% of baskets): ";
+                std::cin >> supportPercent;
+                std::cout << "Minimum confidence (%): ";
+                std::cin >> confidencePercent;
+                if (supportPercent <= 0 || supportPercent > 100 || confidencePercent < 0)
+                {
+                    std::cout << "Invalid thresholds!" << std::endl;
+                    break;
+                }
+                config.minSupport = supportPercent / 100.0;
+                config.minConfidence = confidencePercent / 100.0;
+                store.runBasketAnalysis(config);
+                break;
+            }
+            case 2:
+                analysis.displayItemsets(std::cout, 20);
+                break;
+            case 3:
+                analysis.displayRules(std::cout, 20);
+                break;
+            case 4:
+            {
+                std::string productId;
+                std::cout << "Product ID: ";
+                std::cin >> productId;
+                analysis.displayAlsoBought(std::cout, productId, 10);
+                break;
+            }
+            }
+        } while (choice != 0);
+    }
+
+    void handleSettingsMenu()
+    {
+        int choice;
+        do
+        {
+            std::cout << "\n--- SETTINGS ---" << std::endl;
+            std::cout << "1. Change Cashier ID" << std::endl;
+            std::cout << "2. System Information" << std::endl;
+            std::cout << "3. Data Management" << std::endl;
+            std::cout << "4. Tax Jurisdiction" << std::endl;
+            std::cout << "5. Latency Metrics" << std::endl;
+            std::cout << "6. Transaction Tracing" << std::endl;
+            std::cout << "0. Back to Main Menu" << std::endl;
+            std::cout << "Choose an option: ";
+            std::cin >> choice;
+
+            switch (choice)
+            {
+            case 1:
+                changeCashierId();
+                break;
+            case 2:
+                showSystemInfo();
+                break;
+            case 3:
+                handleDataManagement();
+                break;
+            case 4:
+                changeTaxJurisdiction();
+                break;
+            case 5:
+                handleLatencyMetrics();
+                break;
+            case 6:
+                handleTracing();
+                break;
+            }
+        } while (choice != 0);
+    }
+
+    void changeCashierId()
+    {
+        std::cout << "\nCurrent Cashier ID: " << currentCashierId << std::endl;
+        std::cout << "Enter new Cashier ID: ";
+        std::cin >> currentCashierId;
+        std::cout << "  Cashier ID updated to: " << currentCashierId << std::endl;
+    }
+
+    void changeTaxJurisdiction()
+    {
+        store.getTaxTable().displayRates();
+        std::cout << "Current Jurisdiction: " << store.getCurrentJurisdiction().code << std::endl;
+        std::cout << "Choose jurisdiction: ";
+
+        int choice;
+        std::cin >> choice;
+        if (store.setJurisdiction(choice - 1))
+        {
+            std::cout << "  Jurisdiction set to: " << store.getCurrentJurisdiction().code << std::endl;
+        }
+        else
+        {
+            std::cout << "Invalid jurisdiction!" << std::endl;
+        }
+    }
+
+    void showSystemInfo()
+    {
+        std::cout << "\n--- SYSTEM INFORMATION ---" << std::endl;
+        std::cout << "System: Advanced Convenience Store Management System" << std::endl;
+        std::cout << "Version: 2.0" << std::endl;
+        std::cout << "Current Cashier: " << currentCashierId << std::endl;
+        std::cout << "Tax Jurisdiction: " << store.getCurrentJurisdiction().code << std::endl;
+        std::cout << "Products in System: " << inventory.getTotalProductCount() << std::endl;
+        std::cout << "Customers in System: " << customerDB.getTotalCustomerCount() << std::endl;
+        std::cout << "Total Transactions: " << store.getTransactions().size() << std::endl;
+        std::cout << "Latency Metrics: " << (LatencyMetrics::isEnabled() ? "On" : "Off") << std::endl;
+        std::cout << "Tracing: " << (Tracing::isEnabled() ? "On" : "Off")
+                  << " (" << Tracing::getRecordedCount() << " spans buffered)" << std::endl;
+        LatencyMetrics::displaySummary(std::cout);
+    }
+
+    void handleLatencyMetrics()
+    {
+        std::cout << "\n--- LATENCY METRICS ---" << std::endl;
+        LatencyMetrics::displaySummary(std::cout);
+        std::cout << "\n1. " << (LatencyMetrics::isEnabled() ? "Disable" : "Enable") << " Recording" << std::endl;
+        std::cout << "2. Dump Histograms to File" << std::endl;
+        std::cout << "0. Back" << std::endl;
+        std::cout << "Choose an option: ";
+
+        int choice;
+        std::cin >> choice;
+
+        if (choice == 1)
+        {
+            if (!LatencyMetrics::isCompiledIn())
+            {
+                std::cout << "Rebuild with METRICS=1 to enable latency metrics." << std::endl;
+                return;
+            }
+            LatencyMetrics::setEnabled(!LatencyMetrics::isEnabled());
+            std::cout << "  Latency recording " << (LatencyMetrics::isEnabled() ? "enabled" : "disabled") << std::endl;
+        }
+        else if (choice == 2)
+        {
+            std::string path;
+            std::cout << "Output file: ";
+            std::cin >> path;
+            if (LatencyMetrics::dumpToFile(path))
+            {
+                std::cout << "  Histograms written to " << path << std::endl;
+            }
+            else
+            {
+                std::cout << "  Could not write " << path << std::endl;
+            }
+        }
+    }
+
+    void handleTracing()
+    {
+        std::cout << "\n--- TRANSACTION TRACING ---" << std::endl;
+        std::cout << "Tracing: " << (Tracing::isEnabled() ? "On" : "Off")
+                  << " (" << Tracing::getRecordedCount() << " spans buffered)" << std::endl;
+        std::cout << "1. " << (Tracing::isEnabled() ? "Disable" : "Enable") << " Tracing" << std::endl;
+        std::cout << "2. Export Chrome Trace (JSON)" << std::endl;
+        std::cout << "0. Back" << std::endl;
+        std::cout << "Choose an option: ";
+
+        int choice;
+        std::cin >> choice;
+
+        if (choice == 1)
+        {
+            if (!Tracing::isCompiledIn())
+            {
+                std::cout << "Rebuild with TRACING=1 to enable tracing." << std::endl;
+                return;
+            }
+            Tracing::setEnabled(!Tracing::isEnabled());
+            std::cout << "  Tracing " << (Tracing::isEnabled() ? "enabled" : "disabled") << std::endl;
+        }
+        else if (choice == 2)
+        {
+            std::string path;
+            std::cout << "Output file: ";
+            std::cin >> path;
+            if (Tracing::exportChromeTrace(path))
+            {
+                std::cout << "  Trace written to " << path << " (open in chrome://tracing or Perfetto)" << std::endl;
+            }
+            else
+            {
+                std::cout << "  Could not write " << path << std::endl;
+            }
+        }
+    }
+
+    void handleDataManagement()
+    {
+        std::cout << "\n--- DATA MANAGEMENT ---" << std::endl;
+        std::cout << "1. Export Receipts (Text)" << std::endl;
+        std::cout << "2. Export Receipts (Detailed Text)" << std::endl;
+        std::cout << "3. Export Receipts (JSON Lines)" << std::endl;
+        std::cout << "4. Import Data (Placeholder)" << std::endl;
+        std::cout << "5. Backup System (Placeholder)" << std::endl;
+        std::cout << "6. Save to Database" << std::endl;
+        std::cout << "7. Storage Statistics" << std::endl;
+        std::cout << "8. Archive Closed Days" << std::endl;
+        std::cout << "9. Replication Status" << std::endl;
+        std::cout << "10. Journal Status" << std::endl;
+        std::cout << "0. Back" << std::endl;
+        std::cout << "Choose an option: ";
+
+        int choice;
+        std::cin >> choice;
+
+        if (choice >= 1 && choice <= 3)
+        {
+            exportReceipts(choice == 1 ? ReceiptFormat::TEXT
+                           : choice == 2 ? ReceiptFormat::DETAILED
+                                         : ReceiptFormat::JSON_LINES);
+        }
+        else if (choice == 4 || choice == 5)
+        {
+            std::cout << "Note: Import and backup would be implemented" << std::endl;
+            std::cout << "with file I/O operations in a complete system." << std::endl;
+        }
+        else if (choice == 6)
+        {
+            store.syncDatabase();
+            store.generateStorageReport();
+        }
+        else if (choice == 7)
+        {
+            store.generateStorageReport();
+        }
+        else if (choice == 8)
+        {
+            int archived = store.archiveClosedDays(std::time(nullptr));
+            std::cout << "  Archived " << archived << " transactions from closed days." << std::endl;
+            store.generateArchiveReport();
+        }
+        else if (choice == 9)
+        {
+            store.generateReplicationReport();
+        }
+        else if (choice == 10)
+        {
+            store.syncJournal();
+            store.generateJournalReport();
+        }
+    }
+
+    void exportReceipts(ReceiptFormat format)
+    {
+        std::string path;
+        std::cout << "Output file: ";
+        std::cin >> path;
+
+        ReceiptExporter exporter;
+        if (!exporter.open(path, format))
+        {
+            std::cout << "  Could not open " << path << std::endl;
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        exporter.exportAll(store.getTransactions());
+        bool written = exporter.close();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (!written)
+        {
+            std::cout << "  Write to " << path << " failed; the export is incomplete" << std::endl;
+            return;
+        }
+
+        std::cout << "  Exported " << exporter.getReceiptsWritten() << " receipts ("
+                  << exporter.getBytesWritten() << " bytes) in " << std::fixed << std::setprecision(3)
+                  << seconds << "s" << std::endl;
+    }
+};
+
+static int runScript(const std::string &path, bool quiet, bool sampleData, const StoreOptions &options)
+{
+    std::ifstream file;
+    if (path == "-")
+    {
+        std::ios::sync_with_stdio(false);
+    }
+    else
+    {
+        file.open(path);
+        if (!file)
+        {
+            std::cerr << "Error: cannot open script " << path << std::endl;
+            return 1;
+        }
+    }
+    std::istream &input = (path == "-") ? std::cin : file;
+
+    Store store;
+    openStore(store, options, sampleData);
+
+    CommandProcessor processor(store);
+    NullBuffer discard;
+    std::streambuf *original = quiet ? std::cout.rdbuf(&discard) : nullptr;
+    processor.run(input, std::cerr);
+    if (original)
+    {
+        std::cout.rdbuf(original);
+    }
+
+    processor.printSummary(std::cout);
+    return processor.getStats().errors > 0 ? 2 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string scriptPath;
+    bool quiet = false;
+    bool sampleData = true;
+    std::string metricsPath;
+    std::string tracePath;
+    StoreOptions options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--script" && i + 1 < argc)
+        {
+            scriptPath = argv[++i];
+        }
+        else if (arg == "--quiet")
+        {
+            quiet = true;
+        }
+        else if (arg == "--no-sample-data")
+        {
+            sampleData = false;
+        }
+        else if (arg == "--metrics")
+        {
+            LatencyMetrics::setEnabled(true);
+        }
+        else if (arg == "--metrics-out" && i + 1 < argc)
+        {
+            LatencyMetrics::setEnabled(true);
+            metricsPath = argv[++i];
+        }
+        else if (arg == "--trace-out" && i + 1 < argc)
+        {
+            Tracing::setEnabled(true);
+            tracePath = argv[++i];
+        }
+        else if (arg == "--db" && i + 1 < argc)
+        {
+            options.databasePath = argv[++i];
+        }
+        else if (arg == "--cache-mb" && i + 1 < argc)
+        {
+            options.cacheBytes = static_cast<size_t>(std::max(1, std::atoi(argv[++i]))) * 1024 * 1024;
+        }
+        else if (arg == "--resident" && i + 1 < argc)
+        {
+            options.residentProducts = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--replicate" && i + 1 < argc)
+        {
+            options.replicationPath = argv[++i];
+        }
+        else if (arg == "--store-id" && i + 1 < argc)
+        {
+            options.storeId = argv[++i];
+        }
+        else if (arg == "--journal" && i + 1 < argc)
+        {
+            options.journalPath = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--script <file|->] [--quiet] [--no-sample-data]"
+                      << " [--metrics] [--metrics-out <file>] [--trace-out <file>]"
+                      << " [--db <file>] [--cache-mb <N>] [--resident <N>] [--replicate <file>] [--store-id <code>]"
+                      << " [--journal <file>]" << std::endl;
+            return 1;
+        }
+    }
+
+    try
+    {
+        int status = 0;
+        if (!scriptPath.empty())
+        {
+            status = runScript(scriptPath, quiet, sampleData, options);
+        }
+        else
+        {
+            ConvenienceStoreApp app(options);
+            app.run();
+        }
+
+        if (!metricsPath.empty() && !LatencyMetrics::dumpToFile(metricsPath))
+        {
+            std::cerr << "Error: cannot write " << metricsPath << std::endl;
+            return 1;
+        }
+        if (!tracePath.empty() && !Tracing::exportChromeTrace(tracePath))
+        {
+            std::cerr << "Error: cannot write " << tracePath << std::endl;
+            return 1;
+        }
+        return status;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,464 @@
+// ===== MarketBasket.cpp =====
+#include "MarketBasket.h"
+#include "Transaction.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Prefix path of a conditional pattern base, items in ascending rank
+ */
+struct WeightedPath {
+    std::vector<uint32_t> items;
+    long count;
+};
+
+/**
+ * @brief FP-tree over a compact local item range
+ *
+ * Local item ids follow ascending global rank, so every path from the root
+ * visits items in the same order the inputs list them.
+ */
+struct FpTree {
+    std::vector<uint32_t> globalOf;              // Local item -> global rank
+    std::vector<long> support;                   // Local item -> support in this tree
+    std::vector<std::vector<int32_t>> nodesOf;   // Local item -> its nodes
+    std::vector<uint32_t> nodeItem;
+    std::vector<long> nodeCount;
+    std::vector<int32_t> nodeParent;
+
+    bool empty() const { return globalOf.empty(); }
+};
+
+/**
+ * @brief Per-thread scratch indexed by global rank, reset after each use
+ */
+struct Scratch {
+    std::vector<long> support;
+    std::vector<int32_t> local;
+    std::vector<uint32_t> touched;
+
+    explicit Scratch(size_t itemCount) : support(itemCount, 0), local(itemCount, -1) {}
+};
+
+// Builds a tree from every (items, count) path that forEachPath yields
+template <typename PathSource>
+void buildTree(FpTree& tree, const PathSource& forEachPath, long minSupport, Scratch& scratch) {
+    forEachPath([&](const uint32_t* items, size_t length, long count) {
+        for (size_t i = 0; i < length; ++i) {
+            if (scratch.support[items[i]] == 0) {
+                scratch.touched.push_back(items[i]);
+            }
+            scratch.support[items[i]] += count;
+        }
+    });
+
+    std::sort(scratch.touched.begin(), scratch.touched.end());
+    for (uint32_t rank : scratch.touched) {
+        if (scratch.support[rank] >= minSupport) {
+            scratch.local[rank] = static_cast<int32_t>(tree.globalOf.size());
+            tree.globalOf.push_back(rank);
+            tree.support.push_back(scratch.support[rank]);
+        }
+    }
+    tree.nodesOf.resize(tree.globalOf.size());
+
+    if (!tree.empty()) {
+        tree.nodeItem.push_back(UINT32_MAX);  // Root
+        tree.nodeCount.push_back(0);
+        tree.nodeParent.push_back(-1);
+
+        std::unordered_map<uint64_t, int32_t> children;  // (parent, item) -> node
+        forEachPath([&](const uint32_t* items, size_t length, long count) {
+            int32_t node = 0;
+            for (size_t i = 0; i < length; ++i) {
+                int32_t local = scratch.local[items[i]];
+                if (local < 0) {
+                    continue;
+                }
+                uint64_t key = (static_cast<uint64_t>(node) << 32) | static_cast<uint32_t>(local);
+                auto it = children.find(key);
+                if (it != children.end()) {
+                    node = it->second;
+                    tree.nodeCount[node] += count;
+                } else {
+                    int32_t child = static_cast<int32_t>(tree.nodeItem.size());
+                    tree.nodeItem.push_back(static_cast<uint32_t>(local));
+                    tree.nodeCount.push_back(count);
+                    tree.nodeParent.push_back(node);
+                    tree.nodesOf[local].push_back(child);
+                    children.emplace(key, child);
+                    node = child;
+                }
+            }
+        });
+    }
+
+    for (uint32_t rank : scratch.touched) {
+        scratch.support[rank] = 0;
+        scratch.local[rank] = -1;
+    }
+    scratch.touched.clear();
+}
+
+/**
+ * @brief Recursive FP-growth over one thread's share of the items
+ */
+struct Miner {
+    long minSupport;
+    size_t maxSize;
+    Scratch scratch;
+    std::vector<FrequentItemset> found;   // Items are global ranks here
+
+    Miner(size_t itemCount, long minSupport, size_t maxSize)
+        : minSupport(minSupport), maxSize(maxSize), scratch(itemCount) {}
+
+    void mineItem(const FpTree& tree, uint32_t local, std::vector<uint32_t>& suffix) {
+        suffix.push_back(tree.globalOf[local]);
+        FrequentItemset itemset;
+        itemset.items = suffix;
+        itemset.support = tree.support[local];
+        found.push_back(itemset);
+
+        if (suffix.size() < maxSize) {
+            // Conditional pattern base: the prefix path above every node of the item
+            std::vector<WeightedPath> paths;
+            for (int32_t node : tree.nodesOf[local]) {
+                WeightedPath path;
+                path.count = tree.nodeCount[node];
+                for (int32_t up = tree.nodeParent[node]; up > 0; up = tree.nodeParent[up]) {
+                    path.items.push_back(tree.globalOf[tree.nodeItem[up]]);
+                }
+                if (!path.items.empty()) {
+                    std::reverse(path.items.begin(), path.items.end());
+                    paths.push_back(std::move(path));
+                }
+            }
+
+            FpTree conditional;
+            buildTree(conditional, [&paths](auto&& visit) {
+                for (const WeightedPath& path : paths) {
+                    visit(path.items.data(), path.items.size(), path.count);
+                }
+            }, minSupport, scratch);
+
+            for (uint32_t item = 0; item < conditional.globalOf.size(); ++item) {
+                mineItem(conditional, item, suffix);
+            }
+        }
+        suffix.pop_back();
+    }
+};
+
+} // namespace
+
+MarketBasketAnalysis::MarketBasketAnalysis()
+    : minSupportCount(0), threadsUsed(0), seconds(0.0), ran(false) {
+}
+
+BasketEncoder::BasketEncoder() : basketStart(0) {
+    encoded.offsets.push_back(0);
+}
+
+void BasketEncoder::addItem(const std::string& productId, const std::string& productName) {
+    auto it = codes.find(productId);
+    if (it == codes.end()) {
+        it = codes.emplace(productId, static_cast<uint32_t>(encoded.productIds.size())).first;
+        encoded.productIds.push_back(productId);
+        encoded.productNames.push_back(productName);
+    } else if (encoded.productNames[it->second].empty()) {
+        encoded.productNames[it->second] = productName;
+    }
+    encoded.items.push_back(it->second);
+}
+
+void BasketEncoder::endBasket() {
+    std::sort(encoded.items.begin() + basketStart, encoded.items.end());
+    encoded.items.erase(std::unique(encoded.items.begin() + basketStart, encoded.items.end()), encoded.items.end());
+    if (encoded.items.size() > basketStart) {
+        encoded.offsets.push_back(static_cast<uint32_t>(encoded.items.size()));
+    }
+    basketStart = encoded.items.size();
+}
+
+void BasketEncoder::addTransactions(const std::vector<Transaction*>& transactions) {
+    for (const Transaction* transaction : transactions) {
+        // Fully refunded sales say nothing about what customers kept together
+        if (transaction->getStatus() != TransactionStatus::COMPLETED &&
+            transaction->getStatus() != TransactionStatus::PARTIALLY_REFUNDED) {
+            continue;
+        }
+        for (const TransactionItem& item : transaction->getItems()) {
+            addItem(item.product->getId(), item.product->getName());
+        }
+        endBasket();
+    }
+}
+
+EncodedBaskets MarketBasketAnalysis::encode(const std::vector<Transaction*>& transactions) {
+    BasketEncoder encoder;
+    encoder.addTransactions(transactions);
+    return std::move(encoder.getBaskets());
+}
+
+void MarketBasketAnalysis::run(const std::vector<Transaction*>& transactions, const MarketBasketConfig& config) {
+    run(encode(transactions), config);
+}
+
+void MarketBasketAnalysis::run(const EncodedBaskets& encoded, const MarketBasketConfig& runConfig) {
+    auto start = std::chrono::steady_clock::now();
+    baskets = encoded;
+    config = runConfig;
+    itemsets.clear();
+    rules.clear();
+
+    size_t basketCount = baskets.getBasketCount();
+    minSupportCount = std::max(1L, static_cast<long>(config.minSupport * basketCount + 0.999999));
+    threadsUsed = static_cast<int>(config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency()));
+
+    mine();
+    deriveRules();
+
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ran = true;
+}
+
+void MarketBasketAnalysis::mine() {
+    size_t basketCount = baskets.getBasketCount();
+    size_t itemCount = baskets.productIds.size();
+
+    // Item supports, counted over disjoint basket ranges
+    std::vector<std::vector<long>> partialCounts(threadsUsed, std::vector<long>(itemCount, 0));
+    std::vector<std::thread> workers;
+    size_t chunk = (basketCount + threadsUsed - 1) / threadsUsed;
+    for (int t = 0; t < threadsUsed; ++t) {
+        workers.emplace_back([this, &partialCounts, t, chunk, basketCount]() {
+            size_t first = std::min(basketCount, t * chunk);
+            size_t last = std::min(basketCount, first + chunk);
+            std::vector<long>& counts = partialCounts[t];
+            for (uint32_t i = baskets.offsets[first]; i < baskets.offsets[last]; ++i) {
+                counts[baskets.items[i]]++;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    itemSupport.assign(itemCount, 0);
+    for (const auto& counts : partialCounts) {
+        for (size_t item = 0; item < itemCount; ++item) {
+            itemSupport[item] += counts[item];
+        }
+    }
+
+    // Rank frequent items by descending support; the FP-tree orders paths by rank
+    std::vector<uint32_t> itemOfRank;
+    for (uint32_t item = 0; item < itemCount; ++item) {
+        if (itemSupport[item] >= minSupportCount) {
+            itemOfRank.push_back(item);
+        }
+    }
+    std::sort(itemOfRank.begin(), itemOfRank.end(), [this](uint32_t a, uint32_t b) {
+        return itemSupport[a] != itemSupport[b] ? itemSupport[a] > itemSupport[b] : a < b;
+    });
+    std::vector<uint32_t> rankOfItem(itemCount, UINT32_MAX);
+    for (uint32_t rank = 0; rank < itemOfRank.size(); ++rank) {
+        rankOfItem[itemOfRank[rank]] = rank;
+    }
+    size_t rankCount = itemOfRank.size();
+    if (rankCount == 0) {
+        return;
+    }
+
+    FpTree tree;
+    Scratch scratch(rankCount);
+    std::vector<uint32_t> ranked;
+    buildTree(tree, [&](auto&& visit) {
+        for (size_t b = 0; b < basketCount; ++b) {
+            ranked.clear();
+            for (uint32_t i = baskets.offsets[b]; i < baskets.offsets[b + 1]; ++i) {
+                if (rankOfItem[baskets.items[i]] != UINT32_MAX) {
+                    ranked.push_back(rankOfItem[baskets.items[i]]);
+                }
+            }
+            std::sort(ranked.begin(), ranked.end());
+            visit(ranked.data(), ranked.size(), 1L);
+        }
+    }, minSupportCount, scratch);
+
+    // Each item's conditional tree is independent; threads pull items from a shared counter
+    std::atomic<uint32_t> nextItem(0);
+    std::vector<Miner> miners(threadsUsed, Miner(rankCount, minSupportCount,
+                                                  static_cast<size_t>(std::max(1, config.maxItemsetSize))));
+    workers.clear();
+    for (int t = 0; t < threadsUsed; ++t) {
+        workers.emplace_back([&tree, &nextItem, &miners, t]() {
+            std::vector<uint32_t> suffix;
+            for (uint32_t item = nextItem++; item < tree.globalOf.size(); item = nextItem++) {
+                miners[t].mineItem(tree, item, suffix);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (Miner& miner : miners) {
+        for (FrequentItemset& itemset : miner.found) {
+            for (uint32_t& item : itemset.items) {
+                item = itemOfRank[item];
+            }
+            std::sort(itemset.items.begin(), itemset.items.end());
+            itemsets.push_back(std::move(itemset));
+        }
+    }
+    std::sort(itemsets.begin(), itemsets.end(), [](const FrequentItemset& a, const FrequentItemset& b) {
+        if (a.support != b.support) {
+            return a.support > b.support;
+        }
+        return a.items.size() != b.items.size() ? a.items.size() < b.items.size() : a.items < b.items;
+    });
+}
+
+void MarketBasketAnalysis::deriveRules() {
+    std::map<std::vector<uint32_t>, long> supportOf;
+    for (const FrequentItemset& itemset : itemsets) {
+        supportOf[itemset.items] = itemset.support;
+    }
+
+    double basketCount = static_cast<double>(baskets.getBasketCount());
+    for (const FrequentItemset& itemset : itemsets) {
+        if (itemset.items.size() < 2) {
+            continue;
+        }
+        // One rule per item as the consequent; every subset is frequent, so its support is known
+        for (size_t c = 0; c < itemset.items.size(); ++c) {
+            AssociationRule rule;
+            rule.consequent = itemset.items[c];
+            rule.antecedent = itemset.items;
+            rule.antecedent.erase(rule.antecedent.begin() + c);
+            rule.support = itemset.support;
+            rule.confidence = static_cast<double>(itemset.support) / supportOf[rule.antecedent];
+            if (rule.confidence < config.minConfidence) {
+                continue;
+            }
+            rule.lift = rule.confidence / (itemSupport[rule.consequent] / basketCount);
+            rules.push_back(rule);
+        }
+    }
+    std::sort(rules.begin(), rules.end(), [](const AssociationRule& a, const AssociationRule& b) {
+        if (a.lift != b.lift) {
+            return a.lift > b.lift;
+        }
+        return a.confidence > b.confidence;
+    });
+}
+
+std::vector<const AssociationRule*> MarketBasketAnalysis::getRulesFor(const std::string& productId) const {
+    std::vector<const AssociationRule*> matches;
+    for (const AssociationRule& rule : rules) {
+        if (rule.antecedent.size() == 1 && baskets.productIds[rule.antecedent[0]] == productId) {
+            matches.push_back(&rule);
+        }
+    }
+    std::sort(matches.begin(), matches.end(), [](const AssociationRule* a, const AssociationRule* b) {
+        return a->confidence != b->confidence ? a->confidence > b->confidence : a->lift > b->lift;
+    });
+    return matches;
+}
+
+std::string MarketBasketAnalysis::itemLabel(uint32_t item) const {
+    return baskets.productIds[item] + " " + baskets.productNames[item].substr(0, 20);
+}
+
+std::string MarketBasketAnalysis::itemsetLabel(const std::vector<uint32_t>& items) const {
+    std::string label;
+    for (size_t i = 0; i < items.size(); ++i) {
+        label += (i ? " + " : "") + itemLabel(items[i]);
+    }
+    return label;
+}
+
+void MarketBasketAnalysis::displaySummary(std::ostream& out) const {
+    out << "\n" << std::string(60, '=') << std::endl;
+    out << "            MARKET BASKET ANALYSIS            " << std::endl;
+    out << std::string(60, '=') << std::endl;
+    if (!ran) {
+        out << "No analysis has been run yet." << std::endl;
+        out << std::string(60, '=') << std::endl << std::endl;
+        return;
+    }
+
+    std::map<size_t, long> bySize;
+    for (const FrequentItemset& itemset : itemsets) {
+        bySize[itemset.items.size()]++;
+    }
+
+    out << "Baskets Analysed: " << baskets.getBasketCount() << " (" << baskets.productIds.size()
+        << " distinct products)" << std::endl;
+    out << "Minimum Support: " << std::fixed << std::setprecision(2) << config.minSupport * 100.0 << "% ("
+        << minSupportCount << " baskets)" << std::endl;
+    out << "Minimum Confidence: " << std::fixed << std::setprecision(0) << config.minConfidence * 100.0 << "%"
+        << std::endl;
+    out << "Frequent Itemsets: " << itemsets.size() << std::endl;
+    for (const auto& entry : bySize) {
+        out << "  Size " << entry.first << ": " << entry.second << std::endl;
+    }
+    out << "Association Rules: " << rules.size() << std::endl;
+    out << "Mined in " << std::setprecision(1) << seconds * 1000.0 << " ms on " << threadsUsed << " thread(s)"
+        << std::endl;
+    out << std::string(60, '=') << std::endl << std::endl;
+}
+
+void MarketBasketAnalysis::displayItemsets(std::ostream& out, size_t limit) const {
+    double basketCount = static_cast<double>(std::max<size_t>(1, baskets.getBasketCount()));
+    out << "\nTop Frequent Itemsets (size 2+):" << std::endl;
+    size_t shown = 0;
+    for (const FrequentItemset& itemset : itemsets) {
+        if (itemset.items.size() < 2) {
+            continue;
+        }
+        if (shown++ == limit) {
+            break;
+        }
+        out << std::setw(3) << shown << ". " << itemsetLabel(itemset.items) << " - " << itemset.support
+            << " baskets (" << std::fixed << std::setprecision(2) << 100.0 * itemset.support / basketCount << "%)"
+            << std::endl;
+    }
+    if (shown == 0) {
+        out << "  (none at this support level)" << std::endl;
+    }
+}
+
+void MarketBasketAnalysis::displayRules(std::ostream& out, size_t limit) const {
+    out << "\nTop Association Rules by Lift:" << std::endl;
+    for (size_t i = 0; i < rules.size() && i < limit; ++i) {
+        const AssociationRule& rule = rules[i];
+        out << std::setw(3) << (i + 1) << ". " << itemsetLabel(rule.antecedent) << " => "
+            << itemLabel(rule.consequent) << std::endl;
+        out << "       confidence " << std::fixed << std::setprecision(1) << rule.confidence * 100.0
+            << "%, lift " << std::setprecision(2) << rule.lift << ", " << rule.support << " baskets" << std::endl;
+    }
+    if (rules.empty()) {
+        out << "  (no rules at these thresholds)" << std::endl;
+    }
+}
+
+void MarketBasketAnalysis::displayAlsoBought(std::ostream& out, const std::string& productId, size_t limit) const {
+    std::vector<const AssociationRule*> matches = getRulesFor(productId);
+    out << "\nCustomers who bought " << productId << " also bought:" << std::endl;
+    for (size_t i = 0; i < matches.size() && i < limit; ++i) {
+        const AssociationRule* rule = matches[i];
+        out << std::setw(3) << (i + 1) << ". " << std::left << std::setw(30) << itemLabel(rule->consequent)
+            << std::right << std::fixed << std::setprecision(1) << std::setw(6) << rule->confidence * 100.0
+            << "% of baskets, lift " << std::setprecision(2) << rule->lift << std::endl;
+    }
+    if (matches.empty()) {
+        out << "  (no rules for this product at these thresholds)" << std::endl;
+    }
+}
@@ -0,0 +1,119 @@
+// ===== MarketBasket.h =====
+#ifndef MARKET_BASKET_H
+#define MARKET_BASKET_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Transaction;
+
+/**
+ * @brief Thresholds for one market-basket run
+ */
+struct MarketBasketConfig {
+    double minSupport;         // Fraction of baskets an itemset must appear in
+    double minConfidence;      // For rules: P(consequent | antecedent)
+    int maxItemsetSize;
+    unsigned threads;          // 0 = one per hardware thread
+
+    MarketBasketConfig() : minSupport(0.005), minConfidence(0.2), maxItemsetSize(3), threads(0) {}
+};
+
+struct FrequentItemset {
+    std::vector<uint32_t> items;   // Item codes, ascending
+    long support;                  // Baskets containing every item
+};
+
+/**
+ * @brief "Baskets with antecedent also held consequent"
+ */
+struct AssociationRule {
+    std::vector<uint32_t> antecedent;
+    uint32_t consequent;
+    long support;                  // Baskets with antecedent and consequent
+    double confidence;
+    double lift;                   // Confidence relative to the consequent's base rate
+};
+
+/**
+ * @brief Baskets as sorted integer item sets in one flat array
+ */
+struct EncodedBaskets {
+    std::vector<uint32_t> items;         // Basket b is items[offsets[b] .. offsets[b + 1])
+    std::vector<uint32_t> offsets;
+    std::vector<std::string> productIds; // Item code -> product
+    std::vector<std::string> productNames;
+
+    size_t getBasketCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+};
+
+/**
+ * @brief Builds EncodedBaskets one item at a time, from live or archived sales
+ */
+class BasketEncoder {
+private:
+    EncodedBaskets encoded;
+    std::unordered_map<std::string, uint32_t> codes;
+    size_t basketStart;
+
+public:
+    BasketEncoder();
+
+    // A name left empty is taken from a later item of the same product, if any
+    void addItem(const std::string& productId, const std::string& productName);
+    void endBasket();                       // Sorts and de-duplicates; empty baskets are dropped
+    void addTransactions(const std::vector<Transaction*>& transactions);
+
+    EncodedBaskets& getBaskets() { return encoded; }
+};
+
+/**
+ * @brief Frequent itemsets and association rules mined with FP-growth
+ *
+ * Baskets are encoded once into a flat array of item codes. Item supports
+ * are counted in parallel, the frequent items of every basket are inserted
+ * into a single FP-tree, and each frequent item's conditional tree is then
+ * mined independently, with worker threads taking items from a shared
+ * counter. Only the last run's results are kept.
+ */
+class MarketBasketAnalysis {
+private:
+    EncodedBaskets baskets;
+    MarketBasketConfig config;
+    std::vector<FrequentItemset> itemsets;   // Highest support first
+    std::vector<AssociationRule> rules;      // Highest lift first
+    std::vector<long> itemSupport;           // By item code
+    long minSupportCount;
+    int threadsUsed;
+    double seconds;
+    bool ran;
+
+    std::string itemLabel(uint32_t item) const;
+    std::string itemsetLabel(const std::vector<uint32_t>& items) const;
+    void mine();
+    void deriveRules();
+
+public:
+    MarketBasketAnalysis();
+
+    static EncodedBaskets encode(const std::vector<Transaction*>& transactions);
+
+    // Encodes every completed (or partly refunded) transaction and mines it
+    void run(const std::vector<Transaction*>& transactions, const MarketBasketConfig& config);
+    void run(const EncodedBaskets& encoded, const MarketBasketConfig& config);
+
+    bool hasResults() const { return ran; }
+    const std::vector<FrequentItemset>& getItemsets() const { return itemsets; }
+    const std::vector<AssociationRule>& getRules() const { return rules; }
+    std::vector<const AssociationRule*> getRulesFor(const std::string& productId) const;
+
+    void displaySummary(std::ostream& out) const;
+    void displayItemsets(std::ostream& out, size_t limit) const;
+    void displayRules(std::ostream& out, size_t limit) const;
+    void displayAlsoBought(std::ostream& out, const std::string& productId, size_t limit) const;
+};
+
+#endif // MARKET_BASKET_H
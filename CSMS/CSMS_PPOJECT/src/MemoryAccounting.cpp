@@ -0,0 +1,77 @@
+// ===== MemoryAccounting.cpp =====
+#include "MemoryAccounting.h"
+#include <iomanip>
+#include <sstream>
+
+void MemoryReport::add(const std::string& subsystem, const std::string& component, long objects, size_t bytes) {
+    MemoryUsage usage;
+    usage.subsystem = subsystem;
+    usage.component = component;
+    usage.objects = objects;
+    usage.bytes = bytes;
+    rows.push_back(usage);
+}
+
+size_t MemoryReport::getTotalBytes() const {
+    size_t total = 0;
+    for (const MemoryUsage& usage : rows) {
+        total += usage.bytes;
+    }
+    return total;
+}
+
+size_t MemoryReport::getSubsystemBytes(const std::string& subsystem) const {
+    size_t total = 0;
+    for (const MemoryUsage& usage : rows) {
+        if (usage.subsystem == subsystem) {
+            total += usage.bytes;
+        }
+    }
+    return total;
+}
+
+std::string MemoryReport::formatBytes(size_t bytes) {
+    std::ostringstream text;
+    if (bytes >= (size_t(1) << 30)) {
+        text << std::fixed << std::setprecision(2) << bytes / double(size_t(1) << 30) << " GB";
+    } else if (bytes >= (size_t(1) << 20)) {
+        text << std::fixed << std::setprecision(2) << bytes / double(size_t(1) << 20) << " MB";
+    } else if (bytes >= 1024) {
+        text << std::fixed << std::setprecision(1) << bytes / 1024.0 << " KB";
+    } else {
+        text << bytes << " B";
+    }
+    return text.str();
+}
+
+void MemoryReport::display(std::ostream& out) const {
+    size_t total = getTotalBytes();
+
+    out << "\n" << std::string(70, '=') << std::endl;
+    out << "                       MEMORY USAGE REPORT                       " << std::endl;
+    out << std::string(70, '=') << std::endl;
+    out << std::left << std::setw(36) << "Component" << std::right << std::setw(12) << "Objects"
+        << std::setw(13) << "Bytes" << std::setw(9) << "Share" << std::endl;
+
+    std::string current;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const MemoryUsage& usage = rows[i];
+        if (usage.subsystem != current) {
+            current = usage.subsystem;
+            size_t subsystemBytes = getSubsystemBytes(current);
+            out << std::string(70, '-') << std::endl;
+            out << std::left << std::setw(48) << current << std::right << std::setw(13)
+                << formatBytes(subsystemBytes) << std::setw(8) << std::fixed << std::setprecision(1)
+                << (total ? 100.0 * subsystemBytes / total : 0.0) << "%" << std::endl;
+        }
+        out << "  " << std::left << std::setw(34) << usage.component << std::right << std::setw(12)
+            << usage.objects << std::setw(13) << formatBytes(usage.bytes) << std::setw(8)
+            << std::fixed << std::setprecision(1) << (total ? 100.0 * usage.bytes / total : 0.0)
+            << "%" << std::endl;
+    }
+
+    out << std::string(70, '-') << std::endl;
+    out << std::left << std::setw(48) << "Total (estimated heap)" << std::right << std::setw(13)
+        << formatBytes(total) << std::endl;
+    out << std::string(70, '=') << std::endl << std::endl;
+}
@@ -0,0 +1,82 @@
+// ===== MemoryAccounting.h =====
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bytes and object count of one component of a subsystem
+ */
+struct MemoryUsage {
+    std::string subsystem;
+    std::string component;
+    long objects;
+    size_t bytes;
+};
+
+/**
+ * @brief Heap footprint estimates for standard containers
+ *
+ * Models libstdc++ node layouts and glibc malloc chunk rounding, so the
+ * figures track what the process actually holds rather than sizeof alone.
+ */
+class MemorySizing {
+public:
+    static constexpr size_t MAP_NODE_HEADER = 32;   // Red-black tree color + three links
+    static constexpr size_t HASH_NODE_HEADER = 8;   // Singly linked next pointer
+
+    // Chunk size malloc hands out for a request of the given size
+    static size_t allocation(size_t requested) {
+        size_t chunk = (requested + 8 + 15) & ~static_cast<size_t>(15);
+        return chunk < 32 ? 32 : chunk;
+    }
+
+    // Heap buffer of a string; short strings live inside the object
+    static size_t stringBytes(const std::string& text) {
+        static const size_t inlineCapacity = std::string().capacity();
+        return text.capacity() > inlineCapacity ? allocation(text.capacity() + 1) : 0;
+    }
+
+    template <typename T>
+    static size_t vectorBytes(const std::vector<T>& values) {
+        return values.capacity() ? allocation(values.capacity() * sizeof(T)) : 0;
+    }
+
+    template <typename Key, typename Value>
+    static size_t mapNodeBytes() {
+        return allocation(MAP_NODE_HEADER + sizeof(std::pair<const Key, Value>));
+    }
+
+    template <typename Key, typename Value>
+    static size_t hashNodeBytes() {
+        return allocation(HASH_NODE_HEADER + sizeof(std::pair<const Key, Value>));
+    }
+
+    static size_t hashBucketBytes(size_t bucketCount) {
+        return bucketCount > 1 ? allocation(bucketCount * sizeof(void*)) : 0;
+    }
+};
+
+/**
+ * @brief Per-subsystem memory breakdown filled in by each owner's accountMemory()
+ */
+class MemoryReport {
+private:
+    std::vector<MemoryUsage> rows;
+
+public:
+    void add(const std::string& subsystem, const std::string& component, long objects, size_t bytes);
+
+    const std::vector<MemoryUsage>& getRows() const { return rows; }
+    size_t getTotalBytes() const;
+    size_t getSubsystemBytes(const std::string& subsystem) const;
+
+    static std::string formatBytes(size_t bytes);
+    void display(std::ostream& out) const;
+};
+
+#endif // MEMORY_ACCOUNTING_H
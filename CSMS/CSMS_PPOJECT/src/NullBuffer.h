@@ -0,0 +1,18 @@
+// ===== NullBuffer.h =====
+#ifndef NULL_BUFFER_H
+#define NULL_BUFFER_H
+
+#include <streambuf>
+
+/**
+ * @brief Stream buffer that discards everything written to it
+ *
+ * Swapped into std::cout to silence report output in script and benchmark runs.
+ */
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+#endif // NULL_BUFFER_H
@@ -0,0 +1,370 @@
+// ===== PersistenceFlusher.cpp =====
+#include "PersistenceFlusher.h"
+#include "Transaction.h"
+#include "Refund.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char* PersistenceFlusher::MAGIC = "CSMSJNL1";
+
+static const size_t MAGIC_LENGTH = 8;
+
+static const int WRITE_ATTEMPTS = 3;   // Per batch, before its records are counted as failed
+
+static uint32_t recordChecksum(const ChangeRecord& record) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&record);
+    uint32_t value = 2166136261u;
+    for (size_t i = sizeof(record.checksum); i < sizeof(ChangeRecord); ++i) {
+        value = (value ^ bytes[i]) * 16777619u;
+    }
+    return value;
+}
+
+static long nanosSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<long>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+static void raiseTo(std::atomic<long>& maximum, long value) {
+    long current = maximum.load(std::memory_order_relaxed);
+    while (value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// ChangeRecord implementation
+ChangeRecord::ChangeRecord()
+    : checksum(0), type(0), paymentMethod(0), lineCount(0), transactionId(0), stockUnits(0), timestamp(0),
+      quantity(0.0), amount(0.0) {
+    std::memset(key, 0, sizeof(key));
+}
+
+void ChangeRecord::setKey(const std::string& value) {
+    size_t length = std::min(value.size(), sizeof(key) - 1);
+    std::memcpy(key, value.data(), length);
+    key[length] = '\0';
+}
+
+// PersistenceFlusher implementation
+PersistenceFlusher::PersistenceFlusher()
+    : fd(-1), slots(nullptr), capacity(0), batchLimit(0), intervalMs(0), tail(0), fullStalls(0), stallNanos(0),
+      maxBacklog(0), head(0), durableSize(0), written(0), batches(0), bytes(0), maxBatch(0), syncNanos(0),
+      maxSyncNanos(0), writeErrors(0), failed(0), stopping(false) {
+}
+
+PersistenceFlusher::~PersistenceFlusher() {
+    close();
+}
+
+bool PersistenceFlusher::open(const std::string& journalPath, size_t slotCount, size_t batch, int interval) {
+    if (fd >= 0) {
+        return false;
+    }
+    int file = ::open(journalPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (file < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(file, &info) != 0) {
+        ::close(file);
+        return false;
+    }
+    off_t size = info.st_size;
+    if (size == 0) {
+        if (::write(file, MAGIC, MAGIC_LENGTH) != static_cast<ssize_t>(MAGIC_LENGTH)) {
+            ::close(file);
+            return false;
+        }
+        size = MAGIC_LENGTH;
+    } else {
+        char magic[MAGIC_LENGTH];
+        if (size < static_cast<off_t>(MAGIC_LENGTH) || ::pread(file, magic, MAGIC_LENGTH, 0) !=
+                                                             static_cast<ssize_t>(MAGIC_LENGTH) ||
+            std::memcmp(magic, MAGIC, MAGIC_LENGTH) != 0) {
+            ::close(file);
+            return false;
+        }
+        // A crash mid-write leaves a partial record; later records must start on a boundary
+        off_t whole = MAGIC_LENGTH + (size - MAGIC_LENGTH) / sizeof(ChangeRecord) * sizeof(ChangeRecord);
+        if (whole != size && ftruncate(file, whole) != 0) {
+            ::close(file);
+            return false;
+        }
+        size = whole;
+    }
+
+    capacity = 2;
+    while (capacity < slotCount) {
+        capacity <<= 1;
+    }
+    slots = new Slot[capacity];
+    for (size_t i = 0; i < capacity; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    path = journalPath;
+    fd = file;
+    batchLimit = std::max<size_t>(batch, 1);
+    intervalMs = std::max(interval, 1);
+    tail.store(0);
+    head = 0;
+    durableSize = size;
+    for (std::atomic<long>* counter : { &fullStalls, &stallNanos, &maxBacklog, &written, &batches, &bytes,
+                                        &maxBatch, &syncNanos, &maxSyncNanos, &writeErrors, &failed }) {
+        counter->store(0);
+    }
+    stopping.store(false);
+    worker = std::thread(&PersistenceFlusher::run, this);
+    return true;
+}
+
+void PersistenceFlusher::close() {
+    if (fd < 0) {
+        return;
+    }
+    stopping.store(true);
+    notifyFlusher();
+    worker.join();
+    ::close(fd);
+    fd = -1;
+    delete[] slots;
+    slots = nullptr;
+}
+
+bool PersistenceFlusher::tryPush(const ChangeRecord& record) {
+    uint64_t position = tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots[position & (capacity - 1)];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        int64_t difference = static_cast<int64_t>(sequence - position);
+        if (difference == 0) {
+            // Free for this lap: claim it, fill it, then publish it to the flusher
+            if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                slot.record = record;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;   // The flusher has not yet drained this slot's previous lap
+        } else {
+            position = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool PersistenceFlusher::pop(ChangeRecord& record) {
+    Slot& slot = slots[head & (capacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+        return false;
+    }
+    record = slot.record;
+    slot.sequence.store(head + capacity, std::memory_order_release);
+    ++head;
+    return true;
+}
+
+void PersistenceFlusher::notifyFlusher() {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    wake.notify_one();
+}
+
+void PersistenceFlusher::submit(const ChangeRecord& record) {
+    if (!tryPush(record)) {
+        // Backpressure: the disk is behind by a whole ring, so wait for room
+        fullStalls.fetch_add(1, std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        notifyFlusher();
+        while (!tryPush(record)) {
+            std::this_thread::yield();
+        }
+        stallNanos.fetch_add(nanosSince(start), std::memory_order_relaxed);
+    }
+    raiseTo(maxBacklog, getBacklog());
+}
+
+void PersistenceFlusher::submitSale(const Transaction& transaction) {
+    const std::vector<TransactionItem>& items = transaction.getItems();
+    ChangeRecord sale;
+    sale.type = static_cast<uint8_t>(ChangeRecordType::SALE);
+    sale.paymentMethod = static_cast<uint8_t>(transaction.getPaymentMethod());
+    sale.lineCount = static_cast<uint16_t>(std::min<size_t>(items.size(), UINT16_MAX));
+    sale.transactionId = transaction.getId();
+    sale.timestamp = transaction.getTimestamp();
+    sale.amount = transaction.getFinalTotal();
+    if (transaction.getCustomer()) {
+        sale.setKey(transaction.getCustomer()->getId());
+    }
+    submit(sale);
+
+    for (const TransactionItem& item : items) {
+        ChangeRecord line;
+        line.type = static_cast<uint8_t>(ChangeRecordType::LINE);
+        line.transactionId = sale.transactionId;
+        line.timestamp = sale.timestamp;
+        line.stockUnits = item.stockUnits;
+        line.quantity = item.quantity;
+        line.amount = item.getPaidAmount();
+        if (item.product) {
+            line.setKey(item.product->getId());
+        }
+        submit(line);
+    }
+}
+
+void PersistenceFlusher::submitRefund(const RefundRecord& refund, const Transaction& transaction) {
+    ChangeRecord record;
+    record.type = static_cast<uint8_t>(ChangeRecordType::REFUND);
+    record.lineCount = static_cast<uint16_t>(std::min<size_t>(refund.lines.size(), UINT16_MAX));
+    record.transactionId = refund.transactionId;
+    record.timestamp = refund.timestamp;
+    if (refund.lines.empty()) {
+        record.amount = refund.amount;
+        submit(record);
+        return;
+    }
+    for (const RefundLine& line : refund.lines) {
+        const Product* product = transaction.getItems()[line.itemIndex].product;
+        record.setKey(product ? product->getId() : std::string());
+        record.quantity = line.quantity;
+        record.stockUnits = line.stockRestored;
+        record.amount = line.amount;
+        submit(record);
+    }
+}
+
+bool PersistenceFlusher::sync() {
+    if (fd < 0) {
+        return false;
+    }
+    long target = static_cast<long>(tail.load());
+    long errors = writeErrors.load();
+    notifyFlusher();
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    long lost = failed.load();
+    durable.wait(lock, [this, target]() { return written.load() + failed.load() >= target; });
+    return writeErrors.load() == errors && failed.load() == lost;
+}
+
+bool PersistenceFlusher::writeAll(const char* data, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t done = ::pwrite(fd, data, length, offset);
+        if (done < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += done;
+        offset += done;
+        length -= static_cast<size_t>(done);
+    }
+    return true;
+}
+
+bool PersistenceFlusher::writeBatch(const char* data, size_t length) {
+    for (int attempt = 0; attempt < WRITE_ATTEMPTS; ++attempt) {
+        if (attempt > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        }
+        // Every attempt writes at the durable end, so a torn attempt never shifts later records
+        if (writeAll(data, length, durableSize) && fdatasync(fd) == 0) {
+            durableSize += static_cast<off_t>(length);
+            return true;
+        }
+        writeErrors.fetch_add(1);
+        if (ftruncate(fd, durableSize) != 0) {
+            // Whatever part of the batch stays is overwritten by the next write at durableSize
+        }
+    }
+    return false;
+}
+
+void PersistenceFlusher::run() {
+    std::vector<char> buffer(batchLimit * sizeof(ChangeRecord));
+    for (;;) {
+        size_t count = 0;
+        ChangeRecord record;
+        while (count < batchLimit && pop(record)) {
+            record.checksum = recordChecksum(record);
+            std::memcpy(buffer.data() + count * sizeof(ChangeRecord), &record, sizeof(ChangeRecord));
+            ++count;
+        }
+
+        if (count == 0) {
+            if (stopping.load()) {
+                break;
+            }
+            // Idle: producers only wake us when the ring fills, so poll at the group-commit interval
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, std::chrono::milliseconds(intervalMs));
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        size_t length = count * sizeof(ChangeRecord);
+        bool stored = writeBatch(buffer.data(), length);
+        if (stored) {
+            long elapsed = nanosSince(start);
+            syncNanos.fetch_add(elapsed, std::memory_order_relaxed);
+            raiseTo(maxSyncNanos, elapsed);
+            raiseTo(maxBatch, static_cast<long>(count));
+            batches.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add(static_cast<long>(length), std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        (stored ? written : failed).fetch_add(static_cast<long>(count));
+        durable.notify_all();
+    }
+}
+
+long PersistenceFlusher::getBacklog() const {
+    return static_cast<long>(tail.load(std::memory_order_relaxed)) - written.load(std::memory_order_relaxed) -
+           failed.load(std::memory_order_relaxed);
+}
+
+size_t PersistenceFlusher::getAllocatedBytes() const {
+    return fd >= 0 ? capacity * sizeof(Slot) + batchLimit * sizeof(ChangeRecord) : 0;
+}
+
+PersistenceStats PersistenceFlusher::getStats() const {
+    PersistenceStats stats;
+    stats.submitted = static_cast<long>(tail.load());
+    stats.written = written.load();
+    stats.batches = batches.load();
+    stats.bytes = bytes.load();
+    stats.fullStalls = fullStalls.load();
+    stats.stallNanos = stallNanos.load();
+    stats.maxBacklog = maxBacklog.load();
+    stats.maxBatch = maxBatch.load();
+    stats.syncNanos = syncNanos.load();
+    stats.maxSyncNanos = maxSyncNanos.load();
+    stats.writeErrors = writeErrors.load();
+    stats.failed = failed.load();
+    return stats;
+}
+
+void PersistenceFlusher::display(std::ostream& out) const {
+    PersistenceStats stats = getStats();
+    out << "Journal: " << path << (fd >= 0 ? "" : " (closed)") << std::endl;
+    out << "Queue: " << capacity << " slots (" << MemoryReport::formatBytes(getAllocatedBytes())
+        << " with batch buffer), backlog "
+        << getBacklog() << ", max backlog " << stats.maxBacklog << std::endl;
+    out << "Records: " << stats.submitted << " submitted, " << stats.written << " durable in " << stats.batches
+        << " batches (largest " << stats.maxBatch << "), " << stats.failed << " failed, "
+        << MemoryReport::formatBytes(static_cast<size_t>(stats.bytes)) << " written" << std::endl;
+    out << std::fixed << std::setprecision(1);
+    out << "Disk: " << (stats.batches ? stats.syncNanos / 1000.0 / stats.batches : 0.0)
+        << " us average write+fdatasync, " << stats.maxSyncNanos / 1000.0 << " us max, " << stats.writeErrors
+        << " errors" << std::endl;
+    out << "Backpressure: " << stats.fullStalls << " submissions waited for room, "
+        << stats.stallNanos / 1e6 << " ms in total" << std::endl;
+    out.unsetf(std::ios::fixed);
+}
@@ -0,0 +1,146 @@
+// ===== PersistenceFlusher.h =====
+#ifndef PERSISTENCE_FLUSHER_H
+#define PERSISTENCE_FLUSHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <sys/types.h>
+
+class Transaction;
+struct RefundRecord;
+
+enum class ChangeRecordType : uint8_t {
+    SALE = 1,      // Completed transaction; lineCount LINE records carry its items
+    LINE = 2,
+    REFUND = 3     // One refunded line, or the whole refund when it returned no goods
+};
+
+/**
+ * @brief Fixed-size journal record, written to disk exactly as laid out here
+ */
+struct ChangeRecord {
+    uint32_t checksum;         // FNV-1a over the rest of the record, set by the flusher
+    uint8_t type;              // ChangeRecordType
+    uint8_t paymentMethod;     // SALE only
+    uint16_t lineCount;        // SALE: items; REFUND: lines in the refund
+    int32_t transactionId;
+    int32_t stockUnits;        // LINE: units taken; REFUND: units restored
+    int64_t timestamp;
+    double quantity;           // LINE and REFUND
+    double amount;             // SALE: final total; LINE: net plus tax; REFUND: refunded amount
+    char key[24];              // SALE: customer ID, empty for walk-ins; otherwise product ID
+
+    ChangeRecord();
+    void setKey(const std::string& value);   // Truncated to 23 characters
+};
+
+static_assert(sizeof(ChangeRecord) == 64, "journal records are one cache line");
+
+/**
+ * @brief Counters describing the flusher's backlog and disk work
+ */
+struct PersistenceStats {
+    long submitted;
+    long written;
+    long batches;
+    long bytes;
+    long fullStalls;           // Submissions that found the queue full
+    long stallNanos;           // Time producers spent waiting for room
+    long maxBacklog;
+    long maxBatch;
+    long syncNanos;            // Total time in write plus fdatasync
+    long maxSyncNanos;
+    long writeErrors;          // Failed write or fdatasync attempts
+    long failed;               // Records given up on after every retry failed
+};
+
+/**
+ * @brief Moves sale and refund records to an append-only journal off the checkout path
+ *
+ * Producers copy fixed-size records into a bounded lock-free ring (a
+ * multi-producer, single-consumer queue in which each slot's sequence
+ * number says whether it is free or filled); a background thread drains
+ * it in batches, writes each batch with one pwrite() and makes it durable
+ * with fdatasync(). A checkout therefore costs a few stores and a CAS, not
+ * a disk round trip. When the disk falls far enough behind that the ring
+ * fills, producers wait for room rather than drop records, and the stalls
+ * are counted so the backlog shows up in the report instead of in lost
+ * sales data. A batch whose write or fdatasync fails is cut back off the
+ * file and retried, so the journal always ends on a record boundary; if it
+ * keeps failing its records are counted as failed, never as durable.
+ */
+class PersistenceFlusher {
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        ChangeRecord record;
+    };
+
+    std::string path;
+    int fd;
+    Slot* slots;
+    size_t capacity;           // Power of two
+    size_t batchLimit;
+    int intervalMs;            // Longest an idle flusher sleeps before checking again
+
+    // Producers' and the flusher's counters sit on separate cache lines
+    char producerPad[64];
+    std::atomic<uint64_t> tail;               // Next slot a producer claims; also records submitted
+    std::atomic<long> fullStalls;
+    std::atomic<long> stallNanos;
+    std::atomic<long> maxBacklog;
+    char flusherPad[64];
+    uint64_t head;                            // Next slot the flusher reads; flusher only
+    off_t durableSize;                        // End of the last durable batch; flusher only
+    std::atomic<long> written;                // Records made durable, and the flusher's own counters
+    std::atomic<long> batches;
+    std::atomic<long> bytes;
+    std::atomic<long> maxBatch;
+    std::atomic<long> syncNanos;
+    std::atomic<long> maxSyncNanos;
+    std::atomic<long> writeErrors;
+    std::atomic<long> failed;
+
+    std::atomic<bool> stopping;
+    std::mutex wakeMutex;
+    std::condition_variable wake;             // Flusher: records waiting or stopping
+    std::condition_variable durable;          // Producers waiting in sync()
+    std::thread worker;
+
+    bool tryPush(const ChangeRecord& record);
+    bool pop(ChangeRecord& record);
+    void run();
+    bool writeAll(const char* data, size_t length, off_t offset);
+    bool writeBatch(const char* data, size_t length);
+    void notifyFlusher();
+
+public:
+    PersistenceFlusher();
+    ~PersistenceFlusher();
+
+    // Appends to an existing journal, dropping a torn final record
+    bool open(const std::string& path, size_t capacity = 16384, size_t batchLimit = 4096, int intervalMs = 2);
+    void close();              // Writes everything submitted, then stops the flusher
+    bool isOpen() const { return fd >= 0; }
+
+    void submit(const ChangeRecord& record);
+    void submitSale(const Transaction& transaction);
+    void submitRefund(const RefundRecord& refund, const Transaction& transaction);
+    bool sync();               // Waits until every record submitted so far is on disk or failed
+
+    const std::string& getPath() const { return path; }
+    size_t getCapacity() const { return capacity; }
+    size_t getAllocatedBytes() const;
+    long getBacklog() const;
+    PersistenceStats getStats() const;
+    void display(std::ostream& out) const;
+
+    static const char* MAGIC;   // First 8 bytes of a journal file
+};
+
+#endif // PERSISTENCE_FLUSHER_H
@@ -0,0 +1,400 @@
+// ===== PosLoadClient.cpp =====
+// Load generator for the lane terminal server.
+//
+// Opens many connections to a running posserver and has each one ring up
+// baskets (lookup, items, total, checkout) with a fixed number of requests
+// in flight, then reports throughput and the latency distribution seen by
+// the terminals.
+
+#include "PosProtocol.h"
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Request awaiting its reply
+ */
+struct Pending {
+    Clock::time_point sent;
+    PosOpcode opcode;
+};
+
+/**
+ * @brief One simulated lane: its socket, buffers and place in the current basket
+ */
+struct Lane {
+    int fd;
+    std::string input;
+    std::string output;
+    size_t outputHead;
+    std::deque<Pending> inFlight;             // Oldest first; replies come back in order
+    int step;                                 // Next request of the basket
+    std::string lookupId;
+    uint32_t nextRequestId;
+    bool writing;
+
+    explicit Lane(int fd) : fd(fd), outputHead(0), step(0), nextRequestId(1), writing(false) {}
+};
+
+struct LoadOptions {
+    std::string unixPath;
+    int tcpPort;
+    int connections;
+    int pipeline;
+    int items;
+    double seconds;
+    LoadOptions() : unixPath("/tmp/csms-pos.sock"), tcpPort(0), connections(64), pipeline(8), items(3), seconds(5.0) {}
+};
+
+static void printUsage() {
+    std::cout << "Usage: posload [options]\n"
+              << "  --unix PATH        Server socket (default /tmp/csms-pos.sock)\n"
+              << "  --tcp PORT         Connect to 127.0.0.1:PORT instead\n"
+              << "  --connections N    Lanes connected at once (default 64)\n"
+              << "  --pipeline N       Requests in flight per lane (default 8)\n"
+              << "  --items N          Items per basket (default 3)\n"
+              << "  --seconds S        Test length (default 5)\n";
+}
+
+static int connectTo(const LoadOptions& options) {
+    int fd;
+    if (options.tcpPort > 0) {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(options.tcpPort));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    } else {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, options.unixPath.c_str(), sizeof(address.sun_path) - 1);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+static bool writeAll(int fd, const std::string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t sent = send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        done += sent;
+    }
+    return true;
+}
+
+// Blocking exchange used to fetch the catalog before the test starts
+static bool readFrame(int fd, std::string& body) {
+    char header[POS_FRAME_HEADER];
+    size_t got = 0;
+    while (got < sizeof(header)) {
+        ssize_t n = read(fd, header + got, sizeof(header) - got);
+        if (n <= 0) return false;
+        got += n;
+    }
+    PosReader lengthReader(header, sizeof(header));
+    uint32_t length = lengthReader.u32();
+    if (length > POS_MAX_FRAME) {
+        return false;
+    }
+    body.resize(length);
+    got = 0;
+    while (got < length) {
+        ssize_t n = read(fd, &body[got], length - got);
+        if (n <= 0) return false;
+        got += n;
+    }
+    return true;
+}
+
+static bool fetchCatalog(const LoadOptions& options, std::vector<std::string>& ids) {
+    int fd = connectTo(options);
+    if (fd < 0) {
+        return false;
+    }
+    std::string afterId;
+    for (uint32_t requestId = 1;; ++requestId) {
+        std::string frame;
+        PosWriter request(frame);
+        request.u8(static_cast<uint8_t>(PosOpcode::LIST)).u32(requestId).str(afterId).u16(1000);
+        request.finish();
+        std::string body;
+        if (!writeAll(fd, frame) || !readFrame(fd, body)) {
+            close(fd);
+            return false;
+        }
+        PosReader reply(body.data(), body.size());
+        PosStatus status = static_cast<PosStatus>(reply.u8());
+        reply.u32();
+        uint16_t count = reply.u16();
+        if (status != PosStatus::OK || reply.failed()) {
+            close(fd);
+            return false;
+        }
+        for (uint16_t i = 0; i < count; ++i) {
+            ids.push_back(reply.str());
+        }
+        if (count == 0) {
+            break;
+        }
+        afterId = ids.back();
+    }
+    close(fd);
+    return !ids.empty();
+}
+
+static void record(LatencySnapshot& latency, uint64_t nanos) {
+    latency.counts[LatencyMetrics::bucketFor(nanos)]++;
+    latency.count++;
+    latency.sumNanos += nanos;
+    latency.maxNanos = std::max(latency.maxNanos, nanos);
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--unix" && hasValue) {
+            options.unixPath = argv[++i];
+        } else if (arg == "--tcp" && hasValue) {
+            options.tcpPort = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--connections" && hasValue) {
+            options.connections = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--pipeline" && hasValue) {
+            options.pipeline = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--items" && hasValue) {
+            options.items = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seconds" && hasValue) {
+            options.seconds = std::max(0.1, std::atof(argv[++i]));
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<std::string> catalog;
+    if (!fetchCatalog(options, catalog)) {
+        std::cout << "Cannot fetch the catalog from the server" << std::endl;
+        return 1;
+    }
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<Lane*> lanes;
+    for (int i = 0; i < options.connections; ++i) {
+        int fd = connectTo(options);
+        if (fd < 0) {
+            std::cout << "Connected " << i << " of " << options.connections << " lanes: " << std::strerror(errno)
+                      << std::endl;
+            break;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        Lane* lane = new Lane(fd);
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.ptr = lane;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        lanes.push_back(lane);
+    }
+    if (lanes.empty()) {
+        return 1;
+    }
+
+    std::mt19937 random(7);
+    const int basketSteps = options.items + 3;   // LOOKUP, ADD..., TOTAL, CHECKOUT
+    LatencySnapshot latency;
+    std::memset(&latency, 0, sizeof(latency));
+    long requests = 0;
+    long errors = 0;
+    long baskets = 0;
+    bool sending = true;
+
+    // Queues requests until the lane has its full pipeline in flight, then writes what it can
+    auto fill = [&](Lane& lane) -> bool {
+        while (sending && static_cast<int>(lane.inFlight.size()) < options.pipeline) {
+            PosOpcode opcode = lane.step == 0 ? PosOpcode::LOOKUP
+                             : lane.step <= options.items ? PosOpcode::ADD
+                             : lane.step == options.items + 1 ? PosOpcode::TOTAL : PosOpcode::CHECKOUT;
+            PosWriter request(lane.output);
+            request.u8(static_cast<uint8_t>(opcode)).u32(lane.nextRequestId++);
+            if (opcode == PosOpcode::LOOKUP) {
+                lane.lookupId = catalog[random() % catalog.size()];
+                request.str(lane.lookupId);
+            } else if (opcode == PosOpcode::ADD) {
+                request.str(lane.step == 1 ? lane.lookupId : catalog[random() % catalog.size()]).f64(1.0);
+            } else if (opcode == PosOpcode::CHECKOUT) {
+                request.u8(1).f64(-1.0);   // Credit card, exact amount
+            }
+            request.finish();
+            lane.step = (lane.step + 1) % basketSteps;
+            Pending pending = { Clock::now(), opcode };
+            lane.inFlight.push_back(pending);
+        }
+        while (lane.outputHead < lane.output.size()) {
+            ssize_t sent = send(lane.fd, lane.output.data() + lane.outputHead, lane.output.size() - lane.outputHead,
+                                MSG_NOSIGNAL);
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (sent <= 0) {
+                return false;
+            }
+            lane.outputHead += sent;
+        }
+        if (lane.outputHead == lane.output.size()) {
+            lane.output.clear();
+            lane.outputHead = 0;
+        }
+        bool writing = lane.outputHead < lane.output.size();
+        if (writing != lane.writing) {
+            epoll_event event;
+            std::memset(&event, 0, sizeof(event));
+            event.events = writing ? EPOLLIN | EPOLLOUT : EPOLLIN;
+            event.data.ptr = &lane;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, lane.fd, &event);
+            lane.writing = writing;
+        }
+        return true;
+    };
+
+    // Matches complete replies to their send times
+    auto drain = [&](Lane& lane) -> bool {
+        char chunk[65536];
+        for (;;) {
+            ssize_t n = read(lane.fd, chunk, sizeof(chunk));
+            if (n > 0) {
+                lane.input.append(chunk, n);
+                if (static_cast<size_t>(n) < sizeof(chunk)) break;
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            return false;
+        }
+        Clock::time_point now = Clock::now();
+        size_t head = 0;
+        for (;;) {
+            bool oversized;
+            size_t frame = posFrameLength(lane.input.data() + head, lane.input.size() - head, oversized);
+            if (oversized) {
+                return false;
+            }
+            if (frame == 0) {
+                break;
+            }
+            if (lane.inFlight.empty()) {
+                return false;   // A reply nothing was asked for
+            }
+            PosReader reply(lane.input.data() + head + POS_FRAME_HEADER, frame - POS_FRAME_HEADER);
+            PosStatus status = static_cast<PosStatus>(reply.u8());
+            reply.u32();
+            if (status != PosStatus::OK) {
+                errors++;
+            } else if (lane.inFlight.front().opcode == PosOpcode::CHECKOUT) {
+                baskets++;
+            }
+            record(latency, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - lane.inFlight.front().sent).count()));
+            lane.inFlight.pop_front();
+            requests++;
+            head += frame;
+        }
+        lane.input.erase(0, head);
+        return true;
+    };
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.seconds));
+    for (Lane* lane : lanes) {
+        fill(*lane);
+    }
+
+    std::vector<epoll_event> events(256);
+    long outstanding = 0;
+    do {
+        int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 10);
+        for (int i = 0; i < ready; ++i) {
+            Lane& lane = *static_cast<Lane*>(events[i].data.ptr);
+            bool ok = true;
+            if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+                ok = drain(lane);
+            }
+            if (ok) {
+                ok = fill(lane);
+            }
+            if (!ok) {
+                std::cout << "Lane lost its connection with " << lane.inFlight.size() << " requests in flight"
+                          << std::endl;
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, lane.fd, nullptr);
+                close(lane.fd);
+                lane.fd = -1;
+                lane.inFlight.clear();
+            }
+        }
+        if (sending && Clock::now() >= deadline) {
+            sending = false;   // Let the replies already owed come back
+        }
+        outstanding = 0;
+        for (const Lane* lane : lanes) {
+            outstanding += static_cast<long>(lane->inFlight.size());
+        }
+    } while (sending || outstanding > 0);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << "Lanes: " << lanes.size() << ", pipeline " << options.pipeline << ", " << options.items
+              << " items per basket, " << catalog.size() << " products, "
+              << (options.tcpPort > 0 ? "tcp 127.0.0.1:" + std::to_string(options.tcpPort) : options.unixPath)
+              << "\n";
+    std::cout << "Requests: " << requests << " in " << std::fixed << std::setprecision(2) << seconds << " s = "
+              << std::setprecision(0) << requests / seconds << " req/s (about " << baskets / seconds
+              << " baskets/s), " << errors << " errors\n";
+    std::cout << "Latency us: mean " << std::setprecision(1) << latency.getMeanNanos() / 1000.0 << ", p50 "
+              << latency.getPercentileNanos(0.50) / 1000.0 << ", p99 " << latency.getPercentileNanos(0.99) / 1000.0
+              << ", p99.9 " << latency.getPercentileNanos(0.999) / 1000.0 << ", max " << latency.maxNanos / 1000.0
+              << "\n";
+
+    for (Lane* lane : lanes) {
+        if (lane->fd >= 0) {
+            close(lane->fd);
+        }
+        delete lane;
+    }
+    close(epollFd);
+    return errors == 0 ? 0 : 2;
+}
@@ -0,0 +1,135 @@
+// ===== PosProtocol.cpp =====
+#include "PosProtocol.h"
+#include <algorithm>
+#include <cstring>
+
+// PosWriter implementation
+PosWriter::PosWriter(std::string& buffer) : buffer(buffer), start(buffer.size()) {
+    buffer.append(POS_FRAME_HEADER, '\0');
+}
+
+PosWriter& PosWriter::u8(uint8_t value) {
+    buffer.push_back(static_cast<char>(value));
+    return *this;
+}
+
+PosWriter& PosWriter::u16(uint16_t value) {
+    buffer.push_back(static_cast<char>(value & 0xff));
+    buffer.push_back(static_cast<char>(value >> 8));
+    return *this;
+}
+
+PosWriter& PosWriter::u32(uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        buffer.push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+    return *this;
+}
+
+PosWriter& PosWriter::f64(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    u32(static_cast<uint32_t>(bits));
+    return u32(static_cast<uint32_t>(bits >> 32));
+}
+
+PosWriter& PosWriter::str(const std::string& value) {
+    size_t length = std::min<size_t>(value.size(), 0xffff);
+    u16(static_cast<uint16_t>(length));
+    buffer.append(value, 0, length);
+    return *this;
+}
+
+PosWriter& PosWriter::text(const std::string& value) {
+    u32(static_cast<uint32_t>(value.size()));
+    buffer.append(value);
+    return *this;
+}
+
+void PosWriter::finish() {
+    uint32_t length = static_cast<uint32_t>(buffer.size() - start - POS_FRAME_HEADER);
+    for (int i = 0; i < 4; ++i) {
+        buffer[start + i] = static_cast<char>((length >> (8 * i)) & 0xff);
+    }
+}
+
+// PosReader implementation
+PosReader::PosReader(const char* data, size_t length) : data(data), length(length), offset(0), error(false) {
+}
+
+bool PosReader::take(size_t count) {
+    if (error || length - offset < count) {
+        error = true;
+        return false;
+    }
+    return true;
+}
+
+uint8_t PosReader::u8() {
+    if (!take(1)) {
+        return 0;
+    }
+    return static_cast<uint8_t>(data[offset++]);
+}
+
+uint16_t PosReader::u16() {
+    if (!take(2)) {
+        return 0;
+    }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data + offset);
+    offset += 2;
+    return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+uint32_t PosReader::u32() {
+    if (!take(4)) {
+        return 0;
+    }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data + offset);
+    offset += 4;
+    return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+           (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+double PosReader::f64() {
+    uint64_t low = u32();
+    uint64_t high = u32();
+    uint64_t bits = low | (high << 32);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string PosReader::str() {
+    uint16_t size = u16();
+    if (!take(size)) {
+        return std::string();
+    }
+    std::string value(data + offset, size);
+    offset += size;
+    return value;
+}
+
+std::string PosReader::text() {
+    uint32_t size = u32();
+    if (!take(size)) {
+        return std::string();
+    }
+    std::string value(data + offset, size);
+    offset += size;
+    return value;
+}
+
+size_t posFrameLength(const char* data, size_t available, bool& oversized) {
+    oversized = false;
+    if (available < POS_FRAME_HEADER) {
+        return 0;
+    }
+    PosReader header(data, POS_FRAME_HEADER);
+    uint32_t body = header.u32();
+    if (body > POS_MAX_FRAME) {
+        oversized = true;
+        return 0;
+    }
+    return available >= POS_FRAME_HEADER + body ? POS_FRAME_HEADER + body : 0;
+}
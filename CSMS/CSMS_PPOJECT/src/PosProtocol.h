@@ -0,0 +1,115 @@
+// ===== PosProtocol.h =====
+#ifndef POS_PROTOCOL_H
+#define POS_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Wire format shared by the POS server and its clients.
+ *
+ * Every message is a frame: a 4-byte body length, then the body. A request
+ * body is an opcode byte, a 4-byte request ID chosen by the client, and the
+ * opcode's fields; a response body is a status byte, the request's ID and
+ * the result fields (or, on error, one string). Integers are little-endian,
+ * doubles are IEEE-754 sent as their 8-byte pattern, and strings are a
+ * 2-byte length followed by the bytes; text is a 4-byte length followed by
+ * the bytes, for results that can outgrow a string.
+ *
+ * A client may send any number of requests without waiting; the server
+ * answers each connection's requests in order, and everything it can answer
+ * from one read goes back in one write.
+ *
+ *   Opcode     Request fields                  Response fields
+ *   PING       -                               -
+ *   LIST       str afterId, u16 limit          u16 count, str id...
+ *   LOOKUP     str productId                   str name, f64 price, i32 available, u8 active
+ *   CUSTOMER   str customerId ("" = walk-in)   -
+ *   ADD        str productId, f64 quantity     u16 items
+ *   REMOVE     u16 itemNo (from 1)             u16 items
+ *   TOTAL      -                               u16 items, f64 subtotal, f64 tax, f64 total
+ *   CHECKOUT   u8 method, f64 paid (<0 exact)  i32 transactionId, f64 total, f64 change
+ *   VOID       -                               -
+ *   REFUND     i32 transactionId, f64 amount   f64 refunded      (amount < 0 refunds in full)
+ *   REPORT     str arguments ("sales today")   text report
+ *   SCAN       str barcode (GTIN digits)       u16 items, f64 quantity, f64 line total
+ */
+enum class PosOpcode : uint8_t {
+    PING = 1,
+    LIST,
+    LOOKUP,
+    CUSTOMER,
+    ADD,
+    REMOVE,
+    TOTAL,
+    CHECKOUT,
+    VOID,
+    REFUND,
+    REPORT,
+    SCAN
+};
+
+enum class PosStatus : uint8_t {
+    OK = 0,
+    ERROR = 1
+};
+
+const uint32_t POS_MAX_FRAME = 1024 * 1024;   // Larger frames close the connection
+const size_t POS_FRAME_HEADER = 4;
+const size_t POS_REQUEST_HEADER = 5;          // Opcode and request ID
+const size_t POS_RESPONSE_HEADER = 5;         // Status and request ID
+
+/**
+ * @brief Appends one frame to a buffer; the length is filled in by finish()
+ */
+class PosWriter {
+private:
+    std::string& buffer;
+    size_t start;
+
+public:
+    explicit PosWriter(std::string& buffer);
+
+    PosWriter& u8(uint8_t value);
+    PosWriter& u16(uint16_t value);
+    PosWriter& u32(uint32_t value);
+    PosWriter& i32(int32_t value) { return u32(static_cast<uint32_t>(value)); }
+    PosWriter& f64(double value);
+    PosWriter& str(const std::string& value);   // Truncated to 65535 bytes
+    PosWriter& text(const std::string& value);  // Must fit in POS_MAX_FRAME with the other fields
+    void finish();
+};
+
+/**
+ * @brief Bounds-checked reader over one frame body; a short read sets failed()
+ */
+class PosReader {
+private:
+    const char* data;
+    size_t length;
+    size_t offset;
+    bool error;
+
+    bool take(size_t count);
+
+public:
+    PosReader(const char* data, size_t length);
+
+    uint8_t u8();
+    uint16_t u16();
+    uint32_t u32();
+    int32_t i32() { return static_cast<int32_t>(u32()); }
+    double f64();
+    std::string str();
+    std::string text();
+
+    bool failed() const { return error; }
+    bool atEnd() const { return offset == length; }
+};
+
+/**
+ * @brief Length of the complete frame at the front of a buffer, or 0 if it has not all arrived
+ */
+size_t posFrameLength(const char* data, size_t available, bool& oversized);
+
+#endif // POS_PROTOCOL_H
@@ -0,0 +1,591 @@
+// ===== PosServer.cpp =====
+#include "PosServer.h"
+#include "Gtin.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const size_t READ_CHUNK = 64 * 1024;
+static const size_t OUTPUT_LIMIT = 4 * 1024 * 1024;   // Unsent bytes before a connection stops being read
+static const int MAX_EVENTS = 256;
+
+// Request fields have been read; anything missing or left over means the frame is malformed
+static bool complete(const PosReader& request, std::string& error) {
+    if (request.failed() || !request.atEnd()) {
+        error = "malformed request";
+        return false;
+    }
+    return true;
+}
+
+// PosConnection implementation
+PosConnection::PosConnection(int fd, int id)
+    : fd(fd), id(id), inputHead(0), outputHead(0), events(0), cashierId("LANE" + std::to_string(id)),
+      customer(nullptr), cart(nullptr) {
+}
+
+// PosServer implementation
+PosServer::PosServer(Store& store)
+    : store(store), reports(store), epollFd(epoll_create1(EPOLL_CLOEXEC)), nextConnectionId(1), replenish(false) {
+    std::memset(&stats, 0, sizeof(stats));
+}
+
+PosServer::~PosServer() {
+    std::vector<PosConnection*> open;
+    for (const auto& entry : connections) {
+        open.push_back(entry.second);
+    }
+    for (PosConnection* connection : open) {
+        closeConnection(connection);
+    }
+    for (int listener : listeners) {
+        close(listener);
+    }
+    if (!unixPath.empty()) {
+        unlink(unixPath.c_str());
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+bool PosServer::listenUnix(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    if (epollFd < 0 || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    unlink(path.c_str());   // A socket file left by an earlier run
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return false;
+    }
+
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+    listeners.push_back(fd);
+    unixPath = path;
+    return true;
+}
+
+bool PosServer::listenTcp(int port) {
+    if (epollFd < 0) {
+        return false;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return false;
+    }
+
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        close(fd);
+        return false;
+    }
+    listeners.push_back(fd);
+    return true;
+}
+
+void PosServer::run(const std::atomic<bool>& stop) {
+    epoll_event events[MAX_EVENTS];
+    while (!stop.load(std::memory_order_relaxed)) {
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, 100);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            if (std::find(listeners.begin(), listeners.end(), fd) != listeners.end()) {
+                acceptFrom(fd);
+                continue;
+            }
+            auto it = connections.find(fd);
+            if (it == connections.end()) {
+                continue;   // Closed earlier in this batch of events
+            }
+            PosConnection& connection = *it->second;
+            bool open = true;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                open = false;
+            }
+            if (open && (events[i].events & EPOLLOUT)) {
+                open = writeTo(connection);
+                if (open && connection.output.size() - connection.outputHead < OUTPUT_LIMIT) {
+                    processInput(connection);   // Frames held back while the output was full
+                    open = writeTo(connection);
+                }
+            }
+            if (open && (events[i].events & EPOLLIN)) {
+                open = readFrom(connection);
+            }
+            if (open) {
+                updateInterest(connection);
+            } else {
+                closeConnection(&connection);
+            }
+        }
+    }
+}
+
+void PosServer::acceptFrom(int listener) {
+    for (;;) {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;   // EAGAIN once the backlog is empty; anything else is retried on the next event
+        }
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));   // Fails harmlessly on Unix sockets
+
+        PosConnection* connection = new PosConnection(fd, nextConnectionId++);
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            delete connection;
+            continue;
+        }
+        connection->events = EPOLLIN;
+        connections[fd] = connection;
+        stats.accepted++;
+    }
+}
+
+void PosServer::closeConnection(PosConnection* connection) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+    close(connection->fd);
+    connections.erase(connection->fd);
+    delete connection->cart;   // A cart that was never paid for has not touched the store
+    delete connection;
+    stats.closed++;
+}
+
+bool PosServer::readFrom(PosConnection& connection) {
+    bool peerClosed = false;
+    char chunk[READ_CHUNK];
+    for (;;) {
+        ssize_t received = read(connection.fd, chunk, sizeof(chunk));
+        if (received > 0) {
+            connection.input.append(chunk, received);
+            stats.bytesIn += received;
+            if (static_cast<size_t>(received) < sizeof(chunk)) {
+                break;   // Drained; saves the read that would return EAGAIN
+            }
+            continue;
+        }
+        if (received == 0) {
+            peerClosed = true;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            return false;
+        }
+        break;
+    }
+
+    processInput(connection);
+    bool open = writeTo(connection);
+    return open && !peerClosed;
+}
+
+void PosServer::processInput(PosConnection& connection) {
+    long answered = 0;
+    while (connection.output.size() - connection.outputHead < OUTPUT_LIMIT) {
+        bool oversized;
+        size_t available = connection.input.size() - connection.inputHead;
+        size_t frame = posFrameLength(connection.input.data() + connection.inputHead, available, oversized);
+        if (oversized) {
+            // The stream cannot be resynchronized; drop what is left and let the peer see the close
+            connection.input.clear();
+            connection.inputHead = 0;
+            shutdown(connection.fd, SHUT_RD);
+            break;
+        }
+        if (frame == 0) {
+            break;
+        }
+        answer(connection, connection.input.data() + connection.inputHead + POS_FRAME_HEADER,
+               frame - POS_FRAME_HEADER);
+        connection.inputHead += frame;
+        answered++;
+    }
+
+    // Keep the partial frame at the front of the buffer
+    if (connection.inputHead == connection.input.size()) {
+        connection.input.clear();
+        connection.inputHead = 0;
+    } else if (connection.inputHead > connection.input.size() / 2) {
+        connection.input.erase(0, connection.inputHead);
+        connection.inputHead = 0;
+    }
+
+    if (answered > 0) {
+        stats.batches++;
+        stats.maxBatch = std::max(stats.maxBatch, answered);
+    }
+}
+
+bool PosServer::writeTo(PosConnection& connection) {
+    while (connection.outputHead < connection.output.size()) {
+        ssize_t sent = send(connection.fd, connection.output.data() + connection.outputHead,
+                            connection.output.size() - connection.outputHead, MSG_NOSIGNAL);
+        if (sent > 0) {
+            connection.outputHead += sent;
+            stats.bytesOut += sent;
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;   // The rest goes when EPOLLOUT fires
+        }
+        return false;
+    }
+    connection.output.clear();
+    connection.outputHead = 0;
+    return true;
+}
+
+void PosServer::updateInterest(PosConnection& connection) {
+    size_t pending = connection.output.size() - connection.outputHead;
+    uint32_t wanted = (pending < OUTPUT_LIMIT ? static_cast<uint32_t>(EPOLLIN) : 0u) |
+                      (pending > 0 ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    if (wanted == connection.events) {
+        return;
+    }
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = wanted;
+    event.data.fd = connection.fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event) == 0) {
+        connection.events = wanted;
+    }
+}
+
+void PosServer::answer(PosConnection& connection, const char* body, size_t length) {
+    stats.requests++;
+    PosReader request(body, length);
+    PosOpcode opcode = static_cast<PosOpcode>(request.u8());
+    uint32_t requestId = request.u32();
+
+    size_t mark = connection.output.size();
+    std::string error;
+    bool ok;
+    {
+        PosWriter reply(connection.output);
+        reply.u8(static_cast<uint8_t>(PosStatus::OK)).u32(requestId);
+        if (request.failed()) {
+            error = "malformed request";
+            ok = false;
+        } else {
+            ok = dispatch(connection, opcode, request, reply, error);
+        }
+        if (ok) {
+            reply.finish();
+        }
+    }
+    if (!ok) {
+        // Whatever the handler wrote before failing is replaced by the error
+        connection.output.resize(mark);
+        PosWriter reply(connection.output);
+        reply.u8(static_cast<uint8_t>(PosStatus::ERROR)).u32(requestId).str(error);
+        reply.finish();
+        stats.errors++;
+    }
+}
+
+bool PosServer::addToCart(PosConnection& connection, Product* product, double quantity, const BarcodeScan* scan,
+                          std::string& error) {
+    if (replenish) {
+        int needed = static_cast<int>(std::ceil(quantity));
+        if (product->getAvailableStock() < needed + product->getMinStockLevel()) {
+            product->addStock(product->getRestockRecommendation() + needed);
+        }
+    }
+    if (!connection.cart) {
+        connection.cart = store.openTransaction(connection.customer, connection.cashierId);
+    }
+    bool added = scan ? connection.cart->addScannedItem(product, *scan) : connection.cart->addItem(product, quantity);
+    if (!added) {
+        error = "cannot sell " + product->getId();
+        if (connection.cart->getItems().empty()) {
+            delete connection.cart;
+            connection.cart = nullptr;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool PosServer::dispatch(PosConnection& connection, PosOpcode opcode, PosReader& request, PosWriter& reply,
+                         std::string& error) {
+    switch (opcode) {
+    case PosOpcode::PING:
+        return complete(request, error);
+
+    case PosOpcode::LIST: {
+        std::string afterId = request.str();
+        uint16_t limit = request.u16();
+        if (!complete(request, error)) {
+            return false;
+        }
+        std::vector<Product*> page = store.getInventory().listProducts(afterId, limit);
+        reply.u16(static_cast<uint16_t>(page.size()));
+        for (const Product* product : page) {
+            reply.str(product->getId());
+        }
+        return true;
+    }
+
+    case PosOpcode::LOOKUP: {
+        std::string productId = request.str();
+        if (!complete(request, error)) {
+            return false;
+        }
+        Product* product = store.getInventory().findProduct(productId);
+        if (!product) {
+            error = "no such product: " + productId;
+            return false;
+        }
+        reply.str(product->getName()).f64(store.getPriceBook().getPrice(*product)).i32(product->getAvailableStock());
+        reply.u8(product->getIsActive() ? 1 : 0);
+        return true;
+    }
+
+    case PosOpcode::CUSTOMER: {
+        std::string customerId = request.str();
+        if (!complete(request, error)) {
+            return false;
+        }
+        Customer* customer = nullptr;
+        if (!customerId.empty()) {
+            customer = store.getCustomerDatabase().findCustomer(customerId);
+            if (!customer) {
+                error = "customer not found: " + customerId;
+                return false;
+            }
+        }
+        connection.customer = customer;
+        if (connection.cart) {
+            connection.cart->setCustomer(customer);
+        }
+        return true;
+    }
+
+    case PosOpcode::ADD: {
+        std::string productId = request.str();
+        double quantity = request.f64();
+        if (!complete(request, error)) {
+            return false;
+        }
+        if (!(quantity > 0)) {
+            error = "invalid quantity";
+            return false;
+        }
+        Product* product = store.getInventory().findProduct(productId);
+        if (!product || !product->getIsActive()) {
+            error = "no such product: " + productId;
+            return false;
+        }
+        if (!addToCart(connection, product, quantity, nullptr, error)) {
+            return false;
+        }
+        reply.u16(static_cast<uint16_t>(connection.cart->getItems().size()));
+        return true;
+    }
+
+    case PosOpcode::SCAN: {
+        std::string barcode = request.str();
+        if (!complete(request, error)) {
+            return false;
+        }
+        BarcodeScan scan;
+        Product* product = store.getInventory().findProductByBarcode(barcode, scan);
+        if (!product || !product->getIsActive()) {
+            error = (scan.format == GtinFormat::INVALID ? "invalid barcode: " : "unknown barcode: ") + barcode;
+            return false;
+        }
+        if (!addToCart(connection, product, scan.measure == MeasureKind::WEIGHT ? scan.quantity : 1.0, &scan,
+                       error)) {
+            return false;
+        }
+        const TransactionItem& item = connection.cart->getItems().back();
+        reply.u16(static_cast<uint16_t>(connection.cart->getItems().size())).f64(item.quantity).f64(item.subtotal);
+        return true;
+    }
+
+    case PosOpcode::REMOVE: {
+        uint16_t itemNo = request.u16();
+        if (!complete(request, error)) {
+            return false;
+        }
+        if (!connection.cart || itemNo == 0 || !connection.cart->removeItem(itemNo - 1)) {
+            error = "no item " + std::to_string(itemNo);
+            return false;
+        }
+        size_t items = connection.cart->getItems().size();
+        if (items == 0) {
+            delete connection.cart;
+            connection.cart = nullptr;
+        }
+        reply.u16(static_cast<uint16_t>(items));
+        return true;
+    }
+
+    case PosOpcode::TOTAL: {
+        if (!complete(request, error)) {
+            return false;
+        }
+        if (!connection.cart) {
+            reply.u16(0).f64(0.0).f64(0.0).f64(0.0);
+            return true;
+        }
+        store.priceTransaction(connection.cart);
+        reply.u16(static_cast<uint16_t>(connection.cart->getItems().size()));
+        reply.f64(connection.cart->getSubtotal()).f64(connection.cart->getTax()).f64(connection.cart->getFinalTotal());
+        return true;
+    }
+
+    case PosOpcode::CHECKOUT: {
+        uint8_t method = request.u8();
+        double paid = request.f64();
+        if (!complete(request, error)) {
+            return false;
+        }
+        if (method > static_cast<uint8_t>(PaymentMethod::GIFT_CARD)) {
+            error = "unknown payment method " + std::to_string(method);
+            return false;
+        }
+        if (!connection.cart) {
+            error = "cart is empty";
+            return false;
+        }
+        Transaction* cart = connection.cart;
+        store.priceTransaction(cart);
+        if (paid < 0) {
+            paid = cart->getFinalTotal();
+        }
+        if (!store.completeSale(cart, static_cast<PaymentMethod>(method), paid)) {
+            error = "payment failed";
+            return false;
+        }
+        // The store owns the completed transaction
+        connection.cart = nullptr;
+        reply.i32(cart->getId()).f64(cart->getFinalTotal()).f64(paid - cart->getFinalTotal());
+        stats.sales++;
+        return true;
+    }
+
+    case PosOpcode::VOID:
+        if (!complete(request, error)) {
+            return false;
+        }
+        delete connection.cart;
+        connection.cart = nullptr;
+        return true;
+
+    case PosOpcode::REFUND: {
+        int32_t transactionId = request.i32();
+        double amount = request.f64();
+        if (!complete(request, error)) {
+            return false;
+        }
+        Transaction* transaction = store.findTransaction(transactionId);
+        if (!transaction) {
+            bool archived = store.getArchive().findTransaction(transactionId, [](const ArchivedTransaction&) {});
+            error = (archived ? "archived transaction " : "no transaction ") + std::to_string(transactionId);
+            return false;
+        }
+        RefundRecord record;
+        if (!transaction->processRefund(amount < 0 ? -1.0 : amount, &record)) {
+            error = "refund rejected for transaction " + std::to_string(transactionId);
+            return false;
+        }
+        store.recordRefund(transaction, record);
+        reply.f64(record.amount);
+        return true;
+    }
+
+    case PosOpcode::REPORT: {
+        std::string arguments = request.str();
+        if (!complete(request, error)) {
+            return false;
+        }
+        // Reports print to std::cout; borrow it for the length of the command
+        std::ostringstream text;
+        std::streambuf* previous = std::cout.rdbuf(text.rdbuf());
+        bool ok = reports.execute("report " + arguments, error);
+        std::cout.rdbuf(previous);
+        if (!ok) {
+            return false;
+        }
+        std::string report = text.str();
+        if (report.size() > POS_MAX_FRAME - POS_RESPONSE_HEADER - 4) {
+            error = "report is " + std::to_string(report.size()) + " bytes, over the " +
+                    std::to_string(POS_MAX_FRAME) + "-byte frame limit";
+            return false;
+        }
+        reply.text(report);
+        return true;
+    }
+    }
+
+    error = "unknown opcode " + std::to_string(static_cast<int>(opcode));
+    return false;
+}
+
+void PosServer::display(std::ostream& out) const {
+    out << "Connections: " << connections.size() << " open, " << stats.accepted << " accepted, " << stats.closed
+        << " closed" << std::endl;
+    out << "Requests: " << stats.requests << ", errors " << stats.errors << ", sales " << stats.sales << std::endl;
+    out << "Batches: " << stats.batches << ", " << std::fixed << std::setprecision(1)
+        << (stats.batches ? static_cast<double>(stats.requests) / stats.batches : 0.0) << " requests each on average, "
+        << stats.maxBatch << " at most" << std::endl;
+    out << "Traffic: " << std::setprecision(2) << stats.bytesIn / 1048576.0 << " MB in, "
+        << stats.bytesOut / 1048576.0 << " MB out" << std::endl;
+    out.unsetf(std::ios::fixed);
+}
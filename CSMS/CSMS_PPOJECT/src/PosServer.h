@@ -0,0 +1,105 @@
+// ===== PosServer.h =====
+#ifndef POS_SERVER_H
+#define POS_SERVER_H
+
+#include "Store.h"
+#include "CommandProcessor.h"
+#include "PosProtocol.h"
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct BarcodeScan;
+
+/**
+ * @brief Counters for the server's lifetime
+ */
+struct PosServerStats {
+    long accepted;
+    long closed;
+    long requests;
+    long errors;           // Requests answered with an error status
+    long sales;
+    long batches;          // Reads that carried at least one complete request
+    long maxBatch;         // Most requests answered by one write
+    long bytesIn;
+    long bytesOut;
+};
+
+/**
+ * @brief Lane terminal attached to the server: its buffers and open cart
+ */
+struct PosConnection {
+    int fd;
+    int id;
+    std::string input;
+    size_t inputHead;      // Start of the first unprocessed frame
+    std::string output;
+    size_t outputHead;     // Start of the bytes not yet written
+    uint32_t events;       // Interest currently registered with epoll
+    std::string cashierId;
+    Customer* customer;
+    Transaction* cart;     // Created by the first ADD, nullptr while idle
+
+    PosConnection(int fd, int id);
+};
+
+/**
+ * @brief Serves the store to lane terminals over local sockets
+ *
+ * One thread, one epoll set: listeners on a Unix-domain path and/or a
+ * loopback TCP port, and every connection accepted from them. Requests use
+ * the framing in PosProtocol.h. Each readable event drains the socket,
+ * answers every complete frame it holds in order, and sends the replies
+ * back with a single write, so a terminal that pipelines requests gets them
+ * answered in batches. A connection that stops reading its replies stops
+ * being read once its unsent output passes a limit.
+ *
+ * Store is not thread safe; owning it from one thread is what lets the
+ * server call it without locks.
+ */
+class PosServer {
+private:
+    Store& store;
+    CommandProcessor reports;
+    int epollFd;
+    std::vector<int> listeners;
+    std::string unixPath;
+    std::unordered_map<int, PosConnection*> connections;
+    int nextConnectionId;
+    bool replenish;
+    PosServerStats stats;
+
+    void acceptFrom(int listener);
+    void closeConnection(PosConnection* connection);
+    bool readFrom(PosConnection& connection);
+    bool writeTo(PosConnection& connection);
+    void processInput(PosConnection& connection);
+    void updateInterest(PosConnection& connection);
+    void answer(PosConnection& connection, const char* body, size_t length);
+    bool addToCart(PosConnection& connection, Product* product, double quantity, const BarcodeScan* scan,
+                   std::string& error);
+    bool dispatch(PosConnection& connection, PosOpcode opcode, PosReader& request, PosWriter& reply,
+                  std::string& error);
+
+public:
+    explicit PosServer(Store& store);
+    ~PosServer();                      // Closes every connection; open carts are voided
+
+    bool listenUnix(const std::string& path);
+    bool listenTcp(int port);          // Loopback only
+
+    // Tops a product up from the back room when an ADD would run it below its minimum
+    void setReplenish(bool on) { replenish = on; }
+
+    // Serves until stop is set; checked at least every 100 ms
+    void run(const std::atomic<bool>& stop);
+
+    size_t getConnectionCount() const { return connections.size(); }
+    const PosServerStats& getStats() const { return stats; }
+    void display(std::ostream& out) const;
+};
+
+#endif // POS_SERVER_H
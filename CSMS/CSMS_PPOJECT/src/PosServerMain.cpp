@@ -0,0 +1,120 @@
+// ===== PosServerMain.cpp =====
+// Lane terminal server.
+//
+// Loads a store (generated, or the sample data) and serves it to thin
+// lane clients over a Unix-domain socket and/or a loopback TCP port until
+// interrupted, then prints what it handled. posload drives it.
+
+#include "PosServer.h"
+#include "DataGenerator.h"
+#include "NullBuffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+static std::atomic<bool> stopRequested(false);
+
+static void requestStop(int) {
+    stopRequested.store(true);
+}
+
+static void printUsage() {
+    std::cout << "Usage: posserver [options]\n"
+              << "  --unix PATH      Listen on a Unix-domain socket (default /tmp/csms-pos.sock)\n"
+              << "  --tcp PORT       Also listen on 127.0.0.1:PORT\n"
+              << "  --products N     Generated catalog size; 0 loads the sample data (default 2000)\n"
+              << "  --replenish      Restock from the back room instead of refusing sales\n"
+              << "  --journal FILE   Journal sales to FILE\n"
+              << "  --seconds S      Stop after S seconds (default: run until interrupted)\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string unixPath = "/tmp/csms-pos.sock";
+    int tcpPort = 0;
+    bool replenish = false;
+    std::string journalPath;
+    double seconds = 0.0;
+    GeneratorConfig data;
+    data.productCount = 2000;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--unix" && hasValue) {
+            unixPath = argv[++i];
+        } else if (arg == "--tcp" && hasValue) {
+            tcpPort = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--products" && hasValue) {
+            data.productCount = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--replenish") {
+            replenish = true;
+        } else if (arg == "--journal" && hasValue) {
+            journalPath = argv[++i];
+        } else if (arg == "--seconds" && hasValue) {
+            seconds = std::max(0.0, std::atof(argv[++i]));
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // Transactions still print stock warnings to the console; lanes get error replies instead
+    std::ostream out(std::cout.rdbuf());
+    NullBuffer discard;
+    std::cout.rdbuf(&discard);
+
+    Store store;
+    if (data.productCount > 0) {
+        DataGenerator generator(data);
+        generator.populate(store);
+    } else {
+        store.loadSampleData();
+    }
+    if (!journalPath.empty() && !store.openJournal(journalPath)) {
+        out << "Cannot open journal " << journalPath << "\n";
+        std::cout.rdbuf(out.rdbuf());
+        return 1;
+    }
+
+    PosServer server(store);
+    server.setReplenish(replenish);
+    if (!unixPath.empty() && !server.listenUnix(unixPath)) {
+        out << "Cannot listen on " << unixPath << "\n";
+        std::cout.rdbuf(out.rdbuf());
+        return 1;
+    }
+    if (tcpPort > 0 && !server.listenTcp(tcpPort)) {
+        out << "Cannot listen on 127.0.0.1:" << tcpPort << "\n";
+        std::cout.rdbuf(out.rdbuf());
+        return 1;
+    }
+    out << "Serving " << store.getInventory().getTotalProductCount() << " products on " << unixPath
+        << (tcpPort > 0 ? " and 127.0.0.1:" + std::to_string(tcpPort) : std::string()) << std::endl;
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::thread timer;
+    if (seconds > 0) {
+        timer = std::thread([seconds]() {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+            while (!stopRequested.load() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+            stopRequested.store(true);
+        });
+    }
+
+    server.run(stopRequested);
+    if (timer.joinable()) {
+        timer.join();
+    }
+    store.syncJournal();
+    server.display(out);
+    std::cout.rdbuf(out.rdbuf());
+    return 0;
+}
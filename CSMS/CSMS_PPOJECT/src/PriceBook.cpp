@@ -0,0 +1,329 @@
+// ===== PriceBook.cpp =====
+#include "PriceBook.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <thread>
+#include <unordered_set>
+
+// Touched pages per build thread before a publish goes parallel
+static const size_t PAGES_PER_THREAD = 64;
+
+PriceBook::PriceBook()
+    : nextDue(std::numeric_limits<std::time_t>::max()), nextScheduleId(1),
+      threads(static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))),
+      published(0), pagesCopied(0), pricesChanged(0), lastBuildSeconds(0.0), lastBuildThreads(0) {
+    std::shared_ptr<PriceVersion> first = std::make_shared<PriceVersion>();
+    first->number = 1;
+    first->publishedAt = std::time(nullptr);
+    first->scheduleId = 0;
+    first->count = 0;
+    current = first;
+}
+
+void PriceBook::registerLocked(const std::vector<Product*>& products) {
+    PriceChange change;
+    int nextSlot = static_cast<int>(current->count);
+    for (Product* product : products) {
+        if (product && product->getPriceSlot() < 0) {
+            product->setPriceSlot(nextSlot);
+            change.prices.push_back(std::make_pair(nextSlot, product->calculateSellingPrice()));
+            ++nextSlot;
+        }
+    }
+    if (!change.empty()) {
+        publishLocked(change, 0);
+    }
+}
+
+void PriceBook::publishLocked(const PriceChange& change, uint64_t scheduleId) {
+    auto start = std::chrono::steady_clock::now();
+    PriceVersionPtr base = current;
+
+    // Group the new prices by page; later entries for a slot win
+    std::vector<std::pair<int, double>> sorted(change.prices);
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+                         return a.first < b.first;
+                     });
+    size_t count = base->count;
+    if (!sorted.empty()) {
+        count = std::max(count, static_cast<size_t>(sorted.back().first) + 1);
+    }
+    std::vector<size_t> pageStarts;   // Offsets into sorted where a new page begins
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (i == 0 || sorted[i].first / PRICE_PAGE_SIZE != sorted[i - 1].first / PRICE_PAGE_SIZE) {
+            pageStarts.push_back(i);
+        }
+    }
+    pageStarts.push_back(sorted.size());
+    size_t touched = pageStarts.size() - 1;
+
+    std::shared_ptr<PriceVersion> version = std::make_shared<PriceVersion>();
+    version->number = base->number + 1;
+    version->publishedAt = std::time(nullptr);
+    version->scheduleId = scheduleId;
+    version->count = count;
+    version->pages = base->pages;   // Untouched pages are shared with the base
+    version->pages.resize((count + PRICE_PAGE_SIZE - 1) / PRICE_PAGE_SIZE);
+
+    // Each touched page is copied once and written by one thread
+    auto buildPages = [&sorted, &pageStarts, &version](size_t first, size_t last) {
+        for (size_t p = first; p < last; ++p) {
+            size_t pageIndex = sorted[pageStarts[p]].first / PRICE_PAGE_SIZE;
+            const std::shared_ptr<const PricePage>& old = version->pages[pageIndex];
+            std::shared_ptr<PricePage> page = old ? std::make_shared<PricePage>(*old)
+                                                  : std::make_shared<PricePage>();
+            for (size_t i = pageStarts[p]; i < pageStarts[p + 1]; ++i) {
+                page->prices[sorted[i].first % PRICE_PAGE_SIZE] = sorted[i].second;
+            }
+            version->pages[pageIndex] = page;
+        }
+    };
+    int buildThreads = static_cast<int>(std::min<size_t>(threads, std::max<size_t>(1, touched / PAGES_PER_THREAD)));
+    if (buildThreads <= 1) {
+        buildPages(0, touched);
+    } else {
+        std::vector<std::thread> workers;
+        size_t chunk = (touched + buildThreads - 1) / buildThreads;
+        for (int t = 0; t < buildThreads; ++t) {
+            size_t first = std::min(touched, t * chunk);
+            size_t last = std::min(touched, first + chunk);
+            workers.emplace_back(buildPages, first, last);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Carts that already hold the base keep it; it is freed with the last of them
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                 [](const std::weak_ptr<const PriceVersion>& old) { return old.expired(); }),
+                  retired.end());
+    retired.push_back(base);
+    std::atomic_store(&current, PriceVersionPtr(version));
+
+    published++;
+    pagesCopied += static_cast<long>(touched);
+    pricesChanged += static_cast<long>(sorted.size());
+    lastBuildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    lastBuildThreads = buildThreads;
+}
+
+void PriceBook::promoteLocked(std::time_t now, std::vector<ScheduledPriceChange>& promoted) {
+    while (!pending.empty() && pending.front().effectiveAt <= now) {
+        // Priced from the version current now, so changes published since it was scheduled stay in
+        const ScheduledPriceChange& entry = pending.front();
+        PriceChange change;
+        change.prices.reserve(entry.slots.size());
+        for (int slot : entry.slots) {
+            if (slot >= 0 && static_cast<size_t>(slot) < current->count) {
+                double price = current->pages[slot / PRICE_PAGE_SIZE]->prices[slot % PRICE_PAGE_SIZE];
+                change.prices.push_back(std::make_pair(slot, std::round(price * (100.0 + entry.percentageChange)) / 100.0));
+            }
+        }
+        publishLocked(change, entry.id);
+        promoted.push_back(entry);
+        pending.erase(pending.begin());
+    }
+    nextDue.store(pending.empty() ? std::numeric_limits<std::time_t>::max() : pending.front().effectiveAt);
+}
+
+void PriceBook::registerProducts(const std::vector<Product*>& products) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    registerLocked(products);
+}
+
+void PriceBook::setPromotionListener(const std::function<void(const ScheduledPriceChange&)>& listener) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    promotionListener = listener;
+}
+
+PriceVersionPtr PriceBook::acquire(std::time_t now) {
+    if (now >= nextDue.load()) {
+        std::vector<ScheduledPriceChange> promoted;
+        std::function<void(const ScheduledPriceChange&)> listener;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            promoteLocked(now, promoted);
+            listener = promotionListener;
+        }
+        if (listener) {
+            for (const ScheduledPriceChange& entry : promoted) {
+                listener(entry);
+            }
+        }
+    }
+    return std::atomic_load(&current);
+}
+
+PriceChange PriceBook::draftPercentChange(const std::vector<Product*>& products, double percentageChange) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    registerLocked(products);
+    PriceChange change;
+    change.prices.reserve(products.size());
+    for (const Product* product : products) {
+        if (product) {
+            double price = current->priceOf(*product);
+            change.prices.push_back(std::make_pair(product->getPriceSlot(),
+                                                   std::round(price * (100.0 + percentageChange)) / 100.0));
+        }
+    }
+    return change;
+}
+
+PriceChange PriceBook::draftPrice(Product* product, double price) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    registerLocked(std::vector<Product*>(1, product));
+    PriceChange change;
+    change.prices.push_back(std::make_pair(product->getPriceSlot(), price));
+    return change;
+}
+
+PriceChange PriceBook::draftSellingPrices(const std::vector<Product*>& products) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    registerLocked(products);
+    PriceChange change;
+    change.prices.reserve(products.size());
+    for (const Product* product : products) {
+        if (product) {
+            change.prices.push_back(std::make_pair(product->getPriceSlot(), product->calculateSellingPrice()));
+        }
+    }
+    return change;
+}
+
+uint64_t PriceBook::publish(const PriceChange& change) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (!change.empty()) {
+        publishLocked(change, 0);
+    }
+    return current->number;
+}
+
+uint64_t PriceBook::schedulePercentChange(const std::vector<Product*>& products, double percentageChange,
+                                          std::time_t effectiveAt) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    registerLocked(products);
+    ScheduledPriceChange entry;
+    entry.id = nextScheduleId++;
+    entry.effectiveAt = effectiveAt;
+    entry.percentageChange = percentageChange;
+    entry.slots.reserve(products.size());
+    for (const Product* product : products) {
+        if (product) {
+            entry.slots.push_back(product->getPriceSlot());
+        }
+    }
+    auto position = std::upper_bound(pending.begin(), pending.end(), effectiveAt,
+                                     [](std::time_t when, const ScheduledPriceChange& other) {
+                                         return when < other.effectiveAt;
+                                     });
+    pending.insert(position, entry);
+    nextDue.store(pending.front().effectiveAt);
+    return entry.id;
+}
+
+bool PriceBook::cancelScheduled(uint64_t scheduleId) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    for (auto it = pending.begin(); it != pending.end(); ++it) {
+        if (it->id == scheduleId) {
+            pending.erase(it);
+            nextDue.store(pending.empty() ? std::numeric_limits<std::time_t>::max() : pending.front().effectiveAt);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<ScheduledPriceChange> PriceBook::getScheduled() const {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return pending;
+}
+
+PriceBookStats PriceBook::getStats() const {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    PriceBookStats stats;
+    stats.version = current->number;
+    stats.products = current->count;
+    stats.published = published;
+    stats.scheduled = static_cast<long>(pending.size());
+    stats.pagesCopied = pagesCopied;
+    stats.pricesChanged = pricesChanged;
+    stats.lastBuildSeconds = lastBuildSeconds;
+    stats.lastBuildThreads = lastBuildThreads;
+
+    std::unordered_set<const PricePage*> pages;
+    std::vector<PriceVersionPtr> live(1, current);
+    for (const auto& old : retired) {
+        PriceVersionPtr version = old.lock();
+        if (version) {
+            live.push_back(version);
+        }
+    }
+    for (const auto& version : live) {
+        for (const auto& page : version->pages) {
+            pages.insert(page.get());
+        }
+    }
+    stats.versionsLive = static_cast<long>(live.size());
+    stats.pagesLive = static_cast<long>(pages.size());
+    return stats;
+}
+
+size_t PriceBook::getAllocatedBytes() const {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::unordered_set<const PricePage*> pages;
+    size_t bytes = 0;
+    std::vector<PriceVersionPtr> live(1, current);
+    for (const auto& old : retired) {
+        PriceVersionPtr version = old.lock();
+        if (version) {
+            live.push_back(version);
+        }
+    }
+    for (const auto& version : live) {
+        bytes += MemorySizing::allocation(sizeof(PriceVersion) + 2 * sizeof(long)) +
+                 MemorySizing::vectorBytes(version->pages);
+        for (const auto& page : version->pages) {
+            if (pages.insert(page.get()).second) {
+                bytes += MemorySizing::allocation(sizeof(PricePage) + 2 * sizeof(long));
+            }
+        }
+    }
+    for (const auto& entry : pending) {
+        bytes += MemorySizing::vectorBytes(entry.slots);
+    }
+    return bytes;
+}
+
+void PriceBook::display(std::ostream& out) const {
+    PriceBookStats stats = getStats();
+    out << "Price book: version " << stats.version << ", " << stats.products << " products priced, "
+        << stats.versionsLive << " version" << (stats.versionsLive == 1 ? "" : "s") << " live in "
+        << stats.pagesLive << " pages (" << MemoryReport::formatBytes(getAllocatedBytes()) << ")" << std::endl;
+    out << "Published: " << stats.published << " versions, " << stats.pricesChanged << " prices written, "
+        << stats.pagesCopied << " pages copied";
+    if (stats.published > 0) {
+        out << "; last build " << std::fixed << std::setprecision(2) << stats.lastBuildSeconds * 1000.0
+            << " ms on " << stats.lastBuildThreads << " thread" << (stats.lastBuildThreads == 1 ? "" : "s");
+        out.unsetf(std::ios::fixed);
+    }
+    out << std::endl;
+
+    std::vector<ScheduledPriceChange> scheduled = getScheduled();
+    if (scheduled.empty()) {
+        out << "Scheduled: none" << std::endl;
+        return;
+    }
+    out << "Scheduled:" << std::endl;
+    for (const auto& entry : scheduled) {
+        char when[32];
+        std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M", std::localtime(&entry.effectiveAt));
+        out << "  #" << entry.id << " at " << when << ": " << std::showpos << entry.percentageChange
+            << std::noshowpos << "% on " << entry.slots.size() << " products" << std::endl;
+    }
+}
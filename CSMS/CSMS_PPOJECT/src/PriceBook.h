@@ -0,0 +1,173 @@
+// ===== PriceBook.h =====
+#ifndef PRICE_BOOK_H
+#define PRICE_BOOK_H
+
+#include "Product.h"
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+static const size_t PRICE_PAGE_SIZE = 1024;   // Prices per copy-on-write page
+
+/**
+ * @brief One page of shelf prices, indexed by price slot; never changed once published
+ */
+struct PricePage {
+    double prices[PRICE_PAGE_SIZE];
+};
+
+/**
+ * @brief An immutable price list; carts hold one for as long as they are open
+ *
+ * Versions share every page they did not change with the version they were
+ * built from, so a version costs one page per page of prices that changed.
+ */
+struct PriceVersion {
+    uint64_t number;
+    std::time_t publishedAt;
+    uint64_t scheduleId;                                  // 0 unless a scheduled change published it
+    size_t count;                                         // Slots priced by this version
+    std::vector<std::shared_ptr<const PricePage>> pages;
+
+    // Products this version does not price are sold at their own current price
+    double priceOf(const Product& product) const {
+        int slot = product.getPriceSlot();
+        if (slot < 0 || static_cast<size_t>(slot) >= count) {
+            return product.calculateSellingPrice();
+        }
+        return pages[slot / PRICE_PAGE_SIZE]->prices[slot % PRICE_PAGE_SIZE];
+    }
+};
+
+typedef std::shared_ptr<const PriceVersion> PriceVersionPtr;
+
+/**
+ * @brief New shelf prices as (price slot, price), applied together
+ */
+struct PriceChange {
+    std::vector<std::pair<int, double>> prices;
+
+    bool empty() const { return prices.empty(); }
+    size_t size() const { return prices.size(); }
+};
+
+/**
+ * @brief A percentage change waiting for its effective time
+ *
+ * Kept as a percentage rather than as prices, so it applies on top of
+ * whatever other changes were published before it came due.
+ */
+struct ScheduledPriceChange {
+    uint64_t id;
+    std::time_t effectiveAt;
+    double percentageChange;
+    std::vector<int> slots;    // Price slots it reprices
+};
+
+/**
+ * @brief Counters for the book's lifetime
+ */
+struct PriceBookStats {
+    uint64_t version;          // Current version number
+    size_t products;           // Registered price slots
+    long published;            // Versions published, scheduled ones included
+    long scheduled;            // Changes still waiting
+    long versionsLive;         // Current plus older versions still held by carts
+    long pagesLive;            // Distinct pages across live versions
+    long pagesCopied;          // Pages written by all publishes
+    long pricesChanged;
+    double lastBuildSeconds;
+    int lastBuildThreads;
+};
+
+/**
+ * @brief Versioned shelf prices; bulk changes are published all at once
+ *
+ * The book holds the price every product sells at as a chain of immutable
+ * versions. A cart pins the current version when it opens and prices every
+ * line from it, so a price change never reaches a cart half-way through,
+ * and a 1M-SKU change is built off to the side and becomes visible in one
+ * pointer swap. A version stays alive while any cart still holds it and is
+ * freed with the last one; pages no live version shares go with it.
+ *
+ * Building copies only the pages a change touches. Large changes split
+ * the pages over threads. Changes can also be scheduled: they are applied
+ * to whatever is current once their time comes, and the first cart opened
+ * or price looked up after that publishes them. The promotion listener
+ * then hears about each one, outside the lock, so the owner can bring
+ * everything that is not priced from the book into step.
+ *
+ * A product joins the book the first time a change touches it: it gets a
+ * price slot and the book publishes its current price first, so joining
+ * changes nothing a cart can see. Until then carts price it live.
+ *
+ * Carts read the current version without locking; writers are serialised
+ * by one mutex.
+ */
+class PriceBook {
+private:
+    PriceVersionPtr current;                 // Read and swapped with std::atomic_load/atomic_store
+    mutable std::mutex writeMutex;           // Registration, publishing and the schedule
+    std::vector<ScheduledPriceChange> pending;   // Sorted by effective time, guarded by writeMutex
+    std::atomic<std::time_t> nextDue;        // Earliest pending effective time
+    uint64_t nextScheduleId;
+    std::vector<std::weak_ptr<const PriceVersion>> retired;   // Superseded versions carts may still hold
+    int threads;                             // Upper bound for parallel builds
+    std::function<void(const ScheduledPriceChange&)> promotionListener;
+
+    long published;                          // Guarded by writeMutex
+    long pagesCopied;
+    long pricesChanged;
+    double lastBuildSeconds;
+    int lastBuildThreads;
+
+    void registerLocked(const std::vector<Product*>& products);
+    void publishLocked(const PriceChange& change, uint64_t scheduleId);
+    void promoteLocked(std::time_t now, std::vector<ScheduledPriceChange>& promoted);
+
+public:
+    PriceBook();
+
+    PriceBook(const PriceBook&) = delete;
+    PriceBook& operator=(const PriceBook&) = delete;
+
+    void setThreads(int count) { threads = count > 0 ? count : 1; }
+    // Runs on the thread that promoted a scheduled change, after it is published
+    void setPromotionListener(const std::function<void(const ScheduledPriceChange&)>& listener);
+
+    // Gives unregistered products a slot priced at their current selling price
+    void registerProducts(const std::vector<Product*>& products);
+
+    /**
+     * @brief The version a new cart should price from
+     *
+     * Publishes any scheduled change whose time has come first.
+     */
+    PriceVersionPtr acquire(std::time_t now = std::time(nullptr));
+    PriceVersionPtr getCurrent() const { return std::atomic_load(&current); }
+    double getPrice(const Product& product) { return acquire()->priceOf(product); }   // Promotes due changes first
+
+    // Builds a change from the current prices; registers the products it touches
+    PriceChange draftPercentChange(const std::vector<Product*>& products, double percentageChange);
+    PriceChange draftPrice(Product* product, double price);
+    PriceChange draftSellingPrices(const std::vector<Product*>& products);   // Each product's own price now
+
+    uint64_t publish(const PriceChange& change);                           // Returns the new version number
+    // Registers the products; returns the schedule ID
+    uint64_t schedulePercentChange(const std::vector<Product*>& products, double percentageChange,
+                                   std::time_t effectiveAt);
+    bool cancelScheduled(uint64_t scheduleId);
+    std::vector<ScheduledPriceChange> getScheduled() const;
+
+    PriceBookStats getStats() const;
+    size_t getAllocatedBytes() const;   // Pages and page tables of every live version
+    void display(std::ostream& out) const;
+};
+
+#endif // PRICE_BOOK_H
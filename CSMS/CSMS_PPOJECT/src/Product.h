@@ -1,185 +1,223 @@
-// ===== Product.h =====
-#ifndef PRODUCT_H
-#define PRODUCT_H
-
-#include <string>
-#include <vector>
-#include <iostream>
-#include <iomanip>
-
-/**
- * @brief Enumeration for product categories
- */
-enum class ProductCategory {
-    BEVERAGES,
-    SNACKS,
-    DAIRY,
-    BAKERY,
-    HOUSEHOLD,
-    ELECTRONICS,
-    HEALTH_BEAUTY,
-    OTHER
-};
-
-/**
- * @brief Base class for all products in the store
- */
-class Product {
-protected:
-    std::string productId;
-    std::string name;
-    std::string description;
-    double basePrice;
-    int currentStock;
-    int minStockLevel;
-    int maxStockLevel;
-    ProductCategory category;
-    std::string supplier;
-    std::string barcode;
-    double costPrice;        // Purchase price from supplier
-    bool isActive;           // Whether product is currently being sold
-    std::vector<std::string> tags;  // Search tags for the product
-
-public:
-    /**
-     * @brief Constructor for Product
-     */
-    Product(const std::string& id, const std::string& name, const std::string& desc,
-            double price, double cost, int stock, ProductCategory cat,
-            const std::string& supplier = "", int minStock = 10, int maxStock = 1000);
-
-    // Virtual destructor for proper inheritance
-    virtual ~Product() = default;
-
-    // Pure virtual methods that derived classes must implement
-    virtual double calculateSellingPrice() const = 0;
-    virtual std::string getProductType() const = 0;
-    virtual void displayDetailedInfo() const;
-
-    // Getters
-    std::string getId() const { return productId; }
-    std::string getName() const { return name; }
-    std::string getDescription() const { return description; }
-    double getBasePrice() const { return basePrice; }
-    double getCostPrice() const { return costPrice; }
-    int getCurrentStock() const { return currentStock; }
-    int getMinStockLevel() const { return minStockLevel; }
-    int getMaxStockLevel() const { return maxStockLevel; }
-    ProductCategory getCategory() const { return category; }
-    std::string getSupplier() const { return supplier; }
-    std::string getBarcode() const { return barcode; }
-    bool getIsActive() const { return isActive; }
-    const std::vector<std::string>& getTags() const { return tags; }
-
-    // Setters
-    void setBasePrice(double price) { basePrice = price; }
-    void setCostPrice(double cost) { costPrice = cost; }
-    void setMinStockLevel(int minStock) { minStockLevel = minStock; }
-    void setMaxStockLevel(int maxStock) { maxStockLevel = maxStock; }
-    void setIsActive(bool active) { isActive = active; }
-    void setDescription(const std::string& desc) { description = desc; }
-
-    // Stock management
-    bool reduceStock(int quantity);
-    void addStock(int quantity);
-    bool isLowStock() const;
-    bool isOverstocked() const;
-    int getRestockRecommendation() const;
-
-    // Business logic
-    double calculateProfitMargin() const;
-    double getTotalInventoryValue() const;
-    double getTotalInventoryCost() const;
-    
-    // Tag management
-    void addTag(const std::string& tag);
-    void removeTag(const std::string& tag);
-    bool hasTag(const std::string& tag) const;
-
-    // Utility methods
-    std::string categoryToString() const;
-    static ProductCategory stringToCategory(const std::string& categoryStr);
-};
-
-/**
- * @brief Regular product with standard pricing
- */
-class RegularProduct : public Product {
-private:
-    double markupPercentage;  // Markup percentage over cost price
-
-public:
-    RegularProduct(const std::string& id, const std::string& name, const std::string& desc,
-                   double price, double cost, int stock, ProductCategory cat,
-                   const std::string& supplier = "", double markup = 0.3,
-                   int minStock = 10, int maxStock = 1000);
-
-    double calculateSellingPrice() const override;
-    std::string getProductType() const override { return "Regular"; }
-    
-    double getMarkupPercentage() const { return markupPercentage; }
-    void setMarkupPercentage(double markup) { markupPercentage = markup; }
-};
-
-/**
- * @brief Perishable product with expiration dates
- */
-class PerishableProduct : public Product {
-private:
-    std::string expirationDate;
-    int shelfLifeDays;
-    double discountRate;  // Discount rate when near expiration
-
-public:
-    PerishableProduct(const std::string& id, const std::string& name, const std::string& desc,
-                      double price, double cost, int stock, ProductCategory cat,
-                      const std::string& expDate, int shelfLife,
-                      const std::string& supplier = "", double discount = 0.2,
-                      int minStock = 5, int maxStock = 500);
-
-    double calculateSellingPrice() const override;
-    std::string getProductType() const override { return "Perishable"; }
-    void displayDetailedInfo() const override;
-    
-    bool isNearExpiration() const;
-    int getDaysUntilExpiration() const;
-    
-    // Getters and setters
-    std::string getExpirationDate() const { return expirationDate; }
-    int getShelfLifeDays() const { return shelfLifeDays; }
-    double getDiscountRate() const { return discountRate; }
-    void setExpirationDate(const std::string& date) { expirationDate = date; }
-    void setDiscountRate(double rate) { discountRate = rate; }
-};
-
-/**
- * @brief Bulk product sold by weight or volume
- */
-class BulkProduct : public Product {
-private:
-    std::string unit;  // kg, lbs, liters, etc.
-    double pricePerUnit;
-    double minimumQuantity;
-
-public:
-    BulkProduct(const std::string& id, const std::string& name, const std::string& desc,
-                double pricePerUnit, double cost, int stock, ProductCategory cat,
-                const std::string& unit, double minQty = 0.1,
-                const std::string& supplier = "", int minStock = 10, int maxStock = 1000);
-
-    double calculateSellingPrice() const override;
-    double calculatePriceForQuantity(double quantity) const;
-    std::string getProductType() const override { return "Bulk"; }
-    void displayDetailedInfo() const override;
-    
-    // Getters
-    std::string getUnit() const { return unit; }
-    double getPricePerUnit() const { return pricePerUnit; }
-    double getMinimumQuantity() const { return minimumQuantity; }
-    
-    // Setters
-    void setPricePerUnit(double price) { pricePerUnit = price; }
-    void setMinimumQuantity(double minQty) { minimumQuantity = minQty; }
-};
-
-#endif // PRODUCT_H
+// ===== Product.h =====
+#ifndef PRODUCT_H
+#define PRODUCT_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+
+/**
+ * @brief Enumeration for product categories
+ */
+enum class ProductCategory {
+    BEVERAGES,
+    SNACKS,
+    DAIRY,
+    BAKERY,
+    HOUSEHOLD,
+    ELECTRONICS,
+    HEALTH_BEAUTY,
+    OTHER
+};
+
+/**
+ * @brief Base class for all products in the store
+ */
+class Product {
+protected:
+    std::string productId;
+    std::string name;
+    std::string description;
+    double basePrice;        // Shelf price before markdowns; price changes set it for every type
+    int currentStock;
+    int reservedStock;       // Held for outgoing transfers; not sellable
+    int incomingStock;       // Shelf space held for incoming transfers
+    int minStockLevel;
+    int maxStockLevel;
+    ProductCategory category;
+    std::string supplier;
+    std::string barcode;
+    double costPrice;        // Purchase price from supplier
+    bool isActive;           // Whether product is currently being sold
+    std::vector<std::string> tags;  // Search tags for the product
+    std::atomic<int> priceSlot;     // Index in the store's PriceBook, -1 until a price change registers it
+    std::atomic<int> holders;       // Transaction lines pointing at the product; it stays resident while held
+
+public:
+    /**
+     * @brief Constructor for Product
+     */
+    Product(const std::string& id, const std::string& name, const std::string& desc,
+            double price, double cost, int stock, ProductCategory cat,
+            const std::string& supplier = "", int minStock = 10, int maxStock = 1000);
+
+    // Virtual destructor for proper inheritance
+    virtual ~Product() = default;
+
+    // Pure virtual methods that derived classes must implement
+    virtual double calculateSellingPrice() const = 0;
+    virtual std::string getProductType() const = 0;
+    virtual void displayDetailedInfo() const;
+
+    // Getters
+    const std::string& getId() const { return productId; }
+    const std::string& getName() const { return name; }
+    const std::string& getDescription() const { return description; }
+    double getBasePrice() const { return basePrice; }
+    double getCostPrice() const { return costPrice; }
+    int getCurrentStock() const { return currentStock; }
+    int getAvailableStock() const { return currentStock - reservedStock; }
+    int getReservedStock() const { return reservedStock; }
+    int getIncomingStock() const { return incomingStock; }
+    int getFreeCapacity() const { return maxStockLevel - currentStock - incomingStock; }
+    int getMinStockLevel() const { return minStockLevel; }
+    int getMaxStockLevel() const { return maxStockLevel; }
+    ProductCategory getCategory() const { return category; }
+    const std::string& getSupplier() const { return supplier; }
+    const std::string& getBarcode() const { return barcode; }
+    bool getIsActive() const { return isActive; }
+    const std::vector<std::string>& getTags() const { return tags; }
+    int getPriceSlot() const { return priceSlot.load(std::memory_order_relaxed); }
+    bool isHeld() const { return holders.load(std::memory_order_acquire) > 0; }
+
+    // Setters
+    void setBasePrice(double price) { basePrice = price; }
+    void setCostPrice(double cost) { costPrice = cost; }
+    void setMinStockLevel(int minStock) { minStockLevel = minStock; }
+    void setMaxStockLevel(int maxStock) { maxStockLevel = maxStock; }
+    void setIsActive(bool active) { isActive = active; }
+    void setDescription(const std::string& desc) { description = desc; }
+    void setBarcode(const std::string& code) { barcode = code; }   // Use InventoryManager::setBarcode once stocked
+    void setPriceSlot(int slot) { priceSlot.store(slot, std::memory_order_relaxed); }
+
+    // Taken by anything that keeps a Product* past the current command, so the inventory does not evict it
+    void hold() { holders.fetch_add(1, std::memory_order_relaxed); }
+    void release() { holders.fetch_sub(1, std::memory_order_release); }
+
+    // Stock management
+    bool reduceStock(int quantity);           // Never takes reserved units
+    int addStock(int quantity);               // Units added; stock plus incoming is capped at maxStockLevel
+
+    // Transfer reservations: reserve, then either commit or release
+    bool reserveOutgoing(int quantity);
+    void releaseOutgoing(int quantity);
+    void commitOutgoing(int quantity);
+    bool reserveIncoming(int quantity);
+    void releaseIncoming(int quantity);
+    void commitIncoming(int quantity);
+    bool isLowStock() const;
+    bool isOverstocked() const;
+    int getRestockRecommendation() const;
+
+    // Business logic
+    double calculateProfitMargin() const;
+    double getTotalInventoryValue() const;
+    double getTotalInventoryCost() const;
+    
+    // Tag management
+    void addTag(const std::string& tag);
+    void removeTag(const std::string& tag);
+    bool hasTag(const std::string& tag) const;
+
+    // Utility methods
+    std::string categoryToString() const;
+    static std::string categoryName(ProductCategory category);
+    static ProductCategory stringToCategory(const std::string& categoryStr);
+
+    // Memory accounting
+    virtual size_t getObjectBytes() const = 0;  // Allocation holding the most-derived object
+    virtual size_t getStringBytes() const;      // Heap held by string members
+    size_t getTagBytes() const;                 // Tag vector buffer and tag strings
+};
+
+/**
+ * @brief Regular product with standard pricing
+ *
+ * Opens at cost plus markup; from then on it sells at its base price, so
+ * price changes apply to it like any other product.
+ */
+class RegularProduct : public Product {
+private:
+    double markupPercentage;  // Markup over cost price the product opened at
+
+public:
+    RegularProduct(const std::string& id, const std::string& name, const std::string& desc,
+                   double price, double cost, int stock, ProductCategory cat,
+                   const std::string& supplier = "", double markup = 0.3,
+                   int minStock = 10, int maxStock = 1000);
+
+    double calculateSellingPrice() const override;
+    std::string getProductType() const override { return "Regular"; }
+    size_t getObjectBytes() const override;
+    
+    double getMarkupPercentage() const { return markupPercentage; }
+    void setMarkupPercentage(double markup) { markupPercentage = markup; }
+};
+
+/**
+ * @brief Perishable product with expiration dates
+ */
+class PerishableProduct : public Product {
+private:
+    std::string expirationDate;
+    int shelfLifeDays;
+    double discountRate;  // Discount rate when near expiration
+
+public:
+    PerishableProduct(const std::string& id, const std::string& name, const std::string& desc,
+                      double price, double cost, int stock, ProductCategory cat,
+                      const std::string& expDate, int shelfLife,
+                      const std::string& supplier = "", double discount = 0.2,
+                      int minStock = 5, int maxStock = 500);
+
+    double calculateSellingPrice() const override;
+    std::string getProductType() const override { return "Perishable"; }
+    void displayDetailedInfo() const override;
+    size_t getObjectBytes() const override;
+    size_t getStringBytes() const override;
+    
+    bool isNearExpiration() const;
+    int getDaysUntilExpiration() const;
+    
+    // Getters and setters
+    std::string getExpirationDate() const { return expirationDate; }
+    int getShelfLifeDays() const { return shelfLifeDays; }
+    double getDiscountRate() const { return discountRate; }
+    void setExpirationDate(const std::string& date) { expirationDate = date; }
+    void setDiscountRate(double rate) { discountRate = rate; }
+};
+
+/**
+ * @brief Bulk product sold by weight or volume
+ */
+class BulkProduct : public Product {
+private:
+    std::string unit;  // kg, lbs, liters, etc.; the base price is per unit
+    double minimumQuantity;
+
+public:
+    BulkProduct(const std::string& id, const std::string& name, const std::string& desc,
+                double pricePerUnit, double cost, int stock, ProductCategory cat,
+                const std::string& unit, double minQty = 0.1,
+                const std::string& supplier = "", int minStock = 10, int maxStock = 1000);
+
+    double calculateSellingPrice() const override;
+    double calculatePriceForQuantity(double quantity) const;
+    std::string getProductType() const override { return "Bulk"; }
+    void displayDetailedInfo() const override;
+    size_t getObjectBytes() const override;
+    size_t getStringBytes() const override;
+    
+    // Getters
+    std::string getUnit() const { return unit; }
+    double getPricePerUnit() const { return basePrice; }
+    double getMinimumQuantity() const { return minimumQuantity; }
+    
+    // Setters
+    void setPricePerUnit(double price) { basePrice = price; }
+    void setMinimumQuantity(double minQty) { minimumQuantity = minQty; }
+};
+
+#endif // PRODUCT_H
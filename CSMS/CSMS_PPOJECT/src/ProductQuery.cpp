@@ -0,0 +1,864 @@
+// ===== ProductQuery.cpp =====
+#include "ProductQuery.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static const int CATEGORY_COUNT = static_cast<int>(ProductCategory::OTHER) + 1;
+static const char* const TYPE_KEYS[] = {"regular", "perishable", "bulk"};
+static const uint8_t OTHER_TYPE = 3;
+
+typedef std::vector<uint64_t> RowBits;   // Bit r % 64 of word r / 64 is set while row r matches
+
+static std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+// ASCII case folding; needle is already lowercase
+static bool containsFolded(const std::string& text, const std::string& needle) {
+    return std::search(text.begin(), text.end(), needle.begin(), needle.end(), [](char c, char n) {
+               return (c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c) == n;
+           }) != text.end();
+}
+
+static bool compareNumbers(double left, QueryOp op, double right) {
+    switch (op) {
+        case QueryOp::EQ: return left == right;
+        case QueryOp::NE: return left != right;
+        case QueryOp::LT: return left < right;
+        case QueryOp::LE: return left <= right;
+        case QueryOp::GT: return left > right;
+        case QueryOp::GE: return left >= right;
+        default: return false;
+    }
+}
+
+static const std::string& categoryKey(ProductCategory category) {
+    static const std::vector<std::string> keys = [] {
+        std::vector<std::string> names;
+        for (int c = 0; c < CATEGORY_COUNT; ++c) {
+            names.push_back(ProductQuery::valueKey(Product::categoryName(static_cast<ProductCategory>(c))));
+        }
+        return names;
+    }();
+    return keys[static_cast<size_t>(category)];
+}
+
+static bool categoryForKey(const std::string& key, ProductCategory& category) {
+    for (int c = 0; c < CATEGORY_COUNT; ++c) {
+        if (categoryKey(static_cast<ProductCategory>(c)) == key) {
+            category = static_cast<ProductCategory>(c);
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint8_t typeCode(const std::string& key) {
+    for (uint8_t t = 0; t < OTHER_TYPE; ++t) {
+        if (key == TYPE_KEYS[t]) {
+            return t;
+        }
+    }
+    return OTHER_TYPE;
+}
+
+// Category and type values compare as keys, CONTAINS values in lowercase
+static ProductPredicate textPredicate(ProductField field, QueryOp op, const std::vector<std::string>& values) {
+    ProductPredicate predicate;
+    predicate.field = field;
+    predicate.op = op;
+    for (const std::string& value : values) {
+        if (op == QueryOp::CONTAINS) {
+            predicate.values.push_back(lowercase(value));
+        } else if (field == ProductField::CATEGORY || field == ProductField::TYPE) {
+            predicate.values.push_back(ProductQuery::valueKey(value));
+        } else {
+            predicate.values.push_back(value);
+        }
+    }
+    return predicate;
+}
+
+bool ProductPredicate::matches(const Product& product) const {
+    if (ProductQuery::isNumeric(field)) {
+        double right = compareField ? ProductQuery::numericValue(product, otherField) * scale : number;
+        return compareNumbers(ProductQuery::numericValue(product, field), op, right);
+    }
+
+    bool any = false;
+    if (field == ProductField::TAG) {
+        for (const std::string& tag : product.getTags()) {
+            for (size_t v = 0; !any && v < values.size(); ++v) {
+                any = (op == QueryOp::CONTAINS) ? containsFolded(tag, values[v]) : tag == values[v];
+            }
+        }
+    } else if (field == ProductField::CATEGORY) {
+        any = std::find(values.begin(), values.end(), categoryKey(product.getCategory())) != values.end();
+    } else if (field == ProductField::TYPE) {
+        any = std::find(values.begin(), values.end(), ProductQuery::valueKey(product.getProductType())) !=
+              values.end();
+    } else {
+        const std::string& text = field == ProductField::ID     ? product.getId()
+                                  : field == ProductField::NAME ? product.getName()
+                                                                : product.getSupplier();
+        for (size_t v = 0; !any && v < values.size(); ++v) {
+            any = (op == QueryOp::CONTAINS) ? containsFolded(text, values[v]) : text == values[v];
+        }
+    }
+
+    switch (op) {
+        case QueryOp::EQ:
+        case QueryOp::CONTAINS:
+            return any;
+        case QueryOp::NE:
+            return !any;
+        default:
+            return false;   // Text has no order
+    }
+}
+
+ProductQuery& ProductQuery::where(ProductField field, QueryOp op, double number) {
+    ProductPredicate predicate;
+    predicate.field = field;
+    predicate.op = op;
+    predicate.number = number;
+    filters.push_back(predicate);
+    return *this;
+}
+
+ProductQuery& ProductQuery::where(ProductField field, QueryOp op, const std::string& value) {
+    return where(field, op, std::vector<std::string>(1, value));
+}
+
+ProductQuery& ProductQuery::where(ProductField field, QueryOp op, const std::vector<std::string>& values) {
+    filters.push_back(textPredicate(field, op, values));
+    return *this;
+}
+
+ProductQuery& ProductQuery::whereField(ProductField field, QueryOp op, ProductField other, double scale) {
+    ProductPredicate predicate;
+    predicate.field = field;
+    predicate.op = op;
+    predicate.compareField = true;
+    predicate.otherField = other;
+    predicate.scale = scale;
+    filters.push_back(predicate);
+    return *this;
+}
+
+ProductQuery& ProductQuery::show(const std::vector<ProductField>& shown) {
+    fields = shown;
+    return *this;
+}
+
+ProductQuery& ProductQuery::sortBy(ProductField field, bool descendingOrder) {
+    sorted = true;
+    sortField = field;
+    descending = descendingOrder;
+    return *this;
+}
+
+ProductQuery& ProductQuery::take(size_t count) {
+    limit = count;
+    return *this;
+}
+
+// Sorts on precomputed keys, so each row's key is read once; ties keep row order
+template <typename Key>
+static void sortRows(std::vector<Product*>& rows, std::vector<std::pair<Key, size_t>>& keys, bool descending,
+                     size_t limit) {
+    auto before = [descending](const std::pair<Key, size_t>& a, const std::pair<Key, size_t>& b) {
+        if (a.first != b.first) {
+            return descending ? b.first < a.first : a.first < b.first;
+        }
+        return a.second < b.second;
+    };
+    size_t shown = (limit > 0 && limit < keys.size()) ? limit : keys.size();
+    std::partial_sort(keys.begin(), keys.begin() + shown, keys.end(), before);
+
+    std::vector<Product*> ordered;
+    ordered.reserve(shown);
+    for (size_t i = 0; i < shown; ++i) {
+        ordered.push_back(rows[keys[i].second]);
+    }
+    rows.swap(ordered);
+}
+
+void ProductQuery::order(std::vector<Product*>& rows) const {
+    if (!sorted) {
+        if (limit > 0 && rows.size() > limit) {
+            rows.resize(limit);
+        }
+    } else if (isNumeric(sortField)) {
+        std::vector<double> keys;
+        keys.reserve(rows.size());
+        for (const Product* product : rows) {
+            keys.push_back(numericValue(*product, sortField));
+        }
+        order(rows, keys);
+    } else {
+        std::vector<std::pair<std::string, size_t>> keys;
+        keys.reserve(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            keys.push_back(std::make_pair(textValue(*rows[i], sortField), i));
+        }
+        sortRows(rows, keys, descending, limit);
+    }
+}
+
+void ProductQuery::order(std::vector<Product*>& rows, const std::vector<double>& keys) const {
+    std::vector<std::pair<double, size_t>> indexed;
+    indexed.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        indexed.push_back(std::make_pair(keys[i], i));
+    }
+    sortRows(rows, indexed, descending, limit);
+}
+
+static bool parseFieldList(const std::string& list, std::vector<ProductField>& fields, std::string& error) {
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t comma = list.find(',', begin);
+        std::string name = list.substr(begin, comma == std::string::npos ? std::string::npos : comma - begin);
+        ProductField field;
+        if (!ProductQuery::stringToField(name, field)) {
+            error = "unknown field '" + name + "'";
+            return false;
+        }
+        fields.push_back(field);
+        if (comma == std::string::npos) {
+            break;
+        }
+        begin = comma + 1;
+    }
+    return true;
+}
+
+static std::vector<std::string> splitValues(const std::string& text) {
+    std::vector<std::string> values;
+    size_t begin = 0;
+    while (begin <= text.size()) {
+        size_t comma = text.find(',', begin);
+        values.push_back(text.substr(begin, comma == std::string::npos ? std::string::npos : comma - begin));
+        if (comma == std::string::npos) {
+            break;
+        }
+        begin = comma + 1;
+    }
+    return values;
+}
+
+static bool parseNumber(const std::string& text, double& number) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    number = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size();
+}
+
+bool ProductQuery::parse(const std::vector<std::string>& args, ProductQuery& query, std::string& error) {
+    query = ProductQuery();
+    for (const std::string& arg : args) {
+        if (arg.compare(0, 5, "sort=") == 0) {
+            std::string name = arg.substr(5);
+            bool descendingOrder = !name.empty() && name[0] == '-';
+            ProductField field;
+            if (!stringToField(descendingOrder ? name.substr(1) : name, field)) {
+                error = "unknown sort field '" + name + "'";
+                return false;
+            }
+            query.sortBy(field, descendingOrder);
+            continue;
+        }
+        if (arg.compare(0, 6, "limit=") == 0) {
+            query.take(static_cast<size_t>(std::max(0L, std::atol(arg.c_str() + 6))));
+            continue;
+        }
+        if (arg.compare(0, 5, "show=") == 0) {
+            if (!parseFieldList(arg.substr(5), query.fields, error)) {
+                return false;
+            }
+            continue;
+        }
+
+        size_t position = arg.find_first_of("<>=!~");
+        if (position == std::string::npos) {
+            error = "expected a filter such as price>2.50, got '" + arg + "'";
+            return false;
+        }
+        ProductField field;
+        if (!stringToField(arg.substr(0, position), field)) {
+            error = "unknown field '" + arg.substr(0, position) + "'";
+            return false;
+        }
+        QueryOp op;
+        size_t valueStart = position + 1;
+        char symbol = arg[position];
+        bool orEqual = valueStart < arg.size() && arg[valueStart] == '=';
+        if (symbol == '<') {
+            op = orEqual ? QueryOp::LE : QueryOp::LT;
+        } else if (symbol == '>') {
+            op = orEqual ? QueryOp::GE : QueryOp::GT;
+        } else if (symbol == '!' && orEqual) {
+            op = QueryOp::NE;
+        } else if (symbol == '=') {
+            op = QueryOp::EQ;
+        } else if (symbol == '~') {
+            op = QueryOp::CONTAINS;
+        } else {
+            error = "unknown operator in '" + arg + "'";
+            return false;
+        }
+        if (orEqual && symbol != '=') {
+            ++valueStart;
+        }
+        std::string value = arg.substr(valueStart);
+
+        if (isNumeric(field)) {
+            if (op == QueryOp::CONTAINS) {
+                error = "~ applies to text fields, not '" + fieldName(field) + "'";
+                return false;
+            }
+            if (field == ProductField::ACTIVE) {
+                std::string flag = lowercase(value);
+                if (op != QueryOp::EQ && op != QueryOp::NE) {
+                    error = "active takes = or !=";
+                    return false;
+                }
+                if (flag != "1" && flag != "0" && flag != "yes" && flag != "no" && flag != "true" && flag != "false") {
+                    error = "active is yes or no, got '" + value + "'";
+                    return false;
+                }
+                query.where(field, op, (flag == "1" || flag == "yes" || flag == "true") ? 1.0 : 0.0);
+                continue;
+            }
+            double number;
+            if (parseNumber(value, number)) {
+                query.where(field, op, number);
+                continue;
+            }
+            // Another field, optionally scaled: max*0.9
+            size_t star = value.find('*');
+            ProductField other;
+            double scale = 1.0;
+            if (!stringToField(value.substr(0, star), other) || !isNumeric(other) ||
+                (star != std::string::npos && !parseNumber(value.substr(star + 1), scale))) {
+                error = "expected a number or numeric field after " + fieldName(field) + ", got '" + value + "'";
+                return false;
+            }
+            query.whereField(field, op, other, scale);
+            continue;
+        }
+
+        if (op != QueryOp::EQ && op != QueryOp::NE && op != QueryOp::CONTAINS) {
+            error = fieldName(field) + " takes =, != or ~";
+            return false;
+        }
+        if (op == QueryOp::CONTAINS && (field == ProductField::CATEGORY || field == ProductField::TYPE)) {
+            error = "~ does not apply to " + fieldName(field);
+            return false;
+        }
+        std::vector<std::string> values = splitValues(value);
+        for (const std::string& label : values) {
+            ProductCategory category;
+            if (field == ProductField::CATEGORY && !categoryForKey(valueKey(label), category)) {
+                error = "no category '" + label + "'";
+                return false;
+            }
+            if (field == ProductField::TYPE && typeCode(valueKey(label)) == OTHER_TYPE) {
+                error = "type is regular, perishable or bulk, got '" + label + "'";
+                return false;
+            }
+        }
+        query.where(field, op, values);
+    }
+    return true;
+}
+
+bool ProductQuery::stringToField(const std::string& name, ProductField& field) {
+    static const std::pair<const char*, ProductField> names[] = {
+        {"id", ProductField::ID}, {"name", ProductField::NAME}, {"category", ProductField::CATEGORY},
+        {"supplier", ProductField::SUPPLIER}, {"type", ProductField::TYPE}, {"tag", ProductField::TAG},
+        {"active", ProductField::ACTIVE}, {"price", ProductField::PRICE}, {"cost", ProductField::COST},
+        {"margin", ProductField::MARGIN}, {"min", ProductField::MIN_STOCK}, {"max", ProductField::MAX_STOCK},
+        {"stock", ProductField::STOCK}, {"available", ProductField::AVAILABLE}, {"value", ProductField::VALUE}};
+    std::string key = lowercase(name);
+    for (const auto& entry : names) {
+        if (key == entry.first) {
+            field = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string ProductQuery::fieldName(ProductField field) {
+    switch (field) {
+        case ProductField::ID: return "id";
+        case ProductField::NAME: return "name";
+        case ProductField::CATEGORY: return "category";
+        case ProductField::SUPPLIER: return "supplier";
+        case ProductField::TYPE: return "type";
+        case ProductField::TAG: return "tag";
+        case ProductField::ACTIVE: return "active";
+        case ProductField::PRICE: return "price";
+        case ProductField::COST: return "cost";
+        case ProductField::MARGIN: return "margin";
+        case ProductField::MIN_STOCK: return "min";
+        case ProductField::MAX_STOCK: return "max";
+        case ProductField::STOCK: return "stock";
+        case ProductField::AVAILABLE: return "available";
+        case ProductField::VALUE: return "value";
+    }
+    return "?";
+}
+
+bool ProductQuery::isNumeric(ProductField field) {
+    switch (field) {
+        case ProductField::ID:
+        case ProductField::NAME:
+        case ProductField::CATEGORY:
+        case ProductField::SUPPLIER:
+        case ProductField::TYPE:
+        case ProductField::TAG:
+            return false;
+        default:
+            return true;
+    }
+}
+
+double ProductQuery::numericValue(const Product& product, ProductField field) {
+    switch (field) {
+        case ProductField::ACTIVE: return product.getIsActive() ? 1.0 : 0.0;
+        case ProductField::PRICE: return product.calculateSellingPrice();
+        case ProductField::COST: return product.getCostPrice();
+        case ProductField::MARGIN: return product.calculateProfitMargin();
+        case ProductField::MIN_STOCK: return product.getMinStockLevel();
+        case ProductField::MAX_STOCK: return product.getMaxStockLevel();
+        case ProductField::STOCK: return product.getCurrentStock();
+        case ProductField::AVAILABLE: return product.getAvailableStock();
+        case ProductField::VALUE: return product.getTotalInventoryValue();
+        default: return 0.0;
+    }
+}
+
+std::string ProductQuery::textValue(const Product& product, ProductField field) {
+    switch (field) {
+        case ProductField::ID: return product.getId();
+        case ProductField::NAME: return product.getName();
+        case ProductField::CATEGORY: return product.categoryToString();
+        case ProductField::SUPPLIER: return product.getSupplier();
+        case ProductField::TYPE: return product.getProductType();
+        case ProductField::TAG: {
+            std::string tags;
+            for (const std::string& tag : product.getTags()) {
+                tags += (tags.empty() ? "" : ",") + tag;
+            }
+            return tags;
+        }
+        default: return std::string();
+    }
+}
+
+std::string ProductQuery::valueKey(const std::string& text) {
+    std::string key;
+    for (unsigned char c : text) {
+        if (std::isalnum(c)) {
+            key += static_cast<char>(std::tolower(c));
+        }
+    }
+    return key;
+}
+
+static int fieldWidth(ProductField field) {
+    switch (field) {
+        case ProductField::ID: return 12;
+        case ProductField::NAME: return 26;
+        case ProductField::CATEGORY:
+        case ProductField::SUPPLIER: return 17;
+        case ProductField::TAG: return 22;
+        case ProductField::TYPE: return 12;
+        default: return 11;
+    }
+}
+
+void ProductQueryResult::display(const ProductQuery& query, std::ostream& out) const {
+    std::vector<ProductField> fields = query.fields;
+    if (fields.empty()) {
+        fields = {ProductField::ID, ProductField::NAME, ProductField::CATEGORY, ProductField::PRICE,
+                  ProductField::STOCK};
+    }
+    int width = 0;
+    for (ProductField field : fields) {
+        width += fieldWidth(field);
+    }
+    width = std::max(width, 60);
+
+    out << "\n" << std::string(width, '=') << std::endl;
+    out << "PRODUCT QUERY" << std::endl << std::string(width, '=') << std::endl;
+    for (ProductField field : fields) {
+        std::string name = ProductQuery::fieldName(field);
+        name[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[0])));
+        if (ProductQuery::isNumeric(field)) {
+            out << std::right << std::setw(fieldWidth(field)) << name;
+        } else {
+            out << std::left << std::setw(fieldWidth(field)) << name;
+        }
+    }
+    out << std::endl << std::string(width, '-') << std::endl;
+
+    for (const Product* product : rows) {
+        for (ProductField field : fields) {
+            int columnWidth = fieldWidth(field);
+            if (!ProductQuery::isNumeric(field)) {
+                out << std::left << std::setw(columnWidth)
+                    << ProductQuery::textValue(*product, field).substr(0, columnWidth - 1);
+                continue;
+            }
+            double value = ProductQuery::numericValue(*product, field);
+            out << std::right << std::setw(columnWidth);
+            switch (field) {
+                case ProductField::ACTIVE:
+                    out << (value != 0.0 ? "yes" : "no");
+                    break;
+                case ProductField::PRICE:
+                case ProductField::COST:
+                case ProductField::VALUE:
+                    out << std::fixed << std::setprecision(2) << value;
+                    break;
+                case ProductField::MARGIN:
+                    out << std::fixed << std::setprecision(1) << value;
+                    break;
+                default:
+                    out << static_cast<long>(value);
+                    break;
+            }
+        }
+        out << std::endl;
+    }
+
+    out << std::string(width, '-') << std::endl;
+    out << std::left << matched << " matched";
+    if (rows.size() < matched) {
+        out << ", " << rows.size() << " shown";
+    }
+    out << "; " << plan << "; " << scanned << " rows examined in " << std::fixed << std::setprecision(3)
+        << seconds * 1000.0 << " ms" << std::endl;
+    out << std::string(width, '=') << std::endl << std::endl;
+    out.unsetf(std::ios::fixed);
+}
+
+// ----- Columns -----
+
+void ProductColumns::rebuild(const std::map<std::string, Product*>& products, uint64_t catalogVersion) {
+    size_t count = products.size();
+    rows.clear();
+    category.clear();
+    type.clear();
+    active.clear();
+    supplier.clear();
+    price.clear();
+    cost.clear();
+    margin.clear();
+    minStock.clear();
+    maxStock.clear();
+    supplierNames.clear();
+    supplierCodes.clear();
+
+    rows.reserve(count);
+    category.reserve(count);
+    type.reserve(count);
+    active.reserve(count);
+    supplier.reserve(count);
+    price.reserve(count);
+    cost.reserve(count);
+    margin.reserve(count);
+    minStock.reserve(count);
+    maxStock.reserve(count);
+
+    for (const auto& pair : products) {
+        const Product* product = pair.second;
+        rows.push_back(pair.second);
+        category.push_back(static_cast<uint8_t>(product->getCategory()));
+        type.push_back(typeCode(ProductQuery::valueKey(product->getProductType())));
+        active.push_back(product->getIsActive() ? 1 : 0);
+
+        auto code = supplierCodes.insert(std::make_pair(product->getSupplier(),
+                                                        static_cast<uint32_t>(supplierNames.size())));
+        if (code.second) {
+            supplierNames.push_back(product->getSupplier());
+        }
+        supplier.push_back(code.first->second);
+
+        price.push_back(product->calculateSellingPrice());
+        cost.push_back(product->getCostPrice());
+        margin.push_back(product->calculateProfitMargin());
+        minStock.push_back(product->getMinStockLevel());
+        maxStock.push_back(product->getMaxStockLevel());
+    }
+    version = catalogVersion;
+    built = true;
+}
+
+const std::vector<double>* ProductColumns::getColumn(ProductField field) const {
+    switch (field) {
+        case ProductField::PRICE: return &price;
+        case ProductField::COST: return &cost;
+        case ProductField::MARGIN: return &margin;
+        case ProductField::MIN_STOCK: return &minStock;
+        case ProductField::MAX_STOCK: return &maxStock;
+        default: return nullptr;
+    }
+}
+
+bool ProductColumns::canScan(const ProductPredicate& filter) const {
+    switch (filter.field) {
+        case ProductField::CATEGORY:
+        case ProductField::TYPE:
+        case ProductField::SUPPLIER:
+        case ProductField::ACTIVE:
+            return !filter.compareField && (filter.op == QueryOp::EQ || filter.op == QueryOp::NE);
+        default:
+            return getColumn(filter.field) && filter.op != QueryOp::CONTAINS &&
+                   (!filter.compareField || getColumn(filter.otherField));
+    }
+}
+
+namespace {
+
+// Rows past the last whole word, and builds without SSE2
+template <typename Test>
+void filterRows(RowBits& bits, size_t first, size_t last, Test test) {
+    for (size_t row = first; row < last; ++row) {
+        if (!test(row)) {
+            bits[row / 64] &= ~(1ULL << (row % 64));
+        }
+    }
+}
+
+#if defined(__SSE2__)
+
+template <QueryOp Op>
+inline __m128d compareLanes(__m128d left, __m128d right) {
+    switch (Op) {
+        case QueryOp::EQ: return _mm_cmpeq_pd(left, right);
+        case QueryOp::NE: return _mm_cmpneq_pd(left, right);
+        case QueryOp::LT: return _mm_cmplt_pd(left, right);
+        case QueryOp::LE: return _mm_cmple_pd(left, right);
+        case QueryOp::GT: return _mm_cmpgt_pd(left, right);
+        default: return _mm_cmpge_pd(left, right);
+    }
+}
+
+// 32 compares of two doubles per 64-row word
+template <QueryOp Op>
+void filterDoubles(RowBits& bits, const double* column, const double* other, double number, double scale,
+                   size_t count) {
+    size_t words = count / 64;
+    __m128d constant = _mm_set1_pd(number);
+    __m128d factor = _mm_set1_pd(scale);
+    for (size_t w = 0; w < words; ++w) {
+        if (bits[w] == 0) {
+            continue;
+        }
+        const double* left = column + w * 64;
+        uint64_t keep = 0;
+        if (other) {
+            const double* right = other + w * 64;
+            for (int j = 0; j < 64; j += 2) {
+                __m128d scaled = _mm_mul_pd(_mm_loadu_pd(right + j), factor);
+                keep |= static_cast<uint64_t>(_mm_movemask_pd(compareLanes<Op>(_mm_loadu_pd(left + j), scaled))) << j;
+            }
+        } else {
+            for (int j = 0; j < 64; j += 2) {
+                keep |= static_cast<uint64_t>(_mm_movemask_pd(compareLanes<Op>(_mm_loadu_pd(left + j), constant))) << j;
+            }
+        }
+        bits[w] &= keep;
+    }
+    filterRows(bits, words * 64, count, [&](size_t row) {
+        return compareNumbers(column[row], Op, other ? other[row] * scale : number);
+    });
+}
+
+#endif
+
+void filterNumbers(RowBits& bits, const double* column, const double* other, QueryOp op, double number,
+                   double scale, size_t count) {
+#if defined(__SSE2__)
+    switch (op) {
+        case QueryOp::EQ: filterDoubles<QueryOp::EQ>(bits, column, other, number, scale, count); return;
+        case QueryOp::NE: filterDoubles<QueryOp::NE>(bits, column, other, number, scale, count); return;
+        case QueryOp::LT: filterDoubles<QueryOp::LT>(bits, column, other, number, scale, count); return;
+        case QueryOp::LE: filterDoubles<QueryOp::LE>(bits, column, other, number, scale, count); return;
+        case QueryOp::GT: filterDoubles<QueryOp::GT>(bits, column, other, number, scale, count); return;
+        case QueryOp::GE: filterDoubles<QueryOp::GE>(bits, column, other, number, scale, count); return;
+        default: break;
+    }
+#endif
+    filterRows(bits, 0, count, [&](size_t row) {
+        return compareNumbers(column[row], op, other ? other[row] * scale : number);
+    });
+}
+
+// Keeps rows whose code is in codes (or not in it, when excluding)
+void filterBytes(RowBits& bits, const uint8_t* column, const std::vector<uint8_t>& codes, bool excluding,
+                 size_t count) {
+    size_t words = 0;
+#if defined(__SSE2__)
+    words = count / 64;
+    for (size_t w = 0; w < words; ++w) {
+        if (bits[w] == 0) {
+            continue;
+        }
+        uint64_t hits = 0;
+        for (int j = 0; j < 64; j += 16) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + w * 64 + j));
+            __m128i hit = _mm_setzero_si128();
+            for (uint8_t code : codes) {
+                hit = _mm_or_si128(hit, _mm_cmpeq_epi8(values, _mm_set1_epi8(static_cast<char>(code))));
+            }
+            hits |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(hit))) << j;
+        }
+        bits[w] &= excluding ? ~hits : hits;
+    }
+#endif
+    filterRows(bits, words * 64, count, [&](size_t row) {
+        bool hit = std::find(codes.begin(), codes.end(), column[row]) != codes.end();
+        return hit != excluding;
+    });
+}
+
+void filterCodes(RowBits& bits, const uint32_t* column, const std::vector<uint32_t>& codes, bool excluding,
+                 size_t count) {
+    size_t words = 0;
+#if defined(__SSE2__)
+    words = count / 64;
+    for (size_t w = 0; w < words; ++w) {
+        if (bits[w] == 0) {
+            continue;
+        }
+        uint64_t hits = 0;
+        for (int j = 0; j < 64; j += 4) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + w * 64 + j));
+            __m128i hit = _mm_setzero_si128();
+            for (uint32_t code : codes) {
+                hit = _mm_or_si128(hit, _mm_cmpeq_epi32(values, _mm_set1_epi32(static_cast<int>(code))));
+            }
+            hits |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(hit))) << j;
+        }
+        bits[w] &= excluding ? ~hits : hits;
+    }
+#endif
+    filterRows(bits, words * 64, count, [&](size_t row) {
+        bool hit = std::find(codes.begin(), codes.end(), column[row]) != codes.end();
+        return hit != excluding;
+    });
+}
+
+// Code filters usually cut deepest and are cheapest per row, so they go first
+int scanCost(const ProductPredicate& filter) {
+    switch (filter.field) {
+        case ProductField::CATEGORY:
+        case ProductField::SUPPLIER:
+            return 0;
+        case ProductField::TYPE:
+        case ProductField::ACTIVE:
+            return 1;
+        default:
+            return filter.compareField ? 3 : 2;
+    }
+}
+
+}   // namespace
+
+void ProductColumns::scan(const std::vector<const ProductPredicate*>& filters, std::vector<uint32_t>& out) const {
+    size_t count = rows.size();
+    RowBits bits((count + 63) / 64, ~0ULL);
+    if (count % 64 != 0) {
+        bits.back() = (1ULL << (count % 64)) - 1;
+    }
+
+    std::vector<const ProductPredicate*> ordered(filters);
+    std::stable_sort(ordered.begin(), ordered.end(), [](const ProductPredicate* a, const ProductPredicate* b) {
+        return scanCost(*a) < scanCost(*b);
+    });
+
+    for (const ProductPredicate* filter : ordered) {
+        bool excluding = filter->op == QueryOp::NE;
+        switch (filter->field) {
+            case ProductField::CATEGORY: {
+                std::vector<uint8_t> codes;
+                for (const std::string& key : filter->values) {
+                    ProductCategory value;
+                    if (categoryForKey(key, value)) {
+                        codes.push_back(static_cast<uint8_t>(value));
+                    }
+                }
+                filterBytes(bits, category.data(), codes, excluding, count);
+                break;
+            }
+            case ProductField::TYPE: {
+                std::vector<uint8_t> codes;
+                for (const std::string& key : filter->values) {
+                    codes.push_back(typeCode(key));
+                }
+                filterBytes(bits, type.data(), codes, excluding, count);
+                break;
+            }
+            case ProductField::ACTIVE:
+                filterBytes(bits, active.data(), std::vector<uint8_t>(1, filter->number != 0.0 ? 1 : 0),
+                            excluding, count);
+                break;
+            case ProductField::SUPPLIER: {
+                std::vector<uint32_t> codes;
+                for (const std::string& name : filter->values) {
+                    auto it = supplierCodes.find(name);
+                    if (it != supplierCodes.end()) {
+                        codes.push_back(it->second);
+                    }
+                }
+                filterCodes(bits, supplier.data(), codes, excluding, count);
+                break;
+            }
+            default: {
+                const std::vector<double>* other = filter->compareField ? getColumn(filter->otherField) : nullptr;
+                filterNumbers(bits, getColumn(filter->field)->data(), other ? other->data() : nullptr,
+                              filter->op, filter->number, filter->scale, count);
+                break;
+            }
+        }
+    }
+
+    for (size_t w = 0; w < bits.size(); ++w) {
+        for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+            out.push_back(static_cast<uint32_t>(w * 64 + __builtin_ctzll(word)));
+        }
+    }
+}
+
+size_t ProductColumns::getAllocatedBytes() const {
+    size_t bytes = MemorySizing::vectorBytes(rows) + MemorySizing::vectorBytes(category) +
+                   MemorySizing::vectorBytes(type) + MemorySizing::vectorBytes(active) +
+                   MemorySizing::vectorBytes(supplier) + MemorySizing::vectorBytes(price) +
+                   MemorySizing::vectorBytes(cost) + MemorySizing::vectorBytes(margin) +
+                   MemorySizing::vectorBytes(minStock) + MemorySizing::vectorBytes(maxStock) +
+                   MemorySizing::vectorBytes(supplierNames) +
+                   supplierCodes.size() * MemorySizing::hashNodeBytes<std::string, uint32_t>() +
+                   MemorySizing::hashBucketBytes(supplierCodes.bucket_count());
+    for (const std::string& name : supplierNames) {
+        bytes += 2 * MemorySizing::stringBytes(name);   // Dictionary entry and its map key
+    }
+    return bytes;
+}
@@ -0,0 +1,179 @@
+// ===== ProductQuery.h =====
+#ifndef PRODUCT_QUERY_H
+#define PRODUCT_QUERY_H
+
+#include "Product.h"
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Product attributes a query can filter, sort or show
+ */
+enum class ProductField {
+    ID,
+    NAME,
+    CATEGORY,
+    SUPPLIER,
+    TYPE,          // Regular, Perishable or Bulk
+    TAG,
+    ACTIVE,        // 1 or 0
+    PRICE,         // Selling price
+    COST,
+    MARGIN,        // Percent over cost
+    MIN_STOCK,
+    MAX_STOCK,
+    STOCK,
+    AVAILABLE,     // Stock not reserved for transfers
+    VALUE          // Stock at selling price
+};
+
+enum class QueryOp {
+    EQ,            // Numbers: equal; text: any of the values
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    CONTAINS       // Case-insensitive substring of ID, name or supplier
+};
+
+/**
+ * @brief One filter: a field against a constant, a value list or another field
+ *
+ * Category and type values are kept as lowercase keys without spaces or
+ * punctuation ("healthbeauty"), CONTAINS values in lowercase.
+ */
+struct ProductPredicate {
+    ProductField field;
+    QueryOp op;
+    double number;
+    std::vector<std::string> values;
+    bool compareField;         // Right-hand side is otherField * scale
+    ProductField otherField;
+    double scale;
+
+    ProductPredicate()
+        : field(ProductField::ID), op(QueryOp::EQ), number(0.0), compareField(false),
+          otherField(ProductField::ID), scale(1.0) {}
+
+    bool matches(const Product& product) const;
+};
+
+/**
+ * @brief Filters (all must match), shown fields, sort order and limit
+ *
+ * Queries compose by chaining:
+ *
+ *   ProductQuery().where(ProductField::CATEGORY, QueryOp::EQ, "snacks")
+ *                 .where(ProductField::SUPPLIER, QueryOp::EQ, "Frito-Lay")
+ *                 .where(ProductField::MARGIN, QueryOp::GT, 30)
+ *                 .whereField(ProductField::STOCK, QueryOp::LT, ProductField::MIN_STOCK)
+ *                 .sortBy(ProductField::MARGIN, true).take(20)
+ *
+ * Without a sort field rows come in no particular order.
+ */
+struct ProductQuery {
+    std::vector<ProductPredicate> filters;
+    std::vector<ProductField> fields;   // Shown by display(); empty for the default columns
+    bool sorted;
+    ProductField sortField;
+    bool descending;
+    size_t limit;                       // 0 for no limit
+
+    ProductQuery() : sorted(false), sortField(ProductField::ID), descending(false), limit(0) {}
+
+    ProductQuery& where(ProductField field, QueryOp op, double number);
+    ProductQuery& where(ProductField field, QueryOp op, const std::string& value);
+    ProductQuery& where(ProductField field, QueryOp op, const std::vector<std::string>& values);
+    ProductQuery& whereField(ProductField field, QueryOp op, ProductField other, double scale = 1.0);
+    ProductQuery& show(const std::vector<ProductField>& shown);
+    ProductQuery& sortBy(ProductField field, bool descendingOrder = false);
+    ProductQuery& take(size_t count);
+
+    // Sorts by the sort field and applies the limit
+    void order(std::vector<Product*>& rows) const;
+    void order(std::vector<Product*>& rows, const std::vector<double>& keys) const;   // Numeric keys given
+
+    /**
+     * @brief Parses "field<op>value" filters and sort=, limit= and show= options
+     *
+     * Ops are = != < <= > >= and ~ (contains). Text values are comma-separated
+     * lists; a number can also be another field, optionally scaled:
+     * stock<min, stock>=max*0.9.
+     */
+    static bool parse(const std::vector<std::string>& args, ProductQuery& query, std::string& error);
+
+    static bool stringToField(const std::string& name, ProductField& field);
+    static std::string fieldName(ProductField field);
+    static bool isNumeric(ProductField field);
+    static double numericValue(const Product& product, ProductField field);
+    static std::string textValue(const Product& product, ProductField field);
+    static std::string valueKey(const std::string& text);   // Lowercase letters and digits only
+};
+
+/**
+ * @brief Rows a query returned and how the planner found them
+ */
+struct ProductQueryResult {
+    std::vector<Product*> rows;
+    size_t matched;            // Before the limit
+    std::string plan;
+    long scanned;              // Index candidates or column rows examined
+    double seconds;
+
+    ProductQueryResult() : matched(0), scanned(0), seconds(0.0) {}
+
+    void display(const ProductQuery& query, std::ostream& out) const;
+};
+
+/**
+ * @brief Columnar copy of the attributes that change only through InventoryManager
+ *
+ * One entry per resident product in ID order: category, type, active and a
+ * dictionary-coded supplier as small integer codes, prices and stock levels
+ * as doubles. A scan keeps one bit per row and clears the rows each filter
+ * rejects; with SSE2 a filter compares 16 codes or 2 doubles per
+ * instruction and skips 64-row words already cleared, so the most selective
+ * filters are applied first. Stock moves on every sale and is not
+ * columnar: stock filters run on the rows that survive the scan.
+ *
+ * The owner rebuilds the columns when its catalogue version moves on.
+ */
+class ProductColumns {
+private:
+    std::vector<Product*> rows;
+    std::vector<uint8_t> category;
+    std::vector<uint8_t> type;
+    std::vector<uint8_t> active;
+    std::vector<uint32_t> supplier;
+    std::vector<double> price;
+    std::vector<double> cost;
+    std::vector<double> margin;
+    std::vector<double> minStock;
+    std::vector<double> maxStock;
+    std::vector<std::string> supplierNames;
+    std::unordered_map<std::string, uint32_t> supplierCodes;
+    uint64_t version;
+    bool built;
+
+public:
+    ProductColumns() : version(0), built(false) {}
+
+    bool isCurrent(uint64_t catalogVersion) const { return built && version == catalogVersion; }
+    void rebuild(const std::map<std::string, Product*>& products, uint64_t catalogVersion);
+    size_t size() const { return rows.size(); }
+    Product* getRow(uint32_t row) const { return rows[row]; }
+    const std::vector<double>* getColumn(ProductField field) const;   // Null unless numeric and columnar
+
+    bool canScan(const ProductPredicate& filter) const;
+    // Appends the row numbers every filter accepts, in ID order; filters must pass canScan()
+    void scan(const std::vector<const ProductPredicate*>& filters, std::vector<uint32_t>& out) const;
+
+    size_t getAllocatedBytes() const;
+};
+
+#endif // PRODUCT_QUERY_H
@@ -0,0 +1,172 @@
+// ===== ReceiptExporter.cpp =====
+#include "ReceiptExporter.h"
+#include <cstdio>
+
+// Escapes the characters JSON requires; ids and notes are short so this stays cheap
+static void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+static void appendNumber(std::string& out, const char* format, double value) {
+    char buffer[32];
+    int length = std::snprintf(buffer, sizeof(buffer), format, value);
+    out.append(buffer, length);
+}
+
+ReceiptBuffer::int_type ReceiptBuffer::overflow(int_type ch) {
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        target += traits_type::to_char_type(ch);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize ReceiptBuffer::xsputn(const char* data, std::streamsize count) {
+    target.append(data, static_cast<size_t>(count));
+    return count;
+}
+
+ReceiptExporter::ReceiptExporter(size_t bufferSize)
+    : pendingBuffer(pending), pendingStream(&pendingBuffer), flushThreshold(bufferSize),
+      format(ReceiptFormat::TEXT), receiptsWritten(0), bytesWritten(0), writeFailed(false) {
+}
+
+ReceiptExporter::~ReceiptExporter() {
+    close();
+}
+
+bool ReceiptExporter::open(const std::string& path, ReceiptFormat format) {
+    close();
+    file.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    this->format = format;
+    receiptsWritten = 0;
+    bytesWritten = 0;
+    writeFailed = false;
+    pending.clear();
+    pending.reserve(flushThreshold + flushThreshold / 4);
+    return true;
+}
+
+void ReceiptExporter::exportReceipt(const Transaction& transaction) {
+    if (!file.is_open() || writeFailed) {
+        return;
+    }
+
+    switch (format) {
+        case ReceiptFormat::TEXT:
+            transaction.renderReceipt(pendingStream);
+            break;
+        case ReceiptFormat::DETAILED:
+            transaction.renderDetailedReceipt(pendingStream);
+            break;
+        case ReceiptFormat::JSON_LINES:
+            appendJsonLine(transaction, pending);
+            break;
+    }
+    receiptsWritten++;
+    
+    if (pending.size() >= flushThreshold) {
+        flushPending();
+    }
+}
+
+size_t ReceiptExporter::exportAll(const std::vector<Transaction*>& transactions) {
+    size_t count = 0;
+    for (const Transaction* transaction : transactions) {
+        if (transaction) {
+            exportReceipt(*transaction);
+            count++;
+        }
+    }
+    return count;
+}
+
+bool ReceiptExporter::flushPending() {
+    if (!pending.empty()) {
+        if (!file.write(pending.data(), static_cast<std::streamsize>(pending.size()))) {
+            writeFailed = true;
+        } else {
+            bytesWritten += pending.size();
+        }
+        pending.clear();
+    }
+    return !writeFailed;
+}
+
+bool ReceiptExporter::close() {
+    if (file.is_open()) {
+        flushPending();
+        file.close();
+        if (file.fail()) {
+            writeFailed = true;
+        }
+    }
+    return !writeFailed;
+}
+
+void ReceiptExporter::appendJsonLine(const Transaction& transaction, std::string& out) {
+    out += "{\"id\":";
+    out += std::to_string(transaction.getId());
+    out += ",\"ts\":";
+    out += std::to_string(static_cast<long long>(transaction.getTimestamp()));
+    out += ",\"cashier\":";
+    appendJsonString(out, transaction.getCashierId());
+    if (transaction.getCustomer()) {
+        out += ",\"customer\":";
+        appendJsonString(out, transaction.getCustomer()->getId());
+    }
+    out += ",\"status\":";
+    appendJsonString(out, transaction.getStatusString());
+    out += ",\"payment\":";
+    appendJsonString(out, transaction.getPaymentMethodString());
+    appendNumber(out, ",\"subtotal\":%.2f", transaction.getSubtotal());
+    appendNumber(out, ",\"discount\":%.2f", transaction.getTotalDiscount());
+    appendNumber(out, ",\"tax\":%.2f", transaction.getTax());
+    appendNumber(out, ",\"total\":%.2f", transaction.getFinalTotal());
+    if (transaction.getRefundedTotal() > 0) {
+        appendNumber(out, ",\"refunded\":%.2f", transaction.getRefundedTotal());
+    }
+    if (transaction.isTaxIncluded()) {
+        out += ",\"taxIncluded\":true";
+    }
+
+    out += ",\"items\":[";
+    const std::vector<TransactionItem>& items = transaction.getItems();
+    for (size_t i = 0; i < items.size(); ++i) {
+        const TransactionItem& item = items[i];
+        if (i > 0) {
+            out += ',';
+        }
+        out += "{\"sku\":";
+        appendJsonString(out, item.product ? item.product->getId() : std::string());
+        appendNumber(out, ",\"qty\":%.3f", item.quantity);
+        appendNumber(out, ",\"price\":%.2f", item.unitPrice);
+        if (item.discount > 0) {
+            appendNumber(out, ",\"disc\":%.4g", item.discount);
+        }
+        appendNumber(out, ",\"amount\":%.2f", item.subtotal);
+        appendNumber(out, ",\"tax\":%.2f", item.tax);
+        out += '}';
+    }
+    out += "]}\n";
+}
@@ -0,0 +1,78 @@
+// ===== ReceiptExporter.h =====
+#ifndef RECEIPT_EXPORTER_H
+#define RECEIPT_EXPORTER_H
+
+#include "Transaction.h"
+#include <fstream>
+#include <streambuf>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Stream buffer that appends everything written to a caller-owned string
+ *
+ * Lets the render* methods of Transaction write into memory with no flushing,
+ * e.g. to batch many receipts before a single write.
+ */
+class ReceiptBuffer : public std::streambuf {
+private:
+    std::string& target;
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* data, std::streamsize count) override;
+
+public:
+    explicit ReceiptBuffer(std::string& target) : target(target) {}
+};
+
+/**
+ * @brief Output formats supported by the receipt exporter
+ */
+enum class ReceiptFormat {
+    TEXT,        // Same layout as the printed receipt
+    DETAILED,    // Same layout as the detailed receipt
+    JSON_LINES   // One compact JSON object per receipt
+};
+
+/**
+ * @brief Batch receipt exporter for reprints and audit exports
+ *
+ * Receipts are rendered into a large in-memory staging buffer and handed
+ * to the file in big writes; nothing is flushed per line or per receipt.
+ */
+class ReceiptExporter {
+private:
+    std::ofstream file;
+    std::string pending;            // Rendered receipts staged before a bulk write
+    ReceiptBuffer pendingBuffer;
+    std::ostream pendingStream;     // Text renderers write through this into pending
+    size_t flushThreshold;
+    ReceiptFormat format;
+    size_t receiptsWritten;
+    size_t bytesWritten;
+    bool writeFailed;               // A bulk write failed; later receipts are dropped
+
+    static const size_t DEFAULT_BUFFER_SIZE = 1 << 20;
+
+    bool flushPending();
+
+public:
+    explicit ReceiptExporter(size_t bufferSize = DEFAULT_BUFFER_SIZE);
+    ~ReceiptExporter();
+
+    bool open(const std::string& path, ReceiptFormat format);
+    void exportReceipt(const Transaction& transaction);
+    size_t exportAll(const std::vector<Transaction*>& transactions);
+    bool close();                   // False if any receipt failed to reach the file
+
+    size_t getReceiptsWritten() const { return receiptsWritten; }
+    size_t getBytesWritten() const { return bytesWritten; }
+    bool hasFailed() const { return writeFailed; }
+
+    // Appends one JSON object (terminated by '\n') describing the receipt
+    static void appendJsonLine(const Transaction& transaction, std::string& out);
+};
+
+#endif // RECEIPT_EXPORTER_H
@@ -0,0 +1,83 @@
+// ===== Refund.cpp =====
+#include "Refund.h"
+#include "MemoryAccounting.h"
+#include <iostream>
+#include <iomanip>
+
+int RefundLedger::nextRefundId = 50001;
+
+const RefundRecord* RefundLedger::recordRefund(const RefundRecord& refund) {
+    records.push_back(refund);
+    RefundRecord& stored = records.back();
+    stored.refundId = nextRefundId++;
+
+    auto it = latestByTransaction.find(stored.transactionId);
+    const RefundRecord* previous = (it != latestByTransaction.end()) ? it->second : nullptr;
+    stored.previous = previous;
+    stored.refundCount = previous ? previous->refundCount + 1 : 1;
+    stored.cumulativeAmount = (previous ? previous->cumulativeAmount : 0.0) + stored.amount;
+
+    latestByTransaction[stored.transactionId] = &stored;
+    return &stored;
+}
+
+const RefundRecord* RefundLedger::getLatestRefund(int transactionId) const {
+    auto it = latestByTransaction.find(transactionId);
+    return (it != latestByTransaction.end()) ? it->second : nullptr;
+}
+
+int RefundLedger::getRefundCount(int transactionId) const {
+    const RefundRecord* latest = getLatestRefund(transactionId);
+    return latest ? latest->refundCount : 0;
+}
+
+double RefundLedger::getRefundedAmount(int transactionId) const {
+    const RefundRecord* latest = getLatestRefund(transactionId);
+    return latest ? latest->cumulativeAmount : 0.0;
+}
+
+void RefundLedger::displayRefundHistory(int transactionId) const {
+    const RefundRecord* refund = getLatestRefund(transactionId);
+    if (!refund) {
+        std::cout << "No refunds recorded for transaction " << transactionId << "\n";
+        return;
+    }
+
+    std::cout << "Refund history for transaction " << transactionId << ": "
+              << refund->refundCount << " refund(s), $" << std::fixed << std::setprecision(2)
+              << refund->cumulativeAmount << " total\n";
+    for (; refund; refund = refund->previous) {
+        std::cout << "  #" << refund->refundId << " $" << std::fixed << std::setprecision(2)
+                  << refund->amount << " (tax $" << refund->tax << ", points "
+                  << refund->loyaltyPointsReversed << ")";
+        if (!refund->reason.empty()) {
+            std::cout << " - " << refund->reason;
+        }
+        std::cout << "\n";
+        for (const RefundLine& line : refund->lines) {
+            std::cout << "      item " << (line.itemIndex + 1) << ": qty " << line.quantity
+                      << ", restocked " << line.stockRestored << ", $" << line.amount << "\n";
+        }
+    }
+}
+
+void RefundLedger::accountMemory(MemoryReport& report) const {
+    // libstdc++ deques allocate 512-byte blocks (or one element per block if larger)
+    size_t perBlock = sizeof(RefundRecord) < 512 ? 512 / sizeof(RefundRecord) : 1;
+    size_t blocks = (records.size() + perBlock - 1) / perBlock;
+    size_t recordBytes = blocks * MemorySizing::allocation(perBlock * sizeof(RefundRecord));
+
+    long lineCount = 0;
+    size_t lineBytes = 0;
+    for (const RefundRecord& record : records) {
+        lineCount += static_cast<long>(record.lines.size());
+        lineBytes += MemorySizing::vectorBytes(record.lines) + MemorySizing::stringBytes(record.reason);
+    }
+
+    long indexed = static_cast<long>(latestByTransaction.size());
+    report.add("Refunds", "Refund records", static_cast<long>(records.size()), recordBytes);
+    report.add("Refunds", "Refund lines and reasons", lineCount, lineBytes);
+    report.add("Refunds", "latestByTransaction index", indexed,
+               indexed * MemorySizing::hashNodeBytes<int, const RefundRecord*>() +
+               MemorySizing::hashBucketBytes(latestByTransaction.bucket_count()));
+}
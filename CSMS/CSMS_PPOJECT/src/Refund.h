@@ -0,0 +1,70 @@
+// ===== Refund.h =====
+#ifndef REFUND_H
+#define REFUND_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <ctime>
+
+/**
+ * @brief Refund of (part of) one transaction line
+ */
+struct RefundLine {
+    int itemIndex;        // Index into Transaction::getItems()
+    double quantity;      // Quantity returned (fractional for bulk items)
+    int stockRestored;    // Whole stock units actually put back, capped by the shelf's maximum
+    double amount;        // Refunded amount including tax
+    double tax;           // Tax portion of amount
+};
+
+/**
+ * @brief One refund event against a completed transaction
+ *
+ * Records for the same transaction form a singly linked list, newest first,
+ * and carry running totals so the head alone answers history queries.
+ */
+struct RefundRecord {
+    int refundId;
+    int transactionId;
+    std::time_t timestamp;
+    std::vector<RefundLine> lines;  // Empty for purely monetary refunds
+    double amount;                  // Total refunded including tax
+    double tax;
+    double loyaltyPointsReversed;
+    std::string reason;
+
+    const RefundRecord* previous;   // Earlier refund of the same transaction
+    int refundCount;                // Refunds of the transaction up to and including this one
+    double cumulativeAmount;        // Amount refunded for the transaction so far
+
+    RefundRecord() : refundId(0), transactionId(0), timestamp(0), amount(0.0), tax(0.0),
+                     loyaltyPointsReversed(0.0), previous(nullptr), refundCount(0),
+                     cumulativeAmount(0.0) {}
+};
+
+class MemoryReport;
+
+/**
+ * @brief Store of all refunds, indexed by original transaction
+ */
+class RefundLedger {
+private:
+    std::deque<RefundRecord> records;  // Deque keeps record addresses stable
+    std::unordered_map<int, const RefundRecord*> latestByTransaction;
+    static int nextRefundId;
+
+public:
+    const RefundRecord* recordRefund(const RefundRecord& refund);
+
+    const RefundRecord* getLatestRefund(int transactionId) const;
+    int getRefundCount(int transactionId) const;
+    double getRefundedAmount(int transactionId) const;
+
+    size_t getTotalRefundCount() const { return records.size(); }
+    void displayRefundHistory(int transactionId) const;
+    void accountMemory(MemoryReport& report) const;
+};
+
+#endif // REFUND_H
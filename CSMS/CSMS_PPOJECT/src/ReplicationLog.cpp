@@ -0,0 +1,318 @@
+// ===== ReplicationLog.cpp =====
+#include "ReplicationLog.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+const char* ReplicationLog::HEADER_TAG = "#CSMS-REPLICATION";
+
+// Names and suppliers are free text; tabs and newlines would break the line format
+static std::string cleanField(const std::string& text) {
+    std::string clean = text;
+    std::replace(clean.begin(), clean.end(), '\t', ' ');
+    std::replace(clean.begin(), clean.end(), '\n', ' ');
+    std::replace(clean.begin(), clean.end(), '\r', ' ');
+    return clean;
+}
+
+static std::vector<std::string> splitTabs(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t end = line.find('\t', start);
+        fields.push_back(line.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos) {
+            return fields;
+        }
+        start = end + 1;
+    }
+}
+
+static bool parseNumber(const std::string& text, long long& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtoll(text.c_str(), &end, 10);
+    return *end == '\0';
+}
+
+static bool parseAmount(const std::string& text, double& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+static std::string formatAmount(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.4f", value);
+    return buffer;
+}
+
+// ReplicationEvent implementation
+ReplicationEvent::ReplicationEvent()
+    : sequence(0), timestamp(0), type(ReplicationEventType::STOCK), category(ProductCategory::OTHER), stock(0),
+      basePrice(0.0), sellingPrice(0.0) {
+}
+
+ReplicationEvent::ReplicationEvent(ReplicationEventType type, const Product& product)
+    : sequence(0), timestamp(0), type(type), productId(product.getId()), category(product.getCategory()),
+      stock(product.getCurrentStock()), basePrice(product.getBasePrice()),
+      sellingPrice(product.calculateSellingPrice()) {
+    if (type == ReplicationEventType::PRODUCT) {
+        name = product.getName();
+        supplier = product.getSupplier();
+    }
+}
+
+std::string ReplicationEvent::format() const {
+    std::string line = std::to_string(sequence) + '\t' + std::to_string(static_cast<long long>(timestamp)) + '\t';
+    switch (type) {
+    case ReplicationEventType::PRODUCT:
+        line += "P\t" + cleanField(productId) + '\t' + std::to_string(stock) + '\t' + formatAmount(basePrice) + '\t' +
+                formatAmount(sellingPrice) + '\t' + std::to_string(static_cast<int>(category)) + '\t' +
+                cleanField(name) + '\t' + cleanField(supplier);
+        break;
+    case ReplicationEventType::STOCK:
+        line += "S\t" + cleanField(productId) + '\t' + std::to_string(stock);
+        break;
+    case ReplicationEventType::PRICE:
+        line += "R\t" + cleanField(productId) + '\t' + formatAmount(basePrice) + '\t' + formatAmount(sellingPrice);
+        break;
+    case ReplicationEventType::REMOVE:
+        line += "X\t" + cleanField(productId);
+        break;
+    }
+    return line;
+}
+
+bool ReplicationEvent::parse(const std::string& line, ReplicationEvent& event) {
+    std::vector<std::string> fields = splitTabs(line);
+    long long sequence;
+    long long timestamp;
+    if (fields.size() < 4 || fields[2].size() != 1 || fields[3].empty() ||
+        !parseNumber(fields[0], sequence) || !parseNumber(fields[1], timestamp) || sequence <= 0) {
+        return false;
+    }
+    event = ReplicationEvent();
+    event.sequence = static_cast<uint64_t>(sequence);
+    event.timestamp = static_cast<std::time_t>(timestamp);
+    event.productId = fields[3];
+
+    long long number;
+    switch (fields[2][0]) {
+    case 'P':
+        if (fields.size() != 10 || !parseNumber(fields[4], number) || !parseAmount(fields[5], event.basePrice) ||
+            !parseAmount(fields[6], event.sellingPrice)) {
+            return false;
+        }
+        event.type = ReplicationEventType::PRODUCT;
+        event.stock = static_cast<int>(number);
+        if (!parseNumber(fields[7], number) || number < 0 || number > static_cast<int>(ProductCategory::OTHER)) {
+            return false;
+        }
+        event.category = static_cast<ProductCategory>(number);
+        event.name = fields[8];
+        event.supplier = fields[9];
+        return true;
+    case 'S':
+        if (fields.size() != 5 || !parseNumber(fields[4], number)) {
+            return false;
+        }
+        event.type = ReplicationEventType::STOCK;
+        event.stock = static_cast<int>(number);
+        return true;
+    case 'R':
+        if (fields.size() != 6 || !parseAmount(fields[4], event.basePrice) ||
+            !parseAmount(fields[5], event.sellingPrice)) {
+            return false;
+        }
+        event.type = ReplicationEventType::PRICE;
+        return true;
+    case 'X':
+        if (fields.size() != 4) {
+            return false;
+        }
+        event.type = ReplicationEventType::REMOVE;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// ReplicationLog implementation
+ReplicationLog::ReplicationLog()
+    : pendingEvents(0), nextSequence(1), eventsWritten(0), created(false), flusherIdle(false), stopping(false),
+      batchEvents(256), intervalMs(20), batchesWritten(0) {
+}
+
+ReplicationLog::~ReplicationLog() {
+    close();
+}
+
+bool ReplicationLog::parseHeader(const std::string& line, std::string& storeId, std::string& epoch) {
+    std::vector<std::string> fields = splitTabs(line);
+    if (fields.size() != 4 || fields[0] != HEADER_TAG || fields[1] != "1" || fields[2].empty() || fields[3].empty()) {
+        return false;
+    }
+    storeId = fields[2];
+    epoch = fields[3];
+    return true;
+}
+
+bool ReplicationLog::open(const std::string& logPath, const std::string& store, size_t batch, int interval) {
+    close();
+    path = logPath;
+    storeId = cleanField(store);
+    nextSequence = 1;
+    eventsWritten = 0;
+    batchesWritten = 0;
+    pendingEvents = 0;
+    pending.clear();
+    batchEvents = std::max<size_t>(batch, 1);
+    intervalMs = std::max(interval, 1);
+
+    std::ifstream existing(path, std::ios::binary | std::ios::ate);
+    created = !existing || existing.tellg() <= 0;
+    bool endsWithNewline = true;
+    if (!created) {
+        std::streamoff size = existing.tellg();
+        existing.seekg(0);
+        std::string header;
+        std::string existingStore;
+        if (!std::getline(existing, header) || !parseHeader(header, existingStore, epoch) || existingStore != storeId) {
+            return false;   // Another store's log, or not a log at all
+        }
+
+        // The last complete event line holds the sequence to continue from
+        std::streamoff tailStart = std::min(size, std::max<std::streamoff>(
+                                                      static_cast<std::streamoff>(header.size()) + 1, size - 65536));
+        std::string tail(static_cast<size_t>(size - tailStart), '\0');
+        existing.seekg(tailStart);
+        existing.read(&tail[0], tail.size());
+        endsWithNewline = tail.empty() || tail.back() == '\n';
+        size_t end = tail.rfind('\n');
+        while (end != std::string::npos && end > 0) {
+            size_t start = tail.rfind('\n', end - 1);
+            start = (start == std::string::npos) ? 0 : start + 1;
+            ReplicationEvent last;
+            if (ReplicationEvent::parse(tail.substr(start, end - start), last)) {
+                nextSequence = last.sequence + 1;
+                break;
+            }
+            end = start > 0 ? start - 1 : std::string::npos;
+        }
+    }
+    existing.close();
+
+    out.open(path, std::ios::binary | std::ios::app);
+    if (!out) {
+        return false;
+    }
+    if (created) {
+        std::random_device random;
+        char token[40];
+        std::snprintf(token, sizeof(token), "%llx-%08x", static_cast<unsigned long long>(std::time(nullptr)),
+                      static_cast<unsigned>(random()));
+        epoch = token;
+        out << HEADER_TAG << '\t' << 1 << '\t' << storeId << '\t' << epoch << '\n';
+    } else if (!endsWithNewline) {
+        out << '\n';    // Terminate a line cut short by a crash; readers skip it
+    }
+    out.flush();
+    if (!out) {
+        return false;
+    }
+    stopping = false;
+    flusherIdle = false;
+    flusher = std::thread(&ReplicationLog::run, this);
+    return true;
+}
+
+void ReplicationLog::close() {
+    if (flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        flusher.join();
+    }
+    if (out.is_open()) {
+        flush();
+        out.close();
+    }
+}
+
+void ReplicationLog::append(ReplicationEvent event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    event.sequence = nextSequence++;
+    if (event.timestamp == 0) {
+        event.timestamp = std::time(nullptr);
+    }
+    pending += event.format();
+    pending += '\n';
+    pendingEvents++;
+    eventsWritten++;
+}
+
+bool ReplicationLog::flush() {
+    return writePending();
+}
+
+void ReplicationLog::flushSoon() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (pendingEvents >= batchEvents) {
+        lock.unlock();
+        writePending();
+    } else if (pendingEvents > 0 && flusherIdle) {
+        flusherIdle = false;
+        lock.unlock();
+        wake.notify_one();
+    }
+}
+
+// Swaps the buffer out under the lock so appenders never wait for the disk
+bool ReplicationLog::writePending() {
+    std::lock_guard<std::mutex> writeLock(writeMutex);
+    if (!out.is_open()) {
+        return false;
+    }
+    std::string batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.empty()) {
+            return static_cast<bool>(out);
+        }
+        batch.swap(pending);
+        pending.reserve(batch.capacity());
+        pendingEvents = 0;
+        batchesWritten++;
+    }
+    out.write(batch.data(), batch.size());
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+void ReplicationLog::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (pendingEvents == 0) {
+            flusherIdle = true;
+            wake.wait(lock);
+            continue;
+        }
+        // Let the batch grow for one interval, then write it
+        flusherIdle = false;
+        wake.wait_for(lock, std::chrono::milliseconds(intervalMs), [this]() { return stopping; });
+        lock.unlock();
+        writePending();
+        lock.lock();
+    }
+}
@@ -0,0 +1,107 @@
+// ===== ReplicationLog.h =====
+#ifndef REPLICATION_LOG_H
+#define REPLICATION_LOG_H
+
+#include "Product.h"
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+enum class ReplicationEventType {
+    PRODUCT,    // Full product state
+    STOCK,      // Stock level
+    PRICE,      // Base and selling price
+    REMOVE
+};
+
+/**
+ * @brief One inventory change, carrying absolute values so replaying it is idempotent
+ */
+struct ReplicationEvent {
+    uint64_t sequence;
+    std::time_t timestamp;
+    ReplicationEventType type;
+    std::string productId;
+    std::string name;           // PRODUCT only
+    std::string supplier;       // PRODUCT only
+    ProductCategory category;   // PRODUCT only
+    int stock;                  // PRODUCT and STOCK
+    double basePrice;           // PRODUCT and PRICE
+    double sellingPrice;        // PRODUCT and PRICE
+
+    ReplicationEvent();
+    ReplicationEvent(ReplicationEventType type, const Product& product);
+
+    // One tab-separated line without the newline
+    std::string format() const;
+    static bool parse(const std::string& line, ReplicationEvent& event);
+};
+
+/**
+ * @brief Ordered, append-only log of one store's inventory changes
+ *
+ * A text file: a header line naming the store and the log's epoch, then
+ * one event per line with sequence numbers increasing by one. Reopening
+ * an existing log continues its sequence; a new file gets a new epoch so
+ * readers can tell a replaced log from a grown one. Events are buffered
+ * until flush(), which writes whole lines only.
+ *
+ * flushSoon() is the group commit used for stock changes at checkout: a
+ * background thread writes whatever is buffered at most intervalMs after
+ * the first event of a batch, and the caller writes at once only when
+ * batchEvents are waiting. Appending never waits for the disk.
+ */
+class ReplicationLog {
+private:
+    std::string path;
+    std::string storeId;
+    std::string epoch;
+    std::ofstream out;
+    std::string pending;
+    size_t pendingEvents;
+    uint64_t nextSequence;
+    long eventsWritten;
+    bool created;
+
+    mutable std::mutex mutex;           // Guards pending and the counters
+    std::mutex writeMutex;              // Orders writes to out; taken before mutex
+    std::condition_variable wake;       // Flusher: first event of a batch, or stopping
+    std::thread flusher;
+    bool flusherIdle;
+    bool stopping;
+    size_t batchEvents;
+    int intervalMs;
+    long batchesWritten;
+
+    bool writePending();
+    void run();
+
+public:
+    ReplicationLog();
+    ~ReplicationLog();
+
+    bool open(const std::string& path, const std::string& storeId, size_t batchEvents = 256, int intervalMs = 20);
+    void close();
+    bool isOpen() const { return out.is_open(); }
+
+    void append(ReplicationEvent event);
+    bool flush();                       // Writes everything appended so far before returning
+    void flushSoon();                   // Leaves the write to the flusher thread unless a batch is full
+
+    const std::string& getPath() const { return path; }
+    const std::string& getStoreId() const { return storeId; }
+    const std::string& getEpoch() const { return epoch; }
+    uint64_t getLastSequence() const { std::lock_guard<std::mutex> lock(mutex); return nextSequence - 1; }
+    long getEventsWritten() const { std::lock_guard<std::mutex> lock(mutex); return eventsWritten; }
+    long getBatchesWritten() const { std::lock_guard<std::mutex> lock(mutex); return batchesWritten; }
+    bool wasCreated() const { return created; }
+
+    static const char* HEADER_TAG;
+    static bool parseHeader(const std::string& line, std::string& storeId, std::string& epoch);
+};
+
+#endif // REPLICATION_LOG_H
@@ -0,0 +1,190 @@
+// ===== SalesAggregates.cpp =====
+#include "SalesAggregates.h"
+#include "Transaction.h"
+#include "MemoryAccounting.h"
+
+SalesBucket::SalesBucket(std::time_t start)
+    : start(start), transactions(0), sales(0.0), tax(0.0), refunds(0), refundAmount(0.0), refundTax(0.0) {
+    for (int c = 0; c < PRODUCT_CATEGORY_COUNT; ++c) {
+        unitsSold[c] = 0.0;
+        unitsReturned[c] = 0.0;
+    }
+}
+
+void SalesBucket::merge(const SalesBucket& other) {
+    transactions += other.transactions;
+    sales += other.sales;
+    tax += other.tax;
+    refunds += other.refunds;
+    refundAmount += other.refundAmount;
+    refundTax += other.refundTax;
+    for (int c = 0; c < PRODUCT_CATEGORY_COUNT; ++c) {
+        unitsSold[c] += other.unitsSold[c];
+        unitsReturned[c] += other.unitsReturned[c];
+    }
+}
+
+static void addSale(SalesBucket& bucket, const Transaction& transaction) {
+    bucket.transactions++;
+    bucket.sales += transaction.getFinalTotal();
+    bucket.tax += transaction.getTax();
+    for (const auto& item : transaction.getItems()) {
+        bucket.unitsSold[static_cast<int>(item.product->getCategory())] += item.quantity;
+    }
+}
+
+static void addRefund(SalesBucket& bucket, const Transaction& transaction, const RefundRecord& refund) {
+    bucket.refunds++;
+    bucket.refundAmount += refund.amount;
+    bucket.refundTax += refund.tax;
+    for (const RefundLine& line : refund.lines) {
+        const TransactionItem& item = transaction.getItems()[line.itemIndex];
+        bucket.unitsReturned[static_cast<int>(item.product->getCategory())] += line.quantity;
+    }
+}
+
+SalesAggregates::SalesAggregates()
+    : completedCount(0), completedSales(0.0), completedTax(0.0), refundedCount(0),
+      cachedDay(0), cachedNextDay(0) {
+}
+
+std::time_t SalesAggregates::startOfDay(std::time_t when) {
+    std::tm local;
+    localtime_r(&when, &local);
+    local.tm_hour = 0;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+    return std::mktime(&local);
+}
+
+std::time_t SalesAggregates::addDays(std::time_t day, int days) {
+    std::tm local;
+    localtime_r(&day, &local);
+    local.tm_mday += days;  // mktime normalises across months and DST changes
+    local.tm_hour = 0;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+    return std::mktime(&local);
+}
+
+std::time_t SalesAggregates::startOfHour(std::time_t when) {
+    std::time_t day = startOfDay(when);
+    return day + (when - day) / 3600 * 3600;
+}
+
+std::time_t SalesAggregates::dayContaining(std::time_t when) {
+    // Sales arrive in time order, so almost every lookup hits the cached day
+    if (when < cachedDay || when >= cachedNextDay) {
+        cachedDay = startOfDay(when);
+        cachedNextDay = addDays(cachedDay, 1);
+    }
+    return cachedDay;
+}
+
+void SalesAggregates::recordSale(const Transaction& transaction) {
+    std::time_t when = transaction.getTimestamp();
+    std::time_t day = dayContaining(when);
+    std::time_t hour = day + (when - day) / 3600 * 3600;
+
+    addSale(totals, transaction);
+    addSale(daily.emplace(day, SalesBucket(day)).first->second, transaction);
+    addSale(hourly.emplace(hour, SalesBucket(hour)).first->second, transaction);
+
+    completedCount++;
+    completedSales += transaction.getFinalTotal();
+    completedTax += transaction.getTax();
+}
+
+void SalesAggregates::recordRefund(const Transaction& transaction, const RefundRecord& refund) {
+    std::time_t when = refund.timestamp;
+    std::time_t day = dayContaining(when);
+    std::time_t hour = day + (when - day) / 3600 * 3600;
+
+    addRefund(totals, transaction, refund);
+    addRefund(daily.emplace(day, SalesBucket(day)).first->second, transaction, refund);
+    addRefund(hourly.emplace(hour, SalesBucket(hour)).first->second, transaction, refund);
+
+    // The first refund moves the transaction out of COMPLETED for good
+    if (refund.refundCount == 1) {
+        completedCount--;
+        completedSales -= transaction.getFinalTotal();
+        completedTax -= transaction.getTax();
+        refundedCount++;
+    }
+}
+
+void SalesAggregates::sumRange(const std::map<std::time_t, SalesBucket>& buckets, std::time_t from,
+                               std::time_t to, SalesBucket& result) {
+    for (auto it = buckets.lower_bound(from); it != buckets.end() && it->first < to; ++it) {
+        result.merge(it->second);
+    }
+}
+
+SalesBucket SalesAggregates::getRange(std::time_t from, std::time_t to) const {
+    SalesBucket result(from);
+    if (from >= to) {
+        return result;
+    }
+
+    // Whole days come from the daily rollup, the ragged ends from the hourly one
+    std::time_t firstDay = startOfDay(from);
+    if (firstDay < from) {
+        firstDay = addDays(firstDay, 1);
+    }
+    std::time_t lastDay = startOfDay(to);
+
+    if (firstDay >= lastDay) {
+        sumRange(hourly, from, to, result);
+    } else {
+        sumRange(hourly, from, firstDay, result);
+        sumRange(daily, firstDay, lastDay, result);
+        sumRange(hourly, lastDay, to, result);
+    }
+    return result;
+}
+
+void SalesAggregates::getPeriodRange(ReportPeriod period, std::time_t now, std::time_t& from, std::time_t& to) {
+    std::time_t today = startOfDay(now);
+    to = addDays(today, 1);
+
+    switch (period) {
+        case ReportPeriod::TODAY:
+            from = today;
+            break;
+        case ReportPeriod::THIS_WEEK: {
+            std::tm local;
+            localtime_r(&today, &local);
+            from = addDays(today, -((local.tm_wday + 6) % 7));
+            break;
+        }
+        case ReportPeriod::LAST_30_DAYS:
+            from = addDays(today, -29);
+            break;
+    }
+}
+
+std::string SalesAggregates::periodToString(ReportPeriod period) {
+    switch (period) {
+        case ReportPeriod::TODAY: return "Today";
+        case ReportPeriod::THIS_WEEK: return "This Week";
+        case ReportPeriod::LAST_30_DAYS: return "Last 30 Days";
+        default: return "Unknown";
+    }
+}
+
+bool SalesAggregates::stringToPeriod(const std::string& text, ReportPeriod& period) {
+    if (text == "today") period = ReportPeriod::TODAY;
+    else if (text == "week") period = ReportPeriod::THIS_WEEK;
+    else if (text == "30days") period = ReportPeriod::LAST_30_DAYS;
+    else return false;
+    return true;
+}
+
+void SalesAggregates::accountMemory(MemoryReport& report) const {
+    report.add("Sales rollups", "Hourly buckets", static_cast<long>(hourly.size()),
+               hourly.size() * MemorySizing::mapNodeBytes<std::time_t, SalesBucket>());
+    report.add("Sales rollups", "Daily buckets", static_cast<long>(daily.size()),
+               daily.size() * MemorySizing::mapNodeBytes<std::time_t, SalesBucket>());
+}
@@ -0,0 +1,104 @@
+// ===== SalesAggregates.h =====
+#ifndef SALES_AGGREGATES_H
+#define SALES_AGGREGATES_H
+
+#include "Product.h"
+#include "TaxEngine.h"
+#include "Refund.h"
+#include <ctime>
+#include <map>
+#include <string>
+
+class Transaction;
+class MemoryReport;
+
+/**
+ * @brief Sales and refund totals over one span of time
+ *
+ * Sales are counted when they complete and refunds when they are issued, so
+ * a refund lands in the bucket of the day it was given, not of the sale.
+ */
+struct SalesBucket {
+    std::time_t start;
+    long transactions;
+    double sales;              // Final totals including tax
+    double tax;
+    long refunds;              // Refund events
+    double refundAmount;       // Including tax
+    double refundTax;
+    double unitsSold[PRODUCT_CATEGORY_COUNT];
+    double unitsReturned[PRODUCT_CATEGORY_COUNT];
+
+    SalesBucket(std::time_t start = 0);
+
+    void merge(const SalesBucket& other);
+    double getNetSales() const { return sales - refundAmount; }
+    double getNetTax() const { return tax - refundTax; }
+};
+
+/**
+ * @brief Date ranges answered from the daily rollups
+ */
+enum class ReportPeriod {
+    TODAY,
+    THIS_WEEK,       // Since Monday
+    LAST_30_DAYS
+};
+
+/**
+ * @brief Running sales totals plus hourly and daily rollups
+ *
+ * Updated as each sale completes and each refund is issued, so store-wide
+ * reports read a handful of counters instead of walking every transaction,
+ * and a date-range report merges at most a few dozen buckets. Days are
+ * local calendar days.
+ */
+class SalesAggregates {
+private:
+    SalesBucket totals;
+
+    // Transactions whose status is still COMPLETED (never refunded)
+    long completedCount;
+    double completedSales;
+    double completedTax;
+    long refundedCount;        // Fully or partially refunded transactions
+
+    std::map<std::time_t, SalesBucket> hourly;  // Keyed by start of hour
+    std::map<std::time_t, SalesBucket> daily;   // Keyed by local midnight
+    std::time_t cachedDay;                      // Most recent day looked up, and the next
+    std::time_t cachedNextDay;
+
+    std::time_t dayContaining(std::time_t when);
+    static void sumRange(const std::map<std::time_t, SalesBucket>& buckets, std::time_t from,
+                         std::time_t to, SalesBucket& result);
+
+public:
+    SalesAggregates();
+
+    void recordSale(const Transaction& transaction);
+    void recordRefund(const Transaction& transaction, const RefundRecord& refund);
+
+    // All-time figures
+    const SalesBucket& getTotals() const { return totals; }
+    long getTransactionCount() const { return totals.transactions; }
+    long getCompletedCount() const { return completedCount; }
+    double getCompletedSales() const { return completedSales; }
+    double getCompletedTax() const { return completedTax; }
+    long getRefundedCount() const { return refundedCount; }
+
+    // Totals for [from, to), to hour resolution at the edges
+    SalesBucket getRange(std::time_t from, std::time_t to) const;
+    static void getPeriodRange(ReportPeriod period, std::time_t now, std::time_t& from, std::time_t& to);
+    static std::string periodToString(ReportPeriod period);
+    static bool stringToPeriod(const std::string& text, ReportPeriod& period);
+
+    static std::time_t startOfHour(std::time_t when);
+    static std::time_t startOfDay(std::time_t when);
+    static std::time_t addDays(std::time_t day, int days);
+
+    size_t getHourlyBucketCount() const { return hourly.size(); }
+    size_t getDailyBucketCount() const { return daily.size(); }
+    void accountMemory(MemoryReport& report) const;
+};
+
+#endif // SALES_AGGREGATES_H
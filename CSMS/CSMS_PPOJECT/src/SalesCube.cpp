@@ -0,0 +1,672 @@
+// ===== SalesCube.cpp =====
+#include "SalesCube.h"
+#include "Transaction.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <thread>
+
+static const char* CATEGORY_LABELS[CUBE_CATEGORIES] = {
+    "Beverages", "Snacks", "Dairy", "Bakery", "Household", "Electronics", "Health & Beauty", "Other",
+    "No product"
+};
+
+static const char* CUSTOMER_TYPE_LABELS[CUBE_CUSTOMER_TYPES] = {
+    "Regular", "Premium", "VIP", "Employee", "Walk-in"
+};
+
+static const char* PAYMENT_LABELS[CUBE_PAYMENT_METHODS] = {
+    "Cash", "Credit Card", "Debit Card", "Mobile Payment", "Loyalty Points", "Gift Card"
+};
+
+static const char* DIMENSION_NAMES[CUBE_DIMENSION_COUNT] = {
+    "product", "category", "supplier", "hour", "customer", "payment", "store"
+};
+
+// Below this many rows per thread, starting threads costs more than it saves
+static const size_t MIN_ROWS_PER_THREAD = 1 << 16;
+
+// Group counts up to this use a flat array per thread instead of a hash map
+static const uint64_t DENSE_GROUP_LIMIT = 1 << 18;
+
+SalesCube::SalesCube(const std::string& storeCode)
+    : cells(static_cast<size_t>(CUBE_CATEGORIES) * CUBE_HOURS * CUBE_CUSTOMER_TYPES * CUBE_PAYMENT_METHODS),
+      threadCount(std::max(1u, std::thread::hardware_concurrency())) {
+    stores.push_back(storeCode);
+}
+
+uint32_t SalesCube::internProduct(const std::string& productId) {
+    auto it = productIndex.find(productId);
+    if (it != productIndex.end()) {
+        return it->second;
+    }
+    uint32_t index = static_cast<uint32_t>(productIds.size());
+    productIds.push_back(productId);
+    productIndex[productId] = index;
+    return index;
+}
+
+uint16_t SalesCube::internSupplier(const std::string& supplier) {
+    auto it = supplierIndex.find(supplier);
+    if (it != supplierIndex.end()) {
+        return it->second;
+    }
+    if (suppliers.size() > UINT16_MAX) {
+        return UINT16_MAX;  // Dictionary full; the rest share the last code
+    }
+    uint16_t index = static_cast<uint16_t>(suppliers.size());
+    suppliers.push_back(supplier);
+    supplierIndex[supplier] = index;
+    return index;
+}
+
+uint8_t SalesCube::addStore(const std::string& storeCode) {
+    for (size_t i = 0; i < stores.size(); ++i) {
+        if (stores[i] == storeCode) {
+            return static_cast<uint8_t>(i);
+        }
+    }
+    if (stores.size() > UINT8_MAX) {
+        return UINT8_MAX;
+    }
+    stores.push_back(storeCode);
+    return static_cast<uint8_t>(stores.size() - 1);
+}
+
+void SalesCube::reserve(size_t lines) {
+    productColumn.reserve(lines);
+    supplierColumn.reserve(lines);
+    categoryColumn.reserve(lines);
+    hourColumn.reserve(lines);
+    customerTypeColumn.reserve(lines);
+    paymentColumn.reserve(lines);
+    storeColumn.reserve(lines);
+    quantityColumn.reserve(lines);
+    revenueColumn.reserve(lines);
+    refundColumn.reserve(lines);
+}
+
+void SalesCube::appendLine(uint32_t product, uint16_t supplier, uint8_t category, uint8_t hour,
+                           uint8_t customerType, uint8_t payment, uint8_t store, float quantity, int32_t cents,
+                           bool refund) {
+    productColumn.push_back(product);
+    supplierColumn.push_back(supplier);
+    categoryColumn.push_back(category);
+    hourColumn.push_back(hour);
+    customerTypeColumn.push_back(customerType);
+    paymentColumn.push_back(payment);
+    storeColumn.push_back(store);
+    quantityColumn.push_back(quantity);
+    revenueColumn.push_back(cents);
+    refundColumn.push_back(refund ? 1 : 0);
+    cells[cellIndex(category, hour, customerType, payment)].add(refund ? 0 : 1, refund ? 1 : 0, quantity, cents);
+}
+
+void SalesCube::appendItem(const Transaction& transaction, int itemIndex, double quantity, double amount,
+                           uint8_t store, bool refund) {
+    const TransactionItem& item = transaction.getItems()[itemIndex];
+    std::time_t when = transaction.getTimestamp();
+    std::tm local;
+    localtime_r(&when, &local);
+
+    const Customer* customer = transaction.getCustomer();
+    uint8_t customerType = customer ? static_cast<uint8_t>(customer->getType()) : CUBE_CUSTOMER_TYPES - 1;
+
+    appendLine(internProduct(item.product->getId()), internSupplier(item.product->getSupplier()),
+               static_cast<uint8_t>(item.product->getCategory()), static_cast<uint8_t>(local.tm_hour),
+               customerType, static_cast<uint8_t>(transaction.getPaymentMethod()), store,
+               static_cast<float>(quantity), static_cast<int32_t>(std::llround(amount * 100.0)), refund);
+}
+
+void SalesCube::appendMonetaryRefund(const Transaction& transaction, double amount, uint8_t store) {
+    std::time_t when = transaction.getTimestamp();
+    std::tm local;
+    localtime_r(&when, &local);
+
+    const Customer* customer = transaction.getCustomer();
+    uint8_t customerType = customer ? static_cast<uint8_t>(customer->getType()) : CUBE_CUSTOMER_TYPES - 1;
+
+    appendLine(internProduct(""), internSupplier(""), static_cast<uint8_t>(CUBE_CATEGORIES - 1),
+               static_cast<uint8_t>(local.tm_hour), customerType, static_cast<uint8_t>(transaction.getPaymentMethod()),
+               store, 0.0f, static_cast<int32_t>(std::llround(-amount * 100.0)), true);
+}
+
+void SalesCube::addTransaction(const Transaction& transaction, uint8_t store) {
+    const auto& items = transaction.getItems();
+    for (size_t i = 0; i < items.size(); ++i) {
+        appendItem(transaction, static_cast<int>(i), items[i].quantity, items[i].getPaidAmount(), store, false);
+    }
+}
+
+void SalesCube::addRefund(const Transaction& transaction, const RefundRecord& refund, uint8_t store) {
+    if (refund.lines.empty()) {
+        appendMonetaryRefund(transaction, refund.amount, store);
+        return;
+    }
+    for (const RefundLine& line : refund.lines) {
+        appendItem(transaction, line.itemIndex, -line.quantity, -line.amount, store, true);
+    }
+}
+
+bool SalesCube::isCellDimension(CubeDimension dimension) {
+    return dimension == CubeDimension::CATEGORY || dimension == CubeDimension::HOUR ||
+           dimension == CubeDimension::CUSTOMER_TYPE || dimension == CubeDimension::PAYMENT_METHOD;
+}
+
+uint32_t SalesCube::getCardinality(CubeDimension dimension) const {
+    switch (dimension) {
+        case CubeDimension::PRODUCT: return static_cast<uint32_t>(productIds.size());
+        case CubeDimension::CATEGORY: return CUBE_CATEGORIES;
+        case CubeDimension::SUPPLIER: return static_cast<uint32_t>(suppliers.size());
+        case CubeDimension::HOUR: return CUBE_HOURS;
+        case CubeDimension::CUSTOMER_TYPE: return CUBE_CUSTOMER_TYPES;
+        case CubeDimension::PAYMENT_METHOD: return CUBE_PAYMENT_METHODS;
+        case CubeDimension::STORE: return static_cast<uint32_t>(stores.size());
+        default: return 0;
+    }
+}
+
+namespace {
+
+/**
+ * @brief A dimension taking part in a query, with its place in the group key
+ */
+struct PlannedDimension {
+    CubeDimension dimension;
+    uint64_t stride;                 // Mixed-radix weight in the group key
+    uint32_t cardinality;
+    std::vector<uint8_t> allowed;    // Filters only: allowed[value] != 0
+};
+
+struct QueryPlan {
+    std::vector<PlannedDimension> groups;
+    std::vector<PlannedDimension> filters;
+    uint64_t groupCount;
+};
+
+/**
+ * @brief Per-thread partial aggregates, flat when the key space is small
+ */
+struct GroupTable {
+    bool dense;
+    std::vector<CubeCell> flat;
+    std::unordered_map<uint64_t, CubeCell> sparse;
+
+    GroupTable(const QueryPlan& plan) : dense(plan.groupCount <= DENSE_GROUP_LIMIT) {
+        if (dense) {
+            flat.resize(static_cast<size_t>(plan.groupCount));
+        }
+    }
+
+    CubeCell& at(uint64_t key) { return dense ? flat[static_cast<size_t>(key)] : sparse[key]; }
+
+    void merge(const GroupTable& other) {
+        if (dense) {
+            for (size_t i = 0; i < flat.size(); ++i) {
+                flat[i].merge(other.flat[i]);
+            }
+        } else {
+            for (const auto& entry : other.sparse) {
+                sparse[entry.first].merge(entry.second);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Rows of the fact table
+ */
+struct FactSource {
+    const uint32_t* product;
+    const uint16_t* supplier;
+    const uint8_t* category;
+    const uint8_t* hour;
+    const uint8_t* customerType;
+    const uint8_t* payment;
+    const uint8_t* store;
+    const float* quantity;
+    const int32_t* revenue;
+    const uint8_t* refund;
+
+    // Calls visitor with the dimension's column, whatever its element type
+    template <typename Visitor>
+    void visit(CubeDimension dimension, Visitor&& visitor) const {
+        switch (dimension) {
+            case CubeDimension::PRODUCT: visitor(product); break;
+            case CubeDimension::CATEGORY: visitor(category); break;
+            case CubeDimension::SUPPLIER: visitor(supplier); break;
+            case CubeDimension::HOUR: visitor(hour); break;
+            case CubeDimension::CUSTOMER_TYPE: visitor(customerType); break;
+            case CubeDimension::PAYMENT_METHOD: visitor(payment); break;
+            default: visitor(store); break;
+        }
+    }
+};
+
+/**
+ * @brief Cells of the pre-aggregated cube, decoded from their position
+ */
+struct CellSource {
+    const CubeCell* cells;
+
+    uint32_t value(CubeDimension dimension, size_t index) const {
+        switch (dimension) {
+            case CubeDimension::PAYMENT_METHOD: return index % CUBE_PAYMENT_METHODS;
+            case CubeDimension::CUSTOMER_TYPE: return index / CUBE_PAYMENT_METHODS % CUBE_CUSTOMER_TYPES;
+            case CubeDimension::HOUR: return index / (CUBE_PAYMENT_METHODS * CUBE_CUSTOMER_TYPES) % CUBE_HOURS;
+            default: return index / (CUBE_PAYMENT_METHODS * CUBE_CUSTOMER_TYPES * CUBE_HOURS);
+        }
+    }
+
+    void addTo(CubeCell& cell, size_t index) const { cell.merge(cells[index]); }
+};
+
+// Rows per pass; each column is swept across a block before the next is read
+const size_t SCAN_BLOCK = 1024;
+
+void accumulate(const FactSource& source, const QueryPlan& plan, size_t begin, size_t end, GroupTable& table) {
+    uint64_t keys[SCAN_BLOCK];
+    uint8_t keep[SCAN_BLOCK];
+
+    for (size_t base = begin; base < end; base += SCAN_BLOCK) {
+        size_t count = std::min(SCAN_BLOCK, end - base);
+
+        std::fill(keep, keep + count, 1);
+        for (const PlannedDimension& filter : plan.filters) {
+            const uint8_t* allowed = filter.allowed.data();
+            source.visit(filter.dimension, [&](const auto* column) {
+                for (size_t j = 0; j < count; ++j) {
+                    keep[j] &= allowed[column[base + j]];
+                }
+            });
+        }
+
+        std::fill(keys, keys + count, 0);
+        for (const PlannedDimension& group : plan.groups) {
+            uint64_t stride = group.stride;
+            source.visit(group.dimension, [&](const auto* column) {
+                for (size_t j = 0; j < count; ++j) {
+                    keys[j] += column[base + j] * stride;
+                }
+            });
+        }
+
+        for (size_t j = 0; j < count; ++j) {
+            if (keep[j]) {
+                uint8_t refund = source.refund[base + j];
+                table.at(keys[j]).add(1 - refund, refund, source.quantity[base + j], source.revenue[base + j]);
+            }
+        }
+    }
+}
+
+template <typename Source>
+void accumulate(const Source& source, const QueryPlan& plan, size_t begin, size_t end, GroupTable& table) {
+    for (size_t i = begin; i < end; ++i) {
+        bool matches = true;
+        for (const PlannedDimension& filter : plan.filters) {
+            if (!filter.allowed[source.value(filter.dimension, i)]) {
+                matches = false;
+                break;
+            }
+        }
+        if (!matches) {
+            continue;
+        }
+
+        uint64_t key = 0;
+        for (const PlannedDimension& group : plan.groups) {
+            key += source.value(group.dimension, i) * group.stride;
+        }
+        source.addTo(table.at(key), i);
+    }
+}
+
+template <typename Source>
+GroupTable aggregate(const Source& source, const QueryPlan& plan, size_t count, int threads) {
+    if (threads <= 1) {
+        GroupTable table(plan);
+        accumulate(source, plan, 0, count, table);
+        return table;
+    }
+
+    std::vector<GroupTable> partials(threads, GroupTable(plan));
+    std::vector<std::thread> workers;
+    size_t chunk = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        size_t begin = std::min(count, t * chunk);
+        size_t end = std::min(count, begin + chunk);
+        workers.emplace_back([&source, &plan, &partials, t, begin, end]() {
+            accumulate(source, plan, begin, end, partials[t]);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (int t = 1; t < threads; ++t) {
+        partials[0].merge(partials[t]);
+    }
+    return std::move(partials[0]);
+}
+
+} // namespace
+
+CubeResult SalesCube::query(const CubeQuery& query) const {
+    auto start = std::chrono::steady_clock::now();
+    CubeResult result;
+
+    QueryPlan plan;
+    plan.groupCount = 1;
+    for (size_t g = query.groupBy.size(); g-- > 0;) {
+        PlannedDimension group;
+        group.dimension = query.groupBy[g];
+        group.cardinality = std::max(1u, getCardinality(group.dimension));
+        group.stride = plan.groupCount;
+        plan.groupCount *= group.cardinality;
+        plan.groups.insert(plan.groups.begin(), group);
+    }
+    for (const CubeFilter& cubeFilter : query.filters) {
+        PlannedDimension filter;
+        filter.dimension = cubeFilter.dimension;
+        filter.cardinality = getCardinality(filter.dimension);
+        filter.stride = 0;
+        filter.allowed.assign(filter.cardinality, 0);
+        for (uint32_t value : cubeFilter.values) {
+            if (value < filter.cardinality) {
+                filter.allowed[value] = 1;
+            }
+        }
+        plan.filters.push_back(filter);
+    }
+
+    bool cellsSuffice = true;
+    for (const PlannedDimension& group : plan.groups) {
+        cellsSuffice = cellsSuffice && isCellDimension(group.dimension);
+    }
+    for (const PlannedDimension& filter : plan.filters) {
+        cellsSuffice = cellsSuffice && isCellDimension(filter.dimension);
+    }
+
+    CellSource cellSource = { cells.data() };
+    FactSource factSource = { productColumn.data(), supplierColumn.data(), categoryColumn.data(),
+                              hourColumn.data(), customerTypeColumn.data(), paymentColumn.data(),
+                              storeColumn.data(), quantityColumn.data(), revenueColumn.data(),
+                              refundColumn.data() };
+    size_t rows = getLineCount();
+    int threads = cellsSuffice ? 1 : static_cast<int>(
+        std::min<size_t>(threadCount, std::max<size_t>(1, rows / MIN_ROWS_PER_THREAD)));
+
+    GroupTable table = cellsSuffice ? aggregate(cellSource, plan, cells.size(), 1)
+                                    : aggregate(factSource, plan, rows, threads);
+    result.scanned = static_cast<long>(cellsSuffice ? cells.size() : rows);
+    result.threads = threads;
+    result.fromCells = cellsSuffice;
+
+    // Decode the mixed-radix keys back into one value per dimension
+    auto emit = [&](uint64_t key, const CubeCell& cell) {
+        if (cell.lines == 0 && cell.refunds == 0) {
+            return;
+        }
+        CubeRow row;
+        for (const PlannedDimension& group : plan.groups) {
+            row.key.push_back(static_cast<uint32_t>(key / group.stride % group.cardinality));
+        }
+        row.cell = cell;
+        result.total.merge(cell);
+        result.rows.push_back(row);
+    };
+    if (table.dense) {
+        for (size_t key = 0; key < table.flat.size(); ++key) {
+            emit(key, table.flat[key]);
+        }
+    } else {
+        for (const auto& entry : table.sparse) {
+            emit(entry.first, entry.second);
+        }
+    }
+
+    auto byRevenue = [](const CubeRow& a, const CubeRow& b) {
+        return a.cell.revenueCents != b.cell.revenueCents ? a.cell.revenueCents > b.cell.revenueCents : a.key < b.key;
+    };
+    if (query.limit > 0 && query.limit < result.rows.size()) {
+        std::partial_sort(result.rows.begin(), result.rows.begin() + query.limit, result.rows.end(), byRevenue);
+        result.rows.resize(query.limit);
+    } else {
+        std::sort(result.rows.begin(), result.rows.end(), byRevenue);
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::string SalesCube::dimensionName(CubeDimension dimension) {
+    return DIMENSION_NAMES[static_cast<int>(dimension)];
+}
+
+bool SalesCube::stringToDimension(const std::string& name, CubeDimension& dimension) {
+    for (int d = 0; d < CUBE_DIMENSION_COUNT; ++d) {
+        if (name == DIMENSION_NAMES[d]) {
+            dimension = static_cast<CubeDimension>(d);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string SalesCube::getLabel(CubeDimension dimension, uint32_t value) const {
+    switch (dimension) {
+        case CubeDimension::PRODUCT:
+            if (value >= productIds.size()) {
+                return "?";
+            }
+            return productIds[value].empty() ? "(none)" : productIds[value];
+        case CubeDimension::CATEGORY: return value < CUBE_CATEGORIES ? CATEGORY_LABELS[value] : "?";
+        case CubeDimension::SUPPLIER:
+            if (value >= suppliers.size()) {
+                return "?";
+            }
+            return suppliers[value].empty() ? "(none)" : suppliers[value];
+        case CubeDimension::HOUR: {
+            char text[8];
+            std::snprintf(text, sizeof(text), "%02u:00", value);
+            return text;
+        }
+        case CubeDimension::CUSTOMER_TYPE: return value < CUBE_CUSTOMER_TYPES ? CUSTOMER_TYPE_LABELS[value] : "?";
+        case CubeDimension::PAYMENT_METHOD: return value < CUBE_PAYMENT_METHODS ? PAYMENT_LABELS[value] : "?";
+        case CubeDimension::STORE: return value < stores.size() ? stores[value] : "?";
+        default: return "?";
+    }
+}
+
+// Lowercase letters and digits only, so "walk-in" matches "Walk-in" and "walkin"
+static std::string normalizeLabel(const std::string& text) {
+    std::string result;
+    for (char c : text) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            result += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    return result;
+}
+
+bool SalesCube::findValue(CubeDimension dimension, const std::string& label, uint32_t& value) const {
+    if (dimension == CubeDimension::PRODUCT) {
+        auto it = productIndex.find(label);
+        if (it == productIndex.end()) {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+    if (dimension == CubeDimension::SUPPLIER) {
+        auto it = supplierIndex.find(label);
+        if (it == supplierIndex.end()) {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+    if (dimension == CubeDimension::HOUR) {
+        char* end = nullptr;
+        long hour = std::strtol(label.c_str(), &end, 10);
+        if (end == label.c_str() || hour < 0 || hour >= CUBE_HOURS) {
+            return false;
+        }
+        value = static_cast<uint32_t>(hour);
+        return true;
+    }
+
+    // Fixed dimensions also accept the first word of a label ("credit", "health")
+    std::string wanted = normalizeLabel(label);
+    for (uint32_t v = 0; v < getCardinality(dimension); ++v) {
+        std::string candidate = getLabel(dimension, v);
+        if (normalizeLabel(candidate) == wanted ||
+            normalizeLabel(candidate.substr(0, candidate.find(' '))) == wanted) {
+            value = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SalesCube::parseQuery(const std::vector<std::string>& args, CubeQuery& query, std::string& error) const {
+    query = CubeQuery();
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        size_t equals = arg.find('=');
+
+        if (equals == std::string::npos) {
+            // Comma-separated group-by list; "-" for the grand total only
+            if (i != 0) {
+                error = "group-by list must come first: '" + arg + "'";
+                return false;
+            }
+            if (arg == "-") {
+                continue;
+            }
+            size_t begin = 0;
+            while (begin <= arg.size()) {
+                size_t comma = arg.find(',', begin);
+                std::string name = arg.substr(begin, comma == std::string::npos ? std::string::npos : comma - begin);
+                CubeDimension dimension;
+                if (!stringToDimension(name, dimension)) {
+                    error = "unknown dimension '" + name + "'";
+                    return false;
+                }
+                if (std::find(query.groupBy.begin(), query.groupBy.end(), dimension) != query.groupBy.end()) {
+                    error = "dimension '" + name + "' listed twice";
+                    return false;
+                }
+                query.groupBy.push_back(dimension);
+                if (comma == std::string::npos) {
+                    break;
+                }
+                begin = comma + 1;
+            }
+            continue;
+        }
+
+        std::string key = arg.substr(0, equals);
+        std::string values = arg.substr(equals + 1);
+        if (key == "limit") {
+            query.limit = static_cast<size_t>(std::max(0L, std::atol(values.c_str())));
+            continue;
+        }
+
+        CubeFilter filter;
+        if (!stringToDimension(key, filter.dimension)) {
+            error = "unknown dimension '" + key + "'";
+            return false;
+        }
+        size_t begin = 0;
+        while (begin <= values.size()) {
+            size_t comma = values.find(',', begin);
+            std::string label = values.substr(begin, comma == std::string::npos ? std::string::npos : comma - begin);
+            uint32_t value;
+            if (!findValue(filter.dimension, label, value)) {
+                error = "no " + key + " '" + label + "'";
+                return false;
+            }
+            filter.values.push_back(value);
+            if (comma == std::string::npos) {
+                break;
+            }
+            begin = comma + 1;
+        }
+        query.filters.push_back(filter);
+    }
+    return true;
+}
+
+void SalesCube::display(const CubeQuery& query, const CubeResult& result, std::ostream& out) const {
+    int labelWidth = query.groupBy.empty() ? 18 : static_cast<int>(query.groupBy.size()) * 18;
+    int width = labelWidth + 46;
+
+    out << "\n" << std::string(width, '=') << std::endl;
+    out << "SALES CUBE";
+    for (size_t g = 0; g < query.groupBy.size(); ++g) {
+        out << (g ? " x " : " by ") << dimensionName(query.groupBy[g]);
+    }
+    out << std::endl << std::string(width, '=') << std::endl;
+
+    if (query.groupBy.empty()) {
+        out << std::setw(labelWidth) << "";
+    }
+    for (CubeDimension dimension : query.groupBy) {
+        std::string name = dimensionName(dimension);
+        name[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[0])));
+        out << std::left << std::setw(18) << name;
+    }
+    out << std::right << std::setw(10) << "Lines" << std::setw(10) << "Refunds" << std::setw(12) << "Units"
+        << std::setw(14) << "Revenue"
+        << std::endl << std::string(width, '-') << std::endl;
+
+    for (size_t r = 0; r < result.rows.size() && !query.groupBy.empty(); ++r) {
+        const CubeRow& row = result.rows[r];
+        for (size_t g = 0; g < row.key.size(); ++g) {
+            out << std::left << std::setw(18) << getLabel(query.groupBy[g], row.key[g]).substr(0, 17);
+        }
+        out << std::right << std::setw(10) << row.cell.lines << std::setw(10) << row.cell.refunds
+            << std::fixed << std::setprecision(2)
+            << std::setw(12) << row.cell.units << std::setw(14) << row.cell.getRevenue() << std::endl;
+    }
+
+    out << std::string(width, '-') << std::endl;
+    out << std::left << std::setw(labelWidth) << "Total" << std::right
+        << std::setw(10) << result.total.lines << std::setw(10) << result.total.refunds << std::fixed << std::setprecision(2) << std::setw(12)
+        << result.total.units << std::setw(14) << result.total.getRevenue() << std::endl;
+    out << result.scanned << (result.fromCells ? " cube cells" : " lines") << " scanned on " << result.threads
+        << " thread(s) in " << std::setprecision(3) << result.seconds * 1000.0 << " ms" << std::endl;
+    out << std::string(width, '=') << std::endl << std::endl;
+}
+
+void SalesCube::accountMemory(MemoryReport& report) const {
+    size_t columnBytes = MemorySizing::vectorBytes(productColumn) + MemorySizing::vectorBytes(supplierColumn) +
+                         MemorySizing::vectorBytes(categoryColumn) + MemorySizing::vectorBytes(hourColumn) +
+                         MemorySizing::vectorBytes(customerTypeColumn) + MemorySizing::vectorBytes(paymentColumn) +
+                         MemorySizing::vectorBytes(storeColumn) + MemorySizing::vectorBytes(quantityColumn) +
+                         MemorySizing::vectorBytes(revenueColumn) + MemorySizing::vectorBytes(refundColumn);
+
+    size_t dictionaryBytes = MemorySizing::vectorBytes(productIds) + MemorySizing::vectorBytes(suppliers) +
+                             productIndex.size() * MemorySizing::hashNodeBytes<std::string, uint32_t>() +
+                             MemorySizing::hashBucketBytes(productIndex.bucket_count()) +
+                             supplierIndex.size() * MemorySizing::hashNodeBytes<std::string, uint16_t>() +
+                             MemorySizing::hashBucketBytes(supplierIndex.bucket_count());
+    for (const std::string& id : productIds) {
+        dictionaryBytes += 2 * MemorySizing::stringBytes(id);  // Vector entry and map key
+    }
+    for (const std::string& supplier : suppliers) {
+        dictionaryBytes += 2 * MemorySizing::stringBytes(supplier);
+    }
+
+    report.add("Sales cube", "Fact columns", static_cast<long>(getLineCount()), columnBytes);
+    report.add("Sales cube", "Dictionaries", static_cast<long>(productIds.size() + suppliers.size()), dictionaryBytes);
+    report.add("Sales cube", "Pre-aggregated cells", static_cast<long>(cells.size()), MemorySizing::vectorBytes(cells));
+}
@@ -0,0 +1,161 @@
+// ===== SalesCube.h =====
+#ifndef SALES_CUBE_H
+#define SALES_CUBE_H
+
+#include "TaxEngine.h"
+#include "Refund.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Transaction;
+class MemoryReport;
+
+/**
+ * @brief Attributes a sold line can be grouped or filtered by
+ */
+enum class CubeDimension {
+    PRODUCT,
+    CATEGORY,
+    SUPPLIER,
+    HOUR,            // Local hour of day the sale completed
+    CUSTOMER_TYPE,   // Walk-in sales form their own type
+    PAYMENT_METHOD,
+    STORE
+};
+
+constexpr int CUBE_DIMENSION_COUNT = 7;
+constexpr int CUBE_CATEGORIES = PRODUCT_CATEGORY_COUNT + 1;  // Product categories plus refunds of no line
+constexpr int CUBE_HOURS = 24;
+constexpr int CUBE_CUSTOMER_TYPES = 5;     // CustomerType values plus walk-in
+constexpr int CUBE_PAYMENT_METHODS = 6;
+
+/**
+ * @brief Measures of one group: sold lines, refund rows, units and revenue
+ */
+struct CubeCell {
+    long lines;              // Lines sold; refunds do not count here
+    long refunds;            // Refunded lines plus one per monetary refund
+    double units;
+    int64_t revenueCents;    // Including tax; returns are negative
+
+    CubeCell() : lines(0), refunds(0), units(0.0), revenueCents(0) {}
+
+    void add(long lineCount, long refundCount, double quantity, int64_t cents) {
+        lines += lineCount;
+        refunds += refundCount;
+        units += quantity;
+        revenueCents += cents;
+    }
+    void merge(const CubeCell& other) { add(other.lines, other.refunds, other.units, other.revenueCents); }
+    double getRevenue() const { return revenueCents / 100.0; }
+};
+
+/**
+ * @brief Keeps only lines whose dimension takes one of the given values
+ */
+struct CubeFilter {
+    CubeDimension dimension;
+    std::vector<uint32_t> values;
+};
+
+struct CubeQuery {
+    std::vector<CubeDimension> groupBy;   // Empty for a single grand total
+    std::vector<CubeFilter> filters;      // All must match
+    size_t limit;                         // Top rows by revenue, 0 for all
+
+    CubeQuery() : limit(0) {}
+};
+
+struct CubeRow {
+    std::vector<uint32_t> key;            // One value per group-by dimension
+    CubeCell cell;
+};
+
+struct CubeResult {
+    std::vector<CubeRow> rows;            // Highest revenue first
+    CubeCell total;                       // Over every matching line, before the limit
+    long scanned;                         // Fact rows or cube cells visited
+    bool fromCells;                       // Answered from the pre-aggregated cells
+    int threads;
+    double seconds;
+};
+
+/**
+ * @brief Columnar fact table of sold lines with a pre-aggregated cube
+ *
+ * Every finalized line is appended as one row of narrow, dictionary-encoded
+ * columns (about 20 bytes per line), and returned lines as negative refund
+ * rows. Monetary refunds name no line, so they go in as a refund row with no
+ * product, supplier or category, which keeps cube revenue equal to the ledger.
+ * Alongside, a dense category x hour x customer type x payment method cube
+ * is kept up to date, so queries over only those dimensions read a few
+ * thousand cells; anything touching product, supplier or store scans the
+ * fact table split across all cores.
+ */
+class SalesCube {
+private:
+    // Fact table, one entry per line
+    std::vector<uint32_t> productColumn;
+    std::vector<uint16_t> supplierColumn;
+    std::vector<uint8_t> categoryColumn;
+    std::vector<uint8_t> hourColumn;
+    std::vector<uint8_t> customerTypeColumn;
+    std::vector<uint8_t> paymentColumn;
+    std::vector<uint8_t> storeColumn;
+    std::vector<float> quantityColumn;
+    std::vector<int32_t> revenueColumn;     // Cents
+    std::vector<uint8_t> refundColumn;      // 1 for refund rows, 0 for sold lines
+
+    // Dictionaries for the open-ended dimensions
+    std::vector<std::string> productIds;
+    std::unordered_map<std::string, uint32_t> productIndex;
+    std::vector<std::string> suppliers;
+    std::unordered_map<std::string, uint16_t> supplierIndex;
+    std::vector<std::string> stores;
+
+    std::vector<CubeCell> cells;            // Category (or none) x hour x customer type x payment method
+    unsigned threadCount;
+
+    static size_t cellIndex(int category, int hour, int customerType, int payment) {
+        return ((static_cast<size_t>(category) * CUBE_HOURS + hour) * CUBE_CUSTOMER_TYPES + customerType) *
+               CUBE_PAYMENT_METHODS + payment;
+    }
+    void appendItem(const Transaction& transaction, int itemIndex, double quantity, double amount, uint8_t store,
+                    bool refund);
+    void appendMonetaryRefund(const Transaction& transaction, double amount, uint8_t store);
+
+public:
+    explicit SalesCube(const std::string& storeCode = "LOCAL");
+
+    // Loading
+    void addTransaction(const Transaction& transaction, uint8_t store = 0);
+    void addRefund(const Transaction& transaction, const RefundRecord& refund, uint8_t store = 0);
+    void appendLine(uint32_t product, uint16_t supplier, uint8_t category, uint8_t hour, uint8_t customerType,
+                    uint8_t payment, uint8_t store, float quantity, int32_t cents, bool refund = false);
+    void reserve(size_t lines);
+    uint32_t internProduct(const std::string& productId);
+    uint16_t internSupplier(const std::string& supplier);
+    uint8_t addStore(const std::string& storeCode);
+
+    // Querying
+    CubeResult query(const CubeQuery& query) const;
+    bool parseQuery(const std::vector<std::string>& args, CubeQuery& query, std::string& error) const;
+    void display(const CubeQuery& query, const CubeResult& result, std::ostream& out) const;
+
+    uint32_t getCardinality(CubeDimension dimension) const;
+    std::string getLabel(CubeDimension dimension, uint32_t value) const;
+    bool findValue(CubeDimension dimension, const std::string& label, uint32_t& value) const;
+    static std::string dimensionName(CubeDimension dimension);
+    static bool stringToDimension(const std::string& name, CubeDimension& dimension);
+    static bool isCellDimension(CubeDimension dimension);
+
+    size_t getLineCount() const { return revenueColumn.size(); }
+    void setThreadCount(unsigned threads) { threadCount = threads ? threads : 1; }
+    unsigned getThreadCount() const { return threadCount; }
+    void accountMemory(MemoryReport& report) const;
+};
+
+#endif // SALES_CUBE_H
@@ -0,0 +1,249 @@
+// ===== SalesWindow.cpp =====
+#include "SalesWindow.h"
+#include "Transaction.h"
+#include "Refund.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+const int SalesWindowEngine::MAX_WINDOW_SECONDS;   // std::min/max bind it by reference
+
+static const int HISTORY_SECONDS = 2 * SalesWindowEngine::MAX_WINDOW_SECONDS;
+static const int HISTORY_MINUTES = HISTORY_SECONDS / 60;
+
+static int64_t toHundredths(double value) {
+    return static_cast<int64_t>(std::llround(value * 100.0));
+}
+
+SalesWindowEngine::SalesWindowEngine() {
+}
+
+void SalesWindowEngine::ensureAllocated() {
+    if (seconds.empty()) {
+        seconds.assign(HISTORY_SECONDS, SecondSlot{ -1, SlotTotals() });
+        minutes.assign(HISTORY_MINUTES, MinuteSlot{ -1, SlotTotals(), {} });
+    }
+}
+
+SalesWindowEngine::SecondSlot* SalesWindowEngine::secondSlot(std::time_t when) {
+    if (when < 0) {
+        return nullptr;
+    }
+    ensureAllocated();
+    SecondSlot& slot = seconds[static_cast<size_t>(when % HISTORY_SECONDS)];
+    if (slot.second > when) {
+        return nullptr;  // Older than anything the ring still holds
+    }
+    if (slot.second < when) {
+        slot = SecondSlot{ static_cast<int64_t>(when), SlotTotals() };
+    }
+    return &slot;
+}
+
+SalesWindowEngine::MinuteSlot* SalesWindowEngine::minuteSlot(std::time_t when) {
+    if (when < 0) {
+        return nullptr;
+    }
+    ensureAllocated();
+    int64_t minute = when / 60;
+    MinuteSlot& slot = minutes[static_cast<size_t>(minute % HISTORY_MINUTES)];
+    if (slot.minute > minute) {
+        return nullptr;
+    }
+    if (slot.minute < minute) {
+        slot.minute = minute;
+        slot.totals = SlotTotals();
+        slot.productUnits.clear();
+    }
+    return &slot;
+}
+
+uint32_t SalesWindowEngine::productCode(const std::string& productId) {
+    auto it = productCodes.find(productId);
+    if (it != productCodes.end()) {
+        return it->second;
+    }
+    uint32_t code = static_cast<uint32_t>(productIds.size());
+    productCodes.emplace(productId, code);
+    productIds.push_back(productId);
+    return code;
+}
+
+void SalesWindowEngine::addTotals(SlotTotals& into, const SlotTotals& from) {
+    into.transactions += from.transactions;
+    into.refunds += from.refunds;
+    into.salesCents += from.salesCents;
+    into.refundCents += from.refundCents;
+    into.unitCentis += from.unitCentis;
+}
+
+void SalesWindowEngine::recordSale(const Transaction& transaction) {
+    SecondSlot* slot = secondSlot(transaction.getTimestamp());
+    MinuteSlot* minute = slot ? minuteSlot(transaction.getTimestamp()) : nullptr;
+    if (!minute) {
+        return;
+    }
+
+    SlotTotals sale = SlotTotals();
+    sale.transactions = 1;
+    sale.salesCents = toHundredths(transaction.getFinalTotal());
+    for (const TransactionItem& item : transaction.getItems()) {
+        sale.unitCentis += toHundredths(item.quantity);
+
+        minute->productUnits[productCode(item.product->getId())] += item.quantity;
+    }
+    addTotals(slot->totals, sale);
+    addTotals(minute->totals, sale);
+}
+
+void SalesWindowEngine::recordRefund(const Transaction& transaction, const RefundRecord& refund) {
+    (void)transaction;
+    SecondSlot* slot = secondSlot(refund.timestamp);
+    MinuteSlot* minute = slot ? minuteSlot(refund.timestamp) : nullptr;
+    if (!minute) {
+        return;
+    }
+
+    SlotTotals returned = SlotTotals();
+    returned.refunds = 1;
+    returned.refundCents = toHundredths(refund.amount);
+    addTotals(slot->totals, returned);
+    addTotals(minute->totals, returned);
+}
+
+WindowSummary SalesWindowEngine::summarize(std::time_t from, std::time_t to, size_t topCount) const {
+    WindowSummary summary;
+    from = std::max(from, to - MAX_WINDOW_SECONDS);
+    summary.from = from;
+    summary.to = to;
+    if (seconds.empty() || from >= to || from < 0) {
+        return summary;
+    }
+
+    // Whole minutes come from the minute ring, the ragged edges from the second ring
+    int64_t firstMinute = (from + 59) / 60;
+    int64_t endMinute = to / 60;
+    SlotTotals totals = SlotTotals();
+    auto addSeconds = [this, &totals](std::time_t begin, std::time_t end) {
+        for (std::time_t when = begin; when < end; ++when) {
+            const SecondSlot& slot = seconds[static_cast<size_t>(when % HISTORY_SECONDS)];
+            if (slot.second == when) {
+                addTotals(totals, slot.totals);
+            }
+        }
+    };
+    if (firstMinute >= endMinute) {
+        addSeconds(from, to);
+    } else {
+        addSeconds(from, firstMinute * 60);
+        for (int64_t minute = firstMinute; minute < endMinute; ++minute) {
+            const MinuteSlot& slot = minutes[static_cast<size_t>(minute % HISTORY_MINUTES)];
+            if (slot.minute == minute) {
+                addTotals(totals, slot.totals);
+            }
+        }
+        addSeconds(endMinute * 60, to);
+    }
+    summary.transactions = totals.transactions;
+    summary.refunds = totals.refunds;
+    summary.sales = totals.salesCents / 100.0;
+    summary.refundAmount = totals.refundCents / 100.0;
+    summary.units = totals.unitCentis / 100.0;
+
+    // Product units by minute; a minute counts if it starts inside the window
+    std::unordered_map<uint32_t, double> units;
+    for (int64_t minute = firstMinute; minute * 60 < to; ++minute) {
+        const MinuteSlot& slot = minutes[static_cast<size_t>(minute % HISTORY_MINUTES)];
+        if (slot.minute != minute) {
+            continue;
+        }
+        for (const auto& entry : slot.productUnits) {
+            units[entry.first] += entry.second;
+        }
+    }
+    std::vector<std::pair<uint32_t, double>> ranked(units.begin(), units.end());
+    size_t count = std::min(topCount, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                      [](const std::pair<uint32_t, double>& a, const std::pair<uint32_t, double>& b) {
+                          return a.second != b.second ? a.second > b.second : a.first < b.first;
+                      });
+    for (size_t i = 0; i < count; ++i) {
+        summary.topProducts.emplace_back(productIds[ranked[i].first], ranked[i].second);
+    }
+    return summary;
+}
+
+void SalesWindowEngine::displayComparison(std::ostream& out, int windowSeconds, std::time_t now) const {
+    // Windows end after the current second so that sales made just now count
+    windowSeconds = std::max(1, std::min(windowSeconds, MAX_WINDOW_SECONDS));
+    std::time_t end = now + 1;
+    WindowSummary current = summarize(end - windowSeconds, end);
+    WindowSummary yesterday = summarize(end - windowSeconds - 86400, end - 86400);
+
+    auto printRow = [&out](const std::string& label, double value, double before, int precision) {
+        out << std::left << std::setw(20) << label << std::right << std::fixed << std::setprecision(precision)
+            << std::setw(14) << value << std::setw(14) << before;
+        if (before != 0.0) {
+            out << std::setw(11) << std::setprecision(1) << (value - before) / before * 100.0 << "%";
+        } else {
+            out << std::setw(12) << "-";
+        }
+        out << std::endl;
+    };
+
+    out << "\n" << std::string(60, '=') << std::endl;
+    out << "        LAST " << windowSeconds / 60 << " MINUTES VS SAME WINDOW YESTERDAY" << std::endl;
+    out << std::string(60, '=') << std::endl;
+    out << std::left << std::setw(20) << "Metric" << std::right << std::setw(14) << "Now"
+        << std::setw(14) << "Yesterday" << std::setw(12) << "Change" << std::endl;
+    out << std::string(60, '-') << std::endl;
+    printRow("Transactions", current.transactions, yesterday.transactions, 0);
+    printRow("Sales ($)", current.sales, yesterday.sales, 2);
+    printRow("Average Basket ($)", current.getAverageBasket(), yesterday.getAverageBasket(), 2);
+    printRow("Units per Basket", current.getUnitsPerBasket(), yesterday.getUnitsPerBasket(), 2);
+    printRow("Refunds", current.refunds, yesterday.refunds, 0);
+    printRow("Refunded ($)", current.refundAmount, yesterday.refundAmount, 2);
+
+    out << "\nTop Products (units):" << std::endl;
+    for (size_t i = 0; i < std::max(current.topProducts.size(), yesterday.topProducts.size()); ++i) {
+        std::ostringstream left;
+        std::ostringstream right;
+        if (i < current.topProducts.size()) {
+            left << current.topProducts[i].first << " " << std::fixed << std::setprecision(1)
+                 << current.topProducts[i].second;
+        }
+        if (i < yesterday.topProducts.size()) {
+            right << yesterday.topProducts[i].first << " " << std::fixed << std::setprecision(1)
+                  << yesterday.topProducts[i].second;
+        }
+        out << "  " << std::left << std::setw(28) << left.str() << right.str() << std::right << std::endl;
+    }
+    if (current.topProducts.empty() && yesterday.topProducts.empty()) {
+        out << "  none" << std::endl;
+    }
+    out << std::string(60, '=') << std::endl << std::endl;
+}
+
+void SalesWindowEngine::accountMemory(MemoryReport& report) const {
+    long usedMinutes = 0;
+    size_t productBytes = 0;
+    for (const MinuteSlot& slot : minutes) {
+        usedMinutes += (slot.minute >= 0);
+        productBytes += MemorySizing::hashBucketBytes(slot.productUnits.bucket_count()) +
+                        slot.productUnits.size() * MemorySizing::hashNodeBytes<uint32_t, double>();
+    }
+    size_t dictionaryBytes = MemorySizing::vectorBytes(productIds) +
+                             MemorySizing::hashBucketBytes(productCodes.bucket_count()) +
+                             productCodes.size() * MemorySizing::hashNodeBytes<std::string, uint32_t>();
+    for (const std::string& id : productIds) {
+        dictionaryBytes += 2 * MemorySizing::stringBytes(id);
+    }
+
+    report.add("Sales windows", "Per-second slots", static_cast<long>(seconds.size()),
+               MemorySizing::vectorBytes(seconds));
+    report.add("Sales windows", "Per-minute product slots", usedMinutes,
+               MemorySizing::vectorBytes(minutes) + productBytes);
+    report.add("Sales windows", "Product dictionary", static_cast<long>(productIds.size()), dictionaryBytes);
+}
@@ -0,0 +1,95 @@
+// ===== SalesWindow.h =====
+#ifndef SALES_WINDOW_H
+#define SALES_WINDOW_H
+
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Transaction;
+struct RefundRecord;
+class MemoryReport;
+
+/**
+ * @brief Totals for one time window
+ */
+struct WindowSummary {
+    std::time_t from;
+    std::time_t to;
+    long transactions;
+    double sales;
+    double units;
+    long refunds;
+    double refundAmount;
+    std::vector<std::pair<std::string, double>> topProducts;  // Units sold, highest first
+
+    WindowSummary() : from(0), to(0), transactions(0), sales(0.0), units(0.0), refunds(0), refundAmount(0.0) {}
+
+    double getAverageBasket() const { return transactions > 0 ? sales / transactions : 0.0; }
+    double getUnitsPerBasket() const { return transactions > 0 ? units / transactions : 0.0; }
+};
+
+/**
+ * @brief Sliding-window sales totals over ring buffers
+ *
+ * Sales and refunds land in a per-second slot and its per-minute slot,
+ * which also tracks units by product. Both rings hold two days so that any
+ * window of up to 24 hours can be compared with the same window a day
+ * earlier. A slot is stamped with the second (or minute) it holds and is
+ * reset when the ring wraps onto it. A query reads whole minutes from the
+ * minute ring and only the partial minutes at its edges from the second
+ * ring, and never touches stored transactions. Top products are resolved
+ * to whole minutes at the window edges.
+ */
+class SalesWindowEngine {
+public:
+    static const int MAX_WINDOW_SECONDS = 86400;
+
+private:
+    struct SlotTotals {
+        uint32_t transactions;
+        uint32_t refunds;
+        int64_t salesCents;
+        int64_t refundCents;
+        int64_t unitCentis;     // Units sold in hundredths (bulk items are fractional)
+    };
+
+    struct SecondSlot {
+        int64_t second;         // Epoch second held, -1 if unused
+        SlotTotals totals;
+    };
+
+    struct MinuteSlot {
+        int64_t minute;         // Epoch minute held, -1 if unused
+        SlotTotals totals;
+        std::unordered_map<uint32_t, double> productUnits;     // Product code -> units
+    };
+
+    std::vector<SecondSlot> seconds;   // Allocated on first use
+    std::vector<MinuteSlot> minutes;
+    std::unordered_map<std::string, uint32_t> productCodes;
+    std::vector<std::string> productIds;
+
+    SecondSlot* secondSlot(std::time_t when);
+    MinuteSlot* minuteSlot(std::time_t when);
+    static void addTotals(SlotTotals& into, const SlotTotals& from);
+    uint32_t productCode(const std::string& productId);
+    void ensureAllocated();
+
+public:
+    SalesWindowEngine();
+
+    void recordSale(const Transaction& transaction);
+    void recordRefund(const Transaction& transaction, const RefundRecord& refund);
+
+    // [from, to); at most MAX_WINDOW_SECONDS long and within the last two days
+    WindowSummary summarize(std::time_t from, std::time_t to, size_t topCount = 5) const;
+    void displayComparison(std::ostream& out, int windowSeconds, std::time_t now) const;
+    void accountMemory(MemoryReport& report) const;
+};
+
+#endif // SALES_WINDOW_H
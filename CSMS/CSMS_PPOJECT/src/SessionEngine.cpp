@@ -0,0 +1,373 @@
+// ===== SessionEngine.cpp =====
+#include "SessionEngine.h"
+#include "CommandProcessor.h"
+#include "MemoryAccounting.h"
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+
+static std::atomic<long> allocatedFrameBytes(0);
+
+static bool parseNumber(const std::string& text, double& value) {
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return !text.empty() && end && *end == '\0';
+}
+
+static bool parsePayment(const std::string& text, PaymentMethod& method) {
+    if (text == "cash") method = PaymentMethod::CASH;
+    else if (text == "credit") method = PaymentMethod::CREDIT_CARD;
+    else if (text == "debit") method = PaymentMethod::DEBIT_CARD;
+    else if (text == "mobile") method = PaymentMethod::MOBILE_PAYMENT;
+    else return false;
+    return true;
+}
+
+static std::string formatMoney(double amount) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.2f", amount);
+    return text;
+}
+
+// SessionTask implementation
+void SessionTask::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+    // The frame is suspended here, so it can be destroyed before control leaves it
+    handle.promise().engine.retire(handle.promise().session);
+}
+
+void SessionTask::promise_type::unhandled_exception() {
+    std::terminate();   // run() catches what commands throw; anything else is a bug
+}
+
+void* SessionTask::promise_type::operator new(size_t size) {
+    allocatedFrameBytes.fetch_add(static_cast<long>(size), std::memory_order_relaxed);
+    return ::operator new(size);
+}
+
+void SessionTask::promise_type::operator delete(void* frame, size_t size) {
+    allocatedFrameBytes.fetch_sub(static_cast<long>(size), std::memory_order_relaxed);
+    ::operator delete(frame);
+}
+
+// Session implementation
+Session::Session(int id, const std::string& terminalId)
+    : id(id), terminalId(terminalId), cashierId("CASHIER001"), customer(nullptr), cart(nullptr), inboxHead(0),
+      waiting(false), closed(false) {
+}
+
+// LineAwaiter implementation
+bool LineAwaiter::await_ready() {
+    return false;   // Decided under the inbox lock in await_suspend
+}
+
+bool LineAwaiter::await_suspend(std::coroutine_handle<>) {
+    LockStripes& locks = engine.inboxLocks;
+    int stripe = locks.stripeFor(&session);
+    locks.lock(stripe, &session);
+    bool suspend = session.inboxHead == session.inbox.size() && !session.closed;
+    session.waiting = suspend;
+    // Once unlocked, a delivery may resume the session on another worker
+    locks.unlock(stripe);
+    return suspend;
+}
+
+std::optional<std::string> LineAwaiter::await_resume() {
+    int stripe = engine.inboxLocks.stripeFor(&session);
+    engine.inboxLocks.lock(stripe, &session);
+    std::optional<std::string> line;
+    if (session.inboxHead < session.inbox.size()) {
+        line = std::move(session.inbox[session.inboxHead++]);
+        if (session.inboxHead == session.inbox.size()) {
+            std::vector<std::string>().swap(session.inbox);   // Idle sessions keep no buffer
+            session.inboxHead = 0;
+        }
+    }
+    engine.inboxLocks.unlock(stripe);
+    return line;
+}
+
+// SessionEngine implementation
+SessionEngine::SessionEngine(Store& store, SessionOutput& output, int threads)
+    : store(store), output(output), scheduler(threads), inboxLocks("session", 256), nextSessionId(1), opened(0),
+      finished(0), commands(0), errors(0), sales(0), resumes(0) {
+}
+
+SessionEngine::~SessionEngine() {
+    closeAll();
+    waitIdle();
+}
+
+SessionTask SessionEngine::run(Session& session) {
+    for (;;) {
+        std::optional<std::string> line = co_await nextLine(session);
+        if (!line) {
+            break;
+        }
+        std::vector<std::string> args = CommandProcessor::tokenize(*line);
+        if (args.empty()) {
+            continue;
+        }
+        commands.fetch_add(1, std::memory_order_relaxed);
+        if (args[0] == "quit") {
+            output.send(session.id, "OK bye");
+            break;
+        }
+
+        std::string reply;
+        bool ok;
+        try {
+            ok = execute(session, args, reply);
+        } catch (const std::exception& e) {
+            ok = false;
+            reply = e.what();
+        }
+        if (!ok) {
+            errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        output.send(session.id, (ok ? "OK" : "ERR") + (reply.empty() ? std::string() : " " + reply));
+    }
+
+    // A cart that was never paid for has not touched the store
+    delete session.cart;
+    session.cart = nullptr;
+}
+
+bool SessionEngine::execute(Session& session, const std::vector<std::string>& args, std::string& reply) {
+    const std::string& command = args[0];
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    if (command == "cashier" && args.size() == 2) {
+        session.cashierId = args[1];
+        if (session.cart) {
+            session.cart->setCashierId(args[1]);
+        }
+        return true;
+    }
+    if (command == "customer" && args.size() == 2) {
+        Customer* customer = nullptr;
+        if (args[1] != "-") {
+            customer = store.getCustomerDatabase().findCustomer(args[1]);
+            if (!customer) {
+                reply = "customer not found: " + args[1];
+                return false;
+            }
+        }
+        session.customer = customer;
+        if (session.cart) {
+            session.cart->setCustomer(customer);
+        }
+        return true;
+    }
+    if (command == "add" && (args.size() == 2 || args.size() == 3)) {
+        double quantity = 1.0;
+        if (args.size() == 3 && (!parseNumber(args[2], quantity) || quantity <= 0)) {
+            reply = "invalid quantity '" + args[2] + "'";
+            return false;
+        }
+        Product* product = store.getInventory().findProduct(args[1]);
+        if (!product || !product->getIsActive()) {
+            reply = "no such product: " + args[1];
+            return false;
+        }
+        if (!session.cart) {
+            session.cart = store.openTransaction(session.customer, session.cashierId);
+        }
+        if (!session.cart->addItem(product, quantity)) {
+            reply = "cannot sell " + args[1];
+            if (session.cart->getItems().empty()) {
+                delete session.cart;
+                session.cart = nullptr;
+            }
+            return false;
+        }
+        reply = std::to_string(session.cart->getItems().size()) + " items";
+        return true;
+    }
+    if (command == "remove" && args.size() == 2) {
+        int itemNo = std::atoi(args[1].c_str());
+        if (!session.cart || !session.cart->removeItem(itemNo - 1)) {
+            reply = "no item " + args[1];
+            return false;
+        }
+        if (session.cart->getItems().empty()) {
+            delete session.cart;
+            session.cart = nullptr;
+        }
+        return true;
+    }
+    if (command == "total" && args.size() == 1) {
+        if (!session.cart) {
+            reply = "0 items";
+            return true;
+        }
+        store.priceTransaction(session.cart);
+        reply = std::to_string(session.cart->getItems().size()) + " items, subtotal " +
+                formatMoney(session.cart->getSubtotal()) + ", tax " + formatMoney(session.cart->getTax()) +
+                ", total " + formatMoney(session.cart->getFinalTotal());
+        return true;
+    }
+    if (command == "pay" && (args.size() == 2 || args.size() == 3)) {
+        PaymentMethod method;
+        if (!parsePayment(args[1], method)) {
+            reply = "unknown payment method '" + args[1] + "'";
+            return false;
+        }
+        if (!session.cart) {
+            reply = "cart is empty";
+            return false;
+        }
+        store.priceTransaction(session.cart);
+        double amount = session.cart->getFinalTotal();
+        if (args.size() == 3 && !parseNumber(args[2], amount)) {
+            reply = "invalid amount '" + args[2] + "'";
+            return false;
+        }
+        if (!store.completeSale(session.cart, method, amount)) {
+            reply = "payment failed";
+            return false;
+        }
+        // The store owns the completed transaction
+        reply = "sale " + std::to_string(session.cart->getId()) + " total " +
+                formatMoney(session.cart->getFinalTotal()) + " change " +
+                formatMoney(amount - session.cart->getFinalTotal());
+        session.cart = nullptr;
+        sales.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (command == "void" && args.size() == 1) {
+        delete session.cart;
+        session.cart = nullptr;
+        return true;
+    }
+
+    reply = "unknown command '" + command + "'";
+    return false;
+}
+
+void SessionEngine::schedule(Session& session) {
+    Session* target = &session;
+    scheduler.submit(session.id % scheduler.getWorkerCount(), [target]() { target->handle.resume(); });
+}
+
+void SessionEngine::retire(Session& session) {
+    {
+        std::unique_lock<std::shared_mutex> lock(sessionsMutex);
+        sessions.erase(session.id);
+    }
+    session.handle.destroy();
+    delete &session;
+    finished.fetch_add(1, std::memory_order_relaxed);
+}
+
+int SessionEngine::open(const std::string& terminalId) {
+    Session* session;
+    {
+        std::unique_lock<std::shared_mutex> lock(sessionsMutex);
+        session = new Session(nextSessionId++, terminalId);
+        session->handle = run(*session).handle;
+        sessions[session->id] = session;
+    }
+    opened.fetch_add(1, std::memory_order_relaxed);
+    schedule(*session);   // Runs up to its first read
+    return session->id;
+}
+
+bool SessionEngine::deliver(int sessionId, const std::string& line) {
+    std::shared_lock<std::shared_mutex> lock(sessionsMutex);
+    auto it = sessions.find(sessionId);
+    if (it == sessions.end()) {
+        return false;
+    }
+    Session& session = *it->second;
+    int stripe = inboxLocks.stripeFor(&session);
+    inboxLocks.lock(stripe, &session);
+    if (session.closed) {
+        inboxLocks.unlock(stripe);
+        return false;
+    }
+    session.inbox.push_back(line);
+    bool wake = session.waiting;
+    session.waiting = false;
+    inboxLocks.unlock(stripe);
+    if (wake) {
+        resumes.fetch_add(1, std::memory_order_relaxed);
+        schedule(session);
+    }
+    return true;
+}
+
+bool SessionEngine::close(int sessionId) {
+    std::shared_lock<std::shared_mutex> lock(sessionsMutex);
+    auto it = sessions.find(sessionId);
+    if (it == sessions.end()) {
+        return false;
+    }
+    Session& session = *it->second;
+    int stripe = inboxLocks.stripeFor(&session);
+    inboxLocks.lock(stripe, &session);
+    bool wake = session.waiting;
+    session.closed = true;
+    session.waiting = false;
+    inboxLocks.unlock(stripe);
+    if (wake) {
+        schedule(session);
+    }
+    return true;
+}
+
+void SessionEngine::closeAll() {
+    std::vector<int> ids;
+    {
+        std::shared_lock<std::shared_mutex> lock(sessionsMutex);
+        ids.reserve(sessions.size());
+        for (const auto& entry : sessions) {
+            ids.push_back(entry.first);
+        }
+    }
+    for (int id : ids) {
+        close(id);
+    }
+}
+
+void SessionEngine::waitIdle() {
+    scheduler.waitIdle();
+}
+
+size_t SessionEngine::getSessionCount() {
+    std::shared_lock<std::shared_mutex> lock(sessionsMutex);
+    return sessions.size();
+}
+
+SessionStats SessionEngine::getStats() {
+    SessionStats stats;
+    stats.opened = opened.load();
+    stats.finished = finished.load();
+    stats.live = static_cast<long>(getSessionCount());
+    stats.commands = commands.load();
+    stats.errors = errors.load();
+    stats.sales = sales.load();
+    stats.resumes = resumes.load();
+    stats.frameBytes = allocatedFrameBytes.load();
+    return stats;
+}
+
+size_t SessionEngine::getBytesPerSession() {
+    size_t live = getSessionCount();
+    if (live == 0) {
+        return 0;
+    }
+    size_t perSession = MemorySizing::allocation(sizeof(Session)) + MemorySizing::hashNodeBytes<int, Session*>();
+    return static_cast<size_t>(allocatedFrameBytes.load()) / live + perSession;
+}
+
+void SessionEngine::display(std::ostream& out) {
+    SessionStats stats = getStats();
+    out << "Sessions: " << stats.live << " live, " << stats.opened << " opened, " << stats.finished
+        << " finished, about " << getBytesPerSession() << " bytes each while idle" << std::endl;
+    out << "Threads: " << getThreadCount() << ", resumes " << stats.resumes << ", steals "
+        << scheduler.getStealCount() << ", inbox lock wait " << std::fixed << std::setprecision(2)
+        << inboxLocks.getTotalWaitNanos() / 1e6 << " ms" << std::endl;
+    out.unsetf(std::ios::fixed);
+    out << "Commands: " << stats.commands << ", errors " << stats.errors << ", sales " << stats.sales << std::endl;
+}
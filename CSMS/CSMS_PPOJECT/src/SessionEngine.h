@@ -0,0 +1,175 @@
+// ===== SessionEngine.h =====
+// C++20: session bodies are coroutines. Only the session engine and its
+// front ends are built with -std=c++20; the rest of the tree stays C++14.
+#ifndef SESSION_ENGINE_H
+#define SESSION_ENGINE_H
+
+#include "Store.h"
+#include "WorkStealingScheduler.h"
+#include "LockStripes.h"
+#include <atomic>
+#include <coroutine>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class SessionEngine;
+struct Session;
+
+/**
+ * @brief Where sessions' replies go; called from pool threads, so it must be thread safe
+ */
+class SessionOutput {
+public:
+    virtual ~SessionOutput() {}
+    virtual void send(int sessionId, const std::string& text) = 0;
+};
+
+/**
+ * @brief Coroutine handle of one session body, started by the engine
+ */
+class SessionTask {
+public:
+    struct promise_type;
+
+    // Hands the finished frame back to the engine, which destroys it
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+        void await_resume() noexcept {}
+    };
+
+    struct promise_type {
+        SessionEngine& engine;
+        Session& session;
+
+        promise_type(SessionEngine& engine, Session& session) : engine(engine), session(session) {}
+        SessionTask get_return_object() {
+            return SessionTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception();
+
+        // Frames are counted so the per-session footprint can be reported
+        static void* operator new(size_t size);
+        static void operator delete(void* frame, size_t size);
+    };
+
+    explicit SessionTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief One terminal: its inbox, cashier, customer and open cart
+ */
+struct Session {
+    int id;
+    std::string terminalId;
+    std::string cashierId;
+    Customer* customer;
+    Transaction* cart;                 // Created by the first item, nullptr while idle
+    std::vector<std::string> inbox;    // Lines delivered but not yet read
+    size_t inboxHead;
+    bool waiting;                      // Suspended in nextLine() with nothing to read
+    bool closed;                       // No more input; the session ends once its inbox is read
+    std::coroutine_handle<> handle;
+
+    Session(int id, const std::string& terminalId);
+};
+
+/**
+ * @brief Awaitable returned by SessionEngine::nextLine(); empty once the session is closed
+ */
+class LineAwaiter {
+private:
+    SessionEngine& engine;
+    Session& session;
+
+public:
+    LineAwaiter(SessionEngine& engine, Session& session) : engine(engine), session(session) {}
+    bool await_ready();
+    bool await_suspend(std::coroutine_handle<> handle);
+    std::optional<std::string> await_resume();
+};
+
+/**
+ * @brief Counters for the engine's lifetime
+ */
+struct SessionStats {
+    long opened;
+    long finished;
+    long live;
+    long commands;
+    long errors;
+    long sales;
+    long resumes;          // Times a suspended session was scheduled to run again
+    long frameBytes;       // Coroutine frames currently allocated
+};
+
+/**
+ * @brief Runs many long-lived terminal sessions on a small thread pool
+ *
+ * Each session's body is a coroutine that reads one command line at a time
+ * with co_await; a session with nothing to read is just a suspended frame
+ * and a Session record, so idle terminals cost memory, not threads. Input
+ * is delivered from any thread; delivering to a suspended session schedules
+ * it on the pool, preferring the same worker each time. A session runs on
+ * one worker at a time, and commands that touch the store are serialized by
+ * one store lock because Store is not thread safe.
+ *
+ * Commands, one per line (replies start with OK or ERR):
+ *   cashier <id> | customer <customerId|-> | add <productId> [qty]
+ *   remove <itemNo> | total | pay <cash|credit|debit|mobile> [amount]
+ *   void | quit
+ */
+class SessionEngine {
+private:
+    Store& store;
+    SessionOutput& output;
+    WorkStealingScheduler scheduler;
+    LockStripes inboxLocks;            // Guards each session's inbox and flags
+    std::mutex storeMutex;
+    std::shared_mutex sessionsMutex;   // Guards the map, not the sessions
+    std::unordered_map<int, Session*> sessions;
+    int nextSessionId;
+
+    std::atomic<long> opened;
+    std::atomic<long> finished;
+    std::atomic<long> commands;
+    std::atomic<long> errors;
+    std::atomic<long> sales;
+    std::atomic<long> resumes;
+
+    SessionTask run(Session& session);
+    bool execute(Session& session, const std::vector<std::string>& args, std::string& reply);
+    void schedule(Session& session);
+    void retire(Session& session);
+
+    friend class LineAwaiter;
+    friend struct SessionTask::FinalAwaiter;
+
+public:
+    SessionEngine(Store& store, SessionOutput& output, int threads);
+    ~SessionEngine();                  // Closes every session; open carts are voided
+
+    int open(const std::string& terminalId);
+    bool deliver(int sessionId, const std::string& line);
+    bool close(int sessionId);
+    void closeAll();
+    void waitIdle();                   // Until every delivered line has been handled
+
+    LineAwaiter nextLine(Session& session) { return LineAwaiter(*this, session); }
+
+    size_t getSessionCount();
+    SessionStats getStats();
+    size_t getBytesPerSession();       // Frame, Session record and map entry of an idle session
+    int getThreadCount() const { return scheduler.getWorkerCount(); }
+    void display(std::ostream& out);
+};
+
+#endif // SESSION_ENGINE_H
@@ -0,0 +1,159 @@
+// ===== SessionMain.cpp =====
+// Load driver for the terminal session engine.
+//
+// Opens many terminal sessions against one generated store, leaves most
+// of them idle and drives checkouts through the rest, then reports what
+// the sessions cost in memory and how fast commands were handled.
+
+#include "SessionEngine.h"
+#include "DataGenerator.h"
+#include "NullBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Counts replies; optionally prints one session's conversation
+ */
+class CountingOutput : public SessionOutput {
+private:
+    std::atomic<long> replies;
+    std::atomic<long> failures;
+    std::ostream& echo;
+    int echoSession;
+    std::mutex echoMutex;
+
+public:
+    CountingOutput(std::ostream& echo, int echoSession)
+        : replies(0), failures(0), echo(echo), echoSession(echoSession) {}
+
+    void send(int sessionId, const std::string& text) override {
+        replies.fetch_add(1, std::memory_order_relaxed);
+        if (text.compare(0, 3, "ERR") == 0) {
+            failures.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (sessionId == echoSession) {
+            std::lock_guard<std::mutex> lock(echoMutex);
+            echo << "  [" << sessionId << "] " << text << "\n";
+        }
+    }
+
+    long getReplies() const { return replies.load(); }
+    long getFailures() const { return failures.load(); }
+};
+
+static void printUsage() {
+    std::cout << "Usage: sessions [options]\n"
+              << "  --sessions N   Terminal sessions opened (default 20000)\n"
+              << "  --active N     Sessions that check out each round; the rest stay idle (default 1000)\n"
+              << "  --rounds N     Checkout rounds (default 3)\n"
+              << "  --items N      Items per basket (default 5)\n"
+              << "  --threads N    Pool threads (default 4)\n"
+              << "  --products N   Catalog size (default 2000)\n"
+              << "  --echo         Print the first session's replies\n";
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    int sessionCount = 20000;
+    int active = 1000;
+    int rounds = 3;
+    int items = 5;
+    int threads = 4;
+    bool echo = false;
+    GeneratorConfig data;
+    data.productCount = 2000;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sessions" && hasValue) {
+            sessionCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--active" && hasValue) {
+            active = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--rounds" && hasValue) {
+            rounds = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--items" && hasValue) {
+            items = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--products" && hasValue) {
+            data.productCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--echo") {
+            echo = true;
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    active = std::min(active, sessionCount);
+
+    // Transactions still print stock warnings to the console; terminals get replies instead
+    std::ostream out(std::cout.rdbuf());
+    NullBuffer discard;
+    std::cout.rdbuf(&discard);
+
+    Store store;
+    DataGenerator generator(data);
+    generator.populate(store);
+    CountingOutput output(out, echo ? 1 : 0);
+
+    SessionEngine engine(store, output, threads);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> ids;
+    ids.reserve(sessionCount);
+    for (int i = 0; i < sessionCount; ++i) {
+        ids.push_back(engine.open("T" + std::to_string(i + 1)));
+        engine.deliver(ids.back(), "cashier C" + std::to_string(i % 50 + 1));
+    }
+    engine.waitIdle();
+    out << "Opened " << sessionCount << " sessions in " << std::fixed << std::setprecision(1)
+              << secondsSince(start) * 1000 << " ms, about " << engine.getBytesPerSession()
+              << " bytes per idle session\n";
+
+    // Active terminals are spread over the whole range so idle ones sit between them
+    const std::vector<Customer*>& customers = generator.getCustomers();
+    for (int round = 0; round < rounds; ++round) {
+        // The pool is idle between rounds, so the shelves can be refilled without the store lock
+        for (Product* product : generator.getCatalog()) {
+            product->addStock(product->getMaxStockLevel() - product->getCurrentStock());
+        }
+        long repliesBefore = output.getReplies();
+        start = std::chrono::steady_clock::now();
+        for (int a = 0; a < active; ++a) {
+            int id = ids[static_cast<size_t>(a) * sessionCount / std::max(active, 1)];
+            bool member = !customers.empty() && generator.getRandom()() % 3 != 0;
+            engine.deliver(id, "customer " + (member ? customers[a % customers.size()]->getId() : std::string("-")));
+            for (int n = 0; n < items; ++n) {
+                engine.deliver(id, "add " + generator.pickProduct()->getId());
+            }
+            engine.deliver(id, "total");
+            engine.deliver(id, "pay credit");
+        }
+        engine.waitIdle();
+        double seconds = secondsSince(start);
+        long handled = output.getReplies() - repliesBefore;
+        out << "Round " << round + 1 << ": " << handled << " commands in " << std::setprecision(1)
+                  << seconds * 1000 << " ms (" << std::setprecision(0) << handled / std::max(seconds, 1e-9)
+                  << " commands/s)\n";
+    }
+
+    engine.display(out);
+    out << "Failed replies: " << output.getFailures() << "\n";
+
+    start = std::chrono::steady_clock::now();
+    engine.closeAll();
+    engine.waitIdle();
+    out << "Closed every session in " << std::fixed << std::setprecision(1) << secondsSince(start) * 1000 << " ms; "
+              << engine.getSessionCount() << " left\n";
+    std::cout.rdbuf(out.rdbuf());
+    return 0;
+}
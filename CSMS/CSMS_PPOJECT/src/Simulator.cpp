@@ -0,0 +1,577 @@
+// ===== Simulator.cpp =====
+// Multi-lane point-of-sale simulator used for hardware sizing.
+//
+// Each lane is a stream of checkouts driven through Transaction,
+// InventoryManager and CustomerDatabase: baskets arrive as product and
+// member IDs and are looked up at the till. Lanes are scheduled on a
+// work-stealing pool and the run is repeated as the lane count scales.
+#include "Product.h"
+#include "Customer.h"
+#include "Transaction.h"
+#include "InventoryManager.h"
+#include "TaxEngine.h"
+#include "WorkStealingScheduler.h"
+#include "LockStripes.h"
+#include "DataGenerator.h"
+#include "Tracing.h"
+#include "Sketches.h"
+#include "PersistenceFlusher.h"
+#include "SnapshotCatalog.h"
+#include "NullBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ArrivalPattern {
+    POISSON,   // Exponential inter-arrival times
+    UNIFORM,   // Evenly spaced arrivals
+    BURST      // Groups of customers arriving together
+};
+
+/**
+ * @brief Command-line configurable simulation parameters
+ */
+struct SimulationConfig {
+    int maxLanes;
+    int checkoutsPerLane;
+    int productCount;
+    int memberCount;
+    double arrivalRate;        // Arrivals per second per lane; 0 = saturate
+    ArrivalPattern arrival;
+    BasketMix basket;
+    unsigned seed;
+    bool perLane;              // Print per-lane lines for every run
+    std::string tracePath;     // Chrome trace of the checkouts, if set
+    std::string journalPath;   // Sales journal written by a background flusher, if set
+    int reportIntervalMs;      // Snapshot reports run alongside the lanes this often; 0 = none
+
+    SimulationConfig()
+        : maxLanes(static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))),
+          checkoutsPerLane(2000), productCount(2000), memberCount(5000), arrivalRate(0.0),
+          arrival(ArrivalPattern::POISSON), basket(BasketMix::MIXED), seed(42), perLane(false),
+          reportIntervalMs(0) {}
+};
+
+/**
+ * @brief One customer arriving at a lane
+ */
+struct CheckoutPlan {
+    int lane;
+    long arrivalNanos;                              // Offset from run start
+    std::string customerId;                         // Empty for walk-ins
+    std::vector<std::pair<std::string, double>> basket;   // Product ID and quantity
+};
+
+/**
+ * @brief Counters for one lane, kept per worker and merged after the run
+ */
+struct LaneStats {
+    long checkouts;
+    long rejectedItems;
+    double revenue;
+    std::vector<long> latencies;  // Nanoseconds
+
+    LaneStats() : checkouts(0), rejectedItems(0), revenue(0.0) {}
+
+    void merge(const LaneStats& other) {
+        checkouts += other.checkouts;
+        rejectedItems += other.rejectedItems;
+        revenue += other.revenue;
+        latencies.insert(latencies.end(), other.latencies.begin(), other.latencies.end());
+    }
+};
+
+static long percentile(const std::vector<long>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(std::ceil(p * sorted.size())) - 1;
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+/**
+ * @brief A self-contained store: catalog, members and the locks lanes share
+ */
+class StoreSimulator {
+private:
+    const SimulationConfig& config;
+    InventoryManager inventory;
+    CustomerDatabase customerDB;
+    TaxTable taxTable;
+    DataGenerator generator;
+    LockStripes inventoryLock;    // One stripe: lookups may load or evict, so they are serialised
+    LockStripes memberLock;       // Likewise for the member database
+    LockStripes productLocks;
+    LockStripes customerLocks;
+    PersistenceFlusher* journal;
+    SnapshotCatalog* snapshots;   // Versions for reports read during the run, if enabled
+
+    static GeneratorConfig generatorConfig(const SimulationConfig& config);
+    std::vector<CheckoutPlan> planArrivals(int lanes);
+    void checkout(const CheckoutPlan& plan, LaneStats& stats, SalesSketches& sketches,
+                  std::vector<Transaction*>& completed, long startNanos);
+
+public:
+    StoreSimulator(const SimulationConfig& config, PersistenceFlusher* journal);
+    ~StoreSimulator();
+    void run(int lanes, bool printLanes);
+};
+
+StoreSimulator::StoreSimulator(const SimulationConfig& config, PersistenceFlusher* journal)
+    : config(config), generator(generatorConfig(config)), inventoryLock("inventory", 1), memberLock("members", 1),
+      productLocks("product", 256),
+      customerLocks("customer", 64), journal(journal), snapshots(nullptr) {
+    generator.populateCatalog(inventory);
+    generator.populateCustomers(customerDB);
+    if (config.reportIntervalMs > 0) {
+        snapshots = new SnapshotCatalog();
+        snapshots->registerAll(generator.getCatalog(), generator.getCustomers());
+    }
+}
+
+StoreSimulator::~StoreSimulator() {
+    delete snapshots;
+}
+
+GeneratorConfig StoreSimulator::generatorConfig(const SimulationConfig& config) {
+    GeneratorConfig generated;
+    generated.seed = config.seed;
+    generated.productCount = config.productCount;
+    generated.customerCount = config.memberCount;
+    generated.basket = config.basket;
+    return generated;
+}
+
+std::vector<CheckoutPlan> StoreSimulator::planArrivals(int lanes) {
+    std::vector<CheckoutPlan> plans;
+    plans.reserve(static_cast<size_t>(lanes) * config.checkoutsPerLane);
+    std::mt19937_64& rng = generator.getRandom();
+
+    for (int lane = 0; lane < lanes; ++lane) {
+        double clock = 0.0;  // Seconds since run start
+        double meanGap = (config.arrivalRate > 0) ? 1.0 / config.arrivalRate : 0.0;
+        std::exponential_distribution<double> poissonGap(config.arrivalRate > 0 ? config.arrivalRate : 1.0);
+
+        for (int n = 0; n < config.checkoutsPerLane; ++n) {
+            CheckoutPlan plan;
+            plan.lane = lane;
+
+            if (meanGap > 0) {
+                switch (config.arrival) {
+                    case ArrivalPattern::POISSON: clock += poissonGap(rng); break;
+                    case ArrivalPattern::UNIFORM: clock += meanGap; break;
+                    case ArrivalPattern::BURST:   if (n % 10 == 0) clock += meanGap * 10; break;
+                }
+            }
+            plan.arrivalNanos = static_cast<long>(clock * 1e9);
+
+            // About a third of shoppers are walk-ins without a membership
+            GeneratedSale sale = generator.nextSale();
+            if (sale.customer) {
+                plan.customerId = sale.customer->getId();
+            }
+            for (const auto& line : sale.items) {
+                plan.basket.push_back(std::make_pair(line.first->getId(), line.second));
+            }
+            plans.push_back(std::move(plan));
+        }
+    }
+
+    std::stable_sort(plans.begin(), plans.end(), [](const CheckoutPlan& a, const CheckoutPlan& b) {
+        return a.arrivalNanos < b.arrivalNanos;
+    });
+    return plans;
+}
+
+void StoreSimulator::checkout(const CheckoutPlan& plan, LaneStats& stats, SalesSketches& sketches,
+                              std::vector<Transaction*>& completed, long startNanos) {
+    auto now = []() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+    long begin = now();
+    CSMS_TRACE_SPAN("checkout", "StoreSimulator::checkout", plan.lane + 1);
+
+    // The inventory and member database are shared by every lane and are not
+    // thread-safe, so each is locked only for the lookups themselves
+    std::vector<std::pair<Product*, double>> basket;
+    basket.reserve(plan.basket.size());
+    Customer* customer = nullptr;
+    {
+        CSMS_TRACE_SPAN("lookup", "StoreSimulator::resolveBasket", plan.lane + 1);
+        inventoryLock.lock(0, &inventory);
+        for (const auto& line : plan.basket) {
+            if (Product* product = inventory.findProduct(line.first)) {
+                basket.push_back(std::make_pair(product, line.second));
+            } else {
+                stats.rejectedItems++;
+            }
+        }
+        inventoryLock.unlock(0);
+        if (!plan.customerId.empty()) {
+            memberLock.lock(0, &customerDB);
+            customer = customerDB.findCustomer(plan.customerId);
+            memberLock.unlock(0);
+        }
+    }
+
+    Transaction* transaction = new Transaction(customer, "LANE" + std::to_string(plan.lane + 1));
+
+    std::vector<const void*> productKeys;
+    productKeys.reserve(basket.size());
+    for (const auto& line : basket) {
+        productKeys.push_back(line.first);
+    }
+
+    // Stock is shared by every lane: hold the basket's product stripes from the
+    // availability check through to the stock commit
+    std::vector<int> heldProducts;
+    int customerStripe = -1;
+    {
+        CSMS_TRACE_SPAN("locks", "StoreSimulator::lockBasket", transaction->getId());
+        heldProducts = productLocks.lockAll(productKeys);
+        if (customer) {
+            customerStripe = customerLocks.stripeFor(customer);
+            customerLocks.lock(customerStripe, customer);
+        }
+    }
+
+    for (const auto& line : basket) {
+        Product* product = line.first;
+        int needed = static_cast<int>(std::ceil(line.second));
+        if (product->getAvailableStock() < needed + product->getMinStockLevel()) {
+            product->addStock(product->getRestockRecommendation() + needed);  // Replenish from the back room
+        }
+        if (!transaction->addItem(product, line.second)) {
+            stats.rejectedItems++;
+        }
+    }
+
+    bool sold = false;
+    if (!transaction->getItems().empty()) {
+        transaction->calculateTotals(taxTable.getJurisdiction(0));
+        if (transaction->processPayment(PaymentMethod::CREDIT_CARD, transaction->getFinalTotal())) {
+            transaction->finalizeTransaction(journal);
+            sold = true;
+        }
+    }
+
+    // Sold and replenished lines alike changed stock behind the inventory's back
+    std::vector<const Product*> changed;
+    changed.reserve(basket.size());
+    for (const auto& line : basket) {
+        changed.push_back(line.first);
+    }
+    inventory.recordStockChanges(changed);
+
+    // Publish to reports before the locks go, so each version holds one sale's effects
+    if (snapshots) {
+        if (sold) {
+            std::vector<std::pair<const Product*, double>> lines;
+            for (const TransactionItem& item : transaction->getItems()) {
+                lines.push_back(std::make_pair(item.product, static_cast<double>(item.stockUnits)));
+            }
+            snapshots->commitSale(lines, customer, transaction->getFinalTotal());
+        }
+        // Lines that were not sold may still have been replenished
+        if (!sold || transaction->getItems().size() < basket.size()) {
+            snapshots->commitProducts(changed);
+        }
+    }
+
+    if (customerStripe >= 0) {
+        customerLocks.unlock(customerStripe);
+    }
+    productLocks.unlockAll(heldProducts);
+
+    long end = now();
+    // Open-loop runs include queueing delay since the customer's arrival
+    long reference = (config.arrivalRate > 0) ? startNanos + plan.arrivalNanos : begin;
+
+    if (sold) {
+        stats.checkouts++;
+        stats.revenue += transaction->getFinalTotal();
+        stats.latencies.push_back(end - reference);
+        sketches.recordSale(*transaction);
+        completed.push_back(transaction);
+    } else {
+        delete transaction;
+    }
+}
+
+void StoreSimulator::run(int lanes, bool printLanes) {
+    std::vector<CheckoutPlan> plans = planArrivals(lanes);
+    inventoryLock.resetStats();
+    memberLock.resetStats();
+    productLocks.resetStats();
+    customerLocks.resetStats();
+
+    // Per-worker shards avoid sharing counters between threads
+    std::vector<std::vector<LaneStats>> shards(lanes, std::vector<LaneStats>(lanes));
+    std::vector<std::vector<Transaction*>> completed(lanes);
+    std::vector<SalesSketches> sketches(lanes);
+
+    auto wallStart = std::chrono::steady_clock::now();
+    long startNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          wallStart.time_since_epoch()).count();
+    long steals = 0;
+
+    // Reports read a pinned snapshot while the lanes sell; neither side waits on the other
+    std::atomic<bool> lanesDone(false);
+    long reports = 0;
+    long inconsistent = 0;
+    double reportSeconds = 0.0;
+    double slowestReport = 0.0;
+    std::thread reporter;
+    if (snapshots) {
+        reporter = std::thread([this, &lanesDone, &reports, &inconsistent, &reportSeconds, &slowestReport]() {
+            NullBuffer discard;
+            std::ostream out(&discard);
+            while (!lanesDone.load()) {
+                auto begin = std::chrono::steady_clock::now();
+                {
+                    CatalogSnapshot snapshot(*snapshots);
+                    snapshot.generateInventoryReport(out);
+                    snapshot.generateProfitabilityReport(out);
+                    snapshot.generateFinancialSummary(out);
+                    // Every sale's units reach its products and the ledger in the same epoch
+                    if (std::fabs(snapshot.getTotalUnitsSold() - snapshot.getLedger().units) > 1e-6) {
+                        inconsistent++;
+                    }
+                }
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                reports++;
+                reportSeconds += elapsed;
+                slowestReport = std::max(slowestReport, elapsed);
+                std::this_thread::sleep_for(std::chrono::milliseconds(config.reportIntervalMs));
+            }
+        });
+    }
+
+    {
+        WorkStealingScheduler scheduler(lanes);
+        for (const CheckoutPlan& plan : plans) {
+            if (config.arrivalRate > 0) {
+                std::this_thread::sleep_until(wallStart + std::chrono::nanoseconds(plan.arrivalNanos));
+            }
+            const CheckoutPlan* p = &plan;
+            scheduler.submit(plan.lane, [this, p, &shards, &sketches, &completed, startNanos]() {
+                int worker = WorkStealingScheduler::currentWorker();
+                checkout(*p, shards[worker][p->lane], sketches[worker], completed[worker], startNanos);
+            });
+        }
+        scheduler.waitIdle();
+        steals = scheduler.getStealCount();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    lanesDone.store(true);
+    if (reporter.joinable()) {
+        reporter.join();
+    }
+
+    std::vector<LaneStats> laneTotals(lanes);
+    LaneStats aggregate;
+    for (int worker = 0; worker < lanes; ++worker) {
+        for (int lane = 0; lane < lanes; ++lane) {
+            laneTotals[lane].merge(shards[worker][lane]);
+        }
+    }
+    for (LaneStats& lane : laneTotals) {
+        std::sort(lane.latencies.begin(), lane.latencies.end());
+        aggregate.merge(lane);
+    }
+    std::sort(aggregate.latencies.begin(), aggregate.latencies.end());
+
+    auto printRow = [seconds](const std::string& label, const LaneStats& stats) {
+        std::cout << std::left << std::setw(10) << label << std::right
+                  << std::setw(10) << stats.checkouts
+                  << std::setw(12) << std::fixed << std::setprecision(0) << (stats.checkouts / seconds)
+                  << std::setw(10) << std::setprecision(1) << percentile(stats.latencies, 0.50) / 1000.0
+                  << std::setw(10) << percentile(stats.latencies, 0.99) / 1000.0
+                  << std::setw(10) << percentile(stats.latencies, 0.999) / 1000.0
+                  << std::setw(10) << stats.rejectedItems << "\n";
+    };
+
+    std::cout << "\n--- " << lanes << " lane(s): " << std::fixed << std::setprecision(3) << seconds
+              << "s, steals " << steals << ", lock wait "
+              << std::setprecision(2)
+              << (inventoryLock.getTotalWaitNanos() + memberLock.getTotalWaitNanos() +
+                  productLocks.getTotalWaitNanos() + customerLocks.getTotalWaitNanos()) / 1e6
+              << "ms ---\n";
+    std::cout << std::left << std::setw(10) << "Lane" << std::right << std::setw(10) << "Checkouts"
+              << std::setw(12) << "Per sec" << std::setw(10) << "p50 us" << std::setw(10) << "p99 us"
+              << std::setw(10) << "p999 us" << std::setw(10) << "Rejected" << "\n";
+    if (printLanes) {
+        for (int lane = 0; lane < lanes; ++lane) {
+            printRow("Lane " + std::to_string(lane + 1), laneTotals[lane]);
+        }
+    }
+    printRow("ALL", aggregate);
+
+    // Contention hot spots: the stripes threads waited on the longest
+    std::cout << "Hot spots:\n";
+    bool anyContention = false;
+    for (const LockStripes* structure : { &inventoryLock, &memberLock }) {
+        StripeStats lookups = structure->getStats(0);
+        if (lookups.contended == 0) {
+            continue;
+        }
+        anyContention = true;
+        std::cout << "  " << structure->getName() << " lookups: "
+                  << lookups.contended << "/" << lookups.acquisitions << " contended, "
+                  << std::setprecision(2) << lookups.waitNanos / 1e6 << "ms waited\n";
+    }
+    for (const StripeStats& stripe : productLocks.getHottestStripes(5)) {
+        if (stripe.contended == 0) {
+            break;
+        }
+        anyContention = true;
+        const Product* product = static_cast<const Product*>(stripe.lastKey);
+        std::cout << "  product stripe " << std::setw(3) << stripe.stripe << ": "
+                  << stripe.contended << "/" << stripe.acquisitions << " contended, "
+                  << std::setprecision(2) << stripe.waitNanos / 1e6 << "ms waited"
+                  << (product ? " (e.g. " + product->getId() + " " + product->getName() + ")" : "") << "\n";
+    }
+    for (const StripeStats& stripe : customerLocks.getHottestStripes(3)) {
+        if (stripe.contended == 0) {
+            break;
+        }
+        anyContention = true;
+        std::cout << "  customer stripe " << std::setw(3) << stripe.stripe << ": "
+                  << stripe.contended << "/" << stripe.acquisitions << " contended, "
+                  << std::setprecision(2) << stripe.waitNanos / 1e6 << "ms waited\n";
+    }
+    if (!anyContention) {
+        std::cout << "  none\n";
+    }
+
+    // Workers' sketches are combined only after the run, so recording never locks
+    SalesSketches combined;
+    for (const SalesSketches& worker : sketches) {
+        combined.merge(worker);
+    }
+    combined.display(std::cout, "Live sketches");
+
+    if (snapshots) {
+        std::cout << "Snapshot reports: " << reports << " during the run, mean " << std::setprecision(2)
+                  << (reports ? reportSeconds / reports * 1000 : 0.0) << "ms, slowest " << slowestReport * 1000
+                  << "ms, " << inconsistent << " inconsistent\n";
+        snapshots->display(std::cout);
+    }
+
+    for (auto& list : completed) {
+        for (Transaction* transaction : list) {
+            delete transaction;
+        }
+    }
+}
+
+static void printUsage() {
+    std::cout << "Usage: simulator [options]\n"
+              << "  --lanes N          Maximum lane count (default: core count)\n"
+              << "  --checkouts N      Checkouts per lane (default 2000)\n"
+              << "  --products N       Catalog size (default 2000)\n"
+              << "  --members N        Loyalty members (default 5000)\n"
+              << "  --rate R           Arrivals per second per lane, 0 = saturate (default 0)\n"
+              << "  --arrival KIND     poisson | uniform | burst (default poisson)\n"
+              << "  --basket KIND      small | mixed | large (default mixed)\n"
+              << "  --seed N           Random seed (default 42)\n"
+              << "  --per-lane         Print every lane, not just the aggregate\n"
+              << "  --trace FILE       Write checkout spans as a Chrome trace\n"
+              << "  --journal FILE     Journal every sale through the background flusher\n"
+              << "  --reports MS       Run snapshot reports alongside the lanes every MS milliseconds\n";
+}
+
+int main(int argc, char* argv[]) {
+    SimulationConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--lanes" && hasValue) {
+            config.maxLanes = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--checkouts" && hasValue) {
+            config.checkoutsPerLane = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--products" && hasValue) {
+            config.productCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--members" && hasValue) {
+            config.memberCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--rate" && hasValue) {
+            config.arrivalRate = std::atof(argv[++i]);
+        } else if (arg == "--arrival" && hasValue) {
+            std::string kind = argv[++i];
+            config.arrival = (kind == "uniform") ? ArrivalPattern::UNIFORM
+                           : (kind == "burst")   ? ArrivalPattern::BURST
+                                                 : ArrivalPattern::POISSON;
+        } else if (arg == "--basket" && hasValue) {
+            std::string kind = argv[++i];
+            config.basket = (kind == "small") ? BasketMix::SMALL
+                          : (kind == "large") ? BasketMix::LARGE
+                                              : BasketMix::MIXED;
+        } else if (arg == "--seed" && hasValue) {
+            config.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--per-lane") {
+            config.perLane = true;
+        } else if (arg == "--trace" && hasValue) {
+            config.tracePath = argv[++i];
+            Tracing::setEnabled(true);
+        } else if (arg == "--journal" && hasValue) {
+            config.journalPath = argv[++i];
+        } else if (arg == "--reports" && hasValue) {
+            config.reportIntervalMs = std::max(1, std::atoi(argv[++i]));
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::cout << "CSMS store simulator: " << config.productCount << " products, "
+              << config.memberCount << " members, " << config.checkoutsPerLane << " checkouts/lane, "
+              << (config.arrivalRate > 0 ? std::to_string(config.arrivalRate) + " arrivals/s/lane"
+                                         : std::string("saturated"))
+              << "\n";
+
+    // Scale 1, 2, 4, ... up to the requested lane count
+    std::vector<int> laneCounts;
+    for (int lanes = 1; lanes < config.maxLanes; lanes *= 2) {
+        laneCounts.push_back(lanes);
+    }
+    laneCounts.push_back(config.maxLanes);
+
+    // One journal for every run; lanes submit to it concurrently
+    PersistenceFlusher journal;
+    if (!config.journalPath.empty() && !journal.open(config.journalPath)) {
+        std::cerr << "Error: cannot open " << config.journalPath << "\n";
+        return 1;
+    }
+
+    for (int lanes : laneCounts) {
+        StoreSimulator store(config, journal.isOpen() ? &journal : nullptr);
+        store.run(lanes, config.perLane || lanes == config.maxLanes);
+    }
+
+    if (journal.isOpen()) {
+        journal.sync();
+        std::cout << "\n";
+        journal.display(std::cout);
+        journal.close();
+    }
+
+    if (!config.tracePath.empty()) {
+        if (!Tracing::exportChromeTrace(config.tracePath)) {
+            std::cerr << "Error: cannot write " << config.tracePath << "\n";
+            return 1;
+        }
+        std::cout << "\nTrace written to " << config.tracePath << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,296 @@
+// ===== Sketches.cpp =====
+#include "Sketches.h"
+#include "Transaction.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+// CountMinSketch implementation
+CountMinSketch::CountMinSketch(int width, int depth)
+    : width(width), depth(depth), counters(static_cast<size_t>(width) * depth, 0), total(0) {
+}
+
+void CountMinSketch::add(uint64_t keyHash, uint32_t count) {
+    // Row hashes derived from two halves of one hash (Kirsch-Mitzenmacher)
+    uint32_t h1 = static_cast<uint32_t>(keyHash);
+    uint32_t h2 = static_cast<uint32_t>(keyHash >> 32);
+    for (int row = 0; row < depth; ++row) {
+        counters[static_cast<size_t>(row) * width + (h1 + row * h2) % width] += count;
+    }
+    total += count;
+}
+
+uint64_t CountMinSketch::estimate(uint64_t keyHash) const {
+    uint32_t h1 = static_cast<uint32_t>(keyHash);
+    uint32_t h2 = static_cast<uint32_t>(keyHash >> 32);
+    uint64_t best = UINT64_MAX;
+    for (int row = 0; row < depth; ++row) {
+        best = std::min<uint64_t>(best, counters[static_cast<size_t>(row) * width + (h1 + row * h2) % width]);
+    }
+    return best;
+}
+
+bool CountMinSketch::merge(const CountMinSketch& other) {
+    if (width != other.width || depth != other.depth) {
+        return false;
+    }
+    for (size_t i = 0; i < counters.size(); ++i) {
+        counters[i] += other.counters[i];
+    }
+    total += other.total;
+    return true;
+}
+
+// HeavyHitters implementation
+HeavyHitters::HeavyHitters(size_t capacity) : capacity(std::max<size_t>(1, capacity)), smallest(0) {
+    entries.reserve(this->capacity);
+}
+
+void HeavyHitters::findSmallest() {
+    smallest = 0;
+    for (size_t i = 1; i < entries.size(); ++i) {
+        if (entries[i].count < entries[smallest].count) {
+            smallest = i;
+        }
+    }
+}
+
+void HeavyHitters::offer(const std::string& key, uint64_t estimate) {
+    auto it = positions.find(key);
+    if (it != positions.end()) {
+        Entry& entry = entries[it->second];
+        entry.count = std::max(entry.count, estimate);
+        if (it->second == smallest) {
+            findSmallest();
+        }
+        return;
+    }
+    if (entries.size() < capacity) {
+        positions[key] = entries.size();
+        entries.push_back(Entry{ key, estimate });
+        findSmallest();
+        return;
+    }
+    if (estimate <= entries[smallest].count) {
+        return;
+    }
+    // Replace the weakest key in place
+    positions.erase(entries[smallest].key);
+    entries[smallest] = Entry{ key, estimate };
+    positions[key] = smallest;
+    findSmallest();
+}
+
+std::vector<HeavyHitters::Entry> HeavyHitters::top(size_t k) const {
+    std::vector<Entry> sorted = entries;
+    std::sort(sorted.begin(), sorted.end(), [](const Entry& a, const Entry& b) {
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    });
+    if (sorted.size() > k) {
+        sorted.resize(k);
+    }
+    return sorted;
+}
+
+size_t HeavyHitters::getBytes() const {
+    size_t bytes = MemorySizing::vectorBytes(entries) + MemorySizing::hashBucketBytes(positions.bucket_count()) +
+                   positions.size() * MemorySizing::hashNodeBytes<std::string, size_t>();
+    for (const Entry& entry : entries) {
+        bytes += 2 * MemorySizing::stringBytes(entry.key);  // Entry and index key
+    }
+    return bytes;
+}
+
+// HyperLogLog implementation
+HyperLogLog::HyperLogLog(int precision) : precision(precision), registers(size_t(1) << precision, 0) {
+}
+
+void HyperLogLog::add(uint64_t hash) {
+    size_t index = static_cast<size_t>(hash >> (64 - precision));
+    uint64_t rest = (hash << precision) | (uint64_t(1) << (precision - 1));  // Sentinel bounds the rank
+    uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    if (rank > registers[index]) {
+        registers[index] = rank;
+    }
+}
+
+double HyperLogLog::estimate() const {
+    double m = static_cast<double>(registers.size());
+    double sum = 0.0;
+    int zeros = 0;
+    for (uint8_t value : registers) {
+        sum += std::ldexp(1.0, -value);
+        zeros += (value == 0);
+    }
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double raw = alpha * m * m / sum;
+
+    // Linear counting is more accurate while many registers are still empty
+    if (raw <= 2.5 * m && zeros > 0) {
+        return m * std::log(m / zeros);
+    }
+    return raw;
+}
+
+bool HyperLogLog::merge(const HyperLogLog& other) {
+    if (precision != other.precision) {
+        return false;
+    }
+    for (size_t i = 0; i < registers.size(); ++i) {
+        registers[i] = std::max(registers[i], other.registers[i]);
+    }
+    return true;
+}
+
+// QuantileSketch implementation
+static const double QUANTILE_MIN_VALUE = 0.01;
+static const double QUANTILE_MAX_VALUE = 1e6;
+
+QuantileSketch::QuantileSketch(double relativeAccuracy)
+    : gamma((1.0 + relativeAccuracy) / (1.0 - relativeAccuracy)), logGamma(std::log(gamma)), count(0),
+      minValue(0.0), maxValue(0.0) {
+    minIndex = static_cast<int>(std::ceil(std::log(QUANTILE_MIN_VALUE) / logGamma));
+    int maxIndex = static_cast<int>(std::ceil(std::log(QUANTILE_MAX_VALUE) / logGamma));
+    buckets.assign(static_cast<size_t>(maxIndex - minIndex + 1), 0);
+}
+
+int QuantileSketch::bucketFor(double value) const {
+    if (value <= QUANTILE_MIN_VALUE) {
+        return 0;
+    }
+    int index = static_cast<int>(std::ceil(std::log(value) / logGamma)) - minIndex;
+    return std::min(index, static_cast<int>(buckets.size()) - 1);
+}
+
+void QuantileSketch::add(double value) {
+    buckets[bucketFor(value)]++;
+    minValue = count ? std::min(minValue, value) : value;
+    maxValue = count ? std::max(maxValue, value) : value;
+    count++;
+}
+
+double QuantileSketch::quantile(double q) const {
+    if (count == 0) {
+        return 0.0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * (count - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen > rank) {
+            // Midpoint of the bucket in relative terms, clamped to what was seen
+            double estimate = 2.0 * std::exp((static_cast<int>(i) + minIndex) * logGamma) / (gamma + 1.0);
+            return std::max(minValue, std::min(maxValue, estimate));
+        }
+    }
+    return maxValue;
+}
+
+bool QuantileSketch::merge(const QuantileSketch& other) {
+    if (buckets.size() != other.buckets.size() || gamma != other.gamma) {
+        return false;
+    }
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    if (other.count) {
+        minValue = count ? std::min(minValue, other.minValue) : other.minValue;
+        maxValue = count ? std::max(maxValue, other.maxValue) : other.maxValue;
+    }
+    count += other.count;
+    return true;
+}
+
+// SalesSketches implementation
+SalesSketches::SalesSketches() : sales(0) {
+}
+
+void SalesSketches::recordSale(const Transaction& transaction) {
+    for (const TransactionItem& item : transaction.getItems()) {
+        std::string productId = item.product->getId();
+        uint64_t keyHash = SketchHash::hash(productId);
+        units.add(keyHash, static_cast<uint32_t>(std::max(0LL, std::llround(item.quantity * 100.0))));
+        topProducts.offer(productId, units.estimate(keyHash));
+    }
+    if (transaction.getCustomer()) {
+        customers.add(SketchHash::hash(transaction.getCustomer()->getId()));
+    }
+    basketValue.add(transaction.getFinalTotal());
+    sales++;
+}
+
+void SalesSketches::merge(const SalesSketches& other) {
+    units.merge(other.units);
+    // Both sides' candidates are re-ranked against the combined counts
+    std::vector<HeavyHitters::Entry> candidates = topProducts.getEntries();
+    candidates.insert(candidates.end(), other.topProducts.getEntries().begin(), other.topProducts.getEntries().end());
+    for (const HeavyHitters::Entry& entry : candidates) {
+        topProducts.offer(entry.key, units.estimate(SketchHash::hash(entry.key)));
+    }
+    customers.merge(other.customers);
+    basketValue.merge(other.basketValue);
+    sales += other.sales;
+}
+
+double SalesSketches::estimateUnits(const std::string& productId) const {
+    return units.estimate(SketchHash::hash(productId)) / 100.0;
+}
+
+size_t SalesSketches::getBytes() const {
+    return units.getBytes() + topProducts.getBytes() + customers.getBytes() + basketValue.getBytes();
+}
+
+void SalesSketches::display(std::ostream& out, const std::string& title) const {
+    out << title << " (" << sales << " sales)" << std::endl;
+    if (sales == 0) {
+        out << "  no sales" << std::endl;
+        return;
+    }
+    out << "  Distinct Members: ~" << std::fixed << std::setprecision(0) << estimateDistinctCustomers() << std::endl;
+    out << "  Basket Value p50/p90/p99: $" << std::setprecision(2) << getBasketValueQuantile(0.50) << " / $"
+        << getBasketValueQuantile(0.90) << " / $" << getBasketValueQuantile(0.99) << std::endl;
+    out << "  Top SKUs by Units:" << std::endl;
+    for (const HeavyHitters::Entry& entry : getTopProducts(5)) {
+        out << "    " << std::left << std::setw(12) << entry.key << std::right << std::setw(10)
+            << estimateUnits(entry.key) << " units" << std::endl;
+    }
+}
+
+// LiveSalesSketches implementation
+LiveSalesSketches::LiveSalesSketches(int windowSeconds) : windowStart(0), windowSeconds(windowSeconds) {
+}
+
+void LiveSalesSketches::recordSale(const Transaction& transaction) {
+    std::time_t when = transaction.getTimestamp();
+    std::time_t window = when - when % windowSeconds;
+    if (window > windowStart) {
+        // Keep the window just finished only if it immediately precedes the new one
+        previous = (window == windowStart + windowSeconds) ? current : SalesSketches();
+        current = SalesSketches();
+        windowStart = window;
+    }
+    if (window == windowStart) {
+        current.recordSale(transaction);
+    } else if (window == windowStart - windowSeconds) {
+        previous.recordSale(transaction);  // Late arrival for the previous window
+    }
+    allTime.recordSale(transaction);
+}
+
+void LiveSalesSketches::display(std::ostream& out) const {
+    out << "\n" << std::string(60, '=') << std::endl;
+    out << "             LIVE SALES DASHBOARD             " << std::endl;
+    out << std::string(60, '=') << std::endl;
+    allTime.display(out, "Since Start");
+    current.display(out, "This Hour");
+    previous.display(out, "Previous Hour");
+    out << "(Approximate: counts can overestimate, quantiles within 1%)" << std::endl;
+    out << std::string(60, '=') << std::endl << std::endl;
+}
+
+void LiveSalesSketches::accountMemory(MemoryReport& report) const {
+    report.add("Sales sketches", "All-time sketches", allTime.getSaleCount(), allTime.getBytes());
+    report.add("Sales sketches", "Window sketches", current.getSaleCount() + previous.getSaleCount(),
+               current.getBytes() + previous.getBytes());
+}
@@ -0,0 +1,190 @@
+// ===== Sketches.h =====
+#ifndef SKETCHES_H
+#define SKETCHES_H
+
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Transaction;
+class MemoryReport;
+
+/**
+ * @brief 64-bit hashing shared by the sketches (FNV-1a, then a murmur finalizer)
+ */
+class SketchHash {
+public:
+    static uint64_t mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    static uint64_t hash(const std::string& text) {
+        uint64_t value = 0xcbf29ce484222325ULL;
+        for (unsigned char c : text) {
+            value = (value ^ c) * 0x100000001b3ULL;
+        }
+        return mix(value);
+    }
+};
+
+/**
+ * @brief Count-min sketch: per-key counts that never underestimate
+ *
+ * With width w and depth d an estimate exceeds the true count by more than
+ * e/w of the total with probability at most e^-d.
+ */
+class CountMinSketch {
+private:
+    int width;
+    int depth;
+    std::vector<uint32_t> counters;   // depth rows of width counters
+    uint64_t total;
+
+public:
+    CountMinSketch(int width = 2048, int depth = 4);
+
+    void add(uint64_t keyHash, uint32_t count = 1);
+    uint64_t estimate(uint64_t keyHash) const;
+    bool merge(const CountMinSketch& other);   // False if the shapes differ
+    uint64_t getTotal() const { return total; }
+    size_t getBytes() const { return counters.size() * sizeof(uint32_t); }
+};
+
+/**
+ * @brief Top-k keys ranked by count-min estimates
+ *
+ * A key is admitted only when its estimate beats the smallest tracked count,
+ * so a sale of a slow-moving SKU costs one lookup and one comparison.
+ */
+class HeavyHitters {
+public:
+    struct Entry {
+        std::string key;
+        uint64_t count;    // Estimate when last offered; never below the true count
+    };
+
+private:
+    size_t capacity;
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, size_t> positions;
+    size_t smallest;
+
+    void findSmallest();
+
+public:
+    explicit HeavyHitters(size_t capacity = 32);
+
+    void offer(const std::string& key, uint64_t estimate);
+    const std::vector<Entry>& getEntries() const { return entries; }
+    std::vector<Entry> top(size_t k) const;
+    size_t getBytes() const;
+};
+
+/**
+ * @brief HyperLogLog distinct counter, about 1.6% standard error at 2^12 registers
+ */
+class HyperLogLog {
+private:
+    int precision;
+    std::vector<uint8_t> registers;
+
+public:
+    explicit HyperLogLog(int precision = 12);
+
+    void add(uint64_t hash);
+    double estimate() const;
+    bool merge(const HyperLogLog& other);
+    size_t getBytes() const { return registers.size(); }
+};
+
+/**
+ * @brief Log-bucketed quantile sketch with bounded relative error
+ *
+ * Values fall into buckets whose bounds grow by a factor gamma, so every
+ * quantile is reported within 1% of its true value. Buckets are fixed for
+ * $0.01 to $1M, which keeps memory constant and merging a plain sum.
+ */
+class QuantileSketch {
+private:
+    double gamma;
+    double logGamma;
+    int minIndex;
+    std::vector<uint32_t> buckets;
+    uint64_t count;
+    double minValue;
+    double maxValue;
+
+    int bucketFor(double value) const;
+
+public:
+    explicit QuantileSketch(double relativeAccuracy = 0.01);
+
+    void add(double value);
+    double quantile(double q) const;
+    bool merge(const QuantileSketch& other);
+    uint64_t getCount() const { return count; }
+    size_t getBytes() const { return buckets.size() * sizeof(uint32_t); }
+};
+
+/**
+ * @brief The four sketches for one stream of finalized sales
+ *
+ * One instance per lane or window; instances merge by adding counters, so
+ * lanes record without sharing anything and are combined afterwards.
+ */
+class SalesSketches {
+private:
+    CountMinSketch units;       // Hundredths of a unit sold per SKU, so weighed goods count exactly
+    HeavyHitters topProducts;
+    HyperLogLog customers;      // Members only
+    QuantileSketch basketValue;
+    long sales;
+
+public:
+    SalesSketches();
+
+    void recordSale(const Transaction& transaction);
+    void merge(const SalesSketches& other);
+
+    long getSaleCount() const { return sales; }
+    double estimateUnits(const std::string& productId) const;
+    std::vector<HeavyHitters::Entry> getTopProducts(size_t k) const { return topProducts.top(k); }  // Hundredths
+    double estimateDistinctCustomers() const { return customers.estimate(); }
+    double getBasketValueQuantile(double q) const { return basketValue.quantile(q); }
+    size_t getBytes() const;
+
+    void display(std::ostream& out, const std::string& title) const;
+};
+
+/**
+ * @brief Sketches for the whole run plus the current and previous time window
+ */
+class LiveSalesSketches {
+private:
+    SalesSketches allTime;
+    SalesSketches current;
+    SalesSketches previous;
+    std::time_t windowStart;
+    int windowSeconds;
+
+public:
+    explicit LiveSalesSketches(int windowSeconds = 3600);
+
+    void recordSale(const Transaction& transaction);
+    const SalesSketches& getAllTime() const { return allTime; }
+    const SalesSketches& getCurrentWindow() const { return current; }
+    const SalesSketches& getPreviousWindow() const { return previous; }
+
+    void display(std::ostream& out) const;
+    void accountMemory(MemoryReport& report) const;
+};
+
+#endif // SKETCHES_H
@@ -0,0 +1,487 @@
+// ===== SnapshotCatalog.cpp =====
+#include "SnapshotCatalog.h"
+#include "Product.h"
+#include "Customer.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <thread>
+
+static const uint64_t PINNING = std::numeric_limits<uint64_t>::max();   // Slot claimed, epoch not yet chosen
+
+// SnapshotCatalog implementation
+SnapshotCatalog::SnapshotCatalog()
+    : ledger(nullptr), productPool(nullptr), customerPool(nullptr), ledgerPool(nullptr), visibleEpoch(1), commits(0),
+      versionsLive(0), versionsPooled(0), versionsReclaimed(0), pins(0), pinWaits(0) {
+    for (int i = 0; i < MAX_READERS; ++i) {
+        readerEpochs[i].store(0);
+    }
+    LedgerVersion* initial = new LedgerVersion();
+    initial->epoch = visibleEpoch.load();
+    initial->next.store(nullptr);
+    initial->sales = 0;
+    initial->revenue = 0.0;
+    initial->units = 0.0;
+    ledger.store(initial);
+    versionsLive++;
+}
+
+SnapshotCatalog::~SnapshotCatalog() {
+    for (ProductSlot* slot : products) {
+        release(slot->head.load());
+        delete slot;
+    }
+    for (CustomerSlot* slot : customers) {
+        release(slot->head.load());
+        delete slot;
+    }
+    release(ledger.load());
+    release(productPool);
+    release(customerPool);
+    release(ledgerPool);
+}
+
+template <typename Version>
+void SnapshotCatalog::release(Version* chain) {
+    while (chain) {
+        Version* next = chain->next.load(std::memory_order_relaxed);
+        delete chain;
+        chain = next;
+    }
+}
+
+void SnapshotCatalog::registerProduct(const Product* product) {
+    if (!product || productIndex.count(product)) {
+        return;
+    }
+    ProductSlot* slot = new ProductSlot();
+    slot->product = product;
+    slot->head.store(nullptr);
+    // Stamped with the visible epoch so every snapshot from now on sees it
+    publishProduct(*slot, 0.0, visibleEpoch.load(), visibleEpoch.load());
+    productIndex[product] = products.size();
+    products.push_back(slot);
+}
+
+void SnapshotCatalog::registerCustomer(const Customer* customer) {
+    if (!customer || customerIndex.count(customer)) {
+        return;
+    }
+    CustomerSlot* slot = new CustomerSlot();
+    slot->customer = customer;
+    CustomerVersion* version = new CustomerVersion();
+    version->epoch = visibleEpoch.load();
+    version->next.store(nullptr);
+    version->totalSpent = customer->getTotalSpent();
+    version->loyaltyPoints = customer->getLoyaltyPoints();
+    version->transactionCount = customer->getTransactionCount();
+    slot->head.store(version);
+    customerIndex[customer] = customers.size();
+    customers.push_back(slot);
+    versionsLive++;
+}
+
+void SnapshotCatalog::registerAll(const std::vector<Product*>& catalog, const std::vector<Customer*>& members) {
+    for (const Product* product : catalog) {
+        registerProduct(product);
+    }
+    for (const Customer* customer : members) {
+        registerCustomer(customer);
+    }
+}
+
+uint64_t SnapshotCatalog::oldestPinnedEpoch() const {
+    // Read before the slots: a reader that pins an older epoch after its slot
+    // was scanned sees the epoch has moved on and pins again
+    uint64_t oldest = visibleEpoch.load();
+    for (int i = 0; i < MAX_READERS; ++i) {
+        uint64_t pinned = readerEpochs[i].load();
+        if (pinned != 0 && pinned != PINNING) {
+            oldest = std::min(oldest, pinned);
+        }
+    }
+    return oldest;
+}
+
+template <typename Version>
+Version* SnapshotCatalog::trim(Version* head, uint64_t horizon) {
+    // Keep everything newer than the horizon and the first version at or below it
+    Version* keep = head;
+    while (keep && keep->epoch > horizon) {
+        keep = keep->next.load(std::memory_order_relaxed);
+    }
+    if (!keep) {
+        return nullptr;
+    }
+    Version* tail = keep->next.load(std::memory_order_relaxed);
+    keep->next.store(nullptr, std::memory_order_release);
+    return tail;
+}
+
+template <typename Version>
+Version* SnapshotCatalog::acquire(Version*& pool) {
+    Version* version = pool;
+    if (version) {
+        pool = version->next.load(std::memory_order_relaxed);
+        versionsPooled--;
+    } else {
+        version = new Version();
+    }
+    versionsLive++;
+    return version;
+}
+
+template <typename Version>
+void SnapshotCatalog::recycle(Version* chain, Version*& pool) {
+    // No reader can reach a trimmed tail, so its versions are reused at once
+    while (chain) {
+        Version* next = chain->next.load(std::memory_order_relaxed);
+        chain->next.store(pool, std::memory_order_relaxed);
+        pool = chain;
+        chain = next;
+        versionsLive--;
+        versionsPooled++;
+        versionsReclaimed++;
+    }
+}
+
+void SnapshotCatalog::publishProduct(ProductSlot& slot, double unitsSold, uint64_t epoch, uint64_t horizon) {
+    const Product& product = *slot.product;
+    ProductVersion* previous = slot.head.load(std::memory_order_relaxed);
+    ProductVersion* version = acquire(productPool);
+    version->epoch = epoch;
+    version->next.store(previous, std::memory_order_relaxed);
+    version->stock = product.getCurrentStock();
+    version->minStock = product.getMinStockLevel();
+    version->maxStock = product.getMaxStockLevel();
+    version->sellingPrice = product.calculateSellingPrice();
+    version->costPrice = product.getCostPrice();
+    version->unitsSold = (previous ? previous->unitsSold : 0.0) + unitsSold;   // Accumulates in commit order
+    version->active = product.getIsActive();
+    slot.head.store(version, std::memory_order_release);
+    recycle(trim(version, horizon), productPool);
+}
+
+uint64_t SnapshotCatalog::commitSale(const std::vector<std::pair<const Product*, double>>& lines,
+                                     const Customer* customer, double revenue) {
+    // The caller's locks keep the live objects still while they are copied
+    std::lock_guard<std::mutex> lock(commitMutex);
+    uint64_t epoch = visibleEpoch.load(std::memory_order_relaxed) + 1;
+    uint64_t horizon = oldestPinnedEpoch();
+
+    double units = 0.0;
+    for (const auto& line : lines) {
+        auto it = productIndex.find(line.first);
+        if (it != productIndex.end()) {
+            publishProduct(*products[it->second], line.second, epoch, horizon);
+            units += line.second;
+        }
+    }
+
+    auto member = customer ? customerIndex.find(customer) : customerIndex.end();
+    if (member != customerIndex.end()) {
+        CustomerSlot& slot = *customers[member->second];
+        CustomerVersion* version = acquire(customerPool);
+        version->epoch = epoch;
+        version->next.store(slot.head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        version->totalSpent = customer->getTotalSpent();
+        version->loyaltyPoints = customer->getLoyaltyPoints();
+        version->transactionCount = customer->getTransactionCount();
+        slot.head.store(version, std::memory_order_release);
+        recycle(trim(version, horizon), customerPool);
+    }
+
+    LedgerVersion* previous = ledger.load(std::memory_order_relaxed);
+    LedgerVersion* totals = acquire(ledgerPool);
+    totals->epoch = epoch;
+    totals->next.store(previous, std::memory_order_relaxed);
+    totals->sales = previous->sales + 1;
+    totals->revenue = previous->revenue + revenue;
+    totals->units = previous->units + units;
+    ledger.store(totals, std::memory_order_release);
+    recycle(trim(totals, horizon), ledgerPool);
+
+    // Everything is linked; readers may now pin this epoch
+    visibleEpoch.store(epoch);
+    commits++;
+    return epoch;
+}
+
+uint64_t SnapshotCatalog::commitProducts(const std::vector<const Product*>& changed) {
+    std::lock_guard<std::mutex> lock(commitMutex);
+    uint64_t epoch = visibleEpoch.load(std::memory_order_relaxed) + 1;
+    uint64_t horizon = oldestPinnedEpoch();
+    for (const Product* product : changed) {
+        auto it = productIndex.find(product);
+        if (it != productIndex.end()) {
+            publishProduct(*products[it->second], 0.0, epoch, horizon);
+        }
+    }
+    visibleEpoch.store(epoch);
+    commits++;
+    return epoch;
+}
+
+int SnapshotCatalog::pin(uint64_t& epoch) {
+    pins++;
+    int slot = -1;
+    for (bool waited = false; slot < 0; ) {
+        for (int i = 0; i < MAX_READERS && slot < 0; ++i) {
+            uint64_t expected = 0;
+            if (readerEpochs[i].compare_exchange_strong(expected, PINNING)) {
+                slot = i;
+            }
+        }
+        if (slot < 0) {
+            if (!waited) {
+                pinWaits++;
+                waited = true;
+            }
+            std::this_thread::yield();   // Only other readers hold slots
+        }
+    }
+
+    // Publish the epoch, then check no commit trimmed against an older view in between
+    do {
+        epoch = visibleEpoch.load();
+        readerEpochs[slot].store(epoch);
+    } while (visibleEpoch.load() != epoch);
+    return slot;
+}
+
+void SnapshotCatalog::unpin(int slot) {
+    readerEpochs[slot].store(0);
+}
+
+SnapshotStats SnapshotCatalog::getStats() const {
+    std::lock_guard<std::mutex> lock(commitMutex);
+    SnapshotStats stats;
+    stats.epoch = visibleEpoch.load();
+    stats.commits = commits;
+    stats.versionsLive = versionsLive;
+    stats.versionsPooled = versionsPooled;
+    stats.versionsReclaimed = versionsReclaimed;
+    stats.pins = pins.load();
+    stats.pinWaits = pinWaits.load();
+    return stats;
+}
+
+size_t SnapshotCatalog::getAllocatedBytes() const {
+    // Versions are counted at the product size; the other kinds are no larger
+    SnapshotStats stats = getStats();
+    size_t bytes = static_cast<size_t>(stats.versionsLive + stats.versionsPooled) *
+                   MemorySizing::allocation(sizeof(ProductVersion));
+    bytes += products.size() * (MemorySizing::allocation(sizeof(ProductSlot)) + sizeof(ProductSlot*) +
+                                MemorySizing::hashNodeBytes<const Product*, size_t>());
+    bytes += customers.size() * (MemorySizing::allocation(sizeof(CustomerSlot)) + sizeof(CustomerSlot*) +
+                                 MemorySizing::hashNodeBytes<const Customer*, size_t>());
+    return bytes;
+}
+
+void SnapshotCatalog::display(std::ostream& out) const {
+    SnapshotStats stats = getStats();
+    out << "Snapshot catalog: " << products.size() << " products, " << customers.size() << " customers, epoch "
+        << stats.epoch << " after " << stats.commits << " commits" << std::endl;
+    out << "Versions: " << stats.versionsLive << " live, " << stats.versionsPooled << " pooled ("
+        << MemoryReport::formatBytes(getAllocatedBytes()) << "), " << stats.versionsReclaimed << " reclaimed; "
+        << stats.pins << " snapshots pinned, " << stats.pinWaits << " waited for a reader slot" << std::endl;
+}
+
+// CatalogSnapshot implementation
+CatalogSnapshot::CatalogSnapshot(SnapshotCatalog& catalog) : catalog(catalog), slot(-1), epoch(0) {
+    slot = catalog.pin(epoch);
+}
+
+CatalogSnapshot::~CatalogSnapshot() {
+    catalog.unpin(slot);
+}
+
+template <typename Version>
+const Version* CatalogSnapshot::visible(const Version* head, uint64_t epoch) {
+    while (head && head->epoch > epoch) {
+        head = head->next.load(std::memory_order_acquire);
+    }
+    return head;
+}
+
+const ProductVersion* CatalogSnapshot::getProduct(size_t index) const {
+    return visible(catalog.products[index]->head.load(std::memory_order_acquire), epoch);
+}
+
+const CustomerVersion* CatalogSnapshot::getCustomer(size_t index) const {
+    return visible(catalog.customers[index]->head.load(std::memory_order_acquire), epoch);
+}
+
+const LedgerVersion& CatalogSnapshot::getLedger() const {
+    return *visible(catalog.ledger.load(std::memory_order_acquire), epoch);
+}
+
+double CatalogSnapshot::getTotalInventoryValue() const {
+    double total = 0.0;
+    for (size_t i = 0; i < catalog.products.size(); ++i) {
+        const ProductVersion* version = getProduct(i);
+        if (version) {
+            total += version->sellingPrice * version->stock;
+        }
+    }
+    return total;
+}
+
+double CatalogSnapshot::getTotalInventoryCost() const {
+    double total = 0.0;
+    for (size_t i = 0; i < catalog.products.size(); ++i) {
+        const ProductVersion* version = getProduct(i);
+        if (version) {
+            total += version->costPrice * version->stock;
+        }
+    }
+    return total;
+}
+
+double CatalogSnapshot::getTotalCustomerSpending() const {
+    double total = 0.0;
+    for (size_t i = 0; i < catalog.customers.size(); ++i) {
+        const CustomerVersion* version = getCustomer(i);
+        if (version) {
+            total += version->totalSpent;
+        }
+    }
+    return total;
+}
+
+double CatalogSnapshot::getTotalUnitsSold() const {
+    double total = 0.0;
+    for (size_t i = 0; i < catalog.products.size(); ++i) {
+        const ProductVersion* version = getProduct(i);
+        if (version) {
+            total += version->unitsSold;
+        }
+    }
+    return total;
+}
+
+void CatalogSnapshot::generateInventoryReport(std::ostream& out) const {
+    int total = 0;
+    int active = 0;
+    int lowStock = 0;
+    int outOfStock = 0;
+    int overstocked = 0;
+    double value = 0.0;
+    double cost = 0.0;
+    for (size_t i = 0; i < catalog.products.size(); ++i) {
+        const ProductVersion* version = getProduct(i);
+        if (!version) {
+            continue;
+        }
+        total++;
+        value += version->sellingPrice * version->stock;
+        cost += version->costPrice * version->stock;
+        if (!version->active) {
+            continue;
+        }
+        active++;
+        if (version->stock == 0) {
+            outOfStock++;
+        } else if (version->stock <= version->minStock) {
+            lowStock++;
+        }
+        if (version->stock >= version->maxStock * 0.9) {
+            overstocked++;
+        }
+    }
+
+    out << "\n" << std::string(60, '=') << std::endl;
+    out << "                INVENTORY REPORT                " << std::endl;
+    out << std::string(60, '=') << std::endl;
+    out << "Snapshot Epoch: " << epoch << std::endl;
+    out << "Total Products: " << total << std::endl;
+    out << "Active Products: " << active << std::endl;
+    out << "Total Inventory Value: $" << std::fixed << std::setprecision(2) << value << std::endl;
+    out << "Total Inventory Cost: $" << std::fixed << std::setprecision(2) << cost << std::endl;
+    out << "Potential Profit: $" << std::fixed << std::setprecision(2) << value - cost << std::endl;
+    out << "\nStock Status:" << std::endl;
+    out << "  Low Stock Items: " << lowStock << std::endl;
+    out << "  Out of Stock Items: " << outOfStock << std::endl;
+    out << "  Overstocked Items: " << overstocked << std::endl;
+    out << std::string(60, '=') << std::endl << std::endl;
+}
+
+void CatalogSnapshot::generateProfitabilityReport(std::ostream& out) const {
+    struct Row {
+        size_t index;
+        double profit;
+        double margin;
+    };
+    std::vector<Row> active;
+    double potentialProfit = 0.0;
+    for (size_t i = 0; i < catalog.products.size(); ++i) {
+        const ProductVersion* version = getProduct(i);
+        if (!version) {
+            continue;
+        }
+        double profit = (version->sellingPrice - version->costPrice) * version->stock;
+        potentialProfit += profit;
+        if (version->active) {
+            double margin = version->costPrice == 0
+                                ? 0.0 : (version->sellingPrice - version->costPrice) / version->costPrice * 100;
+            Row row = { i, profit, margin };
+            active.push_back(row);
+        }
+    }
+
+    out << "\n" << std::string(60, '=') << std::endl;
+    out << "              PROFITABILITY REPORT              " << std::endl;
+    out << std::string(60, '=') << std::endl;
+    out << "Snapshot Epoch: " << epoch << std::endl;
+    out << "Potential Profit: $" << std::fixed << std::setprecision(2) << potentialProfit << std::endl;
+
+    size_t shown = std::min<size_t>(10, active.size());
+    std::partial_sort(active.begin(), active.begin() + shown, active.end(),
+                      [](const Row& a, const Row& b) { return a.profit > b.profit; });
+    out << "\nTop " << shown << " Products by Potential Profit:" << std::endl;
+    for (size_t i = 0; i < shown; ++i) {
+        const Product* product = getProductObject(active[i].index);
+        out << "  " << product->getId() << " - " << product->getName() << " | Profit: $" << std::fixed
+            << std::setprecision(2) << active[i].profit << " | Margin: " << std::fixed << std::setprecision(1)
+            << active[i].margin << "%" << std::endl;
+    }
+
+    std::partial_sort(active.begin(), active.begin() + shown, active.end(),
+                      [](const Row& a, const Row& b) { return a.margin < b.margin; });
+    out << "\nLowest " << shown << " Margins:" << std::endl;
+    for (size_t i = 0; i < shown; ++i) {
+        const Product* product = getProductObject(active[i].index);
+        out << "  " << product->getId() << " - " << product->getName() << " | Margin: " << std::fixed
+            << std::setprecision(1) << active[i].margin << "%" << std::endl;
+    }
+    out << std::string(60, '=') << std::endl << std::endl;
+}
+
+void CatalogSnapshot::generateFinancialSummary(std::ostream& out) const {
+    double value = getTotalInventoryValue();
+    double cost = getTotalInventoryCost();
+    double potentialProfit = value - cost;
+    const LedgerVersion& totals = getLedger();
+
+    out << "\n" << std::string(60, '=') << std::endl;
+    out << "              FINANCIAL SUMMARY             " << std::endl;
+    out << std::string(60, '=') << std::endl;
+    out << "Snapshot Epoch: " << epoch << std::endl;
+    out << "INVENTORY:" << std::endl;
+    out << "Total Inventory Value: $" << std::fixed << std::setprecision(2) << value << std::endl;
+    out << "Total Inventory Cost: $" << std::fixed << std::setprecision(2) << cost << std::endl;
+    out << "Potential Profit: $" << std::fixed << std::setprecision(2) << potentialProfit << std::endl;
+    if (cost > 0) {
+        out << "Profit Margin: " << std::fixed << std::setprecision(1) << (potentialProfit / cost) * 100 << "%"
+            << std::endl;
+    }
+    out << "\nSALES:" << std::endl;
+    out << "Sales Since Attach: " << totals.sales << std::endl;
+    out << "Sales Revenue Since Attach: $" << std::fixed << std::setprecision(2) << totals.revenue << std::endl;
+    out << "\nCUSTOMERS:" << std::endl;
+    out << "Total Customer Spending: $" << std::fixed << std::setprecision(2) << getTotalCustomerSpending()
+        << std::endl;
+    out << std::string(60, '=') << std::endl << std::endl;
+}
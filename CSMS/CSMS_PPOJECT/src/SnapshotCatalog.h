@@ -0,0 +1,213 @@
+// ===== SnapshotCatalog.h =====
+#ifndef SNAPSHOT_CATALOG_H
+#define SNAPSHOT_CATALOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Product;
+class Customer;
+
+/**
+ * @brief A product's reportable values as of one commit
+ */
+struct ProductVersion {
+    uint64_t epoch;
+    std::atomic<ProductVersion*> next;   // Older version
+    int stock;
+    int minStock;
+    int maxStock;
+    double sellingPrice;
+    double costPrice;
+    double unitsSold;                    // Cumulative since the catalog was attached
+    bool active;
+};
+
+/**
+ * @brief A member's running totals as of one commit
+ */
+struct CustomerVersion {
+    uint64_t epoch;
+    std::atomic<CustomerVersion*> next;
+    double totalSpent;
+    double loyaltyPoints;
+    int transactionCount;
+};
+
+/**
+ * @brief Store-wide sales totals as of one commit
+ */
+struct LedgerVersion {
+    uint64_t epoch;
+    std::atomic<LedgerVersion*> next;
+    long sales;
+    double revenue;
+    double units;
+};
+
+/**
+ * @brief Counters for the catalog's lifetime
+ */
+struct SnapshotStats {
+    uint64_t epoch;          // Last committed
+    long commits;
+    long versionsLive;
+    long versionsPooled;     // Reclaimed and kept for reuse
+    long versionsReclaimed;
+    long pins;
+    long pinWaits;           // Pins that found every reader slot taken
+};
+
+class CatalogSnapshot;
+
+/**
+ * @brief Multi-version copy of the values reports read, for reading while lanes sell
+ *
+ * Every product, member and the store ledger keeps a chain of versions,
+ * newest first, each stamped with the epoch of the commit that wrote it.
+ * A sale commits once, after it has updated the live objects and while it
+ * still holds their locks: the catalog copies their new values into fresh
+ * versions, stamps them all with the next epoch and only then makes that
+ * epoch visible, so a reader sees all of a sale or none of it.
+ *
+ * A report pins the last visible epoch and reads, for each object, the
+ * newest version no later than it. Readers take no lock and never wait for
+ * writers; writers never wait for readers. Commits are ordered by one short
+ * mutex that covers copying the values and linking the versions.
+ *
+ * Old versions are reclaimed by epoch: a commit trims the chains it touches
+ * below the oldest epoch any reader still has pinned, keeping the one
+ * version that reader needs. A reader can never walk past that version, so
+ * the trimmed tail is reusable at once; it goes to a pool the next commits
+ * take their versions from, so steady selling does not allocate.
+ *
+ * Objects are registered before selling starts; registration is not safe
+ * against concurrent commits.
+ */
+class SnapshotCatalog {
+public:
+    static const int MAX_READERS = 16;
+
+private:
+    struct ProductSlot {
+        const Product* product;
+        std::atomic<ProductVersion*> head;
+    };
+    struct CustomerSlot {
+        const Customer* customer;
+        std::atomic<CustomerVersion*> head;
+    };
+
+    std::vector<ProductSlot*> products;
+    std::vector<CustomerSlot*> customers;
+    std::unordered_map<const Product*, size_t> productIndex;
+    std::unordered_map<const Customer*, size_t> customerIndex;
+    std::atomic<LedgerVersion*> ledger;
+    ProductVersion* productPool;       // Trimmed versions waiting for reuse, guarded by commitMutex
+    CustomerVersion* customerPool;
+    LedgerVersion* ledgerPool;
+
+    mutable std::mutex commitMutex;
+    std::atomic<uint64_t> visibleEpoch;
+    std::atomic<uint64_t> readerEpochs[MAX_READERS];   // 0 = free
+
+    long commits;                      // Writer-side counters, guarded by commitMutex
+    long versionsLive;
+    long versionsPooled;
+    long versionsReclaimed;
+    std::atomic<long> pins;
+    std::atomic<long> pinWaits;
+
+    uint64_t oldestPinnedEpoch() const;
+    void publishProduct(ProductSlot& slot, double unitsSold, uint64_t epoch, uint64_t horizon);
+    template <typename Version>
+    Version* trim(Version* head, uint64_t horizon);
+    template <typename Version>
+    Version* acquire(Version*& pool);
+    template <typename Version>
+    void recycle(Version* chain, Version*& pool);
+    template <typename Version>
+    void release(Version* chain);
+
+    int pin(uint64_t& epoch);
+    void unpin(int slot);
+
+    friend class CatalogSnapshot;
+
+public:
+    SnapshotCatalog();
+    ~SnapshotCatalog();
+
+    SnapshotCatalog(const SnapshotCatalog&) = delete;
+    SnapshotCatalog& operator=(const SnapshotCatalog&) = delete;
+
+    void registerProduct(const Product* product);
+    void registerCustomer(const Customer* customer);
+    void registerAll(const std::vector<Product*>& catalog, const std::vector<Customer*>& members);
+
+    /**
+     * @brief Publishes one sale: new versions of the given products (sold lines
+     *        as (product, quantity)) and member, and the ledger
+     *
+     * Call after the live objects are updated, while holding their locks.
+     * Unregistered objects are skipped. Returns the sale's epoch.
+     */
+    uint64_t commitSale(const std::vector<std::pair<const Product*, double>>& lines, const Customer* customer,
+                        double revenue);
+
+    // Publishes products whose stock or price changed outside a sale
+    uint64_t commitProducts(const std::vector<const Product*>& changed);
+
+    uint64_t getVisibleEpoch() const { return visibleEpoch.load(); }
+    size_t getProductCount() const { return products.size(); }
+    size_t getCustomerCount() const { return customers.size(); }
+    SnapshotStats getStats() const;
+    size_t getAllocatedBytes() const;
+    void display(std::ostream& out) const;
+};
+
+/**
+ * @brief A pinned epoch of a SnapshotCatalog; unpins when destroyed
+ *
+ * Reports rendered from one snapshot agree with each other however long
+ * they take. Keep snapshots short-lived: versions newer than the oldest
+ * pinned one cannot be reclaimed while it is held.
+ */
+class CatalogSnapshot {
+private:
+    SnapshotCatalog& catalog;
+    int slot;
+    uint64_t epoch;
+
+    template <typename Version>
+    static const Version* visible(const Version* head, uint64_t epoch);
+
+public:
+    explicit CatalogSnapshot(SnapshotCatalog& catalog);
+    ~CatalogSnapshot();
+
+    CatalogSnapshot(const CatalogSnapshot&) = delete;
+    CatalogSnapshot& operator=(const CatalogSnapshot&) = delete;
+
+    uint64_t getEpoch() const { return epoch; }
+    const ProductVersion* getProduct(size_t index) const;     // nullptr if registered after the snapshot
+    const CustomerVersion* getCustomer(size_t index) const;
+    const Product* getProductObject(size_t index) const { return catalog.products[index]->product; }
+    const LedgerVersion& getLedger() const;
+
+    double getTotalInventoryValue() const;
+    double getTotalInventoryCost() const;
+    double getTotalCustomerSpending() const;
+    double getTotalUnitsSold() const;   // Summed over products; equals the ledger's units in every snapshot
+
+    // Same layouts as the live reports, read from the snapshot
+    void generateInventoryReport(std::ostream& out) const;
+    void generateProfitabilityReport(std::ostream& out) const;
+    void generateFinancialSummary(std::ostream& out) const;
+};
+
+#endif // SNAPSHOT_CATALOG_H
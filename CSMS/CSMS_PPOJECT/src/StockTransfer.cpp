@@ -0,0 +1,194 @@
+// ===== StockTransfer.cpp =====
+#include "StockTransfer.h"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+std::atomic<int> StockTransfer::nextTransferId(1);
+
+// StockTransfer implementation
+StockTransfer::StockTransfer(InventoryManager& source, const std::string& sourceName,
+                             InventoryManager& destination, const std::string& destinationName)
+    : transferId(nextTransferId++), source(source), destination(destination), sourceName(sourceName),
+      destinationName(destinationName), status(TransferStatus::OPEN), created(std::time(nullptr)) {
+}
+
+StockTransfer::~StockTransfer() {
+    abort();
+}
+
+bool StockTransfer::addLine(const std::string& productId, int quantity) {
+    if (status != TransferStatus::OPEN || quantity <= 0) {
+        return false;
+    }
+    auto it = lineIndex.find(productId);
+    if (it != lineIndex.end()) {
+        lines[it->second].quantity += quantity;
+        return true;
+    }
+    lineIndex[productId] = lines.size();
+    lines.push_back(TransferLine{ productId, quantity, nullptr, nullptr });
+    return true;
+}
+
+void StockTransfer::releaseAll(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        lines[i].source->releaseOutgoing(lines[i].quantity);
+        lines[i].destination->releaseIncoming(lines[i].quantity);
+    }
+}
+
+bool StockTransfer::prepare() {
+    if (status != TransferStatus::OPEN) {
+        return false;
+    }
+    if (&source == &destination) {
+        failure = "source and destination are the same store";
+        status = TransferStatus::ABORTED;
+        return false;
+    }
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        TransferLine& line = lines[i];
+        line.source = source.findProduct(line.productId);
+        line.destination = destination.findProduct(line.productId);
+        if (!line.source || !line.destination) {
+            failure = line.productId + " is not stocked at " + (line.source ? destinationName : sourceName);
+        } else if (!line.source->reserveOutgoing(line.quantity)) {
+            failure = line.productId + ": only " + std::to_string(line.source->getAvailableStock()) +
+                      " available at " + sourceName;
+        } else if (!line.destination->reserveIncoming(line.quantity)) {
+            line.source->releaseOutgoing(line.quantity);
+            failure = line.productId + ": room for only " + std::to_string(line.destination->getFreeCapacity()) +
+                      " at " + destinationName;
+        } else {
+            continue;
+        }
+        releaseAll(i);
+        status = TransferStatus::ABORTED;
+        return false;
+    }
+    status = TransferStatus::PREPARED;
+    return true;
+}
+
+bool StockTransfer::commit() {
+    if (status != TransferStatus::PREPARED) {
+        return false;
+    }
+    std::vector<const Product*> sent;
+    std::vector<const Product*> received;
+    sent.reserve(lines.size());
+    received.reserve(lines.size());
+    for (TransferLine& line : lines) {
+        line.source->commitOutgoing(line.quantity);
+        line.destination->commitIncoming(line.quantity);
+        sent.push_back(line.source);
+        received.push_back(line.destination);
+    }
+    source.recordStockChanges(sent);
+    destination.recordStockChanges(received);
+    status = TransferStatus::COMMITTED;
+    return true;
+}
+
+void StockTransfer::abort() {
+    if (status == TransferStatus::PREPARED) {
+        releaseAll(lines.size());
+    }
+    if (status != TransferStatus::COMMITTED) {
+        status = TransferStatus::ABORTED;
+    }
+}
+
+std::string StockTransfer::getStatusString() const {
+    switch (status) {
+    case TransferStatus::OPEN: return "Open";
+    case TransferStatus::PREPARED: return "Prepared";
+    case TransferStatus::COMMITTED: return "Committed";
+    case TransferStatus::ABORTED: return "Aborted";
+    default: return "Unknown";
+    }
+}
+
+long StockTransfer::getTotalUnits() const {
+    long units = 0;
+    for (const TransferLine& line : lines) {
+        units += line.quantity;
+    }
+    return units;
+}
+
+void StockTransfer::display(std::ostream& out) const {
+    char when[20];
+    std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M", std::localtime(&created));
+    out << "Transfer #" << transferId << " " << sourceName << " -> " << destinationName << " (" << when << "): "
+        << lines.size() << " SKUs, " << getTotalUnits() << " units, " << getStatusString();
+    if (!failure.empty()) {
+        out << " - " << failure;
+    }
+    out << std::endl;
+}
+
+// RebalancePlanner implementation
+std::vector<TransferProposal> RebalancePlanner::plan(const std::vector<StoreInventory>& stores) {
+    std::vector<TransferProposal> proposals;
+    std::map<std::pair<size_t, std::string>, int> committedOut;   // Planned units leaving a donor
+
+    for (size_t to = 0; to < stores.size(); ++to) {
+        for (Product* product : stores[to].inventory->getLowStockProducts()) {
+            int target = (product->getMinStockLevel() + product->getMaxStockLevel()) / 2;
+            int need = std::min(target - product->getCurrentStock() - product->getIncomingStock(),
+                                product->getFreeCapacity());
+            if (need <= 0) {
+                continue;
+            }
+
+            // Donors with the most to spare first
+            std::vector<std::pair<int, size_t>> donors;
+            for (size_t from = 0; from < stores.size(); ++from) {
+                if (from == to) {
+                    continue;
+                }
+                Product* donor = stores[from].inventory->findProduct(product->getId());
+                if (!donor || !donor->getIsActive()) {
+                    continue;
+                }
+                int donorTarget = (donor->getMinStockLevel() + donor->getMaxStockLevel()) / 2;
+                int spare = donor->getAvailableStock() - donorTarget -
+                            committedOut[std::make_pair(from, product->getId())];
+                if (spare > 0) {
+                    donors.push_back(std::make_pair(spare, from));
+                }
+            }
+            std::sort(donors.rbegin(), donors.rend());
+
+            for (const auto& donor : donors) {
+                int quantity = std::min(need, donor.first);
+                proposals.push_back(TransferProposal{ donor.second, to, product->getId(), quantity });
+                committedOut[std::make_pair(donor.second, product->getId())] += quantity;
+                need -= quantity;
+                if (need == 0) {
+                    break;
+                }
+            }
+        }
+    }
+    return proposals;
+}
+
+std::vector<StockTransfer*> RebalancePlanner::buildTransfers(const std::vector<StoreInventory>& stores,
+                                                             const std::vector<TransferProposal>& proposals) {
+    std::vector<StockTransfer*> transfers;
+    std::map<std::pair<size_t, size_t>, StockTransfer*> byRoute;
+    for (const TransferProposal& proposal : proposals) {
+        StockTransfer*& transfer = byRoute[std::make_pair(proposal.from, proposal.to)];
+        if (!transfer) {
+            transfer = new StockTransfer(*stores[proposal.from].inventory, stores[proposal.from].name,
+                                         *stores[proposal.to].inventory, stores[proposal.to].name);
+            transfers.push_back(transfer);
+        }
+        transfer->addLine(proposal.productId, proposal.quantity);
+    }
+    return transfers;
+}
@@ -0,0 +1,111 @@
+// ===== StockTransfer.h =====
+#ifndef STOCK_TRANSFER_H
+#define STOCK_TRANSFER_H
+
+#include "InventoryManager.h"
+#include <atomic>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class TransferStatus {
+    OPEN,        // Lines can still be added
+    PREPARED,    // Every line reserved at both stores
+    COMMITTED,
+    ABORTED
+};
+
+/**
+ * @brief One SKU moving between stores
+ */
+struct TransferLine {
+    std::string productId;
+    int quantity;
+    Product* source;         // Resolved by prepare()
+    Product* destination;
+};
+
+/**
+ * @brief Stock moved between two stores' inventories as one unit
+ *
+ * prepare() reserves every line: the units at the source, which sales can
+ * then no longer take, and the shelf space at the destination. If any line
+ * cannot be reserved, nothing stays reserved. commit() then cannot fail;
+ * abort() releases the reservations. A transfer may cover any number of
+ * SKUs, and each product appears at most once.
+ */
+class StockTransfer {
+private:
+    static std::atomic<int> nextTransferId;     // Transfers may be started from several threads
+
+    int transferId;
+    InventoryManager& source;
+    InventoryManager& destination;
+    std::string sourceName;
+    std::string destinationName;
+    std::vector<TransferLine> lines;
+    std::unordered_map<std::string, size_t> lineIndex;
+    TransferStatus status;
+    std::string failure;          // Why prepare() failed
+    std::time_t created;
+
+    void releaseAll(size_t count);
+
+public:
+    StockTransfer(InventoryManager& source, const std::string& sourceName,
+                  InventoryManager& destination, const std::string& destinationName);
+    ~StockTransfer();             // Aborts a prepared transfer
+
+    bool addLine(const std::string& productId, int quantity);   // Merges repeated products
+    bool prepare();
+    bool commit();
+    void abort();
+
+    int getId() const { return transferId; }
+    TransferStatus getStatus() const { return status; }
+    std::string getStatusString() const;
+    const std::string& getFailure() const { return failure; }
+    const std::vector<TransferLine>& getLines() const { return lines; }
+    long getTotalUnits() const;
+
+    void display(std::ostream& out) const;
+};
+
+/**
+ * @brief A store's inventory under the name used in transfer plans
+ */
+struct StoreInventory {
+    std::string name;
+    InventoryManager* inventory;
+};
+
+/**
+ * @brief One proposed movement of a product between stores
+ */
+struct TransferProposal {
+    size_t from;                  // Indexes into the planned stores
+    size_t to;
+    std::string productId;
+    int quantity;
+};
+
+/**
+ * @brief Proposes transfers that lift low-stock products from other stores' surplus
+ *
+ * For each store's low-stock products, the shortfall to the middle of the
+ * product's min/max range is covered from the stores holding the most
+ * available stock above their own midpoint. Products not stocked at a
+ * store are not sent there.
+ */
+class RebalancePlanner {
+public:
+    static std::vector<TransferProposal> plan(const std::vector<StoreInventory>& stores);
+
+    // One transfer per source/destination pair, ready to prepare
+    static std::vector<StockTransfer*> buildTransfers(const std::vector<StoreInventory>& stores,
+                                                      const std::vector<TransferProposal>& proposals);
+};
+
+#endif // STOCK_TRANSFER_H
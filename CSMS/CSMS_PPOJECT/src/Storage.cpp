@@ -0,0 +1,634 @@
+// ===== Storage.cpp =====
+#include "Storage.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+// Page 0 holds the file header: magic, page count and the catalog
+static const char STORAGE_MAGIC[8] = { 'C', 'S', 'M', 'S', 'B', 'T', '0', '1' };
+static const size_t CATALOG_NAME_SIZE = 32;
+static const size_t CATALOG_ENTRY_SIZE = CATALOG_NAME_SIZE + 4 + 8;
+static const size_t MAX_CATALOG_ENTRIES = (STORAGE_PAGE_SIZE - 16) / CATALOG_ENTRY_SIZE;
+
+// Node layout: type, count, start of cell area and a link (next leaf, or
+// the leftmost child of an internal node), then the slot array growing up
+// and cells growing down from the end of the page. A cell is key length,
+// value length, key, value; an internal cell's value is its child page.
+static const size_t NODE_HEADER_SIZE = 12;
+static const uint8_t LEAF_NODE = 1;
+static const uint8_t INTERNAL_NODE = 2;
+
+template <typename T>
+static T load(const char* data, size_t offset) {
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+static void store(char* data, size_t offset, T value) {
+    std::memcpy(data + offset, &value, sizeof(T));
+}
+
+// Pager implementation
+Pager::Pager() : pageCount(0), reads(0), writes(0) {
+}
+
+bool Pager::open(const std::string& path) {
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file.is_open()) {
+        std::ofstream create(path, std::ios::binary);
+        if (!create) {
+            return false;
+        }
+        create.close();
+        file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+    }
+    file.seekg(0, std::ios::end);
+    pageCount = static_cast<PageId>(static_cast<size_t>(file.tellg()) / STORAGE_PAGE_SIZE);
+    return true;
+}
+
+void Pager::close() {
+    if (file.is_open()) {
+        file.close();
+    }
+    pageCount = 0;
+}
+
+PageId Pager::allocate() {
+    static const char zeroes[STORAGE_PAGE_SIZE] = {};
+    PageId id = pageCount++;
+    write(id, zeroes);
+    return id;
+}
+
+void Pager::read(PageId id, char* buffer) {
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(id) * STORAGE_PAGE_SIZE);
+    file.read(buffer, STORAGE_PAGE_SIZE);
+    if (file.gcount() != static_cast<std::streamsize>(STORAGE_PAGE_SIZE)) {
+        throw std::runtime_error("storage: short read of page " + std::to_string(id));
+    }
+    reads++;
+}
+
+void Pager::write(PageId id, const char* buffer) {
+    file.clear();
+    file.seekp(static_cast<std::streamoff>(id) * STORAGE_PAGE_SIZE);
+    file.write(buffer, STORAGE_PAGE_SIZE);
+    if (!file) {
+        throw std::runtime_error("storage: cannot write page " + std::to_string(id));
+    }
+    writes++;
+}
+
+void Pager::sync() {
+    file.flush();
+}
+
+// BufferPool implementation
+BufferPool::BufferPool(Pager& pager, size_t capacityPages)
+    : pager(pager), memory(std::max<size_t>(capacityPages, 16) * STORAGE_PAGE_SIZE),
+      frames(std::max<size_t>(capacityPages, 16), Frame{ INVALID_PAGE, 0, false, false }),
+      hand(0), hits(0), misses(0), evictions(0) {
+    resident.reserve(frames.size());
+}
+
+size_t BufferPool::claimFrame() {
+    // CLOCK: a referenced frame gets a second chance before it is evicted
+    for (size_t step = 0; step < 2 * frames.size() + 1; ++step) {
+        size_t index = hand;
+        hand = (hand + 1) % frames.size();
+        Frame& frame = frames[index];
+        if (frame.pins > 0) {
+            continue;
+        }
+        if (frame.page != INVALID_PAGE && frame.referenced) {
+            frame.referenced = false;
+            continue;
+        }
+        if (frame.page != INVALID_PAGE) {
+            if (frame.dirty) {
+                pager.write(frame.page, frameData(index));
+            }
+            resident.erase(frame.page);
+            evictions++;
+        }
+        frame = Frame{ INVALID_PAGE, 0, false, false };
+        return index;
+    }
+    throw std::runtime_error("storage: every buffer pool frame is pinned");
+}
+
+char* BufferPool::pin(PageId id) {
+    auto it = resident.find(id);
+    if (it != resident.end()) {
+        Frame& frame = frames[it->second];
+        frame.pins++;
+        frame.referenced = true;
+        hits++;
+        return frameData(it->second);
+    }
+
+    misses++;
+    size_t index = claimFrame();
+    pager.read(id, frameData(index));
+    frames[index] = Frame{ id, 1, false, true };
+    resident[id] = index;
+    return frameData(index);
+}
+
+char* BufferPool::pinNew(PageId& id) {
+    size_t index = claimFrame();
+    id = pager.allocate();
+    std::memset(frameData(index), 0, STORAGE_PAGE_SIZE);
+    frames[index] = Frame{ id, 1, true, true };
+    resident[id] = index;
+    return frameData(index);
+}
+
+void BufferPool::unpin(PageId id, bool dirty) {
+    auto it = resident.find(id);
+    if (it == resident.end()) {
+        return;
+    }
+    Frame& frame = frames[it->second];
+    frame.pins--;
+    frame.dirty = frame.dirty || dirty;
+}
+
+void BufferPool::flushAll() {
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (frames[i].page != INVALID_PAGE && frames[i].dirty) {
+            pager.write(frames[i].page, frameData(i));
+            frames[i].dirty = false;
+        }
+    }
+    pager.sync();
+}
+
+size_t BufferPool::getBytes() const {
+    return MemorySizing::vectorBytes(memory) + MemorySizing::vectorBytes(frames) +
+           MemorySizing::hashBucketBytes(resident.bucket_count()) +
+           resident.size() * MemorySizing::hashNodeBytes<PageId, size_t>();
+}
+
+// Node helpers
+static uint8_t nodeType(const char* page) { return static_cast<uint8_t>(page[0]); }
+static uint16_t cellCount(const char* page) { return load<uint16_t>(page, 2); }
+static uint16_t cellStart(const char* page) { return load<uint16_t>(page, 4); }
+static PageId nodeLink(const char* page) { return load<PageId>(page, 8); }
+static void setNodeLink(char* page, PageId link) { store<PageId>(page, 8, link); }
+static uint16_t slotOffset(const char* page, int index) { return load<uint16_t>(page, NODE_HEADER_SIZE + 2 * index); }
+
+static void initNode(char* page, uint8_t type, PageId link) {
+    std::memset(page, 0, STORAGE_PAGE_SIZE);
+    page[0] = static_cast<char>(type);
+    store<uint16_t>(page, 4, static_cast<uint16_t>(STORAGE_PAGE_SIZE));
+    setNodeLink(page, link);
+}
+
+static int compareKey(const char* page, int index, const std::string& key) {
+    uint16_t offset = slotOffset(page, index);
+    uint16_t length = load<uint16_t>(page, offset);
+    int result = std::memcmp(page + offset + 4, key.data(), std::min<size_t>(length, key.size()));
+    if (result != 0) {
+        return result;
+    }
+    return (length < key.size()) ? -1 : (length > key.size() ? 1 : 0);
+}
+
+static std::string cellKey(const char* page, int index) {
+    uint16_t offset = slotOffset(page, index);
+    return std::string(page + offset + 4, load<uint16_t>(page, offset));
+}
+
+static std::string cellValue(const char* page, int index) {
+    uint16_t offset = slotOffset(page, index);
+    uint16_t keyLength = load<uint16_t>(page, offset);
+    return std::string(page + offset + 4 + keyLength, load<uint16_t>(page, offset + 2));
+}
+
+static PageId cellChild(const char* page, int index) {
+    uint16_t offset = slotOffset(page, index);
+    return load<PageId>(page, offset + 4 + load<uint16_t>(page, offset));
+}
+
+static size_t cellSize(size_t keyLength, size_t valueLength) {
+    return 4 + keyLength + valueLength;
+}
+
+// First slot whose key is >= key
+static int lowerBound(const char* page, const std::string& key) {
+    int low = 0;
+    int high = cellCount(page);
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (compareKey(page, middle, key) < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static PageId childFor(const char* page, const std::string& key) {
+    // The child under the last separator <= key, or the leftmost child
+    int low = 0;
+    int high = cellCount(page);
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (compareKey(page, middle, key) <= 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low == 0 ? nodeLink(page) : cellChild(page, low - 1);
+}
+
+static size_t freeSpace(const char* page) {
+    return cellStart(page) - (NODE_HEADER_SIZE + 2 * cellCount(page));
+}
+
+// Free space once holes left by erased or replaced cells are squeezed out
+static size_t reclaimableSpace(const char* page) {
+    size_t used = NODE_HEADER_SIZE + 2 * cellCount(page);
+    for (int i = 0; i < cellCount(page); ++i) {
+        uint16_t offset = slotOffset(page, i);
+        used += cellSize(load<uint16_t>(page, offset), load<uint16_t>(page, offset + 2));
+    }
+    return STORAGE_PAGE_SIZE - used;
+}
+
+static void insertCell(char* page, int index, const std::string& key, const char* value, size_t valueLength) {
+    uint16_t count = cellCount(page);
+    uint16_t offset = static_cast<uint16_t>(cellStart(page) - cellSize(key.size(), valueLength));
+    store<uint16_t>(page, offset, static_cast<uint16_t>(key.size()));
+    store<uint16_t>(page, offset + 2, static_cast<uint16_t>(valueLength));
+    std::memcpy(page + offset + 4, key.data(), key.size());
+    std::memcpy(page + offset + 4 + key.size(), value, valueLength);
+
+    char* slots = page + NODE_HEADER_SIZE;
+    std::memmove(slots + 2 * (index + 1), slots + 2 * index, 2 * (count - index));
+    store<uint16_t>(page, NODE_HEADER_SIZE + 2 * index, offset);
+    store<uint16_t>(page, 2, static_cast<uint16_t>(count + 1));
+    store<uint16_t>(page, 4, offset);
+}
+
+static void removeCell(char* page, int index) {
+    uint16_t count = cellCount(page);
+    char* slots = page + NODE_HEADER_SIZE;
+    std::memmove(slots + 2 * index, slots + 2 * (index + 1), 2 * (count - index - 1));
+    store<uint16_t>(page, 2, static_cast<uint16_t>(count - 1));
+}
+
+typedef std::vector<std::pair<std::string, std::string>> CellList;
+
+static CellList readCells(const char* page) {
+    CellList cells;
+    cells.reserve(cellCount(page));
+    for (int i = 0; i < cellCount(page); ++i) {
+        cells.emplace_back(cellKey(page, i), cellValue(page, i));
+    }
+    return cells;
+}
+
+static void writeCells(char* page, uint8_t type, PageId link, CellList::const_iterator begin,
+                       CellList::const_iterator end) {
+    initNode(page, type, link);
+    int index = 0;
+    for (auto it = begin; it != end; ++it) {
+        insertCell(page, index++, it->first, it->second.data(), it->second.size());
+    }
+}
+
+static std::string childValue(PageId child) {
+    return std::string(reinterpret_cast<const char*>(&child), sizeof(PageId));
+}
+
+// Index of the first cell of the right half, splitting the bytes evenly
+static size_t splitPoint(const CellList& cells) {
+    size_t total = 0;
+    for (const auto& cell : cells) {
+        total += cellSize(cell.first.size(), cell.second.size()) + 2;
+    }
+    size_t running = 0;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        running += cellSize(cells[i].first.size(), cells[i].second.size()) + 2;
+        if (running * 2 >= total) {
+            return std::max<size_t>(1, std::min(i + 1, cells.size() - 1));
+        }
+    }
+    return cells.size() / 2;
+}
+
+// BPlusTree implementation
+BPlusTree::BPlusTree(BufferPool& pool, CatalogEntry& entry) : pool(pool), entry(entry) {
+    if (entry.root == INVALID_PAGE) {
+        PageGuard root(pool);
+        initNode(root.data(), LEAF_NODE, INVALID_PAGE);
+        entry.root = root.getId();
+    }
+}
+
+PageId BPlusTree::findLeaf(const std::string& key, std::vector<PageId>* path) {
+    PageId page = entry.root;
+    while (true) {
+        PageGuard guard(pool, page);
+        if (path) {
+            path->push_back(page);
+        }
+        if (nodeType(guard.data()) == LEAF_NODE) {
+            return page;
+        }
+        page = childFor(guard.data(), key);
+    }
+}
+
+bool BPlusTree::find(const std::string& key, std::string& value) {
+    PageGuard leaf(pool, findLeaf(key, nullptr));
+    int index = lowerBound(leaf.data(), key);
+    if (index < cellCount(leaf.data()) && compareKey(leaf.data(), index, key) == 0) {
+        value = cellValue(leaf.data(), index);
+        return true;
+    }
+    return false;
+}
+
+bool BPlusTree::insert(const std::string& key, const std::string& value) {
+    if (key.size() > MAX_KEY_SIZE || value.size() > MAX_VALUE_SIZE) {
+        return false;
+    }
+
+    std::vector<PageId> path;
+    PageGuard leaf(pool, findLeaf(key, &path));
+    char* page = leaf.data();
+    leaf.markDirty();
+
+    int index = lowerBound(page, key);
+    if (index < cellCount(page) && compareKey(page, index, key) == 0) {
+        removeCell(page, index);
+    }
+
+    size_t needed = cellSize(key.size(), value.size()) + 2;
+    if (freeSpace(page) < needed && reclaimableSpace(page) >= needed) {
+        CellList cells = readCells(page);
+        writeCells(page, LEAF_NODE, nodeLink(page), cells.begin(), cells.end());
+    }
+    if (freeSpace(page) >= needed) {
+        insertCell(page, index, key, value.data(), value.size());
+        return true;
+    }
+
+    // Split: the upper half moves to a new right sibling in the leaf chain
+    CellList cells = readCells(page);
+    cells.insert(cells.begin() + index, std::make_pair(key, value));
+    size_t split = splitPoint(cells);
+    PageGuard right(pool);
+    writeCells(right.data(), LEAF_NODE, nodeLink(page), cells.begin() + split, cells.end());
+    writeCells(page, LEAF_NODE, right.getId(), cells.begin(), cells.begin() + split);
+    insertIntoParent(path, path.size() - 1, cells[split].first, right.getId());
+    return true;
+}
+
+void BPlusTree::insertIntoParent(std::vector<PageId>& path, size_t level, const std::string& separator,
+                                 PageId right) {
+    if (level == 0) {
+        // The root split: grow the tree by one level
+        PageGuard root(pool);
+        initNode(root.data(), INTERNAL_NODE, path[0]);
+        std::string child = childValue(right);
+        insertCell(root.data(), 0, separator, child.data(), child.size());
+        entry.root = root.getId();
+        return;
+    }
+
+    PageGuard parent(pool, path[level - 1]);
+    char* page = parent.data();
+    parent.markDirty();
+    int index = lowerBound(page, separator);
+    std::string child = childValue(right);
+
+    size_t needed = cellSize(separator.size(), child.size()) + 2;
+    if (freeSpace(page) < needed && reclaimableSpace(page) >= needed) {
+        CellList cells = readCells(page);
+        writeCells(page, INTERNAL_NODE, nodeLink(page), cells.begin(), cells.end());
+    }
+    if (freeSpace(page) >= needed) {
+        insertCell(page, index, separator, child.data(), child.size());
+        return;
+    }
+
+    // Split the internal node; the middle separator moves up a level
+    CellList cells = readCells(page);
+    cells.insert(cells.begin() + index, std::make_pair(separator, child));
+    size_t split = splitPoint(cells);
+    const std::string promoted = cells[split].first;
+    PageId middleChild = load<PageId>(cells[split].second.data(), 0);
+
+    PageGuard sibling(pool);
+    writeCells(sibling.data(), INTERNAL_NODE, middleChild, cells.begin() + split + 1, cells.end());
+    writeCells(page, INTERNAL_NODE, nodeLink(page), cells.begin(), cells.begin() + split);
+    insertIntoParent(path, level - 1, promoted, sibling.getId());
+}
+
+bool BPlusTree::erase(const std::string& key) {
+    PageGuard leaf(pool, findLeaf(key, nullptr));
+    int index = lowerBound(leaf.data(), key);
+    if (index < cellCount(leaf.data()) && compareKey(leaf.data(), index, key) == 0) {
+        removeCell(leaf.data(), index);
+        leaf.markDirty();
+        return true;
+    }
+    return false;
+}
+
+void BPlusTree::scan(const std::string& from,
+                     const std::function<bool(const std::string& key, const std::string& value)>& visitor) {
+    PageId page = findLeaf(from, nullptr);
+    bool first = true;
+    while (page != INVALID_PAGE) {
+        PageGuard leaf(pool, page);
+        for (int i = first ? lowerBound(leaf.data(), from) : 0; i < cellCount(leaf.data()); ++i) {
+            if (!visitor(cellKey(leaf.data(), i), cellValue(leaf.data(), i))) {
+                return;
+            }
+        }
+        first = false;
+        page = nodeLink(leaf.data());
+    }
+}
+
+int BPlusTree::getHeight() {
+    int height = 1;
+    PageId page = entry.root;
+    while (true) {
+        PageGuard guard(pool, page);
+        if (nodeType(guard.data()) == LEAF_NODE) {
+            return height;
+        }
+        page = nodeLink(guard.data());
+        height++;
+    }
+}
+
+// StorageEngine implementation
+StorageEngine::StorageEngine() : pool(nullptr), created(false) {
+}
+
+StorageEngine::~StorageEngine() {
+    close();
+}
+
+bool StorageEngine::open(const std::string& path, size_t cacheBytes) {
+    close();
+    if (!pager.open(path)) {
+        return false;
+    }
+    pool = new BufferPool(pager, cacheBytes / STORAGE_PAGE_SIZE);
+    created = (pager.getPageCount() == 0);
+    if (created) {
+        pager.allocate();
+        writeHeader();
+    } else {
+        readHeader();
+    }
+    return true;
+}
+
+void StorageEngine::close() {
+    if (!pool) {
+        return;
+    }
+    flush();
+    for (BPlusTree* tree : trees) {
+        delete tree;
+    }
+    for (CatalogEntry* entry : catalog) {
+        delete entry;
+    }
+    trees.clear();
+    catalog.clear();
+    delete pool;
+    pool = nullptr;
+    pager.close();
+}
+
+void StorageEngine::readHeader() {
+    char page[STORAGE_PAGE_SIZE];
+    pager.read(0, page);
+    if (std::memcmp(page, STORAGE_MAGIC, sizeof(STORAGE_MAGIC)) != 0) {
+        throw std::runtime_error("storage: not a CSMS database file");
+    }
+    uint32_t count = load<uint32_t>(page, 12);
+    for (uint32_t i = 0; i < count && i < MAX_CATALOG_ENTRIES; ++i) {
+        size_t offset = 16 + i * CATALOG_ENTRY_SIZE;
+        const char* name = page + offset;
+        CatalogEntry* entry = new CatalogEntry();
+        entry->name.assign(name, std::find(name, name + CATALOG_NAME_SIZE, '\0'));
+        entry->root = load<PageId>(page, offset + CATALOG_NAME_SIZE);
+        entry->value = load<uint64_t>(page, offset + CATALOG_NAME_SIZE + 4);
+        catalog.push_back(entry);
+    }
+}
+
+void StorageEngine::writeHeader() {
+    char page[STORAGE_PAGE_SIZE] = {};
+    std::memcpy(page, STORAGE_MAGIC, sizeof(STORAGE_MAGIC));
+    store<uint32_t>(page, 8, pager.getPageCount());
+    store<uint32_t>(page, 12, static_cast<uint32_t>(catalog.size()));
+    for (size_t i = 0; i < catalog.size(); ++i) {
+        size_t offset = 16 + i * CATALOG_ENTRY_SIZE;
+        std::memcpy(page + offset, catalog[i]->name.data(), std::min(catalog[i]->name.size(), CATALOG_NAME_SIZE));
+        store<PageId>(page, offset + CATALOG_NAME_SIZE, catalog[i]->root);
+        store<uint64_t>(page, offset + CATALOG_NAME_SIZE + 4, catalog[i]->value);
+    }
+    pager.write(0, page);
+}
+
+CatalogEntry& StorageEngine::findEntry(const std::string& name) {
+    for (CatalogEntry* entry : catalog) {
+        if (entry->name == name) {
+            return *entry;
+        }
+    }
+    if (catalog.size() >= MAX_CATALOG_ENTRIES || name.size() > CATALOG_NAME_SIZE) {
+        throw std::runtime_error("storage: cannot add catalog entry " + name);
+    }
+    catalog.push_back(new CatalogEntry{ name, INVALID_PAGE, 0 });
+    return *catalog.back();
+}
+
+BPlusTree& StorageEngine::openTree(const std::string& name) {
+    CatalogEntry& entry = findEntry(name);
+    for (BPlusTree* tree : trees) {
+        if (&tree->getCatalogEntry() == &entry) {
+            return *tree;
+        }
+    }
+    trees.push_back(new BPlusTree(*pool, entry));
+    return *trees.back();
+}
+
+uint64_t StorageEngine::getCounter(const std::string& name) {
+    return findEntry(name).value;
+}
+
+void StorageEngine::setCounter(const std::string& name, uint64_t value) {
+    findEntry(name).value = value;
+}
+
+void StorageEngine::flush() {
+    if (!pool) {
+        return;
+    }
+    pool->flushAll();
+    writeHeader();
+    pager.sync();
+}
+
+void StorageEngine::displayStats(std::ostream& out) const {
+    out << "\n" << std::string(60, '=') << std::endl;
+    out << "                 STORAGE ENGINE                 " << std::endl;
+    out << std::string(60, '=') << std::endl;
+    if (!pool) {
+        out << "No database open." << std::endl;
+        out << std::string(60, '=') << std::endl << std::endl;
+        return;
+    }
+    long lookups = pool->getHits() + pool->getMisses();
+    out << "File Size: " << MemoryReport::formatBytes(static_cast<size_t>(pager.getPageCount()) * STORAGE_PAGE_SIZE)
+        << " (" << pager.getPageCount() << " pages)" << std::endl;
+    out << "Buffer Pool: " << pool->getResidentCount() << "/" << pool->getCapacity() << " pages ("
+        << MemoryReport::formatBytes(pool->getCapacity() * STORAGE_PAGE_SIZE) << ")" << std::endl;
+    out << "Hit Rate: " << std::fixed << std::setprecision(1)
+        << (lookups > 0 ? 100.0 * pool->getHits() / lookups : 0.0) << "% of " << lookups << " page pins" << std::endl;
+    out << "Evictions: " << pool->getEvictions() << ", page reads " << pager.getReadCount() << ", writes "
+        << pager.getWriteCount() << std::endl;
+    for (const CatalogEntry* entry : catalog) {
+        if (entry->root != INVALID_PAGE) {
+            out << "  tree " << std::left << std::setw(24) << entry->name << std::right << " root page "
+                << entry->root << std::endl;
+        }
+    }
+    out << std::string(60, '=') << std::endl << std::endl;
+}
+
+void StorageEngine::accountMemory(MemoryReport& report) const {
+    if (!pool) {
+        return;
+    }
+    report.add("Storage", "Buffer pool", static_cast<long>(pool->getCapacity()), pool->getBytes());
+    report.add("Storage", "Catalog and trees", static_cast<long>(catalog.size()),
+               catalog.size() * MemorySizing::allocation(sizeof(CatalogEntry)) +
+               trees.size() * MemorySizing::allocation(sizeof(BPlusTree)));
+}
@@ -0,0 +1,193 @@
+// ===== Storage.h =====
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class MemoryReport;
+
+typedef uint32_t PageId;
+
+static const size_t STORAGE_PAGE_SIZE = 4096;
+static const PageId INVALID_PAGE = 0xffffffffu;
+
+/**
+ * @brief Fixed-size pages in one database file
+ */
+class Pager {
+private:
+    std::fstream file;
+    PageId pageCount;
+    long reads;
+    long writes;
+
+public:
+    Pager();
+
+    bool open(const std::string& path);   // Creates the file if missing
+    void close();
+    bool isOpen() const { return file.is_open(); }
+
+    PageId getPageCount() const { return pageCount; }
+    PageId allocate();                     // Appends a zeroed page
+    void read(PageId id, char* buffer);
+    void write(PageId id, const char* buffer);
+    void sync();
+
+    long getReadCount() const { return reads; }
+    long getWriteCount() const { return writes; }
+};
+
+/**
+ * @brief Page cache of a fixed number of frames with CLOCK replacement
+ *
+ * Pages are pinned while in use and written back when a dirty frame is
+ * evicted or on flushAll(). Pinning more pages than there are frames
+ * throws std::runtime_error.
+ */
+class BufferPool {
+private:
+    struct Frame {
+        PageId page;
+        int pins;
+        bool dirty;
+        bool referenced;
+    };
+
+    Pager& pager;
+    std::vector<char> memory;              // Frame i is memory[i * STORAGE_PAGE_SIZE]
+    std::vector<Frame> frames;
+    std::unordered_map<PageId, size_t> resident;
+    size_t hand;
+    long hits;
+    long misses;
+    long evictions;
+
+    size_t claimFrame();
+    char* frameData(size_t frame) { return &memory[frame * STORAGE_PAGE_SIZE]; }
+
+public:
+    BufferPool(Pager& pager, size_t capacityPages);
+
+    char* pin(PageId id);
+    char* pinNew(PageId& id);
+    void unpin(PageId id, bool dirty);
+    void flushAll();
+
+    size_t getCapacity() const { return frames.size(); }
+    size_t getResidentCount() const { return resident.size(); }
+    long getHits() const { return hits; }
+    long getMisses() const { return misses; }
+    long getEvictions() const { return evictions; }
+    size_t getBytes() const;
+};
+
+/**
+ * @brief Scoped pin of one buffer pool page
+ */
+class PageGuard {
+private:
+    BufferPool& pool;
+    PageId id;
+    char* bytes;
+    bool dirty;
+
+public:
+    PageGuard(BufferPool& pool, PageId id) : pool(pool), id(id), bytes(pool.pin(id)), dirty(false) {}
+    explicit PageGuard(BufferPool& pool) : pool(pool), id(INVALID_PAGE), bytes(pool.pinNew(id)), dirty(true) {}
+    ~PageGuard() { pool.unpin(id, dirty); }
+    PageGuard(const PageGuard&) = delete;
+    PageGuard& operator=(const PageGuard&) = delete;
+
+    PageId getId() const { return id; }
+    char* data() { return bytes; }
+    void markDirty() { dirty = true; }
+};
+
+/**
+ * @brief Named root page and counter kept in the file header
+ */
+struct CatalogEntry {
+    std::string name;
+    PageId root;
+    uint64_t value;
+};
+
+/**
+ * @brief B+tree of byte-string keys and values over slotted pages
+ *
+ * Keys order bytewise. Leaves are chained for range scans. Pages split
+ * when full; erased entries leave space behind that is reclaimed by
+ * compaction rather than by merging pages.
+ */
+class BPlusTree {
+public:
+    static const size_t MAX_KEY_SIZE = 255;
+    static const size_t MAX_VALUE_SIZE = 1000;
+
+private:
+    BufferPool& pool;
+    CatalogEntry& entry;                   // Holds the root page
+
+    PageId findLeaf(const std::string& key, std::vector<PageId>* path);
+    void insertIntoParent(std::vector<PageId>& path, size_t level, const std::string& separator, PageId right);
+
+public:
+    BPlusTree(BufferPool& pool, CatalogEntry& entry);
+
+    bool insert(const std::string& key, const std::string& value);   // Inserts or replaces
+    bool find(const std::string& key, std::string& value);
+    bool erase(const std::string& key);
+
+    // Visits entries with key >= from in order until the visitor returns false
+    void scan(const std::string& from,
+              const std::function<bool(const std::string& key, const std::string& value)>& visitor);
+    int getHeight();
+    const CatalogEntry& getCatalogEntry() const { return entry; }
+};
+
+/**
+ * @brief One database file: pager, buffer pool and named B+trees
+ */
+class StorageEngine {
+private:
+    Pager pager;
+    BufferPool* pool;
+    std::vector<CatalogEntry*> catalog;
+    std::vector<BPlusTree*> trees;
+    bool created;
+
+    CatalogEntry& findEntry(const std::string& name);
+    void readHeader();
+    void writeHeader();
+
+public:
+    StorageEngine();
+    ~StorageEngine();
+    StorageEngine(const StorageEngine&) = delete;
+    StorageEngine& operator=(const StorageEngine&) = delete;
+
+    bool open(const std::string& path, size_t cacheBytes);
+    void close();
+    bool isOpen() const { return pool != nullptr; }
+    bool wasCreated() const { return created; }
+
+    BPlusTree& openTree(const std::string& name);   // Creates an empty tree if missing
+    uint64_t getCounter(const std::string& name);
+    void setCounter(const std::string& name, uint64_t value);
+
+    void flush();
+    BufferPool& getBufferPool() { return *pool; }
+    const Pager& getPager() const { return pager; }
+    void displayStats(std::ostream& out) const;
+    void accountMemory(MemoryReport& report) const;
+};
+
+#endif // STORAGE_H
@@ -0,0 +1,468 @@
+// ===== StorageTables.cpp =====
+#include "StorageTables.h"
+#include "Gtin.h"
+#include <cstring>
+
+static const uint8_t CUSTOMER_ROW_VERSION = 1;
+static const uint8_t PRODUCT_ROW_VERSION = 3;   // Version 1 rows have no barcode; before 3, regular
+                                                 // products sold at cost plus markup, not the base price
+
+/**
+ * @brief Appends fixed-width numbers and length-prefixed strings to a row
+ */
+class RowWriter {
+private:
+    std::string bytes;
+
+public:
+    template <typename T>
+    void put(T value) {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void putString(const std::string& text) {
+        put<uint16_t>(static_cast<uint16_t>(text.size()));
+        bytes.append(text);
+    }
+
+    const std::string& str() const { return bytes; }
+};
+
+/**
+ * @brief Reads a row written by RowWriter; reading past the end yields zeroes
+ */
+class RowReader {
+private:
+    const std::string& bytes;
+    size_t position;
+
+public:
+    explicit RowReader(const std::string& bytes) : bytes(bytes), position(0) {}
+
+    template <typename T>
+    T get() {
+        T value = T();
+        if (position + sizeof(T) <= bytes.size()) {
+            std::memcpy(&value, bytes.data() + position, sizeof(T));
+        }
+        position += sizeof(T);
+        return value;
+    }
+
+    std::string getString() {
+        size_t length = get<uint16_t>();
+        if (position + length > bytes.size()) {
+            position = bytes.size();
+            return "";
+        }
+        std::string text = bytes.substr(position, length);
+        position += length;
+        return text;
+    }
+};
+
+enum ProductKind : uint8_t { REGULAR_KIND, PERISHABLE_KIND, BULK_KIND };
+
+// Big-endian, so barcode index keys order by lookup key
+static std::string lookupKeyPrefix(uint64_t lookupKey) {
+    std::string prefix(8, '\0');
+    for (int i = 0; i < 8; ++i) {
+        prefix[i] = static_cast<char>((lookupKey >> (56 - 8 * i)) & 0xFF);
+    }
+    return prefix;
+}
+
+// ProductTable implementation
+ProductTable::ProductTable(StorageEngine& engine)
+    : engine(engine), rows(engine.openTree("products")), bySupplier(engine.openTree("products_by_supplier")),
+      byCategory(engine.openTree("products_by_category")), byBarcode(engine.openTree("products_by_barcode")) {
+    if (engine.getCounter("products.barcode_index") == 0) {
+        indexBarcodes();
+    }
+}
+
+void ProductTable::indexBarcodes() {
+    std::vector<std::string> keys;
+    rows.scan("", [&](const std::string&, const std::string& row) {
+        Product* product = decode(row);
+        if (product) {
+            std::string key = barcodeKey(product->getBarcode(), product->getId());
+            if (!key.empty()) {
+                keys.push_back(key);
+            }
+            delete product;
+        }
+        return true;
+    });
+    for (const std::string& key : keys) {
+        byBarcode.insert(key, "");
+    }
+    engine.setCounter("products.barcode_index", 1);
+}
+
+std::string ProductTable::supplierKey(const std::string& supplier, const std::string& productId) {
+    return supplier + '\0' + productId;
+}
+
+std::string ProductTable::categoryKey(ProductCategory category, const std::string& productId) {
+    return std::string(1, static_cast<char>('A' + static_cast<int>(category))) + productId;
+}
+
+std::string ProductTable::barcodeKey(const std::string& barcode, const std::string& productId) {
+    BarcodeScan scan;
+    if (!Gtin::decode(barcode, scan)) {
+        return "";
+    }
+    return lookupKeyPrefix(scan.lookupKey) + productId;
+}
+
+std::string ProductTable::encode(const Product& product) {
+    const PerishableProduct* perishable = dynamic_cast<const PerishableProduct*>(&product);
+    const BulkProduct* bulk = dynamic_cast<const BulkProduct*>(&product);
+    const RegularProduct* regular = dynamic_cast<const RegularProduct*>(&product);
+
+    // Index columns first so that put() can read them from an old row cheaply
+    RowWriter row;
+    row.put<uint8_t>(PRODUCT_ROW_VERSION);
+    row.put<uint8_t>(perishable ? PERISHABLE_KIND : (bulk ? BULK_KIND : REGULAR_KIND));
+    row.put<uint8_t>(static_cast<uint8_t>(product.getCategory()));
+    row.putString(product.getSupplier());
+    row.putString(product.getId());
+    row.putString(product.getName());
+    row.putString(product.getDescription());
+    row.put<double>(product.getBasePrice());
+    row.put<double>(product.getCostPrice());
+    row.put<int32_t>(product.getCurrentStock());
+    row.put<int32_t>(product.getMinStockLevel());
+    row.put<int32_t>(product.getMaxStockLevel());
+    row.put<uint8_t>(product.getIsActive() ? 1 : 0);
+    row.put<uint16_t>(static_cast<uint16_t>(product.getTags().size()));
+    for (const std::string& tag : product.getTags()) {
+        row.putString(tag);
+    }
+
+    if (perishable) {
+        row.putString(perishable->getExpirationDate());
+        row.put<int32_t>(perishable->getShelfLifeDays());
+        row.put<double>(perishable->getDiscountRate());
+    } else if (bulk) {
+        row.putString(bulk->getUnit());
+        row.put<double>(bulk->getPricePerUnit());
+        row.put<double>(bulk->getMinimumQuantity());
+    } else {
+        row.put<double>(regular ? regular->getMarkupPercentage() : 0.3);
+    }
+    row.putString(product.getBarcode());
+    return row.str();
+}
+
+bool ProductTable::put(const Product& product) {
+    std::string row = encode(product);
+    std::string old;
+    bool existed = rows.find(product.getId(), old);
+    if (existed && old == row) {
+        return true;
+    }
+    if (!rows.insert(product.getId(), row)) {
+        return false;  // Row too large for a page
+    }
+
+    std::string newBarcodeKey = barcodeKey(product.getBarcode(), product.getId());
+    if (existed) {
+        RowReader reader(old);
+        reader.get<uint8_t>();
+        reader.get<uint8_t>();
+        ProductCategory oldCategory = static_cast<ProductCategory>(reader.get<uint8_t>());
+        std::string oldSupplier = reader.getString();
+        if (oldSupplier != product.getSupplier()) {
+            bySupplier.erase(supplierKey(oldSupplier, product.getId()));
+        }
+        if (oldCategory != product.getCategory()) {
+            byCategory.erase(categoryKey(oldCategory, product.getId()));
+        }
+        // The barcode is the last column, so the old one needs the whole row decoded
+        Product* previous = decode(old);
+        if (previous) {
+            std::string oldBarcodeKey = barcodeKey(previous->getBarcode(), product.getId());
+            if (!oldBarcodeKey.empty() && oldBarcodeKey != newBarcodeKey) {
+                byBarcode.erase(oldBarcodeKey);
+            }
+            delete previous;
+        }
+    } else {
+        engine.setCounter("products.rows", engine.getCounter("products.rows") + 1);
+    }
+    bySupplier.insert(supplierKey(product.getSupplier(), product.getId()), "");
+    byCategory.insert(categoryKey(product.getCategory(), product.getId()), "");
+    if (!newBarcodeKey.empty()) {
+        byBarcode.insert(newBarcodeKey, "");
+    }
+    return true;
+}
+
+Product* ProductTable::load(const std::string& productId) {
+    std::string row;
+    return rows.find(productId, row) ? decode(row) : nullptr;
+}
+
+Product* ProductTable::decode(const std::string& row) {
+    RowReader reader(row);
+    uint8_t version = reader.get<uint8_t>();
+    if (version < 1 || version > PRODUCT_ROW_VERSION) {
+        return nullptr;
+    }
+    uint8_t kind = reader.get<uint8_t>();
+    ProductCategory category = static_cast<ProductCategory>(reader.get<uint8_t>());
+    std::string supplier = reader.getString();
+    std::string id = reader.getString();
+    std::string name = reader.getString();
+    std::string description = reader.getString();
+    double basePrice = reader.get<double>();
+    double costPrice = reader.get<double>();
+    int stock = reader.get<int32_t>();
+    int minStock = reader.get<int32_t>();
+    int maxStock = reader.get<int32_t>();
+    bool active = reader.get<uint8_t>() != 0;
+    std::vector<std::string> tags(reader.get<uint16_t>());
+    for (std::string& tag : tags) {
+        tag = reader.getString();
+    }
+
+    Product* product;
+    if (kind == PERISHABLE_KIND) {
+        std::string expiration = reader.getString();
+        int shelfLife = reader.get<int32_t>();
+        double discount = reader.get<double>();
+        product = new PerishableProduct(id, name, description, basePrice, costPrice, stock, category,
+                                        expiration, shelfLife, supplier, discount, minStock, maxStock);
+    } else if (kind == BULK_KIND) {
+        std::string unit = reader.getString();
+        double pricePerUnit = reader.get<double>();
+        double minimumQuantity = reader.get<double>();
+        product = new BulkProduct(id, name, description, pricePerUnit, costPrice, stock, category,
+                                  unit, minimumQuantity, supplier, minStock, maxStock);
+    } else {
+        double markup = reader.get<double>();
+        product = new RegularProduct(id, name, description, basePrice, costPrice, stock, category,
+                                     supplier, markup, minStock, maxStock);
+        if (version >= 3) {
+            product->setBasePrice(basePrice);
+        }
+    }
+    if (version >= 2) {
+        product->setBarcode(reader.getString());
+    }
+    product->setIsActive(active);
+    for (const std::string& tag : tags) {
+        product->addTag(tag);
+    }
+    return product;
+}
+
+bool ProductTable::contains(const std::string& productId) {
+    std::string row;
+    return rows.find(productId, row);
+}
+
+bool ProductTable::erase(const std::string& productId) {
+    std::string row;
+    if (!rows.find(productId, row)) {
+        return false;
+    }
+    RowReader reader(row);
+    reader.get<uint8_t>();
+    reader.get<uint8_t>();
+    ProductCategory category = static_cast<ProductCategory>(reader.get<uint8_t>());
+    bySupplier.erase(supplierKey(reader.getString(), productId));
+    byCategory.erase(categoryKey(category, productId));
+    Product* product = decode(row);
+    if (product) {
+        std::string key = barcodeKey(product->getBarcode(), productId);
+        if (!key.empty()) {
+            byBarcode.erase(key);
+        }
+        delete product;
+    }
+    rows.erase(productId);
+    engine.setCounter("products.rows", engine.getCounter("products.rows") - 1);
+    return true;
+}
+
+std::vector<std::string> ProductTable::scanIds(const std::string& fromId, const std::string& toId, size_t limit) {
+    std::vector<std::string> ids;
+    rows.scan(fromId, [&](const std::string& key, const std::string&) {
+        if (!toId.empty() && key >= toId) {
+            return false;
+        }
+        ids.push_back(key);
+        return ids.size() < limit;
+    });
+    return ids;
+}
+
+std::string ProductTable::loadRange(const std::string& fromId, size_t limit, std::vector<Product*>& batch) {
+    std::string next;
+    size_t seen = 0;
+    rows.scan(fromId, [&](const std::string& key, const std::string& row) {
+        if (seen == limit) {
+            next = key;
+            return false;
+        }
+        ++seen;
+        if (Product* product = decode(row)) {
+            batch.push_back(product);
+        }
+        return true;
+    });
+    return next;
+}
+
+std::vector<std::string> ProductTable::prefixScan(BPlusTree& tree, const std::string& prefix, size_t limit) {
+    std::vector<std::string> ids;
+    tree.scan(prefix, [&](const std::string& key, const std::string&) {
+        if (key.compare(0, prefix.size(), prefix) != 0) {
+            return false;
+        }
+        ids.push_back(key.substr(prefix.size()));
+        return ids.size() < limit;
+    });
+    return ids;
+}
+
+std::vector<std::string> ProductTable::idsBySupplier(const std::string& supplier, size_t limit) {
+    return prefixScan(bySupplier, supplier + '\0', limit);
+}
+
+std::vector<std::string> ProductTable::idsByCategory(ProductCategory category, size_t limit) {
+    return prefixScan(byCategory, categoryKey(category, ""), limit);
+}
+
+std::string ProductTable::idByBarcode(uint64_t lookupKey) {
+    std::vector<std::string> ids = prefixScan(byBarcode, lookupKeyPrefix(lookupKey), 1);
+    return ids.empty() ? "" : ids.front();
+}
+
+long ProductTable::getRowCount() {
+    return static_cast<long>(engine.getCounter("products.rows"));
+}
+
+// CustomerTable implementation
+CustomerTable::CustomerTable(StorageEngine& engine)
+    : engine(engine), rows(engine.openTree("customers")), byPhone(engine.openTree("customers_by_phone")),
+      byEmail(engine.openTree("customers_by_email")) {
+}
+
+std::string CustomerTable::encode(const Customer& customer) {
+    RowWriter row;
+    row.put<uint8_t>(CUSTOMER_ROW_VERSION);
+    row.putString(customer.getPhone());
+    row.putString(customer.getEmail());
+    row.putString(customer.getId());
+    row.putString(customer.getFirstName());
+    row.putString(customer.getLastName());
+    row.put<uint8_t>(static_cast<uint8_t>(customer.getType()));
+    row.put<double>(customer.getTotalSpent());
+    row.put<int32_t>(customer.getTransactionCount());
+    row.put<double>(customer.getLoyaltyPoints());
+    row.putString(customer.getMembershipDate());
+    row.put<uint8_t>(customer.getIsActive() ? 1 : 0);
+    return row.str();
+}
+
+bool CustomerTable::put(const Customer& customer) {
+    std::string row = encode(customer);
+    std::string old;
+    bool existed = rows.find(customer.getId(), old);
+    if (existed && old == row) {
+        return true;
+    }
+    if (!rows.insert(customer.getId(), row)) {
+        return false;
+    }
+
+    if (existed) {
+        RowReader reader(old);
+        reader.get<uint8_t>();
+        std::string oldPhone = reader.getString();
+        std::string oldEmail = reader.getString();
+        if (oldPhone != customer.getPhone()) {
+            byPhone.erase(oldPhone + '\0' + customer.getId());
+        }
+        if (oldEmail != customer.getEmail()) {
+            byEmail.erase(oldEmail + '\0' + customer.getId());
+        }
+    } else {
+        engine.setCounter("customers.rows", engine.getCounter("customers.rows") + 1);
+    }
+    if (!customer.getPhone().empty()) {
+        byPhone.insert(customer.getPhone() + '\0' + customer.getId(), "");
+    }
+    if (!customer.getEmail().empty()) {
+        byEmail.insert(customer.getEmail() + '\0' + customer.getId(), "");
+    }
+    return true;
+}
+
+Customer* CustomerTable::load(const std::string& customerId) {
+    std::string row;
+    if (!rows.find(customerId, row)) {
+        return nullptr;
+    }
+
+    RowReader reader(row);
+    if (reader.get<uint8_t>() != CUSTOMER_ROW_VERSION) {
+        return nullptr;
+    }
+    std::string phone = reader.getString();
+    std::string email = reader.getString();
+    std::string id = reader.getString();
+    std::string firstName = reader.getString();
+    std::string lastName = reader.getString();
+    CustomerType type = static_cast<CustomerType>(reader.get<uint8_t>());
+    double totalSpent = reader.get<double>();
+    int transactionCount = reader.get<int32_t>();
+    double loyaltyPoints = reader.get<double>();
+    std::string membershipDate = reader.getString();
+    bool active = reader.get<uint8_t>() != 0;
+
+    Customer* customer = new Customer(id, firstName, lastName, email, phone, type);
+    customer->restoreHistory(totalSpent, transactionCount, loyaltyPoints, membershipDate, active);
+    return customer;
+}
+
+bool CustomerTable::contains(const std::string& customerId) {
+    std::string row;
+    return rows.find(customerId, row);
+}
+
+std::string CustomerTable::findIndexed(BPlusTree& tree, const std::string& value) {
+    std::string prefix = value + '\0';
+    std::string id;
+    tree.scan(prefix, [&](const std::string& key, const std::string&) {
+        if (key.compare(0, prefix.size(), prefix) == 0) {
+            id = key.substr(prefix.size());
+        }
+        return false;
+    });
+    return id;
+}
+
+std::string CustomerTable::findIdByPhone(const std::string& phone) {
+    return phone.empty() ? "" : findIndexed(byPhone, phone);
+}
+
+std::string CustomerTable::findIdByEmail(const std::string& email) {
+    return email.empty() ? "" : findIndexed(byEmail, email);
+}
+
+long CustomerTable::getRowCount() {
+    return static_cast<long>(engine.getCounter("customers.rows"));
+}
+
+int CustomerTable::getNextCustomerNumber() {
+    return static_cast<int>(engine.getCounter("customers.next"));
+}
+
+void CustomerTable::setNextCustomerNumber(int number) {
+    engine.setCounter("customers.next", static_cast<uint64_t>(number));
+}
@@ -0,0 +1,85 @@
+// ===== StorageTables.h =====
+#ifndef STORAGE_TABLES_H
+#define STORAGE_TABLES_H
+
+#include "Storage.h"
+#include "Product.h"
+#include "Customer.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Products on disk: rows by ID plus supplier, category and barcode indexes
+ *
+ * Rows are a compact binary encoding of every Product field, including
+ * the fields of the concrete product type and, from row version 2, the
+ * barcode. Version 1 rows still load, without one. From version 3 a
+ * regular product's base price is its shelf price; older rows reopen at
+ * cost plus markup, the price they sold at. Index entries are key-only.
+ * Barcodes are indexed by BarcodeScan::lookupKey, so a scan finds a
+ * product that is not resident; a table written before the index existed
+ * is indexed when it is opened.
+ */
+class ProductTable {
+private:
+    StorageEngine& engine;
+    BPlusTree& rows;
+    BPlusTree& bySupplier;      // supplier \0 productId
+    BPlusTree& byCategory;      // category byte, productId
+    BPlusTree& byBarcode;       // lookup key (8 bytes, big-endian), productId
+
+    static std::string encode(const Product& product);
+    static Product* decode(const std::string& row);
+    static std::string barcodeKey(const std::string& barcode, const std::string& productId);   // Empty if no GTIN
+    void indexBarcodes();
+    static std::string supplierKey(const std::string& supplier, const std::string& productId);
+    static std::string categoryKey(ProductCategory category, const std::string& productId);
+    std::vector<std::string> prefixScan(BPlusTree& tree, const std::string& prefix, size_t limit);
+
+public:
+    explicit ProductTable(StorageEngine& engine);
+
+    bool put(const Product& product);                    // Inserts or updates
+    Product* load(const std::string& productId);         // New object owned by the caller, or nullptr
+    bool contains(const std::string& productId);
+    bool erase(const std::string& productId);
+
+    std::vector<std::string> scanIds(const std::string& fromId, const std::string& toId, size_t limit);
+    // Decodes up to limit rows from fromId on into new objects owned by the caller;
+    // returns the ID to continue from, empty once the table is exhausted
+    std::string loadRange(const std::string& fromId, size_t limit, std::vector<Product*>& batch);
+    std::vector<std::string> idsBySupplier(const std::string& supplier, size_t limit);
+    std::vector<std::string> idsByCategory(ProductCategory category, size_t limit);
+    std::string idByBarcode(uint64_t lookupKey);         // First product with the code, empty if none
+    long getRowCount();
+};
+
+/**
+ * @brief Customers on disk: rows by ID plus phone and email indexes
+ */
+class CustomerTable {
+private:
+    StorageEngine& engine;
+    BPlusTree& rows;
+    BPlusTree& byPhone;         // phone \0 customerId
+    BPlusTree& byEmail;         // email \0 customerId
+
+    static std::string encode(const Customer& customer);
+    std::string findIndexed(BPlusTree& tree, const std::string& value);
+
+public:
+    explicit CustomerTable(StorageEngine& engine);
+
+    bool put(const Customer& customer);
+    Customer* load(const std::string& customerId);       // New object owned by the caller, or nullptr
+    bool contains(const std::string& customerId);
+    std::string findIdByPhone(const std::string& phone);  // Empty if none
+    std::string findIdByEmail(const std::string& email);
+    long getRowCount();
+
+    // Highest customer number handed out, so IDs keep increasing across runs
+    int getNextCustomerNumber();
+    void setNextCustomerNumber(int number);
+};
+
+#endif // STORAGE_TABLES_H
@@ -0,0 +1,510 @@
+// ===== Store.cpp =====
+#include "Store.h"
+#include "LatencyHistogram.h"
+#include "Tracing.h"
+#include "Gtin.h"
+#include <iostream>
+#include <iomanip>
+#include <ctime>
+#include <map>
+
+Store::Store()
+    : database(nullptr), productTable(nullptr), customerTable(nullptr), replication(nullptr), journal(nullptr),
+      jurisdiction(0) {
+    inventory.attachPriceBook(&prices);
+}
+
+Store::~Store() {
+    inventory.attachPriceBook(nullptr);   // prices is destroyed first; stop it calling back into inventory
+    if (database) {
+        syncDatabase();
+        inventory.attachStorage(nullptr);
+        customerDB.attachStorage(nullptr);
+        delete productTable;
+        delete customerTable;
+        delete database;
+    }
+    if (replication) {
+        inventory.attachReplication(nullptr);
+        delete replication;
+    }
+    delete journal;   // Closing writes whatever is still queued
+    for (auto* transaction : transactions) {
+        delete transaction;
+    }
+}
+
+bool Store::openDatabase(const std::string& path, size_t cacheBytes) {
+    if (database) {
+        return false;
+    }
+    database = new StorageEngine();
+    if (!database->open(path, cacheBytes)) {
+        delete database;
+        database = nullptr;
+        return false;
+    }
+    productTable = new ProductTable(*database);
+    customerTable = new CustomerTable(*database);
+    inventory.attachStorage(productTable);
+    customerDB.attachStorage(customerTable);
+    return true;
+}
+
+bool Store::hasStoredData() const {
+    return database && (productTable->getRowCount() > 0 || customerTable->getRowCount() > 0);
+}
+
+void Store::syncDatabase() {
+    if (!database) {
+        return;
+    }
+    inventory.syncStorage();
+    customerDB.syncStorage();
+    database->flush();
+}
+
+bool Store::openReplication(const std::string& path, const std::string& storeId) {
+    if (replication) {
+        return false;
+    }
+    replication = new ReplicationLog();
+    if (!replication->open(path, storeId)) {
+        delete replication;
+        replication = nullptr;
+        return false;
+    }
+    // Starts with the resident catalogue, so head office converges even
+    // if this store's state changed while it was not logging
+    inventory.attachReplication(replication);
+    return true;
+}
+
+bool Store::openJournal(const std::string& path) {
+    if (journal) {
+        return false;
+    }
+    journal = new PersistenceFlusher();
+    if (!journal->open(path)) {
+        delete journal;
+        journal = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool Store::syncJournal() {
+    return journal && journal->sync();
+}
+
+void Store::loadSampleData() {
+    // Add sample products
+    inventory.addProduct(new RegularProduct("P001", "Coca Cola 330ml", "Classic Coca Cola can",
+                                            2.50, 1.20, 50, ProductCategory::BEVERAGES, "Coca Cola Co", 0.3));
+
+    inventory.addProduct(new RegularProduct("P002", "Lay's Chips Original", "Crispy potato chips",
+                                            3.00, 1.50, 30, ProductCategory::SNACKS, "Frito-Lay", 0.25));
+
+    inventory.addProduct(new PerishableProduct("P003", "Fresh Milk 1L", "Whole milk",
+                                               4.00, 2.50, 15, ProductCategory::DAIRY, "2025-08-20", 7, "Dairy Farm"));
+
+    inventory.addProduct(new BulkProduct("P004", "Rice Premium", "Premium jasmine rice",
+                                         2.50, 1.80, 100, ProductCategory::OTHER, "kg", 0.5, "Rice Supplier"));
+
+    inventory.addProduct(new RegularProduct("P005", "Chocolate Bar", "Dark chocolate bar",
+                                            2.00, 1.00, 8, ProductCategory::SNACKS, "Chocolate Co", 0.4));
+
+    // Packaged goods carry EAN-13s; the rice is sold from the scale on weight labels
+    inventory.setBarcode("P001", Gtin::makeEan13("5901234", 1));
+    inventory.setBarcode("P002", Gtin::makeEan13("5901234", 2));
+    inventory.setBarcode("P003", Gtin::makeEan13("5901234", 3));
+    inventory.setBarcode("P004", Gtin::makeMeasureLabel(21, 4, 0));
+    inventory.setBarcode("P005", Gtin::makeEan13("5901234", 5));
+
+    // Add sample customers
+    customerDB.addCustomer("John", "Doe", "john.doe@email.com", "+1234567890", CustomerType::REGULAR);
+    customerDB.addCustomer("Jane", "Smith", "jane.smith@email.com", "+1234567891", CustomerType::PREMIUM);
+    customerDB.addCustomer("Bob", "Johnson", "bob.johnson@email.com", "+1234567892", CustomerType::VIP);
+}
+
+bool Store::setJurisdiction(int index) {
+    if (index < 0 || index >= taxTable.getJurisdictionCount()) {
+        return false;
+    }
+    jurisdiction = index;
+    return true;
+}
+
+Transaction* Store::findTransaction(int transactionId) {
+    auto it = transactionsById.find(transactionId);
+    return (it != transactionsById.end()) ? it->second : nullptr;
+}
+
+Transaction* Store::openTransaction(Customer* customer, const std::string& cashierId) {
+    Transaction* transaction = new Transaction(customer, cashierId);
+    transaction->setPriceVersion(prices.acquire());
+    return transaction;
+}
+
+void Store::priceTransaction(Transaction* transaction) const {
+    transaction->calculateTotals(getCurrentJurisdiction());
+}
+
+bool Store::completeSale(Transaction* transaction, PaymentMethod method, double amountPaid) {
+    CSMS_TRACE_SPAN("checkout", "Store::completeSale", transaction->getId());
+    if (!transaction->processPayment(method, amountPaid)) {
+        return false;
+    }
+    
+    // The store takes ownership of every completed transaction
+    transaction->finalizeTransaction(journal);
+    if (replication) {
+        std::vector<const Product*> changed;
+        for (const auto& item : transaction->getItems()) {
+            if (item.stockUnits > 0) {
+                changed.push_back(item.product);
+            }
+        }
+        inventory.recordStockChanges(changed);
+    }
+    transactions.push_back(transaction);
+    transactionsById[transaction->getId()] = transaction;
+    sales.recordSale(*transaction);
+    cube.addTransaction(*transaction);
+    liveSketches.recordSale(*transaction);
+    windows.recordSale(*transaction);
+    return true;
+}
+
+const RefundRecord* Store::recordRefund(Transaction* transaction, const RefundRecord& refund) {
+    const RefundRecord* stored = refunds.recordRefund(refund);
+    if (journal) {
+        journal->submitRefund(*stored, *transaction);
+    }
+    if (replication) {
+        std::vector<const Product*> changed;
+        for (const RefundLine& line : stored->lines) {
+            if (line.stockRestored > 0) {
+                changed.push_back(transaction->getItems()[line.itemIndex].product);
+            }
+        }
+        inventory.recordStockChanges(changed);
+    }
+    sales.recordRefund(*transaction, *stored);
+    cube.addRefund(*transaction, *stored);
+    windows.recordRefund(*transaction, *stored);
+    return stored;
+}
+
+int Store::archiveClosedDays(std::time_t now) {
+    std::time_t today = SalesAggregates::startOfDay(now);
+    std::map<std::time_t, std::vector<const Transaction*>> closedDays;
+    std::vector<Transaction*> open;
+    for (auto* transaction : transactions) {
+        if (transaction->getTimestamp() < today) {
+            closedDays[SalesAggregates::startOfDay(transaction->getTimestamp())].push_back(transaction);
+        } else {
+            open.push_back(transaction);
+        }
+    }
+
+    int archived = 0;
+    for (const auto& day : closedDays) {
+        size_t sourceBytes = 0;
+        for (const auto* transaction : day.second) {
+            sourceBytes += MemorySizing::allocation(sizeof(Transaction)) + transaction->getHeapBytes();
+        }
+        archive.recordSourceBytes(sourceBytes);
+        archive.add(ArchiveSegment::seal(day.first, day.second));
+        for (const auto* transaction : day.second) {
+            transactionsById.erase(transaction->getId());
+            delete transaction;
+            archived++;
+        }
+    }
+    transactions.swap(open);
+    return archived;
+}
+
+void Store::generateSalesReport() const {
+    CSMS_TIME_LATENCY(SALES_REPORT);
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "                SALES REPORT                " << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+
+    long totalTransactions = static_cast<long>(transactions.size()) + archive.getTransactionCount();
+    if (totalTransactions == 0) {
+        std::cout << "No transactions to report." << std::endl;
+        std::cout << std::string(60, '=') << std::endl << std::endl;
+        return;
+    }
+
+    double totalSales = sales.getCompletedSales();
+    double totalTax = sales.getCompletedTax();
+    long completedTransactions = sales.getCompletedCount();
+    long refundedTransactions = sales.getRefundedCount();
+
+    std::cout << "Total Transactions: " << totalTransactions << std::endl;
+    std::cout << "Completed Transactions: " << completedTransactions << std::endl;
+    std::cout << "Refunded Transactions: " << refundedTransactions << std::endl;
+    std::cout << "Total Sales: $" << std::fixed << std::setprecision(2) << totalSales << std::endl;
+    std::cout << "Total Tax Collected: $" << std::fixed << std::setprecision(2) << totalTax << std::endl;
+
+    if (completedTransactions > 0) {
+        std::cout << "Average Transaction: $" << std::fixed << std::setprecision(2)
+                  << (totalSales / completedTransactions) << std::endl;
+    }
+
+    std::cout << std::string(60, '=') << std::endl << std::endl;
+}
+
+void Store::generateCustomerAnalytics() {
+    CSMS_TIME_LATENCY(CUSTOMER_ANALYTICS);
+    auto topCustomers = customerDB.getTopCustomers(5);
+
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "              CUSTOMER ANALYTICS             " << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+
+    std::cout << "Total Customers: " << customerDB.getTotalCustomerCount() << std::endl;
+    std::cout << "Total Customer Spending: $" << std::fixed << std::setprecision(2)
+              << customerDB.getTotalCustomerSpending() << std::endl;
+
+    std::cout << "\nTop 5 Customers by Spending:" << std::endl;
+    for (size_t i = 0; i < topCustomers.size(); ++i) {
+        const Customer* customer = topCustomers[i];
+        std::cout << (i + 1) << ". " << customer->getFullName()
+                  << " - $" << std::fixed << std::setprecision(2) << customer->getTotalSpent()
+                  << " (" << customer->getTransactionCount() << " transactions)" << std::endl;
+    }
+
+    // Customer type distribution
+    std::cout << "\nCustomer Type Distribution:" << std::endl;
+    auto regularCustomers = customerDB.getCustomersByType(CustomerType::REGULAR);
+    auto premiumCustomers = customerDB.getCustomersByType(CustomerType::PREMIUM);
+    auto vipCustomers = customerDB.getCustomersByType(CustomerType::VIP);
+    auto employeeCustomers = customerDB.getCustomersByType(CustomerType::EMPLOYEE);
+
+    std::cout << "Regular: " << regularCustomers.size() << std::endl;
+    std::cout << "Premium: " << premiumCustomers.size() << std::endl;
+    std::cout << "VIP: " << vipCustomers.size() << std::endl;
+    std::cout << "Employee: " << employeeCustomers.size() << std::endl;
+
+    std::cout << std::string(60, '=') << std::endl << std::endl;
+}
+
+void Store::generateFinancialSummary() const {
+    CSMS_TIME_LATENCY(FINANCIAL_SUMMARY);
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "              FINANCIAL SUMMARY             " << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+
+    double totalInventoryValue = inventory.getTotalInventoryValue();
+    double totalInventoryCost = inventory.getTotalInventoryCost();
+    double potentialProfit = inventory.getTotalPotentialProfit();
+
+    double totalSales = sales.getCompletedSales();
+
+    std::cout << "INVENTORY:" << std::endl;
+    std::cout << "Total Inventory Value: $" << std::fixed << std::setprecision(2)
+              << totalInventoryValue << std::endl;
+    std::cout << "Total Inventory Cost: $" << std::fixed << std::setprecision(2)
+              << totalInventoryCost << std::endl;
+    std::cout << "Potential Profit: $" << std::fixed << std::setprecision(2)
+              << potentialProfit << std::endl;
+
+    if (totalInventoryCost > 0) {
+        double profitMargin = (potentialProfit / totalInventoryCost) * 100;
+        std::cout << "Profit Margin: " << std::fixed << std::setprecision(1)
+                  << profitMargin << "%" << std::endl;
+    }
+
+    std::cout << "\nSALES:" << std::endl;
+    std::cout << "Total Sales Revenue: $" << std::fixed << std::setprecision(2)
+              << totalSales << std::endl;
+
+    std::cout << "\nCUSTOMERS:" << std::endl;
+    std::cout << "Total Customer Spending: $" << std::fixed << std::setprecision(2)
+              << customerDB.getTotalCustomerSpending() << std::endl;
+
+    std::cout << std::string(60, '=') << std::endl << std::endl;
+}
+
+void Store::generatePeriodReport(ReportPeriod period) const {
+    std::time_t from;
+    std::time_t to;
+    SalesAggregates::getPeriodRange(period, std::time(nullptr), from, to);
+    SalesBucket bucket = sales.getRange(from, to);
+
+    char fromText[16];
+    char toText[16];
+    std::time_t lastDay = SalesAggregates::addDays(to, -1);
+    std::strftime(fromText, sizeof(fromText), "%Y-%m-%d", std::localtime(&from));
+    std::strftime(toText, sizeof(toText), "%Y-%m-%d", std::localtime(&lastDay));
+
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "           SALES REPORT - " << SalesAggregates::periodToString(period) << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    std::cout << "Period: " << fromText << " to " << toText << std::endl;
+
+    if (bucket.transactions == 0 && bucket.refunds == 0) {
+        std::cout << "No sales in this period." << std::endl;
+        std::cout << std::string(60, '=') << std::endl << std::endl;
+        return;
+    }
+
+    std::cout << "Transactions: " << bucket.transactions << std::endl;
+    std::cout << "Gross Sales: $" << std::fixed << std::setprecision(2) << bucket.sales << std::endl;
+    std::cout << "Tax Collected: $" << std::fixed << std::setprecision(2) << bucket.tax << std::endl;
+    std::cout << "Refunds Issued: " << bucket.refunds << " ($" << std::fixed << std::setprecision(2)
+              << bucket.refundAmount << ")" << std::endl;
+    std::cout << "Net Sales: $" << std::fixed << std::setprecision(2) << bucket.getNetSales() << std::endl;
+    if (bucket.transactions > 0) {
+        std::cout << "Average Transaction: $" << std::fixed << std::setprecision(2)
+                  << (bucket.sales / bucket.transactions) << std::endl;
+    }
+
+    std::cout << "\nUnits by Category:" << std::endl;
+    for (int c = 0; c < PRODUCT_CATEGORY_COUNT; ++c) {
+        if (bucket.unitsSold[c] == 0.0 && bucket.unitsReturned[c] == 0.0) {
+            continue;
+        }
+        std::cout << "  " << std::left << std::setw(18)
+                  << Product::categoryName(static_cast<ProductCategory>(c)) << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(12) << bucket.unitsSold[c]
+                  << " sold" << std::setw(12) << bucket.unitsReturned[c] << " returned" << std::endl;
+    }
+
+    std::cout << std::string(60, '=') << std::endl << std::endl;
+}
+
+void Store::runBasketAnalysis(const MarketBasketConfig& config) {
+    // Closed days first, from the archive, then the open transactions
+    BasketEncoder encoder;
+    for (const ArchiveSegment& segment : archive.getSegments()) {
+        segment.forEach([&encoder](const ArchivedTransaction& transaction) {
+            if (transaction.status != TransactionStatus::COMPLETED &&
+                transaction.status != TransactionStatus::PARTIALLY_REFUNDED) {
+                return;
+            }
+            for (const ArchivedLine& line : transaction.lines) {
+                encoder.addItem(line.productId, std::string());
+            }
+            encoder.endBasket();
+        });
+    }
+    encoder.addTransactions(transactions);
+
+    // Archived lines keep only the product ID
+    EncodedBaskets& baskets = encoder.getBaskets();
+    for (size_t item = 0; item < baskets.productIds.size(); ++item) {
+        if (baskets.productNames[item].empty()) {
+            Product* product = inventory.findProduct(baskets.productIds[item]);
+            baskets.productNames[item] = product ? product->getName() : std::string("(removed)");
+        }
+    }
+    basketAnalysis.run(baskets, config);
+    basketAnalysis.displaySummary(std::cout);
+}
+
+void Store::generateLiveDashboard() const {
+    liveSketches.display(std::cout);
+}
+
+void Store::generateWindowComparison(int minutes) const {
+    windows.displayComparison(std::cout, minutes * 60, std::time(nullptr));
+}
+
+void Store::generateStorageReport() const {
+    if (!database) {
+        std::cout << "No database open (start with --db <file>)." << std::endl;
+        return;
+    }
+    database->displayStats(std::cout);
+    std::cout << "Stored Products: " << productTable->getRowCount() << ", Customers: "
+              << customerTable->getRowCount() << std::endl;
+    std::cout << "Resident Products: " << inventory.getResidentCount();
+    if (inventory.getResidentLimit() > 0) {
+        std::cout << " (limit " << inventory.getResidentLimit() << ")";
+    }
+    std::cout << ", evicted " << inventory.getEvictionCount() << std::endl;
+}
+
+void Store::generateArchiveReport() const {
+    archive.displayStats(std::cout);
+}
+
+void Store::generateReplicationReport() const {
+    if (!replication) {
+        std::cout << "Replication is off (start with --replicate <file> --store-id <code>)." << std::endl;
+        return;
+    }
+    std::cout << "Replication Log: " << replication->getPath() << std::endl;
+    std::cout << "Store: " << replication->getStoreId() << ", Epoch: " << replication->getEpoch() << std::endl;
+    std::cout << "Last Sequence: " << replication->getLastSequence() << " (" << replication->getEventsWritten()
+              << " events this run, " << replication->getBatchesWritten() << " writes)" << std::endl;
+}
+
+void Store::generateJournalReport() const {
+    if (!journal) {
+        std::cout << "Journal is off (start with --journal <file>)." << std::endl;
+        return;
+    }
+    journal->display(std::cout);
+}
+
+void Store::generatePriceBookReport() const {
+    prices.display(std::cout);
+    std::vector<const Product*> mismatched = inventory.getPriceMismatches();
+    std::cout << "Shelf prices out of step with the book: " << mismatched.size() << std::endl;
+    for (size_t i = 0; i < mismatched.size() && i < 5; ++i) {
+        std::cout << "  " << mismatched[i]->getId() << ": book $" << std::fixed << std::setprecision(2)
+                  << prices.getCurrent()->priceOf(*mismatched[i]) << ", product $"
+                  << mismatched[i]->calculateSellingPrice() << std::endl;
+    }
+}
+
+void Store::accountMemory(MemoryReport& report) const {
+    inventory.accountMemory(report);
+    customerDB.accountMemory(report);
+
+    long itemCount = 0;
+    size_t heapBytes = 0;
+    for (const auto* transaction : transactions) {
+        itemCount += static_cast<long>(transaction->getItems().size());
+        heapBytes += transaction->getHeapBytes();
+    }
+
+    long count = static_cast<long>(transactions.size());
+    report.add("Transactions", "Transaction objects", count, count * MemorySizing::allocation(sizeof(Transaction)));
+    report.add("Transactions", "Items and strings", itemCount, heapBytes);
+    report.add("Transactions", "History vector", count, MemorySizing::vectorBytes(transactions));
+    report.add("Transactions", "transactionsById index", static_cast<long>(transactionsById.size()),
+               transactionsById.size() * MemorySizing::hashNodeBytes<int, Transaction*>() +
+               MemorySizing::hashBucketBytes(transactionsById.bucket_count()));
+
+    refunds.accountMemory(report);
+    sales.accountMemory(report);
+    cube.accountMemory(report);
+    liveSketches.accountMemory(report);
+    windows.accountMemory(report);
+    archive.accountMemory(report);
+    if (database) {
+        database->accountMemory(report);
+    }
+    report.add("Prices", "Price book versions", prices.getStats().versionsLive, prices.getAllocatedBytes());
+    if (journal) {
+        report.add("Journal", "Queue and batch buffer", static_cast<long>(journal->getCapacity()),
+                   journal->getAllocatedBytes());
+    }
+
+    report.add("Diagnostics", "Latency histograms", LatencyMetrics::getThreadCount(),
+               LatencyMetrics::getAllocatedBytes());
+    report.add("Diagnostics", "Trace rings", Tracing::getThreadCount(), Tracing::getAllocatedBytes());
+}
+
+void Store::generateMemoryReport() const {
+    MemoryReport report;
+    accountMemory(report);
+    report.display(std::cout);
+}
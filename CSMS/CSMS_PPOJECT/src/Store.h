@@ -0,0 +1,130 @@
+// ===== Store.h =====
+#ifndef STORE_H
+#define STORE_H
+
+#include "Product.h"
+#include "Customer.h"
+#include "Transaction.h"
+#include "InventoryManager.h"
+#include "TaxEngine.h"
+#include "Refund.h"
+#include "SalesAggregates.h"
+#include "SalesCube.h"
+#include "MarketBasket.h"
+#include "Sketches.h"
+#include "SalesWindow.h"
+#include "StorageTables.h"
+#include "TransactionArchive.h"
+#include "ReplicationLog.h"
+#include "PersistenceFlusher.h"
+#include "MemoryAccounting.h"
+#include "PriceBook.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * @brief One store's state and the operations every front end shares
+ *
+ * Owns the inventory, customer database, completed transactions and refund
+ * ledger, and keeps the sales aggregates and cube in step with both. The interactive
+ * menu and the headless command processor both go through this class so a
+ * sale or refund has the same effects either way.
+ */
+class Store {
+private:
+    InventoryManager inventory;
+    CustomerDatabase customerDB;
+    std::vector<Transaction*> transactions;
+    std::unordered_map<int, Transaction*> transactionsById;
+    RefundLedger refunds;
+    SalesAggregates sales;     // Updated at every sale and refund
+    SalesCube cube;            // Line-level facts for ad-hoc slicing
+    MarketBasketAnalysis basketAnalysis;  // Results of the last batch run
+    LiveSalesSketches liveSketches;       // Approximate top sellers, reach and basket values
+    SalesWindowEngine windows;            // Exact totals for any recent window
+    TransactionArchive archive;           // Closed days, sealed out of transactions
+    StorageEngine* database;              // Optional on-disk products and customers
+    ProductTable* productTable;
+    CustomerTable* customerTable;
+    ReplicationLog* replication;          // Optional inventory change log for head office
+    PersistenceFlusher* journal;          // Optional sales journal, written in the background
+    PriceBook prices;                     // Shelf prices carts pin when they open
+    TaxTable taxTable;
+    int jurisdiction;
+
+public:
+    Store();
+    ~Store();
+
+    void loadSampleData();
+
+    // Persistent storage of products and customers
+    bool openDatabase(const std::string& path, size_t cacheBytes);
+    bool hasStoredData() const;
+    void syncDatabase();
+
+    // Inventory replication to head office
+    bool openReplication(const std::string& path, const std::string& storeId);
+    const ReplicationLog* getReplication() const { return replication; }
+
+    // Sales and refunds journalled without putting the disk on the checkout path
+    bool openJournal(const std::string& path);
+    bool syncJournal();
+    const PersistenceFlusher* getJournal() const { return journal; }
+
+    // Components
+    InventoryManager& getInventory() { return inventory; }
+    const InventoryManager& getInventory() const { return inventory; }
+    CustomerDatabase& getCustomerDatabase() { return customerDB; }
+    const CustomerDatabase& getCustomerDatabase() const { return customerDB; }
+    RefundLedger& getRefunds() { return refunds; }
+    const RefundLedger& getRefunds() const { return refunds; }
+    const SalesAggregates& getSalesAggregates() const { return sales; }
+    SalesCube& getSalesCube() { return cube; }
+    const SalesCube& getSalesCube() const { return cube; }
+    const MarketBasketAnalysis& getBasketAnalysis() const { return basketAnalysis; }
+    const LiveSalesSketches& getLiveSketches() const { return liveSketches; }
+    const SalesWindowEngine& getSalesWindows() const { return windows; }
+    TransactionArchive& getArchive() { return archive; }
+    const TransactionArchive& getArchive() const { return archive; }
+    TaxTable& getTaxTable() { return taxTable; }
+    PriceBook& getPriceBook() { return prices; }
+    const PriceBook& getPriceBook() const { return prices; }
+
+    // Tax jurisdiction the store charges in
+    int getJurisdiction() const { return jurisdiction; }
+    bool setJurisdiction(int index);
+    const TaxJurisdiction& getCurrentJurisdiction() const { return taxTable.getJurisdiction(jurisdiction); }
+
+    // Transactions
+    // New cart priced from the current price book version for as long as it is open
+    Transaction* openTransaction(Customer* customer, const std::string& cashierId);
+    const std::vector<Transaction*>& getTransactions() const { return transactions; }
+    Transaction* findTransaction(int transactionId);
+    void priceTransaction(Transaction* transaction) const;
+    bool completeSale(Transaction* transaction, PaymentMethod method, double amountPaid);
+    const RefundRecord* recordRefund(Transaction* transaction, const RefundRecord& refund);
+    // Seals every day before today into the archive and frees those transactions;
+    // returns how many were archived. Archived sales can no longer be refunded, but
+    // their receipts are reprinted from the archive.
+    int archiveClosedDays(std::time_t now);
+
+    // Store-wide reports
+    void generateSalesReport() const;
+    void generateCustomerAnalytics();
+    void generateFinancialSummary() const;
+    void generatePeriodReport(ReportPeriod period) const;
+    void runBasketAnalysis(const MarketBasketConfig& config);   // Archived and open sales
+    void generateLiveDashboard() const;
+    void generateWindowComparison(int minutes) const;
+    void generateStorageReport() const;
+    void generateArchiveReport() const;
+    void generateReplicationReport() const;
+    void generateJournalReport() const;
+    void generatePriceBookReport() const;
+    void accountMemory(MemoryReport& report) const;
+    void generateMemoryReport() const;
+};
+
+#endif // STORE_H
@@ -0,0 +1,91 @@
+// ===== TaxEngine.cpp =====
+#include "TaxEngine.h"
+#include <iostream>
+#include <iomanip>
+
+void TaxBreakdown::add(uint16_t rateBasisPoints, double taxableAmount, double taxAmount) {
+    // At most PRODUCT_CATEGORY_COUNT distinct rates, so a linear probe is cheapest
+    for (int i = 0; i < entryCount; ++i) {
+        if (entries[i].rateBasisPoints == rateBasisPoints) {
+            entries[i].taxableAmount += taxableAmount;
+            entries[i].taxAmount += taxAmount;
+            return;
+        }
+    }
+    entries[entryCount].rateBasisPoints = rateBasisPoints;
+    entries[entryCount].taxableAmount = taxableAmount;
+    entries[entryCount].taxAmount = taxAmount;
+    entryCount++;
+}
+
+TaxTable::TaxTable() {
+    // Index 0 keeps the historical flat 8% behaviour
+    addJurisdiction(makeFlatJurisdiction("DEFAULT", 0.08));
+
+    // Typical US grocery rules: dairy and bakery exempt, everything else taxed.
+    // OTHER is the catch-all for anything unclassified, so it pays the full rate.
+    TaxJurisdiction grocery = makeFlatJurisdiction("US-GROCERY", 0.0825);
+    grocery.name = "US Grocery (food exempt)";
+    grocery.rateBasisPoints[static_cast<int>(ProductCategory::DAIRY)] = 0;
+    grocery.rateBasisPoints[static_cast<int>(ProductCategory::BAKERY)] = 0;
+    addJurisdiction(grocery);
+
+    // VAT-style jurisdiction: shelf prices include tax, reduced rate on food
+    TaxJurisdiction vat = makeFlatJurisdiction("EU-VAT", 0.20, true);
+    vat.name = "EU VAT (tax inclusive)";
+    vat.rateBasisPoints[static_cast<int>(ProductCategory::DAIRY)] = 500;
+    vat.rateBasisPoints[static_cast<int>(ProductCategory::BAKERY)] = 500;
+    vat.rateBasisPoints[static_cast<int>(ProductCategory::HOUSEHOLD)] = 2000;
+    addJurisdiction(vat);
+}
+
+int TaxTable::addJurisdiction(const TaxJurisdiction& jurisdiction) {
+    int existing = findJurisdiction(jurisdiction.code);
+    if (existing >= 0) {
+        jurisdictions[existing] = jurisdiction;
+        return existing;
+    }
+    jurisdictions.push_back(jurisdiction);
+    return static_cast<int>(jurisdictions.size()) - 1;
+}
+
+int TaxTable::findJurisdiction(const std::string& code) const {
+    for (size_t i = 0; i < jurisdictions.size(); ++i) {
+        if (jurisdictions[i].code == code) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void TaxTable::displayRates() const {
+    static const char* categoryNames[PRODUCT_CATEGORY_COUNT] = {
+        "Beverages", "Snacks", "Dairy", "Bakery", "Household",
+        "Electronics", "Health & Beauty", "Other"
+    };
+
+    std::cout << "\n========== Tax Jurisdictions ==========\n";
+    for (size_t i = 0; i < jurisdictions.size(); ++i) {
+        const TaxJurisdiction& j = jurisdictions[i];
+        std::cout << (i + 1) << ". " << j.code << " - " << j.name
+                  << (j.pricesIncludeTax ? " [prices include tax]" : "") << "\n";
+        for (int c = 0; c < PRODUCT_CATEGORY_COUNT; ++c) {
+            std::cout << "     " << std::left << std::setw(16) << categoryNames[c] << std::right
+                      << std::fixed << std::setprecision(2) << (j.rateBasisPoints[c] / 100.0) << "%\n";
+        }
+    }
+    std::cout << "=======================================\n";
+}
+
+TaxJurisdiction TaxTable::makeFlatJurisdiction(const std::string& code, double rate,
+                                               bool pricesIncludeTax) {
+    TaxJurisdiction jurisdiction;
+    jurisdiction.code = code;
+    jurisdiction.name = code;
+    jurisdiction.pricesIncludeTax = pricesIncludeTax;
+    uint16_t basisPoints = static_cast<uint16_t>(rate * 10000.0 + 0.5);
+    for (int c = 0; c < PRODUCT_CATEGORY_COUNT; ++c) {
+        jurisdiction.rateBasisPoints[c] = basisPoints;
+    }
+    return jurisdiction;
+}
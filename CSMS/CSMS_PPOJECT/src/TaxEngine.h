@@ -0,0 +1,80 @@
+// ===== TaxEngine.h =====
+#ifndef TAX_ENGINE_H
+#define TAX_ENGINE_H
+
+#include "Product.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Number of ProductCategory values, used to size per-category rate tables
+ */
+constexpr int PRODUCT_CATEGORY_COUNT = static_cast<int>(ProductCategory::OTHER) + 1;
+
+/**
+ * @brief Tax rates for one store jurisdiction
+ *
+ * Rates are stored in basis points (1/100 of a percent) in a fixed array
+ * indexed by ProductCategory, so a line's rate is a single indexed load.
+ */
+struct TaxJurisdiction {
+    std::string code;                                // e.g. "CA-SF"
+    std::string name;
+    uint16_t rateBasisPoints[PRODUCT_CATEGORY_COUNT]; // 825 == 8.25%
+    bool pricesIncludeTax;                           // Shelf prices already contain tax
+
+    double rateFor(ProductCategory category) const {
+        return rateBasisPoints[static_cast<int>(category)] * 0.0001;
+    }
+};
+
+/**
+ * @brief One row of a receipt's tax breakdown (all lines sharing a rate)
+ */
+struct TaxBreakdownEntry {
+    uint16_t rateBasisPoints;
+    double taxableAmount;
+    double taxAmount;
+};
+
+/**
+ * @brief Per-rate tax breakdown for a transaction
+ *
+ * A jurisdiction has at most one distinct rate per category, so the
+ * breakdown fits in a fixed array and never allocates.
+ */
+struct TaxBreakdown {
+    TaxBreakdownEntry entries[PRODUCT_CATEGORY_COUNT];
+    int entryCount;
+
+    TaxBreakdown() : entryCount(0) {}
+    void clear() { entryCount = 0; }
+    void add(uint16_t rateBasisPoints, double taxableAmount, double taxAmount);
+};
+
+/**
+ * @brief Table of tax jurisdictions known to the store chain
+ *
+ * Jurisdictions are registered once at start-up; checkout refers to them by
+ * index so no string lookups happen on the sale path.
+ */
+class TaxTable {
+private:
+    std::vector<TaxJurisdiction> jurisdictions;
+
+public:
+    TaxTable();
+
+    int addJurisdiction(const TaxJurisdiction& jurisdiction);
+    int findJurisdiction(const std::string& code) const;  // -1 if unknown
+    const TaxJurisdiction& getJurisdiction(int index) const { return jurisdictions[index]; }
+    int getJurisdictionCount() const { return static_cast<int>(jurisdictions.size()); }
+
+    void displayRates() const;
+
+    static TaxJurisdiction makeFlatJurisdiction(const std::string& code, double rate,
+                                                bool pricesIncludeTax = false);
+};
+
+#endif // TAX_ENGINE_H
@@ -0,0 +1,137 @@
+// ===== Tracing.cpp =====
+#include "Tracing.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Tracing::enabled(false);
+
+/**
+ * @brief One thread's span ring; only the owning thread writes to it
+ */
+struct TraceRing {
+    int threadIndex;
+    std::atomic<uint64_t> head;  // Total spans ever written
+    TraceEvent events[TRACE_RING_CAPACITY];
+
+    explicit TraceRing(int threadIndex) : threadIndex(threadIndex), head(0) {}
+};
+
+// Rings outlive their threads so spans from finished workers can still be exported
+static std::mutex ringsMutex;
+static std::vector<TraceRing*> rings;
+
+static const std::chrono::steady_clock::time_point traceOrigin = std::chrono::steady_clock::now();
+
+static TraceRing& localRing() {
+    static thread_local TraceRing* ring = nullptr;
+    if (!ring) {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        ring = new TraceRing(static_cast<int>(rings.size()) + 1);
+        rings.push_back(ring);
+    }
+    return *ring;
+}
+
+void Tracing::setEnabled(bool on) {
+    enabled.store(on && isCompiledIn(), std::memory_order_relaxed);
+}
+
+int64_t Tracing::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - traceOrigin).count();
+}
+
+void Tracing::record(const char* category, const char* name, int64_t startNanos,
+                     int64_t durationNanos, long id) {
+    TraceRing& ring = localRing();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+
+    TraceEvent& event = ring.events[head % TRACE_RING_CAPACITY];
+    event.category = category;
+    event.name = name;
+    event.startNanos = startNanos;
+    event.durationNanos = durationNanos;
+    event.id = id;
+
+    // Publish the slot after it is fully written
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+long Tracing::getRecordedCount() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    long total = 0;
+    for (const TraceRing* ring : rings) {
+        total += static_cast<long>(std::min<uint64_t>(ring->head.load(std::memory_order_acquire),
+                                                      TRACE_RING_CAPACITY));
+    }
+    return total;
+}
+
+long Tracing::getThreadCount() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    return static_cast<long>(rings.size());
+}
+
+size_t Tracing::getAllocatedBytes() {
+    return getThreadCount() * sizeof(TraceRing);
+}
+
+long Tracing::exportChromeTrace(std::ostream& out) {
+    std::vector<TraceRing*> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        snapshot = rings;
+    }
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << std::fixed << std::setprecision(3);
+
+    long written = 0;
+    bool first = true;
+    std::vector<TraceEvent> copy;
+    for (const TraceRing* ring : snapshot) {
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << ring->threadIndex << ",\"args\":{\"name\":\"thread " << ring->threadIndex << "\"}}";
+        first = false;
+
+        // Copy the live window, then drop any slot the owner may have overwritten meanwhile
+        uint64_t end = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = (end > TRACE_RING_CAPACITY) ? end - TRACE_RING_CAPACITY : 0;
+        copy.clear();
+        for (uint64_t i = begin; i < end; ++i) {
+            copy.push_back(ring->events[i % TRACE_RING_CAPACITY]);
+        }
+        // (the slot at the new head may be half written, hence the + 1)
+        uint64_t after = ring->head.load(std::memory_order_acquire) + 1;
+        size_t skip = (after > begin + TRACE_RING_CAPACITY)
+                      ? std::min<size_t>(copy.size(), after - begin - TRACE_RING_CAPACITY) : 0;
+
+        for (size_t i = skip; i < copy.size(); ++i) {
+            const TraceEvent& event = copy[i];
+            out << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+                << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->threadIndex
+                << ",\"ts\":" << event.startNanos / 1000.0 << ",\"dur\":" << event.durationNanos / 1000.0;
+            if (event.id >= 0) {
+                out << ",\"args\":{\"id\":" << event.id << "}";
+            }
+            out << "}";
+            written++;
+        }
+    }
+
+    out << "\n]}\n";
+    return written;
+}
+
+bool Tracing::exportChromeTrace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    exportChromeTrace(file);
+    return static_cast<bool>(file);
+}
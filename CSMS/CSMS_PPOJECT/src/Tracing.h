@@ -0,0 +1,89 @@
+// ===== Tracing.h =====
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Build with -DCSMS_TRACING=0 (make TRACING=0) to compile the spans out
+#ifndef CSMS_TRACING
+#define CSMS_TRACING 1
+#endif
+
+constexpr int TRACE_RING_CAPACITY = 1 << 15;  // Most recent spans kept per thread
+
+/**
+ * @brief One completed span; category and name must be string literals
+ */
+struct TraceEvent {
+    const char* category;
+    const char* name;
+    int64_t startNanos;      // Since the trace clock origin
+    int64_t durationNanos;
+    long id;                 // Transaction ID (or other correlation key), -1 if none
+};
+
+/**
+ * @brief Span recorder with per-thread ring buffers and Chrome trace export
+ *
+ * Each thread appends to its own fixed-size ring, overwriting its oldest
+ * spans once full, so recording never blocks or allocates after the first
+ * span. Export copies every ring and writes the Chrome trace-event JSON
+ * format, which chrome://tracing and Perfetto open directly.
+ */
+class Tracing {
+private:
+    static std::atomic<bool> enabled;
+
+public:
+    static bool isEnabled() { return CSMS_TRACING && enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on);
+    static bool isCompiledIn() { return CSMS_TRACING != 0; }
+
+    static int64_t now();
+    static void record(const char* category, const char* name, int64_t startNanos,
+                       int64_t durationNanos, long id);
+
+    static long getRecordedCount();
+    static long getThreadCount();          // Threads that have recorded a span
+    static size_t getAllocatedBytes();
+    static long exportChromeTrace(std::ostream& out);      // Returns the number of spans written
+    static bool exportChromeTrace(const std::string& path);
+};
+
+/**
+ * @brief Records the lifetime of a scope as a span when tracing is enabled
+ */
+class TraceSpan {
+private:
+    const char* category;
+    const char* name;
+    long id;
+    int64_t start;
+
+public:
+    TraceSpan(const char* category, const char* name, long id = -1)
+        : category(category), name(name), id(id), start(Tracing::isEnabled() ? Tracing::now() : -1) {}
+
+    ~TraceSpan() {
+        if (start >= 0) {
+            Tracing::record(category, name, start, Tracing::now() - start, id);
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+#define CSMS_TRACE_CONCAT_INNER(a, b) a##b
+#define CSMS_TRACE_CONCAT(a, b) CSMS_TRACE_CONCAT_INNER(a, b)
+
+#if CSMS_TRACING
+#define CSMS_TRACE_SPAN(category, name, id) TraceSpan CSMS_TRACE_CONCAT(traceSpan, __LINE__)(category, name, id)
+#else
+#define CSMS_TRACE_SPAN(category, name, id) ((void)0)
+#endif
+
+#endif // TRACING_H
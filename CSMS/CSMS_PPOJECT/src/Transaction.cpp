@@ -1,380 +1,729 @@
-// ===== Transaction.cpp =====
-#include "Transaction.h"
-#include <iostream>
-#include <iomanip>
-#include <sstream>
-#include <cmath>
-
-int Transaction::nextTransactionId = 10001;
-
-// TransactionItem implementation
-TransactionItem::TransactionItem(Product* prod, double qty, double discount, const std::string& notes)
-    : product(prod), quantity(qty), discount(discount), notes(notes) {
-    
-    if (product) {
-        unitPrice = product->calculateSellingPrice();
-        calculateSubtotal();
-    } else {
-        unitPrice = 0.0;
-        subtotal = 0.0;
-    }
-}
-
-void TransactionItem::calculateSubtotal() {
-    if (product) {
-        // For bulk products, use special pricing
-        BulkProduct* bulkProduct = dynamic_cast<BulkProduct*>(product);
-        if (bulkProduct) {
-            subtotal = bulkProduct->calculatePriceForQuantity(quantity);
-        } else {
-            subtotal = unitPrice * quantity;
-        }
-        
-        // Apply discount
-        subtotal *= (1.0 - discount);
-    }
-}
-
-void TransactionItem::displayItem() const {
-    if (product) {
-        std::cout << product->getName();
-        if (quantity != 1.0) {
-            std::cout << " x" << std::fixed << std::setprecision(2) << quantity;
-        }
-        std::cout << " @ $" << std::fixed << std::setprecision(2) << unitPrice;
-        if (discount > 0) {
-            std::cout << " (" << (discount * 100) << "% off)";
-        }
-        std::cout << " = $" << std::fixed << std::setprecision(2) << subtotal;
-        if (!notes.empty()) {
-            std::cout << " [" << notes << "]";
-        }
-        std::cout << std::endl;
-    }
-}
-
-// Transaction implementation
-Transaction::Transaction(Customer* customer, const std::string& cashierId)
-    : transactionId(nextTransactionId++), customer(customer), subtotal(0.0), tax(0.0),
-      totalDiscount(0.0), loyaltyPointsUsed(0.0), loyaltyPointsEarned(0.0), finalTotal(0.0),
-      paymentMethod(PaymentMethod::CASH), status(TransactionStatus::PENDING),
-      cashierId(cashierId) {
-    
-    timestamp = std::time(nullptr);
-}
-
-bool Transaction::addItem(Product* product, double quantity, double discount, const std::string& notes) {
-    if (!product || !product->getIsActive() || quantity <= 0) {
-        return false;
-    }
-    
-    // Check stock availability
-    if (product->getCurrentStock() < static_cast<int>(std::ceil(quantity))) {
-        std::cout << "Insufficient stock for " << product->getName() 
-                  << ". Available: " << product->getCurrentStock() << std::endl;
-        return false;
-    }
-    
-    // For bulk products, check minimum quantity
-    BulkProduct* bulkProduct = dynamic_cast<BulkProduct*>(product);
-    if (bulkProduct && quantity < bulkProduct->getMinimumQuantity()) {
-        std::cout << "Minimum quantity for " << product->getName() 
-                  << " is " << bulkProduct->getMinimumQuantity() 
-                  << " " << bulkProduct->getUnit() << std::endl;
-        return false;
-    }
-    
-    items.push_back(TransactionItem(product, quantity, discount, notes));
-    return true;
-}
-
-bool Transaction::removeItem(int itemIndex) {
-    if (itemIndex >= 0 && itemIndex < static_cast<int>(items.size())) {
-        items.erase(items.begin() + itemIndex);
-        return true;
-    }
-    return false;
-}
-
-void Transaction::clearItems() {
-    items.clear();
-}
-
-void Transaction::calculateTotals(double taxRate) {
-    subtotal = 0.0;
-    totalDiscount = 0.0;
-    
-    for (const auto& item : items) {
-        subtotal += item.subtotal;
-        if (item.discount > 0 && item.product) {
-            double originalPrice = item.product->calculateSellingPrice() * item.quantity;
-            totalDiscount += (originalPrice - item.subtotal);
-        }
-    }
-    
-    // Apply customer discount
-    if (customer) {
-        double customerDiscount = subtotal * customer->getDiscountRate();
-        totalDiscount += customerDiscount;
-        subtotal -= customerDiscount;
-    }
-    
-    // Apply loyalty points discount
-    subtotal -= loyaltyPointsUsed;
-    
-    // Calculate tax
-    tax = subtotal * taxRate;
-    
-    // Calculate final total
-    finalTotal = subtotal + tax;
-    
-    // Calculate loyalty points earned
-    if (customer) {
-        loyaltyPointsEarned = finalTotal * 0.01; // 1% base rate
-        if (customer->getType() == CustomerType::PREMIUM) {
-            loyaltyPointsEarned *= 1.5;
-        } else if (customer->getType() == CustomerType::VIP) {
-            loyaltyPointsEarned *= 2.0;
-        }
-    }
-}
-
-bool Transaction::processPayment(PaymentMethod method, double amountPaid) {
-    if (finalTotal <= 0) {
-        return false;
-    }
-    
-    paymentMethod = method;
-    
-    // For cash payments, check if enough money was provided
-    if (method == PaymentMethod::CASH && amountPaid < finalTotal) {
-        std::cout << "Insufficient payment. Required: $" << std::fixed << std::setprecision(2) 
-                  << finalTotal << ", Provided: $" << amountPaid << std::endl;
-        return false;
-    }
-    
-    return true;
-}
-
-bool Transaction::applyLoyaltyPoints(double points) {
-    if (!customer || customer->getLoyaltyPoints() < points) {
-        return false;
-    }
-    
-    loyaltyPointsUsed = points;
-    return true;
-}
-
-void Transaction::finalizeTransaction() {
-    if (status != TransactionStatus::PENDING) {
-        return;
-    }
-    
-    // Reduce stock for all items
-    for (const auto& item : items) {
-        if (item.product) {
-            item.product->reduceStock(static_cast<int>(std::ceil(item.quantity)));
-        }
-    }
-    
-    // Update customer data
-    if (customer) {
-        customer->addPurchase(finalTotal);
-        if (loyaltyPointsUsed > 0) {
-            customer->redeemLoyaltyPoints(loyaltyPointsUsed);
-        }
-        customer->addLoyaltyPoints(loyaltyPointsEarned);
-    }
-    
-    status = TransactionStatus::COMPLETED;
-}
-
-std::string Transaction::getPaymentMethodString() const {
-    switch (paymentMethod) {
-        case PaymentMethod::CASH: return "Cash";
-        case PaymentMethod::CREDIT_CARD: return "Credit Card";
-        case PaymentMethod::DEBIT_CARD: return "Debit Card";
-        case PaymentMethod::MOBILE_PAYMENT: return "Mobile Payment";
-        case PaymentMethod::LOYALTY_POINTS: return "Loyalty Points";
-        case PaymentMethod::GIFT_CARD: return "Gift Card";
-        default: return "Unknown";
-    }
-}
-
-std::string Transaction::getStatusString() const {
-    switch (status) {
-        case TransactionStatus::PENDING: return "Pending";
-        case TransactionStatus::COMPLETED: return "Completed";
-        case TransactionStatus::CANCELLED: return "Cancelled";
-        case TransactionStatus::REFUNDED: return "Refunded";
-        case TransactionStatus::PARTIALLY_REFUNDED: return "Partially Refunded";
-        default: return "Unknown";
-    }
-}
-
-void Transaction::printReceipt() const {
-    std::cout << "\n" << std::string(40, '=') << std::endl;
-    std::cout << "           CONVENIENCE STORE           " << std::endl;
-    std::cout << "               RECEIPT                 " << std::endl;
-    std::cout << std::string(40, '=') << std::endl;
-    
-    std::cout << "Transaction ID: " << transactionId << std::endl;
-    std::cout << "Date: " << std::ctime(&timestamp);
-    std::cout << "Cashier: " << cashierId << std::endl;
-    
-    if (customer) {
-        std::cout << "Customer: " << customer->getFullName() 
-                  << " (" << customer->getTypeString() << ")" << std::endl;
-    }
-    
-    std::cout << std::string(40, '-') << std::endl;
-    
-    for (const auto& item : items) {
-        item.displayItem();
-    }
-    
-    std::cout << std::string(40, '-') << std::endl;
-    std::cout << "Subtotal: $" << std::fixed << std::setprecision(2) << subtotal << std::endl;
-    
-    if (totalDiscount > 0) {
-        std::cout << "Discount: -$" << std::fixed << std::setprecision(2) << totalDiscount << std::endl;
-    }
-    
-    if (loyaltyPointsUsed > 0) {
-        std::cout << "Loyalty Points Used: -$" << std::fixed << std::setprecision(2) 
-                  << loyaltyPointsUsed << std::endl;
-    }
-    
-    std::cout << "Tax: $" << std::fixed << std::setprecision(2) << tax << std::endl;
-    std::cout << "TOTAL: $" << std::fixed << std::setprecision(2) << finalTotal << std::endl;
-    
-    std::cout << std::string(40, '-') << std::endl;
-    std::cout << "Payment Method: " << getPaymentMethodString() << std::endl;
-    std::cout << "Status: " << getStatusString() << std::endl;
-    
-    if (customer && loyaltyPointsEarned > 0) {
-        std::cout << "Loyalty Points Earned: " << std::fixed << std::setprecision(2) 
-                  << loyaltyPointsEarned << std::endl;
-        std::cout << "Total Loyalty Points: " << std::fixed << std::setprecision(2) 
-                  << customer->getLoyaltyPoints() << std::endl;
-    }
-    
-    std::cout << std::string(40, '=') << std::endl;
-    std::cout << "    Thank you for shopping with us!    " << std::endl;
-    std::cout << std::string(40, '=') << std::endl << std::endl;
-}
-
-bool Transaction::processRefund(double amount) {
-    if (status != TransactionStatus::COMPLETED) {
-        return false;
-    }
-    
-    if (amount == -1.0) {
-        amount = finalTotal; // Full refund
-    }
-    
-    if (amount > finalTotal) {
-        return false;
-    }
-    
-    // Return items to stock
-    for (const auto& item : items) {
-        if (item.product) {
-            item.product->addStock(static_cast<int>(std::ceil(item.quantity)));
-        }
-    }
-    
-    // Update customer data
-    if (customer) {
-        customer->addPurchase(-amount); // Subtract from total spent
-        if (loyaltyPointsEarned > 0) {
-            customer->redeemLoyaltyPoints(loyaltyPointsEarned); // Remove earned points
-        }
-    }
-    
-    if (amount >= finalTotal) {
-        status = TransactionStatus::REFUNDED;
-    } else {
-        status = TransactionStatus::PARTIALLY_REFUNDED;
-    }
-    
-    return true;
-}
-
-void Transaction::printDetailedReceipt() const {
-    std::cout << "\n" << std::string(50, '=') << std::endl;
-    std::cout << "           DETAILED TRANSACTION RECEIPT        " << std::endl;
-    std::cout << std::string(50, '=') << std::endl;
-    
-    std::cout << "Transaction ID: " << transactionId << std::endl;
-    std::cout << "Date & Time: " << std::ctime(&timestamp);
-    std::cout << "Cashier: " << cashierId << std::endl;
-    std::cout << "Status: " << getStatusString() << std::endl;
-    
-    if (customer) {
-        std::cout << "\nCustomer Information:" << std::endl;
-        std::cout << "  Name: " << customer->getFullName() << std::endl;
-        std::cout << "  Type: " << customer->getTypeString() << std::endl;
-        std::cout << "  ID: " << customer->getId() << std::endl;
-        std::cout << "  Discount Rate: " << (customer->getDiscountRate() * 100) << "%" << std::endl;
-    }
-    
-    std::cout << "\n" << std::string(50, '-') << std::endl;
-    std::cout << "ITEMS PURCHASED:" << std::endl;
-    std::cout << std::string(50, '-') << std::endl;
-    
-    for (size_t i = 0; i < items.size(); ++i) {
-        const auto& item = items[i];
-        std::cout << (i + 1) << ". ";
-        item.displayItem();
-        
-        if (!item.notes.empty()) {
-            std::cout << "    Note: " << item.notes << std::endl;
-        }
-    }
-    
-    std::cout << std::string(50, '-') << std::endl;
-    std::cout << "FINANCIAL BREAKDOWN:" << std::endl;
-    std::cout << std::string(50, '-') << std::endl;
-    
-    double itemTotal = 0.0;
-    for (const auto& item : items) {
-        itemTotal += item.subtotal;
-    }
-    
-    std::cout << "Items Subtotal: $" << std::fixed << std::setprecision(2) << itemTotal << std::endl;
-    
-    if (totalDiscount > 0) {
-        std::cout << "Total Discounts: -$" << std::fixed << std::setprecision(2) << totalDiscount << std::endl;
-        std::cout << "After Discounts: $" << std::fixed << std::setprecision(2) << (itemTotal - totalDiscount) << std::endl;
-    }
-    
-    if (loyaltyPointsUsed > 0) {
-        std::cout << "Loyalty Points Used: -$" << std::fixed << std::setprecision(2) << loyaltyPointsUsed << std::endl;
-    }
-    
-    std::cout << "Subtotal: $" << std::fixed << std::setprecision(2) << subtotal << std::endl;
-    std::cout << "Tax (8%): $" << std::fixed << std::setprecision(2) << tax << std::endl;
-    std::cout << "FINAL TOTAL: $" << std::fixed << std::setprecision(2) << finalTotal << std::endl;
-    
-    std::cout << "\n" << std::string(50, '-') << std::endl;
-    std::cout << "PAYMENT INFORMATION:" << std::endl;
-    std::cout << std::string(50, '-') << std::endl;
-    std::cout << "Payment Method: " << getPaymentMethodString() << std::endl;
-    std::cout << "Amount Paid: $" << std::fixed << std::setprecision(2) << finalTotal << std::endl;
-    
-    if (customer && loyaltyPointsEarned > 0) {
-        std::cout << "\nLOYALTY PROGRAM:" << std::endl;
-        std::cout << "Points Earned: " << std::fixed << std::setprecision(2) << loyaltyPointsEarned << std::endl;
-        std::cout << "Current Points Balance: " << std::fixed << std::setprecision(2) << customer->getLoyaltyPoints() << std::endl;
-    }
-    
-    if (!notes.empty()) {
-        std::cout << "\nTransaction Notes: " << notes << std::endl;
-    }
-    
-    std::cout << std::string(50, '=') << std::endl;
-    std::cout << "    Thank you for shopping with us!    " << std::endl;
-    std::cout << "         Please come again!           " << std::endl;
-    std::cout << std::string(50, '=') << std::endl << std::endl;
-}
\ No newline at end of file
+// ===== Transaction.cpp =====
+#include "Transaction.h"
+#include "LatencyHistogram.h"
+#include "Tracing.h"
+#include "MemoryAccounting.h"
+#include "PersistenceFlusher.h"
+#include "PriceBook.h"
+#include "Gtin.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+
+std::atomic<int> Transaction::nextTransactionId(10001);
+
+// Receipt separators, built once instead of per rendered line
+static const std::string RECEIPT_RULE(40, '=');
+static const std::string RECEIPT_DIVIDER(40, '-');
+static const std::string DETAIL_RULE(50, '=');
+static const std::string DETAIL_DIVIDER(50, '-');
+
+// TransactionItem implementation
+TransactionItem::TransactionItem(Product* prod, double qty, double discount, const std::string& notes)
+    : product(prod), quantity(qty), discount(discount), notes(notes),
+      taxRateBasisPoints(0), netAmount(0.0), tax(0.0), stockUnits(0), refundedQuantity(0.0) {
+    
+    if (product) {
+        product->hold();
+        unitPrice = product->calculateSellingPrice();
+        calculateSubtotal();
+    } else {
+        unitPrice = 0.0;
+        subtotal = 0.0;
+    }
+}
+
+TransactionItem::TransactionItem(const TransactionItem& other)
+    : product(other.product), quantity(other.quantity), unitPrice(other.unitPrice), discount(other.discount),
+      subtotal(other.subtotal), notes(other.notes), taxRateBasisPoints(other.taxRateBasisPoints),
+      netAmount(other.netAmount), tax(other.tax), stockUnits(other.stockUnits),
+      refundedQuantity(other.refundedQuantity) {
+    if (product) {
+        product->hold();
+    }
+}
+
+TransactionItem& TransactionItem::operator=(const TransactionItem& other) {
+    if (other.product) {
+        other.product->hold();
+    }
+    if (product) {
+        product->release();
+    }
+    product = other.product;
+    quantity = other.quantity;
+    unitPrice = other.unitPrice;
+    discount = other.discount;
+    subtotal = other.subtotal;
+    notes = other.notes;
+    taxRateBasisPoints = other.taxRateBasisPoints;
+    netAmount = other.netAmount;
+    tax = other.tax;
+    stockUnits = other.stockUnits;
+    refundedQuantity = other.refundedQuantity;
+    return *this;
+}
+
+TransactionItem::~TransactionItem() {
+    if (product) {
+        product->release();
+    }
+}
+
+void TransactionItem::calculateSubtotal() {
+    if (product) {
+        // For bulk products, use special pricing
+        BulkProduct* bulkProduct = dynamic_cast<BulkProduct*>(product);
+        if (bulkProduct) {
+            subtotal = unitPrice * std::max(quantity, bulkProduct->getMinimumQuantity());
+        } else {
+            subtotal = unitPrice * quantity;
+        }
+        
+        // Apply discount
+        subtotal *= (1.0 - discount);
+    }
+}
+
+int TransactionItem::stockUnitsReturnedAt(double refunded) const {
+    // Whole units go back as they are returned; the rounded-up remainder of a
+    // bulk line only goes back once the line is fully returned
+    if (refunded >= quantity - 1e-9) {
+        return stockUnits;
+    }
+    int units = static_cast<int>(std::floor(refunded + 1e-9));
+    return units < stockUnits ? units : stockUnits;
+}
+
+void TransactionItem::displayItem() const {
+    renderItem(std::cout);
+    std::cout.flush();
+}
+
+void TransactionItem::renderItem(std::ostream& out) const {
+    if (product) {
+        out << product->getName();
+        if (quantity != 1.0) {
+            out << " x" << std::fixed << std::setprecision(2) << quantity;
+        }
+        out << " @ $" << std::fixed << std::setprecision(2) << unitPrice;
+        if (discount > 0) {
+            out << " (" << (discount * 100) << "% off)";
+        }
+        out << " = $" << std::fixed << std::setprecision(2) << subtotal;
+        if (!notes.empty()) {
+            out << " [" << notes << "]";
+        }
+        out << "\n";
+    }
+}
+
+// Transaction implementation
+Transaction::Transaction(Customer* customer, const std::string& cashierId)
+    : transactionId(nextTransactionId++), customer(customer), subtotal(0.0), tax(0.0),
+      totalDiscount(0.0), loyaltyPointsUsed(0.0), loyaltyPointsEarned(0.0), finalTotal(0.0),
+      taxIncluded(false), refundedTotal(0.0), paymentMethod(PaymentMethod::CASH), status(TransactionStatus::PENDING),
+      cashierId(cashierId) {
+    CSMS_TRACE_SPAN("transaction", "Transaction::Transaction", transactionId);
+    timestamp = std::time(nullptr);
+}
+
+bool Transaction::addItem(Product* product, double quantity, double discount, const std::string& notes) {
+    CSMS_TIME_LATENCY(ADD_ITEM);
+    CSMS_TRACE_SPAN("transaction", "Transaction::addItem", transactionId);
+    if (!product || !product->getIsActive() || quantity <= 0) {
+        return false;
+    }
+    
+    // Check stock availability; units reserved for outgoing transfers are not for sale
+    if (product->getAvailableStock() < static_cast<int>(std::ceil(quantity))) {
+        std::cout << "Insufficient stock for " << product->getName() 
+                  << ". Available: " << product->getAvailableStock() << std::endl;
+        return false;
+    }
+    
+    // For bulk products, check minimum quantity
+    BulkProduct* bulkProduct = dynamic_cast<BulkProduct*>(product);
+    if (bulkProduct && quantity < bulkProduct->getMinimumQuantity()) {
+        std::cout << "Minimum quantity for " << product->getName() 
+                  << " is " << bulkProduct->getMinimumQuantity() 
+                  << " " << bulkProduct->getUnit() << std::endl;
+        return false;
+    }
+    
+    items.push_back(TransactionItem(product, quantity, discount, notes));
+    if (prices) {
+        items.back().unitPrice = prices->priceOf(*product);
+        items.back().calculateSubtotal();
+    }
+    return true;
+}
+
+bool Transaction::addScannedItem(Product* product, const BarcodeScan& scan) {
+    if (!product) {
+        return false;
+    }
+    if (scan.measure == MeasureKind::WEIGHT) {
+        return addItem(product, scan.quantity);
+    }
+    if (scan.measure != MeasureKind::PRICE) {
+        return addItem(product, 1.0);
+    }
+
+    // The label's price is what the customer pays; weighed goods get the
+    // quantity it buys at the cart's price, to the gram
+    double quantity = 1.0;
+    if (dynamic_cast<BulkProduct*>(product)) {
+        double unitPrice = prices ? prices->priceOf(*product) : product->calculateSellingPrice();
+        if (unitPrice <= 0) {
+            return false;
+        }
+        quantity = std::round(scan.price / unitPrice * 1000.0) / 1000.0;
+    }
+    if (!addItem(product, quantity)) {
+        return false;
+    }
+    TransactionItem& item = items.back();
+    item.unitPrice = scan.price / quantity;
+    item.subtotal = scan.price;
+    return true;
+}
+
+bool Transaction::removeItem(int itemIndex) {
+    if (itemIndex >= 0 && itemIndex < static_cast<int>(items.size())) {
+        items.erase(items.begin() + itemIndex);
+        return true;
+    }
+    return false;
+}
+
+void Transaction::clearItems() {
+    items.clear();
+}
+
+void Transaction::calculateTotals(double taxRate) {
+    // Flat rate across every category, as before the tax engine existed; the
+    // jurisdiction is rebuilt only when a thread asks for a different rate
+    thread_local double flatRate = 0.08;
+    thread_local TaxJurisdiction flat = TaxTable::makeFlatJurisdiction("FLAT", flatRate);
+    if (taxRate != flatRate) {
+        flat = TaxTable::makeFlatJurisdiction("FLAT", taxRate);
+        flatRate = taxRate;
+    }
+    calculateTotals(flat);
+}
+
+void Transaction::calculateTotals(const TaxJurisdiction& jurisdiction) {
+    CSMS_TIME_LATENCY(CALCULATE_TOTALS);
+    CSMS_TRACE_SPAN("pricing", "Transaction::calculateTotals", transactionId);
+    double itemsSubtotal = 0.0;
+    double categoryAmount[PRODUCT_CATEGORY_COUNT] = {0.0};
+    totalDiscount = 0.0;
+    
+    // Single pass over the lines: totals, discounts and per-category taxable base
+    for (auto& item : items) {
+        int categoryIndex = static_cast<int>(item.product ? item.product->getCategory()
+                                                          : ProductCategory::OTHER);
+        item.taxRateBasisPoints = jurisdiction.rateBasisPoints[categoryIndex];
+        categoryAmount[categoryIndex] += item.subtotal;
+        itemsSubtotal += item.subtotal;
+        if (item.discount > 0 && item.product) {
+            double originalPrice = item.unitPrice * item.quantity;
+            totalDiscount += (originalPrice - item.subtotal);
+        }
+    }
+    subtotal = itemsSubtotal;
+    
+    // Apply customer discount
+    if (customer) {
+        double customerDiscount = subtotal * customer->getDiscountRate();
+        totalDiscount += customerDiscount;
+        subtotal -= customerDiscount;
+    }
+    
+    // Apply loyalty points discount
+    subtotal -= loyaltyPointsUsed;
+    
+    // Transaction-level discounts are spread over the lines pro rata
+    double scale = (itemsSubtotal > 0) ? subtotal / itemsSubtotal : 0.0;
+    
+    // Tax factor per category: r for exclusive pricing, r / (1 + r) when prices include tax
+    double taxFactor[PRODUCT_CATEGORY_COUNT];
+    double inclusive = jurisdiction.pricesIncludeTax ? 1.0 : 0.0;
+    for (int c = 0; c < PRODUCT_CATEGORY_COUNT; ++c) {
+        double rate = jurisdiction.rateFor(static_cast<ProductCategory>(c));
+        taxFactor[c] = rate / (1.0 + inclusive * rate);
+    }
+    
+    // Calculate tax and its per-rate breakdown
+    tax = 0.0;
+    taxBreakdown.clear();
+    for (int c = 0; c < PRODUCT_CATEGORY_COUNT; ++c) {
+        if (categoryAmount[c] == 0.0) {
+            continue;
+        }
+        double amount = categoryAmount[c] * scale;
+        double categoryTax = amount * taxFactor[c];
+        taxBreakdown.add(jurisdiction.rateBasisPoints[c], amount - inclusive * categoryTax, categoryTax);
+        tax += categoryTax;
+    }
+    
+    // Per-line tax, kept on the item so refunds can reverse it exactly
+    for (auto& item : items) {
+        int categoryIndex = static_cast<int>(item.product ? item.product->getCategory()
+                                                          : ProductCategory::OTHER);
+        double amount = item.subtotal * scale;
+        item.tax = amount * taxFactor[categoryIndex];
+        item.netAmount = amount - inclusive * item.tax;
+    }
+    
+    // Tax-inclusive prices already contain the tax, so subtotal is reported net of it
+    taxIncluded = jurisdiction.pricesIncludeTax;
+    subtotal -= inclusive * tax;
+    
+    // Calculate final total
+    finalTotal = subtotal + tax;
+    
+    // Calculate loyalty points earned
+    if (customer) {
+        loyaltyPointsEarned = finalTotal * 0.01; // 1% base rate
+        if (customer->getType() == CustomerType::PREMIUM) {
+            loyaltyPointsEarned *= 1.5;
+        } else if (customer->getType() == CustomerType::VIP) {
+            loyaltyPointsEarned *= 2.0;
+        }
+    }
+}
+
+bool Transaction::processPayment(PaymentMethod method, double amountPaid) {
+    CSMS_TRACE_SPAN("payment", "Transaction::processPayment", transactionId);
+    if (finalTotal <= 0) {
+        return false;
+    }
+    
+    paymentMethod = method;
+    
+    // For cash payments, check if enough money was provided
+    if (method == PaymentMethod::CASH && amountPaid < finalTotal) {
+        std::cout << "Insufficient payment. Required: $" << std::fixed << std::setprecision(2) 
+                  << finalTotal << ", Provided: $" << amountPaid << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+bool Transaction::applyLoyaltyPoints(double points) {
+    CSMS_TRACE_SPAN("loyalty", "Transaction::applyLoyaltyPoints", transactionId);
+    if (!customer || customer->getLoyaltyPoints() < points) {
+        return false;
+    }
+    
+    loyaltyPointsUsed = points;
+    return true;
+}
+
+void Transaction::finalizeTransaction(PersistenceFlusher* journal) {
+    CSMS_TIME_LATENCY(FINALIZE_TRANSACTION);
+    CSMS_TRACE_SPAN("transaction", "Transaction::finalizeTransaction", transactionId);
+    if (status != TransactionStatus::PENDING) {
+        return;
+    }
+    
+    // Reduce stock for all items, remembering what was actually taken
+    {
+        CSMS_TRACE_SPAN("stock", "Transaction::commitStock", transactionId);
+        for (auto& item : items) {
+            if (item.product) {
+                int units = static_cast<int>(std::ceil(item.quantity));
+                item.stockUnits = item.product->reduceStock(units) ? units : 0;
+            }
+        }
+    }
+    
+    // Update customer data
+    if (customer) {
+        CSMS_TRACE_SPAN("loyalty", "Transaction::updateCustomer", transactionId);
+        customer->addPurchase(finalTotal);
+        if (loyaltyPointsUsed > 0) {
+            customer->redeemLoyaltyPoints(loyaltyPointsUsed);
+        }
+        customer->addLoyaltyPoints(loyaltyPointsEarned);
+    }
+    
+    status = TransactionStatus::COMPLETED;
+    prices.reset();   // Completed sales must not keep an old price version alive
+
+    if (journal) {
+        CSMS_TRACE_SPAN("journal", "PersistenceFlusher::submitSale", transactionId);
+        journal->submitSale(*this);
+    }
+}
+
+std::string Transaction::getPaymentMethodString() const {
+    return paymentMethodName(paymentMethod);
+}
+
+std::string Transaction::getStatusString() const {
+    return statusName(status);
+}
+
+std::string Transaction::paymentMethodName(PaymentMethod method) {
+    switch (method) {
+        case PaymentMethod::CASH: return "Cash";
+        case PaymentMethod::CREDIT_CARD: return "Credit Card";
+        case PaymentMethod::DEBIT_CARD: return "Debit Card";
+        case PaymentMethod::MOBILE_PAYMENT: return "Mobile Payment";
+        case PaymentMethod::LOYALTY_POINTS: return "Loyalty Points";
+        case PaymentMethod::GIFT_CARD: return "Gift Card";
+        default: return "Unknown";
+    }
+}
+
+std::string Transaction::statusName(TransactionStatus status) {
+    switch (status) {
+        case TransactionStatus::PENDING: return "Pending";
+        case TransactionStatus::COMPLETED: return "Completed";
+        case TransactionStatus::CANCELLED: return "Cancelled";
+        case TransactionStatus::REFUNDED: return "Refunded";
+        case TransactionStatus::PARTIALLY_REFUNDED: return "Partially Refunded";
+        default: return "Unknown";
+    }
+}
+
+void Transaction::renderTaxBreakdown(std::ostream& out) const {
+    for (int i = 0; i < taxBreakdown.entryCount; ++i) {
+        const TaxBreakdownEntry& entry = taxBreakdown.entries[i];
+        out << "  " << std::fixed << std::setprecision(2) << (entry.rateBasisPoints / 100.0)
+            << "% on $" << entry.taxableAmount << ": $" << entry.taxAmount << "\n";
+    }
+}
+
+size_t Transaction::getHeapBytes() const {
+    size_t bytes = MemorySizing::vectorBytes(items) + MemorySizing::stringBytes(cashierId) +
+                   MemorySizing::stringBytes(notes);
+    for (const auto& item : items) {
+        bytes += MemorySizing::stringBytes(item.notes);
+    }
+    return bytes;
+}
+
+void Transaction::printReceipt() const {
+    renderReceipt(std::cout);
+    std::cout.flush();
+}
+
+void Transaction::renderReceipt(std::ostream& out) const {
+    CSMS_TRACE_SPAN("receipt", "Transaction::renderReceipt", transactionId);
+    // Money is printed fixed to 2 places; the caller's format is put back at the end
+    std::ios::fmtflags savedFlags = out.flags();
+    std::streamsize savedPrecision = out.precision();
+    out << "\n" << RECEIPT_RULE << "\n";
+    out << "           CONVENIENCE STORE           \n";
+    out << "               RECEIPT                 \n";
+    out << RECEIPT_RULE << "\n";
+    
+    out << "Transaction ID: " << transactionId << "\n";
+    out << "Date: " << std::ctime(&timestamp);
+    out << "Cashier: " << cashierId << "\n";
+    
+    if (customer) {
+        out << "Customer: " << customer->getFullName() 
+            << " (" << customer->getTypeString() << ")\n";
+    }
+    
+    out << RECEIPT_DIVIDER << "\n";
+    
+    for (const auto& item : items) {
+        item.renderItem(out);
+    }
+    
+    out << RECEIPT_DIVIDER << "\n";
+    out << "Subtotal: $" << std::fixed << std::setprecision(2) << subtotal << "\n";
+    
+    if (totalDiscount > 0) {
+        out << "Discount: -$" << std::fixed << std::setprecision(2) << totalDiscount << "\n";
+    }
+    
+    if (loyaltyPointsUsed > 0) {
+        out << "Loyalty Points Used: -$" << std::fixed << std::setprecision(2) 
+            << loyaltyPointsUsed << "\n";
+    }
+    
+    out << "Tax" << (taxIncluded ? " (included)" : "") << ": $"
+        << std::fixed << std::setprecision(2) << tax << "\n";
+    if (taxBreakdown.entryCount > 1) {
+        renderTaxBreakdown(out);
+    }
+    out << "TOTAL: $" << std::fixed << std::setprecision(2) << finalTotal << "\n";
+    if (refundedTotal > 0) {
+        out << "Refunded: -$" << std::fixed << std::setprecision(2) << refundedTotal << "\n";
+    }
+    
+    out << RECEIPT_DIVIDER << "\n";
+    out << "Payment Method: " << getPaymentMethodString() << "\n";
+    out << "Status: " << getStatusString() << "\n";
+    
+    if (customer && loyaltyPointsEarned > 0) {
+        out << "Loyalty Points Earned: " << std::fixed << std::setprecision(2) 
+            << loyaltyPointsEarned << "\n";
+        out << "Total Loyalty Points: " << std::fixed << std::setprecision(2) 
+            << customer->getLoyaltyPoints() << "\n";
+    }
+    
+    out << RECEIPT_RULE << "\n";
+    out << "    Thank you for shopping with us!    \n";
+    out << RECEIPT_RULE << "\n\n";
+    out.flags(savedFlags);
+    out.precision(savedPrecision);
+}
+
+bool Transaction::canRefund() const {
+    return (status == TransactionStatus::COMPLETED ||
+            status == TransactionStatus::PARTIALLY_REFUNDED) &&
+           getRefundableAmount() > 0.005;
+}
+
+RefundLine Transaction::refundLine(int itemIndex, double quantity) {
+    TransactionItem& item = items[itemIndex];
+    
+    RefundLine line;
+    line.itemIndex = itemIndex;
+    line.quantity = quantity;
+    
+    double share = quantity / item.quantity;
+    line.amount = item.getPaidAmount() * share;
+    line.tax = item.tax * share;
+    
+    // Put back exactly the stock units this return releases
+    int before = item.stockUnitsReturnedAt(item.refundedQuantity);
+    item.refundedQuantity += quantity;
+    int returned = item.stockUnitsReturnedAt(item.refundedQuantity) - before;
+    line.stockRestored = 0;
+    if (item.product && returned > 0) {
+        // A shelf already at its maximum takes back fewer units than were returned
+        line.stockRestored = item.product->addStock(returned);
+    }
+    
+    return line;
+}
+
+void Transaction::applyRefund(RefundRecord& refund) {
+    refund.transactionId = transactionId;
+    refund.timestamp = std::time(nullptr);
+    refund.loyaltyPointsReversed = (finalTotal > 0) ? loyaltyPointsEarned * (refund.amount / finalTotal) : 0.0;
+    
+    // Update customer data proportionally to what was refunded
+    if (customer) {
+        customer->recordRefund(refund.amount, refund.loyaltyPointsReversed);
+    }
+    
+    refundedTotal += refund.amount;
+    if (getRefundableAmount() <= 0.005) {
+        status = TransactionStatus::REFUNDED;
+    } else {
+        status = TransactionStatus::PARTIALLY_REFUNDED;
+    }
+}
+
+bool Transaction::processItemRefunds(const std::vector<std::pair<int, double>>& itemQuantities,
+                                     RefundRecord* record) {
+    CSMS_TIME_LATENCY(ITEM_REFUND);
+    CSMS_TRACE_SPAN("refund", "Transaction::processItemRefunds", transactionId);
+    if (!canRefund() || itemQuantities.empty()) {
+        return false;
+    }
+    
+    // Validate every line first so a bad line leaves the transaction untouched
+    std::vector<double> requested(items.size(), 0.0);
+    for (const auto& request : itemQuantities) {
+        if (request.first < 0 || request.first >= static_cast<int>(items.size()) || request.second <= 0) {
+            return false;
+        }
+        requested[request.first] += request.second;
+        if (requested[request.first] > items[request.first].getRefundableQuantity() + 1e-9) {
+            return false;
+        }
+    }
+    
+    RefundRecord refund;
+    for (const auto& request : itemQuantities) {
+        RefundLine line = refundLine(request.first, request.second);
+        refund.amount += line.amount;
+        refund.tax += line.tax;
+        refund.lines.push_back(line);
+    }
+    
+    // An earlier monetary refund may already cover part of these lines
+    if (refund.amount > getRefundableAmount()) {
+        double cap = getRefundableAmount();
+        refund.tax *= cap / refund.amount;
+        refund.amount = cap;
+    }
+    applyRefund(refund);
+    
+    if (record) {
+        *record = refund;
+    }
+    return true;
+}
+
+bool Transaction::processItemRefund(int itemIndex, double quantity, RefundRecord* record) {
+    return processItemRefunds(std::vector<std::pair<int, double>>(1, std::make_pair(itemIndex, quantity)),
+                              record);
+}
+
+bool Transaction::processPartialRefund(int itemIndex, double refundAmount, RefundRecord* record) {
+    if (itemIndex < 0 || itemIndex >= static_cast<int>(items.size()) || refundAmount <= 0) {
+        return false;
+    }
+    
+    // Convert the amount into the quantity of the line it pays for
+    const TransactionItem& item = items[itemIndex];
+    double paidPerUnit = item.getPaidAmount() / item.quantity;
+    if (paidPerUnit <= 0) {
+        return false;
+    }
+    double quantity = refundAmount / paidPerUnit;
+    if (quantity > item.getRefundableQuantity() + 1e-9) {
+        return false;
+    }
+    if (quantity > item.getRefundableQuantity()) {
+        quantity = item.getRefundableQuantity();
+    }
+    return processItemRefund(itemIndex, quantity, record);
+}
+
+bool Transaction::processRefund(double amount, RefundRecord* record) {
+    CSMS_TIME_LATENCY(PROCESS_REFUND);
+    CSMS_TRACE_SPAN("refund", "Transaction::processRefund", transactionId);
+    if (!canRefund()) {
+        return false;
+    }
+    
+    if (amount == -1.0 || std::fabs(amount - getRefundableAmount()) <= 0.005) {
+        // Full refund: return everything still outstanding on every line
+        std::vector<std::pair<int, double>> remaining;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (items[i].getRefundableQuantity() > 1e-9) {
+                remaining.push_back(std::make_pair(static_cast<int>(i), items[i].getRefundableQuantity()));
+            }
+        }
+        if (!remaining.empty()) {
+            return processItemRefunds(remaining, record);
+        }
+        amount = getRefundableAmount();
+    }
+    
+    if (amount <= 0 || amount > getRefundableAmount() + 0.005) {
+        return false;
+    }
+    
+    // Monetary refund (price adjustment, goodwill): nothing goes back on the shelf
+    RefundRecord refund;
+    refund.amount = amount;
+    refund.tax = (finalTotal > 0) ? tax * (amount / finalTotal) : 0.0;
+    refund.reason = "Monetary refund";
+    applyRefund(refund);
+    
+    if (record) {
+        *record = refund;
+    }
+    return true;
+}
+
+void Transaction::printDetailedReceipt() const {
+    renderDetailedReceipt(std::cout);
+    std::cout.flush();
+}
+
+void Transaction::renderDetailedReceipt(std::ostream& out) const {
+    CSMS_TRACE_SPAN("receipt", "Transaction::renderDetailedReceipt", transactionId);
+    // Money is printed fixed to 2 places; the caller's format is put back at the end
+    std::ios::fmtflags savedFlags = out.flags();
+    std::streamsize savedPrecision = out.precision();
+    out << "\n" << DETAIL_RULE << "\n";
+    out << "           DETAILED TRANSACTION RECEIPT        \n";
+    out << DETAIL_RULE << "\n";
+    
+    out << "Transaction ID: " << transactionId << "\n";
+    out << "Date & Time: " << std::ctime(&timestamp);
+    out << "Cashier: " << cashierId << "\n";
+    out << "Status: " << getStatusString() << "\n";
+    
+    if (customer) {
+        out << "\nCustomer Information:\n";
+        out << "  Name: " << customer->getFullName() << "\n";
+        out << "  Type: " << customer->getTypeString() << "\n";
+        out << "  ID: " << customer->getId() << "\n";
+        out << "  Discount Rate: " << (customer->getDiscountRate() * 100) << "%\n";
+    }
+    
+    out << "\n" << DETAIL_DIVIDER << "\n";
+    out << "ITEMS PURCHASED:\n";
+    out << DETAIL_DIVIDER << "\n";
+    
+    for (size_t i = 0; i < items.size(); ++i) {
+        const auto& item = items[i];
+        out << (i + 1) << ". ";
+        item.renderItem(out);
+        
+        if (!item.notes.empty()) {
+            out << "    Note: " << item.notes << "\n";
+        }
+    }
+    
+    out << DETAIL_DIVIDER << "\n";
+    out << "FINANCIAL BREAKDOWN:\n";
+    out << DETAIL_DIVIDER << "\n";
+    
+    double itemTotal = 0.0;
+    for (const auto& item : items) {
+        itemTotal += item.subtotal;
+    }
+    
+    out << "Items Subtotal: $" << std::fixed << std::setprecision(2) << itemTotal << "\n";
+    
+    if (totalDiscount > 0) {
+        out << "Total Discounts: -$" << std::fixed << std::setprecision(2) << totalDiscount << "\n";
+        out << "After Discounts: $" << std::fixed << std::setprecision(2) << (itemTotal - totalDiscount) << "\n";
+    }
+    
+    if (loyaltyPointsUsed > 0) {
+        out << "Loyalty Points Used: -$" << std::fixed << std::setprecision(2) << loyaltyPointsUsed << "\n";
+    }
+    
+    out << "Subtotal: $" << std::fixed << std::setprecision(2) << subtotal << "\n";
+    out << "Tax" << (taxIncluded ? " (included)" : "") << ": $"
+        << std::fixed << std::setprecision(2) << tax << "\n";
+    renderTaxBreakdown(out);
+    out << "FINAL TOTAL: $" << std::fixed << std::setprecision(2) << finalTotal << "\n";
+    if (refundedTotal > 0) {
+        out << "Refunded: -$" << std::fixed << std::setprecision(2) << refundedTotal << "\n";
+    }
+    
+    out << "\n" << DETAIL_DIVIDER << "\n";
+    out << "PAYMENT INFORMATION:\n";
+    out << DETAIL_DIVIDER << "\n";
+    out << "Payment Method: " << getPaymentMethodString() << "\n";
+    out << "Amount Paid: $" << std::fixed << std::setprecision(2) << finalTotal << "\n";
+    
+    if (customer && loyaltyPointsEarned > 0) {
+        out << "\nLOYALTY PROGRAM:\n";
+        out << "Points Earned: " << std::fixed << std::setprecision(2) << loyaltyPointsEarned << "\n";
+        out << "Current Points Balance: " << std::fixed << std::setprecision(2) << customer->getLoyaltyPoints() << "\n";
+    }
+    
+    if (!notes.empty()) {
+        out << "\nTransaction Notes: " << notes << "\n";
+    }
+    
+    out << DETAIL_RULE << "\n";
+    out << "    Thank you for shopping with us!    \n";
+    out << "         Please come again!           \n";
+    out << DETAIL_RULE << "\n\n";
+    out.flags(savedFlags);
+    out.precision(savedPrecision);
+}
@@ -1,120 +1,169 @@
-// ===== Transaction.h =====
-#ifndef TRANSACTION_H
-#define TRANSACTION_H
-
-#include "Product.h"
-#include "Customer.h"
-#include <vector>
-#include <ctime>
-
-/**
- * @brief Enumeration for payment methods
- */
-enum class PaymentMethod {
-    CASH,
-    CREDIT_CARD,
-    DEBIT_CARD,
-    MOBILE_PAYMENT,
-    LOYALTY_POINTS,
-    GIFT_CARD
-};
-
-/**
- * @brief Enumeration for transaction status
- */
-enum class TransactionStatus {
-    PENDING,
-    COMPLETED,
-    CANCELLED,
-    REFUNDED,
-    PARTIALLY_REFUNDED
-};
-
-/**
- * @brief Class representing an item in a transaction
- */
-class TransactionItem {
-public:
-    Product* product;
-    double quantity;      // For bulk products, this can be fractional
-    double unitPrice;     // Price at time of purchase
-    double discount;      // Discount applied to this item
-    double subtotal;      // Final price for this item
-    std::string notes;    // Special notes for this item
-
-    TransactionItem(Product* prod, double qty, double discount = 0.0, const std::string& notes = "");
-    
-    void calculateSubtotal();
-    void displayItem() const;
-};
-
-/**
- * @brief Class representing a complete transaction
- */
-class Transaction {
-private:
-    static int nextTransactionId;
-    
-    int transactionId;
-    std::vector<TransactionItem> items;
-    Customer* customer;
-    
-    double subtotal;
-    double tax;
-    double totalDiscount;
-    double loyaltyPointsUsed;
-    double loyaltyPointsEarned;
-    double finalTotal;
-    
-    PaymentMethod paymentMethod;
-    TransactionStatus status;
-    std::time_t timestamp;
-    std::string cashierId;
-    std::string notes;
-
-public:
-    Transaction(Customer* customer = nullptr, const std::string& cashierId = "");
-    
-    // Item management
-    bool addItem(Product* product, double quantity, double discount = 0.0, const std::string& notes = "");
-    bool removeItem(int itemIndex);
-    void clearItems();
-    
-    // Transaction processing
-    void calculateTotals(double taxRate = 0.08);
-    bool processPayment(PaymentMethod method, double amountPaid = 0.0);
-    bool applyLoyaltyPoints(double points);
-    void finalizeTransaction();
-    
-    // Getters
-    int getId() const { return transactionId; }
-    const std::vector<TransactionItem>& getItems() const { return items; }
-    Customer* getCustomer() const { return customer; }
-    double getSubtotal() const { return subtotal; }
-    double getTax() const { return tax; }
-    double getTotalDiscount() const { return totalDiscount; }
-    double getFinalTotal() const { return finalTotal; }
-    PaymentMethod getPaymentMethod() const { return paymentMethod; }
-    TransactionStatus getStatus() const { return status; }
-    std::time_t getTimestamp() const { return timestamp; }
-    std::string getCashierId() const { return cashierId; }
-    double getLoyaltyPointsUsed() const { return loyaltyPointsUsed; }
-    double getLoyaltyPointsEarned() const { return loyaltyPointsEarned; }
-    
-    // Setters
-    void setCustomer(Customer* customer) { this->customer = customer; }
-    void setCashierId(const std::string& id) { cashierId = id; }
-    void setNotes(const std::string& notes) { this->notes = notes; }
-    
-    // Utility methods
-    void printReceipt() const;
-    void printDetailedReceipt() const;
-    std::string getPaymentMethodString() const;
-    std::string getStatusString() const;
-    
-    // Refund operations
-    bool processRefund(double amount = -1.0);  // -1 means full refund
-    bool processPartialRefund(int itemIndex, double refundAmount);
-};
-
+// ===== Transaction.h =====
+#ifndef TRANSACTION_H
+#define TRANSACTION_H
+
+#include "Product.h"
+#include "Customer.h"
+#include "TaxEngine.h"
+#include "Refund.h"
+#include <vector>
+#include <ctime>
+#include <atomic>
+#include <memory>
+#include <ostream>
+
+class PersistenceFlusher;
+struct PriceVersion;
+struct BarcodeScan;
+
+/**
+ * @brief Enumeration for payment methods
+ */
+enum class PaymentMethod {
+    CASH,
+    CREDIT_CARD,
+    DEBIT_CARD,
+    MOBILE_PAYMENT,
+    LOYALTY_POINTS,
+    GIFT_CARD
+};
+
+/**
+ * @brief Enumeration for transaction status
+ */
+enum class TransactionStatus {
+    PENDING,
+    COMPLETED,
+    CANCELLED,
+    REFUNDED,
+    PARTIALLY_REFUNDED
+};
+
+/**
+ * @brief Class representing an item in a transaction
+ */
+class TransactionItem {
+public:
+    Product* product;
+    double quantity;      // For bulk products, this can be fractional
+    double unitPrice;     // Price at time of purchase
+    double discount;      // Discount applied to this item
+    double subtotal;      // Final price for this item
+    std::string notes;    // Special notes for this item
+    uint16_t taxRateBasisPoints; // Rate applied to this line by calculateTotals
+    double netAmount;     // Line amount after transaction-level discounts, excluding tax
+    double tax;           // Tax charged on this line
+    int stockUnits;       // Whole units taken from stock at finalize
+    double refundedQuantity;
+
+    TransactionItem(Product* prod, double qty, double discount = 0.0, const std::string& notes = "");
+    TransactionItem(const TransactionItem& other);      // Lines hold their product while they exist
+    TransactionItem& operator=(const TransactionItem& other);
+    ~TransactionItem();
+    
+    void calculateSubtotal();
+    double getPaidAmount() const { return netAmount + tax; }
+    double getRefundableQuantity() const { return quantity - refundedQuantity; }
+    int stockUnitsReturnedAt(double refunded) const;
+    void displayItem() const;
+    void renderItem(std::ostream& out) const;  // No flushing; caller owns the stream
+};
+
+/**
+ * @brief Class representing a complete transaction
+ */
+class Transaction {
+private:
+    static std::atomic<int> nextTransactionId;  // Lanes create transactions concurrently
+    
+    int transactionId;
+    std::vector<TransactionItem> items;
+    Customer* customer;
+    
+    double subtotal;
+    double tax;
+    double totalDiscount;
+    double loyaltyPointsUsed;
+    double loyaltyPointsEarned;
+    double finalTotal;
+    TaxBreakdown taxBreakdown;
+    bool taxIncluded;     // Shelf prices of the applied jurisdiction include tax
+    double refundedTotal;
+    
+    PaymentMethod paymentMethod;
+    TransactionStatus status;
+    std::time_t timestamp;
+    std::string cashierId;
+    std::string notes;
+    std::shared_ptr<const PriceVersion> prices;   // Pinned while open; lines are priced live without one
+
+public:
+    Transaction(Customer* customer = nullptr, const std::string& cashierId = "");
+    
+    // Item management
+    bool addItem(Product* product, double quantity, double discount = 0.0, const std::string& notes = "");
+    bool addScannedItem(Product* product, const BarcodeScan& scan);   // One unit, or the label's weight or price
+    bool removeItem(int itemIndex);
+    void clearItems();
+    
+    // Transaction processing
+    void calculateTotals(double taxRate = 0.08);
+    void calculateTotals(const TaxJurisdiction& jurisdiction);
+    bool processPayment(PaymentMethod method, double amountPaid = 0.0);
+    bool applyLoyaltyPoints(double points);
+    void finalizeTransaction(PersistenceFlusher* journal = nullptr);  // Journal gets the sale without waiting on disk
+    
+    // Getters
+    int getId() const { return transactionId; }
+    const std::vector<TransactionItem>& getItems() const { return items; }
+    Customer* getCustomer() const { return customer; }
+    double getSubtotal() const { return subtotal; }
+    double getTax() const { return tax; }
+    double getTotalDiscount() const { return totalDiscount; }
+    double getFinalTotal() const { return finalTotal; }
+    const TaxBreakdown& getTaxBreakdown() const { return taxBreakdown; }
+    bool isTaxIncluded() const { return taxIncluded; }
+    PaymentMethod getPaymentMethod() const { return paymentMethod; }
+    TransactionStatus getStatus() const { return status; }
+    std::time_t getTimestamp() const { return timestamp; }
+    std::string getCashierId() const { return cashierId; }
+    double getLoyaltyPointsUsed() const { return loyaltyPointsUsed; }
+    double getLoyaltyPointsEarned() const { return loyaltyPointsEarned; }
+    double getRefundedTotal() const { return refundedTotal; }
+    std::string getNotes() const { return notes; }
+    double getRefundableAmount() const { return finalTotal - refundedTotal; }
+    
+    // Setters
+    void setCustomer(Customer* customer) { this->customer = customer; }
+    void setCashierId(const std::string& id) { cashierId = id; }
+    void setNotes(const std::string& notes) { this->notes = notes; }
+    void setTimestamp(std::time_t when) { timestamp = when; }  // Backdating for imports and generated data
+    void setPriceVersion(const std::shared_ptr<const PriceVersion>& version) { prices = version; }
+    const std::shared_ptr<const PriceVersion>& getPriceVersion() const { return prices; }
+    
+    // Utility methods
+    void printReceipt() const;
+    void printDetailedReceipt() const;
+    void renderReceipt(std::ostream& out) const;
+    void renderDetailedReceipt(std::ostream& out) const;
+    std::string getPaymentMethodString() const;
+    std::string getStatusString() const;
+    static std::string paymentMethodName(PaymentMethod method);
+    static std::string statusName(TransactionStatus status);
+    void renderTaxBreakdown(std::ostream& out) const;
+    size_t getHeapBytes() const;  // Item buffer and strings owned by the transaction
+    
+    // Refund operations; when given, record is filled in for a RefundLedger
+    bool processRefund(double amount = -1.0, RefundRecord* record = nullptr);  // -1 means full refund
+    bool processPartialRefund(int itemIndex, double refundAmount, RefundRecord* record = nullptr);
+    bool processItemRefund(int itemIndex, double quantity, RefundRecord* record = nullptr);
+    bool processItemRefunds(const std::vector<std::pair<int, double>>& itemQuantities,
+                            RefundRecord* record = nullptr);
+    bool canRefund() const;
+
+private:
+    RefundLine refundLine(int itemIndex, double quantity);
+    void applyRefund(RefundRecord& refund);
+};
+
 #endif // TRANSACTION_H
\ No newline at end of file
@@ -0,0 +1,691 @@
+// ===== TransactionArchive.cpp =====
+#include "TransactionArchive.h"
+#include "MemoryAccounting.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+static const char ARCHIVE_MAGIC[8] = { 'C', 'S', 'M', 'S', 'A', 'R', 'C', '1' };
+
+static void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+static void putSigned(std::string& out, int64_t value) {
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+static int64_t toFixed(double value, double scale) {
+    return static_cast<int64_t>(std::llround(value * scale));
+}
+
+static void putQuantity(std::string& out, int64_t thousandths) {
+    // Whole quantities as 2n, fractional ones as 2t+1
+    putSigned(out, thousandths % 1000 == 0 ? thousandths / 1000 * 2 : thousandths * 2 + 1);
+}
+
+static int64_t expectedSubtotal(int64_t priceCents, int64_t quantity, int64_t discount) {
+    return std::llround(priceCents * (quantity / 1000.0) * (1.0 - discount / 10000.0));
+}
+
+static int64_t expectedUnits(int64_t quantity) {
+    return quantity > 0 ? (quantity + 999) / 1000 : 0;
+}
+
+static int64_t expectedTax(int64_t netCents, int64_t rateBasisPoints) {
+    return std::llround(netCents * static_cast<double>(rateBasisPoints) / 10000.0);
+}
+
+/**
+ * @brief Sequential varint decoder over one column
+ */
+class ColumnReader {
+private:
+    const uint8_t* position;
+    const uint8_t* end;
+
+public:
+    explicit ColumnReader(const std::string& column)
+        : position(reinterpret_cast<const uint8_t*>(column.data())), end(position + column.size()) {}
+
+    uint64_t next() {
+        uint64_t value = 0;
+        int shift = 0;
+        while (position < end) {
+            uint8_t byte = *position++;
+            if (shift < 64) {
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            }
+            if (!(byte & 0x80)) {
+                break;
+            }
+            shift += 7;
+        }
+        return value;
+    }
+
+    bool atEnd() const { return position == end; }
+
+    int64_t nextSigned() {
+        uint64_t value = next();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    int64_t nextQuantity() {
+        int64_t value = nextSigned();
+        return (value & 1) ? (value - 1) / 2 : value / 2 * 1000;
+    }
+};
+
+/**
+ * @brief Assigns dense codes to strings in first-seen order
+ */
+class DictionaryBuilder {
+private:
+    std::unordered_map<std::string, uint32_t> codes;
+    ArchiveDictionary& dictionary;
+
+public:
+    explicit DictionaryBuilder(ArchiveDictionary& dictionary) : dictionary(dictionary) {
+        for (uint32_t i = 0; i < dictionary.size(); ++i) {
+            codes.emplace(dictionary.at(i), i);
+        }
+    }
+
+    uint32_t code(const std::string& value) {
+        auto it = codes.find(value);
+        if (it != codes.end()) {
+            return it->second;
+        }
+        uint32_t code = static_cast<uint32_t>(dictionary.size());
+        codes.emplace(value, code);
+        dictionary.append(value);
+        return code;
+    }
+};
+
+static void writeVarint(std::ostream& out, uint64_t value) {
+    std::string bytes;
+    putVarint(bytes, value);
+    out.write(bytes.data(), bytes.size());
+}
+
+static uint64_t readVarint(std::istream& in) {
+    uint64_t value = 0;
+    int shift = 0;
+    int byte;
+    while ((byte = in.get()) != EOF) {
+        if (shift < 64) {
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        }
+        if (!(byte & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    return value;
+}
+
+static void writeBytes(std::ostream& out, const std::string& bytes) {
+    writeVarint(out, bytes.size());
+    out.write(bytes.data(), bytes.size());
+}
+
+// Bytes between the read position and the end of the stream
+static uint64_t bytesLeft(std::istream& in) {
+    std::streampos position = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::streampos end = in.tellg();
+    in.seekg(position);
+    return (position < 0 || end < position) ? 0 : static_cast<uint64_t>(end - position);
+}
+
+static bool readBytes(std::istream& in, std::string& bytes) {
+    uint64_t length = readVarint(in);
+    if (!in || length > bytesLeft(in)) {
+        return false;
+    }
+    bytes.resize(length);
+    in.read(&bytes[0], length);
+    return static_cast<uint64_t>(in.gcount()) == length;
+}
+
+// ArchiveDictionary implementation
+void ArchiveDictionary::append(const std::string& value) {
+    offsets.push_back(static_cast<uint32_t>(bytes.size()));
+    bytes.append(value);
+    bytes.push_back('\0');
+}
+
+size_t ArchiveDictionary::getHeapBytes() const {
+    return MemorySizing::stringBytes(bytes) + MemorySizing::vectorBytes(offsets);
+}
+
+void ArchiveDictionary::shrink() {
+    bytes.shrink_to_fit();
+    offsets.shrink_to_fit();
+}
+
+void ArchiveDictionary::write(std::ostream& out) const {
+    writeVarint(out, offsets.size());
+    writeBytes(out, bytes);
+}
+
+bool ArchiveDictionary::read(std::istream& in) {
+    uint64_t count = readVarint(in);
+    if (!readBytes(in, bytes)) {
+        return false;
+    }
+    offsets.clear();
+    size_t start = 0;
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        if (bytes[i] == '\0') {
+            offsets.push_back(static_cast<uint32_t>(start));
+            start = i + 1;
+        }
+    }
+    return offsets.size() == count && start == bytes.size();
+}
+
+// ArchiveSegment implementation
+ArchiveSegment::ArchiveSegment() : day(0), transactionCount(0), lineCount(0), columns(COLUMN_COUNT) {
+    customers.append("");
+    notes.append("");
+}
+
+ArchiveSegment ArchiveSegment::seal(std::time_t day, const std::vector<const Transaction*>& transactions) {
+    ArchiveSegment segment;
+    segment.day = day;
+    DictionaryBuilder productCodes(segment.products);
+    DictionaryBuilder customerCodes(segment.customers);
+    DictionaryBuilder cashierCodes(segment.cashiers);
+    DictionaryBuilder noteCodes(segment.notes);
+    std::vector<std::string>& c = segment.columns;
+    std::vector<int64_t> lastPrice;   // By product code
+    std::vector<int64_t> lastRate;
+
+    int64_t previousId = 0;
+    int64_t previousTime = day;
+    for (const Transaction* transaction : transactions) {
+        putSigned(c[TXN_ID], transaction->getId() - previousId);
+        putSigned(c[TXN_TIME], static_cast<int64_t>(transaction->getTimestamp()) - previousTime);
+        previousId = transaction->getId();
+        previousTime = transaction->getTimestamp();
+
+        putVarint(c[TXN_CUSTOMER], transaction->getCustomer() ? customerCodes.code(transaction->getCustomer()->getId()) : 0);
+        putVarint(c[TXN_CASHIER], cashierCodes.code(transaction->getCashierId()));
+        putVarint(c[TXN_PAYMENT], static_cast<uint64_t>(transaction->getPaymentMethod()));
+        putVarint(c[TXN_STATUS], static_cast<uint64_t>(transaction->getStatus()));
+        putVarint(c[TXN_FLAGS], transaction->isTaxIncluded() ? 1 : 0);
+        putSigned(c[TXN_SUBTOTAL], toFixed(transaction->getSubtotal(), 100));
+        putSigned(c[TXN_DISCOUNT], toFixed(transaction->getTotalDiscount(), 100));
+        putSigned(c[TXN_TAX], toFixed(transaction->getTax(), 100));
+        putSigned(c[TXN_TOTAL], toFixed(transaction->getFinalTotal(), 100));
+        putSigned(c[TXN_REFUNDED], toFixed(transaction->getRefundedTotal(), 100));
+        putSigned(c[TXN_POINTS_USED], toFixed(transaction->getLoyaltyPointsUsed(), 100));
+        putSigned(c[TXN_POINTS_EARNED], toFixed(transaction->getLoyaltyPointsEarned(), 100));
+        putVarint(c[TXN_NOTES], noteCodes.code(transaction->getNotes()));
+        putVarint(c[TXN_LINE_COUNT], transaction->getItems().size());
+
+        for (const TransactionItem& item : transaction->getItems()) {
+            uint32_t product = productCodes.code(item.product->getId());
+            if (product >= lastPrice.size()) {
+                lastPrice.resize(product + 1, 0);
+                lastRate.resize(product + 1, 0);
+            }
+            int64_t quantity = toFixed(item.quantity, 1000);
+            int64_t price = toFixed(item.unitPrice, 100);
+            int64_t discount = toFixed(item.discount, 10000);
+            int64_t subtotal = toFixed(item.subtotal, 100);
+            int64_t net = toFixed(item.netAmount, 100);
+
+            putVarint(c[LINE_PRODUCT], product);
+            putQuantity(c[LINE_QUANTITY], quantity);
+            putSigned(c[LINE_PRICE], price - lastPrice[product]);
+            putSigned(c[LINE_DISCOUNT], discount);
+            putSigned(c[LINE_SUBTOTAL], subtotal - expectedSubtotal(price, quantity, discount));
+            putSigned(c[LINE_NET], net - subtotal);
+            putSigned(c[LINE_TAX_RATE], item.taxRateBasisPoints - lastRate[product]);
+            putSigned(c[LINE_TAX], toFixed(item.tax, 100) - expectedTax(net, item.taxRateBasisPoints));
+            putSigned(c[LINE_STOCK_UNITS], item.stockUnits - expectedUnits(quantity));
+            putQuantity(c[LINE_REFUNDED], toFixed(item.refundedQuantity, 1000));
+            putVarint(c[LINE_NOTES], noteCodes.code(item.notes));
+            lastPrice[product] = price;
+            lastRate[product] = item.taxRateBasisPoints;
+            segment.lineCount++;
+        }
+        segment.transactionCount++;
+    }
+
+    for (std::string& column : segment.columns) {
+        column.shrink_to_fit();
+    }
+    for (ArchiveDictionary* dictionary : { &segment.products, &segment.customers, &segment.cashiers, &segment.notes }) {
+        dictionary->shrink();
+    }
+    return segment;
+}
+
+size_t ArchiveSegment::getEncodedBytes() const {
+    size_t bytes = 0;
+    for (const std::string& column : columns) {
+        bytes += column.size();
+    }
+    for (const ArchiveDictionary* dictionary : { &products, &customers, &cashiers, &notes }) {
+        bytes += dictionary->getEncodedBytes();
+    }
+    return bytes;
+}
+
+size_t ArchiveSegment::getHeapBytes() const {
+    size_t bytes = MemorySizing::vectorBytes(columns);
+    for (const std::string& column : columns) {
+        bytes += MemorySizing::stringBytes(column);
+    }
+    for (const ArchiveDictionary* dictionary : { &products, &customers, &cashiers, &notes }) {
+        bytes += dictionary->getHeapBytes();
+    }
+    return bytes;
+}
+
+void ArchiveSegment::forEach(const std::function<void(const ArchivedTransaction&)>& visitor) const {
+    std::vector<ColumnReader> readers;
+    readers.reserve(COLUMN_COUNT);
+    for (const std::string& column : columns) {
+        readers.emplace_back(column);
+    }
+    auto next = [&readers](Column column) { return readers[column].next(); };
+    auto cents = [&readers](Column column) { return readers[column].nextSigned() / 100.0; };
+    std::vector<int64_t> lastPrice(products.size(), 0);
+    std::vector<int64_t> lastRate(products.size(), 0);
+
+    ArchivedTransaction transaction;
+    int64_t id = 0;
+    int64_t time = day;
+    for (long t = 0; t < transactionCount; ++t) {
+        id += readers[TXN_ID].nextSigned();
+        time += readers[TXN_TIME].nextSigned();
+        transaction.id = static_cast<int>(id);
+        transaction.timestamp = static_cast<std::time_t>(time);
+        uint64_t customer = next(TXN_CUSTOMER);
+        transaction.customerId = customer ? customers.at(customer) : nullptr;
+        transaction.cashierId = cashiers.at(next(TXN_CASHIER));
+        transaction.paymentMethod = static_cast<PaymentMethod>(next(TXN_PAYMENT));
+        transaction.status = static_cast<TransactionStatus>(next(TXN_STATUS));
+        transaction.taxIncluded = (next(TXN_FLAGS) & 1) != 0;
+        transaction.subtotal = cents(TXN_SUBTOTAL);
+        transaction.totalDiscount = cents(TXN_DISCOUNT);
+        transaction.tax = cents(TXN_TAX);
+        transaction.finalTotal = cents(TXN_TOTAL);
+        transaction.refundedTotal = cents(TXN_REFUNDED);
+        transaction.loyaltyPointsUsed = cents(TXN_POINTS_USED);
+        transaction.loyaltyPointsEarned = cents(TXN_POINTS_EARNED);
+        transaction.notes = notes.at(next(TXN_NOTES));
+
+        transaction.lines.resize(next(TXN_LINE_COUNT));
+        for (ArchivedLine& line : transaction.lines) {
+            uint64_t product = next(LINE_PRODUCT);
+            int64_t quantity = readers[LINE_QUANTITY].nextQuantity();
+            int64_t price = lastPrice[product] + readers[LINE_PRICE].nextSigned();
+            int64_t discount = readers[LINE_DISCOUNT].nextSigned();
+            int64_t subtotal = expectedSubtotal(price, quantity, discount) + readers[LINE_SUBTOTAL].nextSigned();
+            int64_t net = subtotal + readers[LINE_NET].nextSigned();
+            int64_t rate = lastRate[product] + readers[LINE_TAX_RATE].nextSigned();
+            int64_t tax = expectedTax(net, rate) + readers[LINE_TAX].nextSigned();
+            lastPrice[product] = price;
+            lastRate[product] = rate;
+
+            line.productId = products.at(product);
+            line.quantity = quantity / 1000.0;
+            line.unitPrice = price / 100.0;
+            line.discount = discount / 10000.0;
+            line.subtotal = subtotal / 100.0;
+            line.netAmount = net / 100.0;
+            line.tax = tax / 100.0;
+            line.taxRateBasisPoints = static_cast<int>(rate);
+            line.stockUnits = static_cast<int>(expectedUnits(quantity) + readers[LINE_STOCK_UNITS].nextSigned());
+            line.refundedQuantity = readers[LINE_REFUNDED].nextQuantity() / 1000.0;
+            line.notes = notes.at(next(LINE_NOTES));
+        }
+        visitor(transaction);
+    }
+}
+
+ArchiveTotals ArchiveSegment::summarize() const {
+    ArchiveTotals totals;
+    ColumnReader total(columns[TXN_TOTAL]);
+    ColumnReader tax(columns[TXN_TAX]);
+    ColumnReader refunded(columns[TXN_REFUNDED]);
+    int64_t totalCents = 0;
+    int64_t taxCents = 0;
+    int64_t refundedCents = 0;
+    for (long t = 0; t < transactionCount; ++t) {
+        totalCents += total.nextSigned();
+        taxCents += tax.nextSigned();
+        refundedCents += refunded.nextSigned();
+    }
+    totals.transactions = transactionCount;
+    totals.lines = lineCount;
+    totals.sales = totalCents / 100.0;
+    totals.tax = taxCents / 100.0;
+    totals.refunded = refundedCents / 100.0;
+    return totals;
+}
+
+void ArchiveSegment::productUnits(std::unordered_map<std::string, double>& units) const {
+    std::vector<int64_t> thousandths(products.size(), 0);
+    ColumnReader product(columns[LINE_PRODUCT]);
+    ColumnReader quantity(columns[LINE_QUANTITY]);
+    for (long l = 0; l < lineCount; ++l) {
+        uint64_t code = product.next();
+        thousandths[code] += quantity.nextQuantity();
+    }
+    for (size_t code = 0; code < products.size(); ++code) {
+        units[products.at(code)] += thousandths[code] / 1000.0;
+    }
+}
+
+void ArchiveSegment::write(std::ostream& out) const {
+    std::string header;
+    putSigned(header, day);
+    putVarint(header, transactionCount);
+    putVarint(header, lineCount);
+    putVarint(header, COLUMN_COUNT);
+    out.write(header.data(), header.size());
+    for (const ArchiveDictionary* dictionary : { &products, &customers, &cashiers, &notes }) {
+        dictionary->write(out);
+    }
+    for (const std::string& column : columns) {
+        writeBytes(out, column);
+    }
+}
+
+bool ArchiveSegment::read(std::istream& in) {
+    uint64_t rawDay = readVarint(in);
+    day = static_cast<std::time_t>(static_cast<int64_t>(rawDay >> 1) ^ -static_cast<int64_t>(rawDay & 1));
+    transactionCount = static_cast<long>(readVarint(in));
+    lineCount = static_cast<long>(readVarint(in));
+    if (readVarint(in) != COLUMN_COUNT) {
+        return false;
+    }
+    for (ArchiveDictionary* dictionary : { &products, &customers, &cashiers, &notes }) {
+        if (!dictionary->read(in)) {
+            return false;
+        }
+    }
+    for (std::string& column : columns) {
+        if (!readBytes(in, column)) {
+            return false;
+        }
+    }
+    return validate();
+}
+
+bool ArchiveSegment::validate() const {
+    // Every row takes at least one byte of its first column, so the counts
+    // are bounded before any loop runs on them
+    if (customers.size() == 0 || notes.size() == 0 ||
+        static_cast<uint64_t>(transactionCount) > columns[TXN_ID].size() ||
+        static_cast<uint64_t>(lineCount) > columns[LINE_PRODUCT].size()) {
+        return false;
+    }
+
+    // forEach() trusts the codes: dictionaries and enums must cover every one
+    ColumnReader customer(columns[TXN_CUSTOMER]);
+    ColumnReader cashier(columns[TXN_CASHIER]);
+    ColumnReader payment(columns[TXN_PAYMENT]);
+    ColumnReader status(columns[TXN_STATUS]);
+    ColumnReader transactionNote(columns[TXN_NOTES]);
+    ColumnReader lineCounts(columns[TXN_LINE_COUNT]);
+    uint64_t lines = 0;
+    for (long t = 0; t < transactionCount; ++t) {
+        if (customer.next() >= customers.size() || cashier.next() >= cashiers.size() ||
+            payment.next() > static_cast<uint64_t>(PaymentMethod::GIFT_CARD) ||
+            status.next() > static_cast<uint64_t>(TransactionStatus::PARTIALLY_REFUNDED) ||
+            transactionNote.next() >= notes.size()) {
+            return false;
+        }
+        lines += lineCounts.next();
+        if (lines > static_cast<uint64_t>(lineCount)) {
+            return false;
+        }
+    }
+    if (lines != static_cast<uint64_t>(lineCount) || !customer.atEnd() || !cashier.atEnd() ||
+        !lineCounts.atEnd()) {
+        return false;
+    }
+
+    ColumnReader product(columns[LINE_PRODUCT]);
+    ColumnReader lineNote(columns[LINE_NOTES]);
+    for (long l = 0; l < lineCount; ++l) {
+        if (product.next() >= products.size() || lineNote.next() >= notes.size()) {
+            return false;
+        }
+    }
+    return product.atEnd() && lineNote.atEnd();
+}
+
+// TransactionArchive implementation
+TransactionArchive::TransactionArchive() : sourceBytes(0) {
+}
+
+void TransactionArchive::add(ArchiveSegment segment) {
+    auto position = std::upper_bound(segments.begin(), segments.end(), segment.getDay(),
+                                     [](std::time_t day, const ArchiveSegment& s) { return day < s.getDay(); });
+    segments.insert(position, std::move(segment));
+}
+
+bool TransactionArchive::isSealed(std::time_t day) const {
+    for (const ArchiveSegment& segment : segments) {
+        if (segment.getDay() == day) {
+            return true;
+        }
+    }
+    return false;
+}
+
+long TransactionArchive::getTransactionCount() const {
+    long count = 0;
+    for (const ArchiveSegment& segment : segments) {
+        count += segment.getTransactionCount();
+    }
+    return count;
+}
+
+size_t TransactionArchive::getEncodedBytes() const {
+    size_t bytes = 0;
+    for (const ArchiveSegment& segment : segments) {
+        bytes += segment.getEncodedBytes();
+    }
+    return bytes;
+}
+
+ArchiveTotals TransactionArchive::summarize(std::time_t from, std::time_t to) const {
+    ArchiveTotals totals;
+    for (const ArchiveSegment& segment : segments) {
+        if (segment.getDay() < from || segment.getDay() >= to) {
+            continue;
+        }
+        ArchiveTotals day = segment.summarize();
+        totals.transactions += day.transactions;
+        totals.lines += day.lines;
+        totals.sales += day.sales;
+        totals.tax += day.tax;
+        totals.refunded += day.refunded;
+    }
+    return totals;
+}
+
+void TransactionArchive::forEach(std::time_t from, std::time_t to,
+                                 const std::function<void(const ArchivedTransaction&)>& visitor) const {
+    for (const ArchiveSegment& segment : segments) {
+        if (segment.getDay() >= from && segment.getDay() < to) {
+            segment.forEach(visitor);
+        }
+    }
+}
+
+bool TransactionArchive::findTransaction(int transactionId,
+                                         const std::function<void(const ArchivedTransaction&)>& visitor) const {
+    bool found = false;
+    for (const ArchiveSegment& segment : segments) {
+        segment.forEach([&](const ArchivedTransaction& transaction) {
+            if (transaction.id == transactionId) {
+                visitor(transaction);
+                found = true;
+            }
+        });
+        if (found) {
+            break;
+        }
+    }
+    return found;
+}
+
+bool TransactionArchive::renderReceipt(int transactionId, std::ostream& out) const {
+    return findTransaction(transactionId, [&out](const ArchivedTransaction& transaction) {
+        std::ios::fmtflags savedFlags = out.flags();
+        std::streamsize savedPrecision = out.precision();
+        out << "\n" << std::string(40, '=') << "\n";
+        out << "           CONVENIENCE STORE           \n";
+        out << "          RECEIPT (ARCHIVED)           \n";
+        out << std::string(40, '=') << "\n";
+        out << "Transaction ID: " << transaction.id << "\n";
+        out << "Date: " << std::ctime(&transaction.timestamp);
+        out << "Cashier: " << transaction.cashierId << "\n";
+        if (transaction.customerId) {
+            out << "Customer: " << transaction.customerId << "\n";
+        }
+        out << std::string(40, '-') << "\n";
+        out << std::fixed << std::setprecision(2);
+        for (const ArchivedLine& line : transaction.lines) {
+            out << line.productId;
+            if (line.quantity != 1.0) {
+                out << " x" << line.quantity;
+            }
+            out << " @ $" << line.unitPrice;
+            if (line.discount > 0) {
+                out << " (" << (line.discount * 100) << "% off)";
+            }
+            out << " = $" << line.subtotal;
+            if (line.notes[0]) {
+                out << " [" << line.notes << "]";
+            }
+            if (line.refundedQuantity > 0) {
+                out << " (" << line.refundedQuantity << " returned)";
+            }
+            out << "\n";
+        }
+        out << std::string(40, '-') << "\n";
+        out << "Subtotal: $" << transaction.subtotal << "\n";
+        if (transaction.totalDiscount > 0) {
+            out << "Discount: -$" << transaction.totalDiscount << "\n";
+        }
+        if (transaction.loyaltyPointsUsed > 0) {
+            out << "Loyalty Points Used: -$" << transaction.loyaltyPointsUsed << "\n";
+        }
+        out << "Tax" << (transaction.taxIncluded ? " (included)" : "") << ": $" << transaction.tax << "\n";
+        out << "TOTAL: $" << transaction.finalTotal << "\n";
+        if (transaction.refundedTotal > 0) {
+            out << "Refunded: -$" << transaction.refundedTotal << "\n";
+        }
+        out << std::string(40, '-') << "\n";
+        out << "Payment Method: " << Transaction::paymentMethodName(transaction.paymentMethod) << "\n";
+        out << "Status: " << Transaction::statusName(transaction.status) << "\n";
+        out << std::string(40, '=') << "\n\n";
+        out.flags(savedFlags);
+        out.precision(savedPrecision);
+    });
+}
+
+bool TransactionArchive::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        return false;
+    }
+    out.write(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    writeVarint(out, segments.size());
+    for (const ArchiveSegment& segment : segments) {
+        segment.write(out);
+    }
+    return static_cast<bool>(out);
+}
+
+bool TransactionArchive::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(ARCHIVE_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), ARCHIVE_MAGIC)) {
+        return false;
+    }
+    // A segment is at least its header, four empty dictionaries and one
+    // length byte per column
+    uint64_t count = readVarint(in);
+    if (!in || count > bytesLeft(in) / (4 + 4 * 2 + ArchiveSegment::COLUMN_COUNT)) {
+        return false;
+    }
+    std::vector<ArchiveSegment> loaded(count);
+    for (ArchiveSegment& segment : loaded) {
+        // A day sealed twice would be counted twice by every report
+        if (!segment.read(in) || isSealed(segment.getDay())) {
+            return false;
+        }
+    }
+    for (ArchiveSegment& segment : loaded) {
+        add(std::move(segment));
+    }
+    return true;
+}
+
+void TransactionArchive::displayStats(std::ostream& out) const {
+    long lines = 0;
+    size_t heapBytes = 0;
+    for (const ArchiveSegment& segment : segments) {
+        lines += segment.getLineCount();
+        heapBytes += segment.getHeapBytes();
+    }
+    long transactions = getTransactionCount();
+    size_t encoded = getEncodedBytes();
+
+    out << "\n" << std::string(60, '=') << std::endl;
+    out << "               TRANSACTION ARCHIVE               " << std::endl;
+    out << std::string(60, '=') << std::endl;
+    if (segments.empty()) {
+        out << "No sealed days." << std::endl;
+        out << std::string(60, '=') << std::endl << std::endl;
+        return;
+    }
+    char first[16];
+    char last[16];
+    std::time_t firstDay = segments.front().getDay();
+    std::time_t lastDay = segments.back().getDay();
+    std::strftime(first, sizeof(first), "%Y-%m-%d", std::localtime(&firstDay));
+    std::strftime(last, sizeof(last), "%Y-%m-%d", std::localtime(&lastDay));
+
+    out << "Segments: " << segments.size() << " (" << first << " to " << last << ")" << std::endl;
+    out << "Transactions: " << transactions << ", Lines: " << lines << std::endl;
+    out << "Encoded Size: " << MemoryReport::formatBytes(encoded) << " (" << std::fixed << std::setprecision(1)
+        << (transactions ? static_cast<double>(encoded) / transactions : 0.0) << " bytes/transaction)" << std::endl;
+    out << "In Memory: " << MemoryReport::formatBytes(heapBytes) << std::endl;
+    if (sourceBytes > 0) {
+        out << "Sealed From: " << MemoryReport::formatBytes(sourceBytes) << " of Transaction objects ("
+            << std::setprecision(1) << static_cast<double>(sourceBytes) / std::max<size_t>(heapBytes, 1)
+            << "x smaller)" << std::endl;
+    }
+    ArchiveTotals totals = summarize(firstDay, lastDay + 1);
+    out << "Archived Sales: $" << std::setprecision(2) << totals.sales << ", Tax: $" << totals.tax
+        << ", Refunded: $" << totals.refunded << std::endl;
+    out << std::string(60, '=') << std::endl << std::endl;
+}
+
+void TransactionArchive::accountMemory(MemoryReport& report) const {
+    size_t bytes = MemorySizing::vectorBytes(segments);
+    for (const ArchiveSegment& segment : segments) {
+        bytes += segment.getHeapBytes();
+    }
+    report.add("Transaction archive", "Sealed segments", getTransactionCount(), bytes);
+}
@@ -0,0 +1,179 @@
+// ===== TransactionArchive.h =====
+#ifndef TRANSACTION_ARCHIVE_H
+#define TRANSACTION_ARCHIVE_H
+
+#include "Transaction.h"
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class MemoryReport;
+
+/**
+ * @brief One line of an archived transaction, decoded from its segment
+ */
+struct ArchivedLine {
+    const char* productId;         // Points into the segment dictionary
+    double quantity;
+    double unitPrice;
+    double discount;
+    double subtotal;
+    double netAmount;
+    double tax;
+    double refundedQuantity;
+    int taxRateBasisPoints;
+    int stockUnits;
+    const char* notes;
+};
+
+/**
+ * @brief An archived transaction, decoded from its segment
+ */
+struct ArchivedTransaction {
+    int id;
+    std::time_t timestamp;
+    const char* customerId;         // nullptr for walk-in customers
+    const char* cashierId;
+    PaymentMethod paymentMethod;
+    TransactionStatus status;
+    bool taxIncluded;
+    double subtotal;
+    double totalDiscount;
+    double tax;
+    double finalTotal;
+    double refundedTotal;
+    double loyaltyPointsUsed;
+    double loyaltyPointsEarned;
+    const char* notes;
+    std::vector<ArchivedLine> lines;
+};
+
+/**
+ * @brief Totals from a scan of archived transactions
+ */
+struct ArchiveTotals {
+    long transactions;
+    long lines;
+    double sales;
+    double tax;
+    double refunded;
+
+    ArchiveTotals() : transactions(0), lines(0), sales(0.0), tax(0.0), refunded(0.0) {}
+};
+
+/**
+ * @brief Strings of one segment packed end to end, each NUL-terminated
+ */
+class ArchiveDictionary {
+private:
+    std::string bytes;
+    std::vector<uint32_t> offsets;
+
+public:
+    size_t size() const { return offsets.size(); }
+    const char* at(size_t code) const { return bytes.data() + offsets[code]; }
+    void append(const std::string& value);
+
+    size_t getEncodedBytes() const { return bytes.size(); }
+    size_t getHeapBytes() const;
+    void shrink();
+
+    void write(std::ostream& out) const;
+    bool read(std::istream& in);
+};
+
+/**
+ * @brief The sealed transactions of one day, stored column by column
+ *
+ * Each field is its own byte column of LEB128 varints: IDs and timestamps
+ * as zigzag deltas from the previous row, product, customer, cashier and
+ * note strings as codes into per-segment dictionaries, quantities in
+ * thousandths (whole quantities in a single byte) and amounts in cents.
+ * Line prices and tax rates are deltas from the product's previous line;
+ * subtotals, net amounts, tax and stock units are the residual from what
+ * the rest of the line implies. Both are zero for almost every line. Scans decode only the columns they read. The
+ * per-jurisdiction tax breakdown is not kept.
+ */
+class ArchiveSegment {
+public:
+    enum Column {
+        TXN_ID, TXN_TIME, TXN_CUSTOMER, TXN_CASHIER, TXN_PAYMENT, TXN_STATUS, TXN_FLAGS,
+        TXN_SUBTOTAL, TXN_DISCOUNT, TXN_TAX, TXN_TOTAL, TXN_REFUNDED, TXN_POINTS_USED, TXN_POINTS_EARNED,
+        TXN_NOTES, TXN_LINE_COUNT,
+        LINE_PRODUCT, LINE_QUANTITY, LINE_PRICE, LINE_DISCOUNT, LINE_SUBTOTAL, LINE_NET, LINE_TAX,
+        LINE_TAX_RATE, LINE_STOCK_UNITS, LINE_REFUNDED, LINE_NOTES,
+        COLUMN_COUNT
+    };
+
+private:
+    std::time_t day;
+    long transactionCount;
+    long lineCount;
+    std::vector<std::string> columns;               // COLUMN_COUNT byte columns
+    ArchiveDictionary products;
+    ArchiveDictionary customers;                    // Code 0 is the walk-in customer
+    ArchiveDictionary cashiers;
+    ArchiveDictionary notes;                        // Code 0 is the empty note
+
+    bool validate() const;                          // Counts and codes fit the columns and dictionaries
+
+public:
+    ArchiveSegment();
+
+    static ArchiveSegment seal(std::time_t day, const std::vector<const Transaction*>& transactions);
+
+    std::time_t getDay() const { return day; }
+    long getTransactionCount() const { return transactionCount; }
+    long getLineCount() const { return lineCount; }
+    size_t getEncodedBytes() const;              // Columns and dictionaries as written to disk
+    size_t getHeapBytes() const;                 // Including container and string overhead
+    size_t getColumnBytes(Column column) const { return columns[column].size(); }
+
+    // Full decode, one transaction at a time
+    void forEach(const std::function<void(const ArchivedTransaction&)>& visitor) const;
+    // Column-only scans
+    ArchiveTotals summarize() const;
+    void productUnits(std::unordered_map<std::string, double>& units) const;
+
+    void write(std::ostream& out) const;
+    bool read(std::istream& in);                 // False if truncated or inconsistent
+};
+
+/**
+ * @brief Sealed days of transaction history, oldest first
+ */
+class TransactionArchive {
+private:
+    std::vector<ArchiveSegment> segments;
+    size_t sourceBytes;        // In-memory footprint of what was sealed
+
+public:
+    TransactionArchive();
+
+    void add(ArchiveSegment segment);
+    bool isSealed(std::time_t day) const;
+    const std::vector<ArchiveSegment>& getSegments() const { return segments; }
+
+    long getTransactionCount() const;
+    size_t getEncodedBytes() const;
+    void recordSourceBytes(size_t bytes) { sourceBytes += bytes; }
+
+    ArchiveTotals summarize(std::time_t from, std::time_t to) const;
+    void forEach(std::time_t from, std::time_t to,
+                 const std::function<void(const ArchivedTransaction&)>& visitor) const;
+    bool findTransaction(int transactionId, const std::function<void(const ArchivedTransaction&)>& visitor) const;
+    // Reprints an archived sale: lines show product IDs, the tax breakdown is not kept
+    bool renderReceipt(int transactionId, std::ostream& out) const;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);       // Adds the file's segments; false if any day is already sealed
+
+    void displayStats(std::ostream& out) const;
+    void accountMemory(MemoryReport& report) const;
+};
+
+#endif // TRANSACTION_ARCHIVE_H
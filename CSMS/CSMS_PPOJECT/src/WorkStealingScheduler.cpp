@@ -0,0 +1,111 @@
+// ===== WorkStealingScheduler.cpp =====
+#include "WorkStealingScheduler.h"
+
+static thread_local int currentWorkerIndex = -1;
+
+WorkStealingScheduler::WorkStealingScheduler(int workerCount)
+    : pending(0), queued(0), steals(0), executed(0), stopping(false) {
+    if (workerCount < 1) {
+        workerCount = 1;
+    }
+    for (int i = 0; i < workerCount; ++i) {
+        queues.push_back(new WorkerQueue());
+    }
+    for (int i = 0; i < workerCount; ++i) {
+        workers.push_back(std::thread(&WorkStealingScheduler::workerLoop, this, i));
+    }
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() {
+    waitIdle();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (WorkerQueue* queue : queues) {
+        delete queue;
+    }
+}
+
+int WorkStealingScheduler::currentWorker() {
+    return currentWorkerIndex;
+}
+
+void WorkStealingScheduler::submit(int preferredWorker, Task task) {
+    int count = static_cast<int>(queues.size());
+    int index = ((preferredWorker % count) + count) % count;
+
+    pending++;
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Taking the state lock orders this push before any worker's sleep check
+        std::lock_guard<std::mutex> lock(stateMutex);
+        queued++;
+    }
+    workAvailable.notify_one();
+}
+
+void WorkStealingScheduler::waitIdle() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allIdle.wait(lock, [this] { return pending.load() == 0; });
+}
+
+bool WorkStealingScheduler::popLocal(int index, Task& task) {
+    WorkerQueue* queue = queues[index];
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (queue->tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue->tasks.back());
+    queue->tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingScheduler::steal(int thief, Task& task) {
+    int count = static_cast<int>(queues.size());
+    for (int offset = 1; offset < count; ++offset) {
+        WorkerQueue* victim = queues[(thief + offset) % count];
+        std::unique_lock<std::mutex> lock(victim->mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim->tasks.empty()) {
+            continue;
+        }
+        task = std::move(victim->tasks.front());
+        victim->tasks.pop_front();
+        steals++;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingScheduler::workerLoop(int index) {
+    currentWorkerIndex = index;
+
+    while (true) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            queued--;
+            task();
+            executed++;
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                allIdle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        if (stopping) {
+            return;
+        }
+        if (queued.load() == 0) {
+            workAvailable.wait(lock, [this] { return stopping || queued.load() > 0; });
+        }
+    }
+}
@@ -0,0 +1,60 @@
+// ===== WorkStealingScheduler.h =====
+#ifndef WORK_STEALING_SCHEDULER_H
+#define WORK_STEALING_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size thread pool with one task deque per worker
+ *
+ * A worker runs its own tasks newest-first and, when it runs dry, steals the
+ * oldest task from another worker. Tasks are given a preferred worker so
+ * related work (e.g. one checkout lane) stays on one thread until it has to
+ * be rebalanced.
+ */
+class WorkStealingScheduler {
+public:
+    typedef std::function<void()> Task;
+
+    explicit WorkStealingScheduler(int workerCount);
+    ~WorkStealingScheduler();
+
+    void submit(int preferredWorker, Task task);
+    void waitIdle();  // Blocks until every submitted task has finished
+
+    int getWorkerCount() const { return static_cast<int>(workers.size()); }
+    long getStealCount() const { return steals.load(); }
+    long getExecutedCount() const { return executed.load(); }
+
+    static int currentWorker();  // Index of the calling worker, -1 outside the pool
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<WorkerQueue*> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allIdle;
+    std::atomic<long> pending;   // Submitted but not yet finished
+    std::atomic<long> queued;    // Sitting in a deque
+    std::atomic<long> steals;
+    std::atomic<long> executed;
+    bool stopping;
+
+    void workerLoop(int index);
+    bool popLocal(int index, Task& task);
+    bool steal(int thief, Task& task);
+};
+
+#endif // WORK_STEALING_SCHEDULER_H